@@ -0,0 +1,317 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "Utils.hpp"
+
+namespace moe
+{
+    /**
+     * @brief 线性（Bump-pointer）分配器
+     *
+     * 从大块内存中顺序切分，不支持单独释放对象，适用于生命周期一致的一组临时对象（如一次请求中产生的所有数据）。
+     * - Reset 以O(1)的代价回收所有内存（已分配的大块会被保留用于后续分配）；
+     * - GetCheckpoint/Rewind 可以回滚到任意检查点，检查点可以嵌套；
+     * - New 构造的非平凡析构对象会在回滚或重置时按构造的逆序析构。
+     *
+     * 非线程安全。
+     */
+    class Arena :
+        public NonCopyable
+    {
+        struct Chunk
+        {
+            Chunk* Next;  // 下一个块
+            size_t Size;  // 数据区大小
+            // 数据区紧随其后
+        };
+
+        struct Finalizer
+        {
+            void (*Func)(void*);
+            void* Object;
+            Finalizer* Prev;
+        };
+
+    public:
+        static const size_t kDefaultAlignment = alignof(std::max_align_t);
+        static const size_t kChunkHeaderSize = (sizeof(Chunk) + kDefaultAlignment - 1) & ~(kDefaultAlignment - 1);
+        static const size_t kDefaultChunkSize = 4096 - kChunkHeaderSize;
+
+        /**
+         * @brief 检查点
+         */
+        class Checkpoint
+        {
+            friend class Arena;
+
+        public:
+            Checkpoint() = default;
+
+        private:
+            Chunk* m_pChunk = nullptr;
+            uint8_t* m_pCursor = nullptr;
+            Finalizer* m_pFinalizers = nullptr;
+        };
+
+        /**
+         * @brief 作用域检查点
+         *
+         * 构造时记录检查点，析构时回滚到检查点。
+         */
+        class Scope :
+            public NonCopyable
+        {
+        public:
+            explicit Scope(Arena& arena)
+                : m_stArena(arena), m_stCheckpoint(arena.GetCheckpoint()) {}
+
+            ~Scope()
+            {
+                m_stArena.Rewind(m_stCheckpoint);
+            }
+
+        private:
+            Arena& m_stArena;
+            Checkpoint m_stCheckpoint;
+        };
+
+    public:
+        /**
+         * @brief 构造分配器
+         * @param chunkSize 每次向系统申请的块大小，超过该大小的分配会使用独立的块
+         */
+        explicit Arena(size_t chunkSize=kDefaultChunkSize)noexcept;
+        ~Arena();
+
+    public:
+        /**
+         * @brief 获取已分配的内存量（字节，包含对齐填充和块尾部未能利用的空间）
+         */
+        size_t GetUsedSize()const noexcept;
+
+        /**
+         * @brief 获取向系统申请的内存总量（字节）
+         */
+        size_t GetCapacity()const noexcept;
+
+        /**
+         * @brief 分配内存
+         * @exception std::bad_alloc 内存不足时抛出
+         * @param sz 大小
+         * @param align 对齐，必须是2的幂
+         * @return 指针
+         */
+        void* Alloc(size_t sz, size_t align=kDefaultAlignment)
+        {
+            assert(align > 0 && (align & (align - 1)) == 0);
+
+            auto p = AlignUp(m_pCursor, align);
+            if (p && p <= m_pEnd && sz <= static_cast<size_t>(m_pEnd - p))
+            {
+                m_pCursor = p + sz;
+                return p;
+            }
+            return AllocSlow(sz, align);
+        }
+
+        /**
+         * @brief 释放内存
+         * @param p 指针
+         * @param sz 分配时的大小
+         *
+         * 仅当p是最近一次分配的内存时才会真正回收，否则什么也不做。
+         */
+        void Free(void* p, size_t sz)noexcept
+        {
+            if (p && static_cast<uint8_t*>(p) + sz == m_pCursor)
+                m_pCursor = static_cast<uint8_t*>(p);
+        }
+
+        /**
+         * @brief 构造对象
+         * @exception std::bad_alloc 内存不足时抛出
+         * @tparam T 类型
+         * @param args 构造参数
+         * @return 对象指针，生命周期由Arena管理
+         */
+        template <typename T, typename... Args>
+        T* New(Args&&... args)
+        {
+            return NewImpl<T>(std::is_trivially_destructible<T>(), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief 获取检查点
+         */
+        Checkpoint GetCheckpoint()const noexcept
+        {
+            Checkpoint ret;
+            ret.m_pChunk = m_pCurrent;
+            ret.m_pCursor = m_pCursor;
+            ret.m_pFinalizers = m_pFinalizers;
+            return ret;
+        }
+
+        /**
+         * @brief 回滚到检查点
+         * @param checkpoint 检查点
+         *
+         * 检查点之后分配的内存全部失效，之后New出的对象会被析构。检查点之后获取的检查点也同时失效。
+         */
+        void Rewind(const Checkpoint& checkpoint)noexcept;
+
+        /**
+         * @brief 重置分配器
+         *
+         * 析构所有New出的对象，并回收所有内存（保留已申请的块）。
+         */
+        void Reset()noexcept;
+
+        /**
+         * @brief 释放未使用的块
+         * @return 释放的内存量（字节）
+         */
+        size_t Shrink()noexcept;
+
+    private:
+        static uint8_t* AlignUp(uint8_t* p, size_t align)noexcept
+        {
+            return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(p) + (align - 1)) &
+                ~static_cast<uintptr_t>(align - 1));
+        }
+
+        static uint8_t* GetChunkData(Chunk* chunk)noexcept
+        {
+            return reinterpret_cast<uint8_t*>(chunk) + kChunkHeaderSize;
+        }
+
+        template <typename T>
+        static void Destruct(void* p)noexcept
+        {
+            static_cast<T*>(p)->~T();
+        }
+
+        template <typename T, typename... Args>
+        T* NewImpl(std::true_type, Args&&... args)
+        {
+            auto p = Alloc(sizeof(T), alignof(T));
+            return new(p) T(std::forward<Args>(args)...);
+        }
+
+        template <typename T, typename... Args>
+        T* NewImpl(std::false_type, Args&&... args)
+        {
+            auto checkpoint = GetCheckpoint();
+            auto f = static_cast<Finalizer*>(Alloc(sizeof(Finalizer), alignof(Finalizer)));
+            auto p = Alloc(sizeof(T), alignof(T));
+
+            T* ret = nullptr;
+            try
+            {
+                ret = new(p) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                Rewind(checkpoint);
+                throw;
+            }
+
+            f->Func = &Destruct<T>;
+            f->Object = ret;
+            f->Prev = m_pFinalizers;
+            m_pFinalizers = f;
+            return ret;
+        }
+
+        void* AllocSlow(size_t sz, size_t align);
+        void RunFinalizers(Finalizer* until)noexcept;
+
+    private:
+        size_t m_uChunkSize = 0;
+        Chunk* m_pHead = nullptr;  // 第一个块
+        Chunk* m_pCurrent = nullptr;  // 当前分配的块
+        uint8_t* m_pCursor = nullptr;
+        uint8_t* m_pEnd = nullptr;
+        Finalizer* m_pFinalizers = nullptr;
+    };
+
+    /**
+     * @brief 基于Arena的STL分配器
+     * @tparam T 类型
+     *
+     * deallocate仅在释放最近一次的分配时回收内存，其余时候为空操作，内存随Arena统一回收。
+     */
+    template <typename T>
+    class ArenaAllocator
+    {
+        template <typename U>
+        friend class ArenaAllocator;
+
+    public:
+        using value_type = T;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = ArenaAllocator<U>;
+        };
+
+    public:
+        ArenaAllocator(Arena& arena)noexcept
+            : m_pArena(&arena) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& rhs)noexcept
+            : m_pArena(rhs.m_pArena) {}
+
+        bool operator==(const ArenaAllocator& rhs)const noexcept { return m_pArena == rhs.m_pArena; }
+        bool operator!=(const ArenaAllocator& rhs)const noexcept { return m_pArena != rhs.m_pArena; }
+
+    public:
+        /**
+         * @brief 获取关联的Arena
+         */
+        Arena& GetArena()const noexcept { return *m_pArena; }
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(m_pArena->Alloc(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n)noexcept
+        {
+            m_pArena->Free(p, n * sizeof(T));
+        }
+
+        template <typename U, typename... Args>
+        void construct(U* p, Args&&... args)
+        {
+            new(p) U(std::forward<Args>(args)...);
+        }
+
+        template <typename U>
+        void destroy(U* p)noexcept
+        {
+            p->~U();
+        }
+
+    private:
+        Arena* m_pArena = nullptr;
+    };
+}
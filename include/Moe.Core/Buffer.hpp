@@ -9,12 +9,16 @@
 
 #include "Math.hpp"
 #include "ArrayView.hpp"
+#include "ObjectPool.hpp"
 
 namespace moe
 {
     /**
      * @brief 缓冲区
      * @tparam LocalStorageSize 原地分配的大小
+     *
+     * 超过原地空间的数据存放在堆上，容量按2的幂次增长，连续追加的均摊复杂度为O(1)。
+     * 堆空间默认通过malloc分配，指定对象池后改为从对象池分配，适用于大量短小消息的场合。
      */
     template <size_t LocalStorageSize = 128>
     class Buffer
@@ -27,6 +31,13 @@ namespace moe
     public:
         Buffer() = default;
 
+        /**
+         * @brief 构造使用对象池分配堆空间的缓冲区
+         * @param pool 对象池，需要比缓冲区活得更久
+         */
+        explicit Buffer(ObjectPool* pool)noexcept
+            : m_pPool(pool) {}
+
         Buffer(const uint8_t* data, size_t sz)
         {
             Resize(sz);
@@ -39,65 +50,61 @@ namespace moe
             ::memcpy(GetBuffer(), view.GetBuffer(), view.GetSize());
         }
 
+        Buffer(const Buffer& rhs)
+            : m_pPool(rhs.m_pPool)
+        {
+            CopyFrom(rhs);
+        }
+
         template <size_t I>
         Buffer(const Buffer<I>& rhs)
+            : m_pPool(rhs.m_pPool)
         {
-            Resize(rhs.GetSize());
-            ::memcpy(GetBuffer(), rhs.GetBuffer(), rhs.GetSize());
+            CopyFrom(rhs);
+        }
+
+        Buffer(Buffer&& rhs)
+            : m_pPool(rhs.m_pPool)
+        {
+            MoveFrom(rhs);
         }
 
         template <size_t I>
         Buffer(Buffer<I>&& rhs)
+            : m_pPool(rhs.m_pPool)
         {
-            if (rhs.GetSize() <= LocalStorageSize)
-            {
-                // 原地拷贝
-                m_uSize = rhs.m_uSize;
-                ::memcpy(&m_stStorage, rhs.GetBuffer(), rhs.GetSize());
-
-                rhs.m_uSize = 0;
-            }
-            else
-            {
-                if (rhs.m_uHeapCapacity != 0)
-                {
-                    // 直接move指针
-                    m_pBuffer = rhs.m_pBuffer;
-                    m_uHeapCapacity = rhs.m_uHeapCapacity;
-                    m_uSize = rhs.m_uSize;
-
-                    rhs.m_pBuffer = nullptr;
-                    rhs.m_uHeapCapacity = 0;
-                    rhs.m_uSize = 0;
-                }
-                else
-                {
-                    // 需要分配堆空间
-                    Resize(rhs.GetSize());
-                    ::memcpy(GetBuffer(), rhs.GetBuffer(), rhs.GetSize());
-
-                    rhs.m_uSize = 0;
-                }
-            }
+            MoveFrom(rhs);
         }
 
         ~Buffer()
         {
-            if (m_uHeapCapacity > 0)
-            {
-                ::free(m_pBuffer);
-                m_pBuffer = nullptr;
-                m_uHeapCapacity = 0;
-            }
+            ReleaseHeap();
             m_uSize = 0;
         }
 
+        Buffer& operator=(const Buffer& rhs)
+        {
+            if (this != &rhs)
+                CopyFrom(rhs);
+            return *this;
+        }
+
         template <size_t I>
         Buffer& operator=(const Buffer<I>& rhs)
         {
-            Resize(rhs.GetSize());
-            ::memcpy(GetBuffer(), rhs.GetBuffer(), rhs.GetSize());
+            CopyFrom(rhs);
+            return *this;
+        }
 
+        Buffer& operator=(Buffer&& rhs)
+        {
+            if (this != &rhs)
+            {
+                // 无论如何都需要释放对象自己申请的堆空间
+                ReleaseHeap();
+                m_uSize = 0;
+                MoveFrom(rhs);
+            }
             return *this;
         }
 
@@ -105,45 +112,9 @@ namespace moe
         Buffer& operator=(Buffer<I>&& rhs)
         {
             // 无论如何都需要释放对象自己申请的堆空间
-            if (m_uHeapCapacity > 0)
-            {
-                ::free(m_pBuffer);
-                m_uHeapCapacity = 0;
-            }
-            m_pBuffer = nullptr;
+            ReleaseHeap();
             m_uSize = 0;
-
-            if (rhs.GetSize() <= LocalStorageSize)
-            {
-                // 原地拷贝
-                m_uSize = rhs.m_uSize;
-                ::memcpy(&m_stStorage, rhs.GetBuffer(), rhs.GetSize());
-
-                rhs.m_uSize = 0;
-            }
-            else
-            {
-                if (rhs.m_uHeapCapacity != 0)
-                {
-                    // 直接move指针
-                    m_pBuffer = rhs.m_pBuffer;
-                    m_uHeapCapacity = rhs.m_uHeapCapacity;
-                    m_uSize = rhs.m_uSize;
-
-                    rhs.m_pBuffer = nullptr;
-                    rhs.m_uHeapCapacity = 0;
-                    rhs.m_uSize = 0;
-                }
-                else
-                {
-                    // 需要分配堆空间
-                    Resize(rhs.GetSize());
-                    ::memcpy(GetBuffer(), rhs.GetBuffer(), rhs.GetSize());
-
-                    rhs.m_uSize = 0;
-                }
-            }
-
+            MoveFrom(rhs);
             return *this;
         }
 
@@ -160,6 +131,15 @@ namespace moe
         }
 
     public:
+        /**
+         * @brief 获取或设置分配堆空间使用的对象池
+         *
+         * nullptr表示使用malloc。设置只影响之后的分配，已经分配的空间仍然按照原来的方式释放。
+         * 拷贝或移动构造时继承来源的对象池，赋值时保持不变。
+         */
+        ObjectPool* GetPool()const noexcept { return m_pPool; }
+        void SetPool(ObjectPool* pool)noexcept { m_pPool = pool; }
+
         /**
          * @brief 是否为空
          */
@@ -220,6 +200,8 @@ namespace moe
         /**
          * @brief 重新分配大小
          * @param sz 期望的可用空间
+         *
+         * 空间不足时按2的幂次向上取整分配。
          */
         void Recapacity(size_t sz)
         {
@@ -228,27 +210,54 @@ namespace moe
                 return;
 
             // 否则需要分配足够内存
-            size_t required = Math::NextPowerOf2(sz);
+            size_t required = sz;
+            if (sz <= 0x80000000u)
+                required = Math::NextPowerOf2(static_cast<uint32_t>(sz));
             assert(required >= LocalStorageSize);
             if (required <= m_uHeapCapacity)
                 return;
 
-            uint8_t* buffer = nullptr;
-            if (m_uHeapCapacity == 0)
-                buffer = static_cast<uint8_t*>(::malloc(required));
-            else
-                buffer = static_cast<uint8_t*>(::realloc(m_pBuffer, required));
+            Reallocate(required);
+        }
 
-            // 若内存分配失败则抛出异常，此时保证原状态不变
-            if (!buffer)
-                throw std::bad_alloc();
+        /**
+         * @brief 预留空间
+         * @param sz 期望的可用空间
+         *
+         * 与Recapacity不同，空间不足时按照sz精确分配，适用于最终大小已知的场合。
+         * 若内存分配失败则抛出异常，此时保证原状态不变。
+         */
+        void Reserve(size_t sz)
+        {
+            if (sz <= GetCapacity())
+                return;
+            Reallocate(sz);
+        }
+
+        /**
+         * @brief 释放多余的空间
+         *
+         * 数据可以放入原地空间时归还堆空间，否则将堆空间缩小到恰好容纳数据。
+         * 若内存分配失败则抛出异常，此时保证原状态不变。
+         */
+        void ShrinkToFit()
+        {
+            if (m_uHeapCapacity == 0 || m_uSize == m_uHeapCapacity)
+                return;
 
-            // 如果原来在栈空间分配，则需要把东西拷贝到新的空间上
-            if (m_uHeapCapacity == 0 && m_uSize > 0)
-                ::memcpy(buffer, &m_stStorage, m_uSize);
+            if (m_uSize <= LocalStorageSize)
+            {
+                auto buffer = m_pBuffer;
+                auto pooled = m_bHeapFromPool;
+                if (m_uSize > 0)
+                    ::memcpy(&m_stStorage, buffer, m_uSize);
+                FreeHeap(buffer, pooled);
+                m_uHeapCapacity = 0;
+                m_bHeapFromPool = false;
+                return;
+            }
 
-            m_pBuffer = buffer;
-            m_uHeapCapacity = required;
+            Reallocate(m_uSize);
         }
 
         /**
@@ -264,7 +273,7 @@ namespace moe
          * @param data 数据源
          * @param sz 大小
          */
-        void Append(void* data, size_t sz)
+        void Append(const void* data, size_t sz)
         {
             if (sz == 0)
                 return;
@@ -278,14 +287,7 @@ namespace moe
 
         void Append(BytesView data)
         {
-            if (data.GetSize() == 0)
-                return;
-
-            size_t osz = GetSize();
-            Resize(osz + data.GetSize());
-
-            // 空间分配成功后拷贝data的内容
-            ::memcpy(GetBuffer() + osz, data.GetBuffer(), data.GetSize());
+            Append(data.GetBuffer(), data.GetSize());
         }
 
         /**
@@ -337,6 +339,112 @@ namespace moe
             return MutableBytesView(GetBuffer(), GetSize());
         }
 
+    private:
+        template <size_t I>
+        void CopyFrom(const Buffer<I>& rhs)
+        {
+            Resize(rhs.GetSize());
+            if (rhs.GetSize() > 0)
+                ::memcpy(GetBuffer(), rhs.GetBuffer(), rhs.GetSize());
+        }
+
+        template <size_t I>
+        void MoveFrom(Buffer<I>& rhs)
+        {
+            assert(m_uHeapCapacity == 0 && m_uSize == 0);
+
+            if (rhs.GetSize() <= LocalStorageSize)
+            {
+                // 原地拷贝
+                m_uSize = rhs.m_uSize;
+                if (m_uSize > 0)
+                    ::memcpy(&m_stStorage, rhs.GetBuffer(), rhs.GetSize());
+
+                rhs.m_uSize = 0;
+            }
+            else
+            {
+                if (rhs.m_uHeapCapacity != 0)
+                {
+                    // 直接move指针
+                    m_pBuffer = rhs.m_pBuffer;
+                    m_uHeapCapacity = rhs.m_uHeapCapacity;
+                    m_bHeapFromPool = rhs.m_bHeapFromPool;
+                    m_uSize = rhs.m_uSize;
+
+                    rhs.m_pBuffer = nullptr;
+                    rhs.m_uHeapCapacity = 0;
+                    rhs.m_bHeapFromPool = false;
+                    rhs.m_uSize = 0;
+                }
+                else
+                {
+                    // 需要分配堆空间
+                    Resize(rhs.GetSize());
+                    ::memcpy(GetBuffer(), rhs.GetBuffer(), rhs.GetSize());
+
+                    rhs.m_uSize = 0;
+                }
+            }
+        }
+
+        uint8_t* AllocHeap(size_t sz)
+        {
+            if (m_pPool)
+                return static_cast<uint8_t*>(m_pPool->Alloc(sz).release());
+
+            auto ret = static_cast<uint8_t*>(::malloc(sz));
+            if (!ret)
+                throw std::bad_alloc();
+            return ret;
+        }
+
+        static void FreeHeap(uint8_t* p, bool pooled)noexcept
+        {
+            if (pooled)
+                ObjectPool::Free(p);
+            else
+                ::free(p);
+        }
+
+        void ReleaseHeap()noexcept
+        {
+            if (m_uHeapCapacity > 0)
+            {
+                FreeHeap(m_pBuffer, m_bHeapFromPool);
+                m_pBuffer = nullptr;
+                m_uHeapCapacity = 0;
+                m_bHeapFromPool = false;
+            }
+        }
+
+        void Reallocate(size_t capacity)
+        {
+            assert(capacity > LocalStorageSize && capacity >= m_uSize);
+
+            // 若内存分配失败则抛出异常，此时保证原状态不变
+            uint8_t* buffer = nullptr;
+            if (m_uHeapCapacity != 0 && !m_bHeapFromPool && !m_pPool)
+            {
+                buffer = static_cast<uint8_t*>(::realloc(m_pBuffer, capacity));
+                if (!buffer)
+                    throw std::bad_alloc();
+            }
+            else
+            {
+                // 如果原来在栈空间分配或者分配方式发生变化，则需要把东西拷贝到新的空间上
+                buffer = AllocHeap(capacity);
+                if (m_uSize > 0)
+                    ::memcpy(buffer, GetBuffer(), m_uSize);
+                if (m_uHeapCapacity != 0)
+                    FreeHeap(m_pBuffer, m_bHeapFromPool);
+            }
+
+            m_pBuffer = buffer;
+            m_uHeapCapacity = capacity;
+            m_bHeapFromPool = (m_pPool != nullptr);
+        }
+
     private:
         union
         {
@@ -346,5 +454,7 @@ namespace moe
 
         size_t m_uSize = 0;
         size_t m_uHeapCapacity = 0;
+        ObjectPool* m_pPool = nullptr;
+        bool m_bHeapFromPool = false;  // 当前的堆空间是否来自对象池
     };
 }
@@ -0,0 +1,226 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#pragma once
+#include <deque>
+
+#include "Stream.hpp"
+#include "ObjectPool.hpp"
+
+namespace moe
+{
+    /**
+     * @brief 分段缓冲区
+     *
+     * 由若干从ObjectPool分配的定长块串成的缓冲区。追加、前插、从头部消耗和拆分都不会移动已有数据，
+     * 适用于网络收发等数据不断增长、又需要从头部逐步处理的场合。
+     *
+     * 块带有引用计数，Split时跨越边界的块由两个缓冲区共享，共享的块不会再被写入。
+     *
+     * 注意到：
+     *  - 缓冲区不是线程安全的，块的引用计数也不是原子的；
+     *  - 块的内存在释放时归还给分配它的对象池，对象池需要比缓冲区及由其拆分出的缓冲区活得更久。
+     */
+    class ChainBuffer :
+        public NonCopyable
+    {
+    public:
+        /**
+         * @brief 默认块大小
+         *
+         * 留出块头部的空间，使整个块落在对象池的小对象分级中。
+         */
+        static const size_t kDefaultChunkSize = ObjectPool::kSmallSizeThreshold - 32;
+
+    public:
+        ChainBuffer(ObjectPool& pool, size_t chunkSize=kDefaultChunkSize);
+        ChainBuffer(ChainBuffer&& rhs)noexcept;
+        ~ChainBuffer();
+
+        ChainBuffer& operator=(ChainBuffer&& rhs)noexcept;
+
+    public:
+        /**
+         * @brief 获取关联的对象池
+         */
+        ObjectPool& GetPool()const noexcept { return *m_pPool; }
+
+        /**
+         * @brief 获取块大小
+         */
+        size_t GetChunkSize()const noexcept { return m_uChunkSize; }
+
+        /**
+         * @brief 是否为空
+         */
+        bool IsEmpty()const noexcept { return m_uSize == 0; }
+
+        /**
+         * @brief 获取数据大小
+         */
+        size_t GetSize()const noexcept { return m_uSize; }
+
+        /**
+         * @brief 获取分段个数
+         */
+        size_t GetSegmentCount()const noexcept { return m_stSegments.size(); }
+
+        /**
+         * @brief 获取分段
+         * @param index 下标
+         */
+        BytesView GetSegment(size_t index)const noexcept
+        {
+            assert(index < m_stSegments.size());
+            const Segment& segment = m_stSegments[index];
+            return BytesView(segment.Block->GetData() + segment.Begin, segment.End - segment.Begin);
+        }
+
+        /**
+         * @brief 清空
+         */
+        void Clear()noexcept;
+
+        /**
+         * @brief 在末尾追加数据
+         * @param data 数据
+         */
+        void Append(BytesView data);
+
+        /**
+         * @brief 将另一个缓冲区的数据追加到末尾
+         * @param other 缓冲区，调用后被清空
+         *
+         * 只转移分段，不拷贝数据。
+         */
+        void Append(ChainBuffer&& other);
+
+        /**
+         * @brief 在头部插入数据
+         * @param data 数据
+         *
+         * 头部块前方有空闲空间时直接写入，否则分配新块并从块的末尾开始向前填充，使后续的前插可以继续使用剩余空间。
+         */
+        void Prepend(BytesView data);
+
+        /**
+         * @brief 准备在末尾写入
+         * @return 末尾的可写空间，不为空
+         *
+         * 用于直接将数据接收到缓冲区中，写入后通过CommitAppend提交。
+         */
+        MutableBytesView PrepareAppend();
+
+        /**
+         * @brief 提交写入到PrepareAppend返回的空间中的数据
+         * @param count 写入的字节数
+         */
+        void CommitAppend(size_t count);
+
+        /**
+         * @brief 从头部消耗数据
+         * @param count 字节数
+         * @return 实际消耗的字节数
+         */
+        size_t Consume(size_t count)noexcept;
+
+        /**
+         * @brief 拆分出头部的数据
+         * @param count 字节数
+         * @return 包含头部count字节的新缓冲区，使用相同的对象池和块大小
+         *
+         * 剩余的数据留在当前缓冲区中。跨越边界的块会被共享而不是拷贝。
+         */
+        ChainBuffer Split(size_t count);
+
+        /**
+         * @brief 拷贝数据而不消耗
+         * @param out 输出缓冲区
+         * @param offset 开始拷贝的偏移
+         * @return 拷贝的字节数
+         */
+        size_t CopyTo(MutableBytesView out, size_t offset=0)const noexcept;
+
+        /**
+         * @brief 收集分段
+         * @param[out] out 输出的分段数组
+         * @param offset 开始收集的偏移
+         * @return 输出的分段个数
+         *
+         * 输出可以直接交给Stream::WriteV等分散/聚集接口。分段数量超过out的大小时只输出前面的部分。
+         */
+        size_t Gather(MutableArrayView<BytesView> out, size_t offset=0)const noexcept;
+
+    private:
+        struct Chunk
+        {
+            size_t RefCount;
+            size_t Capacity;
+
+            uint8_t* GetData()noexcept { return reinterpret_cast<uint8_t*>(this + 1); }
+            const uint8_t* GetData()const noexcept { return reinterpret_cast<const uint8_t*>(this + 1); }
+        };
+
+        struct Segment
+        {
+            Chunk* Block;
+            size_t Begin;
+            size_t End;
+        };
+
+        Chunk* AllocChunk();
+        void RecycleChunk(Chunk* chunk)noexcept;
+        static void ReleaseChunk(Chunk* chunk)noexcept;
+        Segment* GetWritableTail()noexcept;
+
+    private:
+        ObjectPool* m_pPool = nullptr;
+        size_t m_uChunkSize = 0;
+        size_t m_uSize = 0;
+        std::deque<Segment> m_stSegments;
+        Chunk* m_pReserved = nullptr;  // PrepareAppend分配的尚未提交的块，或被回收以备复用的块
+    };
+
+    /**
+     * @brief ChainBuffer到Stream包装器
+     *
+     * 读取从缓冲区头部消耗数据，写入追加到缓冲区末尾。位置为已经读取的字节数，长度为位置加上缓冲区中剩余的数据量。
+     * 读窗口为头部分段，写窗口为末尾的空闲空间，BinaryReader/BinaryWriter及Mdr可以直接在块上读写。
+     * 包装器不会持有缓冲区对象。
+     */
+    class ChainBufferStream :
+        public Stream
+    {
+    public:
+        ChainBufferStream(ChainBuffer& buffer);
+
+    public:
+        /**
+         * @brief 获取缓冲区
+         */
+        ChainBuffer& GetBuffer()const noexcept { return m_stBuffer; }
+
+        bool IsReadable()const noexcept;
+        bool IsWriteable()const noexcept;
+        bool IsSeekable()const noexcept;
+        size_t GetLength()const;
+        size_t GetPosition()const;
+        void Flush();
+        int ReadByte();
+        size_t Read(MutableBytesView out, size_t count);
+        size_t Seek(int64_t offset, StreamSeekOrigin origin);
+        void SetLength(size_t length);
+        void WriteByte(uint8_t b);
+        void Write(BytesView view, size_t count);
+        void WriteV(ArrayView<BytesView> buffers);
+        BytesView GetReadWindow();
+        void AdvanceRead(size_t count);
+        MutableBytesView GetWriteWindow();
+        void AdvanceWrite(size_t count);
+
+    private:
+        size_t m_uPosition = 0;
+        ChainBuffer& m_stBuffer;
+    };
+}
@@ -0,0 +1,190 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#pragma once
+#include <vector>
+
+#include "Stream.hpp"
+
+namespace moe
+{
+    /**
+     * @brief 压缩方法
+     */
+    namespace Compression
+    {
+        /**
+         * @brief LZ4块格式压缩
+         * @see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+         *
+         * 输出与LZ4块格式兼容，可以被标准的LZ4_decompress_safe解压，反之亦然。
+         * 块格式不记录原始大小，需要由调用方自行保存。
+         */
+        class Lz4
+        {
+        public:
+            /**
+             * @brief 获取压缩结果的最大大小
+             * @param inputSize 输入大小
+             */
+            static size_t GetMaxCompressedSize(size_t inputSize)noexcept
+            {
+                return inputSize + inputSize / 255 + 16;
+            }
+
+            /**
+             * @brief 压缩
+             * @exception BadArgumentException 输入超过2016MB时抛出
+             * @exception OutOfRangeException 输出缓冲区不足时抛出
+             * @param input 输入
+             * @param output 输出缓冲区，大小不小于GetMaxCompressedSize时总能成功
+             * @return 压缩后的大小
+             */
+            static size_t Compress(BytesView input, MutableBytesView output);
+
+            /**
+             * @brief 压缩并追加到容器末尾
+             * @exception BadArgumentException 输入超过2016MB时抛出
+             * @param out 输出容器
+             * @param input 输入
+             */
+            static void Compress(std::vector<uint8_t>& out, BytesView input);
+
+            /**
+             * @brief 解压
+             * @exception BadFormatException 数据损坏时抛出
+             * @exception OutOfRangeException 输出缓冲区不足时抛出
+             * @param input 压缩数据
+             * @param output 输出缓冲区
+             * @return 解压后的大小
+             */
+            static size_t Decompress(BytesView input, MutableBytesView output);
+
+            /**
+             * @brief 解压并追加到容器末尾
+             * @exception BadFormatException 数据损坏时抛出
+             * @param out 输出容器
+             * @param input 压缩数据
+             *
+             * 原始大小未知，会按需扩大输出缓冲区并重试。已知原始大小时应使用缓冲区版本。
+             */
+            static void Decompress(std::vector<uint8_t>& out, BytesView input);
+        };
+
+        /**
+         * @brief LZ4压缩流
+         *
+         * 写入的数据按块压缩后写入底层流，每个块独立压缩。
+         * 流格式为：4字节魔数"MLZ4"，之后是若干块，每块以4字节小端的长度开始（最高位为1表示未压缩），
+         * 压缩块随后是4字节小端的原始大小，最后以长度为0的块结束。
+         *
+         * 注意到：
+         *  - 压缩流不会持有底层流对象；
+         *  - 必须调用Finish（或析构）写出最后的块和结束标记。
+         */
+        class Lz4CompressStream final :
+            public Stream
+        {
+        public:
+            static const size_t kDefaultBlockSize = 64 * 1024;
+            static const size_t kMaxBlockSize = 4 * 1024 * 1024;
+
+        public:
+            Lz4CompressStream(Stream* stream, size_t blockSize=kDefaultBlockSize);
+            ~Lz4CompressStream();
+
+        public:
+            /**
+             * @brief 获取底层流
+             */
+            Stream* GetStream()const noexcept { return m_pStream; }
+
+            /**
+             * @brief 写出剩余数据和结束标记
+             *
+             * 调用后不能再写入数据。
+             */
+            void Finish();
+
+            bool IsReadable()const noexcept;
+            bool IsWriteable()const noexcept;
+            bool IsSeekable()const noexcept;
+            size_t GetLength()const;
+            size_t GetPosition()const;
+            void Flush();
+            int ReadByte();
+            size_t Read(MutableBytesView out, size_t count);
+            size_t Seek(int64_t offset, StreamSeekOrigin origin);
+            void SetLength(size_t length);
+            void WriteByte(uint8_t b);
+            void Write(BytesView view, size_t count);
+            MutableBytesView GetWriteWindow();
+            void AdvanceWrite(size_t count);
+
+        private:
+            void WriteHeader();
+            void FlushBlock();
+
+        private:
+            Stream* m_pStream = nullptr;
+            std::vector<uint8_t> m_stBlock;
+            std::vector<uint8_t> m_stCompressed;
+            size_t m_uBlockEnd = 0;
+            size_t m_uTotal = 0;
+            bool m_bHeaderWritten = false;
+            bool m_bFinished = false;
+        };
+
+        /**
+         * @brief LZ4解压流
+         *
+         * 读取Lz4CompressStream产生的数据。提供读取窗口，BinaryReader和Mdr::Reader可以直接在解压缓冲区上解码。
+         * 解压流不会持有底层流对象。
+         */
+        class Lz4DecompressStream final :
+            public Stream
+        {
+        public:
+            /**
+             * @brief 构造解压流
+             * @exception BadFormatException 魔数不匹配时抛出
+             * @param stream 底层流
+             */
+            Lz4DecompressStream(Stream* stream);
+
+        public:
+            /**
+             * @brief 获取底层流
+             */
+            Stream* GetStream()const noexcept { return m_pStream; }
+
+            bool IsReadable()const noexcept;
+            bool IsWriteable()const noexcept;
+            bool IsSeekable()const noexcept;
+            size_t GetLength()const;
+            size_t GetPosition()const;
+            void Flush();
+            int ReadByte();
+            size_t Read(MutableBytesView out, size_t count);
+            size_t Seek(int64_t offset, StreamSeekOrigin origin);
+            void SetLength(size_t length);
+            void WriteByte(uint8_t b);
+            void Write(BytesView view, size_t count);
+            BytesView GetReadWindow();
+            void AdvanceRead(size_t count);
+
+        private:
+            bool ReadBlock();
+
+        private:
+            Stream* m_pStream = nullptr;
+            std::vector<uint8_t> m_stBlock;
+            std::vector<uint8_t> m_stCompressed;
+            size_t m_uReadPosition = 0;
+            size_t m_uBlockEnd = 0;
+            size_t m_uTotal = 0;  // 已解压的块的总大小
+            bool m_bEof = false;
+        };
+    }
+}
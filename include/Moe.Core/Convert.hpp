@@ -607,6 +607,30 @@ namespace moe
                 static void GetCachedPowerForDecimalExponent(int requestedExponent, DiyFp& power, int& foundExponent);
             };
 
+            /**
+             * @brief Eisel-Lemire算法
+             *
+             * 将有效数字与128位精度（向下截断）的10的幂相乘，通常一次64位乘法即可确定最接近的double。
+             * 截断误差可能影响舍入方向，或结果落在非规格化数及溢出范围内时返回false，需要回退到更慢的算法。
+             *
+             * @see https://arxiv.org/abs/2101.11408
+             */
+            class EiselLemire
+            {
+            public:
+                static const int kMinDecimalExponent;
+                static const int kMaxDecimalExponent;
+
+                /**
+                 * @brief 计算significand*10^exponent
+                 * @param significand 有效数字，不能为0
+                 * @param exponent 十进制指数，必须在[kMinDecimalExponent, kMaxDecimalExponent]范围内
+                 * @param[out] result 结果
+                 * @return 结果是否可以确定
+                 */
+                static bool Compute(uint64_t significand, int exponent, double& result)noexcept;
+            };
+
             class UInt128
             {
             private:
@@ -2599,6 +2623,9 @@ namespace moe
                 // (which has a 53bit significand) without loss of precision.
                 static const int kMaxExactDoubleIntegerDecimalDigits = 15;
 
+                // Any integer up to 2^53 fits into a double without loss of precision either.
+                static const uint64_t kMaxExactDoubleInteger = 9007199254740992ull;
+
                 // 2^64 = 18446744073709551616 > 10^19
                 static const int kMaxUInt64DecimalDigits = 19;
 
@@ -2717,6 +2744,22 @@ namespace moe
                 }
 
                 static bool DoubleStrtod(const ArrayView<T>& trimmed, int exponent, double& result)
+                {
+                    if (trimmed.GetSize() <= kMaxExactDoubleIntegerDecimalDigits)
+                    {
+                        size_t readDigits;
+                        uint64_t significand = ReadUInt64(trimmed, readDigits);
+                        assert(readDigits == trimmed.GetSize());
+                        return DoubleStrtod(significand, readDigits, exponent, result);
+                    }
+
+                    return false;
+                }
+
+                // Same as above, but takes the digits as an integer. The significand must be
+                // exactly representable by a double, i.e. not greater than 2^53, and have the
+                // given count of decimal digits.
+                static bool DoubleStrtod(uint64_t significand, size_t digits, int exponent, double& result)
                 {
                     static const double kExactPowersOfTen[] = {
                         1.0,  // 10^0
@@ -2749,11 +2792,9 @@ namespace moe
                     if (!kPlatformCorrectDoubleOperations)
                         return false;
 
-                    if (trimmed.GetSize() <= kMaxExactDoubleIntegerDecimalDigits)
+                    if (significand <= kMaxExactDoubleInteger)
                     {
-                        size_t readDigits;
-
-                        // The trimmed input fits into a double.
+                        // The significand fits into a double.
                         // If the 10^exponent (resp. 10^-exponent) fits into a double too then we
                         // can compute the result-double simply by multiplying (resp. dividing) the
                         // two numbers.
@@ -2762,8 +2803,7 @@ namespace moe
                         if (exponent < 0 && -exponent < kExactPowersOfTenSize)
                         {
                             // 10^-exponent fits into a double.
-                            result = static_cast<double>(ReadUInt64(trimmed, readDigits));
-                            assert(readDigits == trimmed.GetSize());
+                            result = static_cast<double>(significand);
                             result /= kExactPowersOfTen[-exponent];
                             return true;
                         }
@@ -2771,20 +2811,19 @@ namespace moe
                         if (0 <= exponent && exponent < kExactPowersOfTenSize)
                         {
                             // 10^exponent fits into a double.
-                            result = static_cast<double>(ReadUInt64(trimmed, readDigits));
-                            assert(readDigits == trimmed.GetSize());
+                            result = static_cast<double>(significand);
                             result *= kExactPowersOfTen[exponent];
                             return true;
                         }
 
-                        auto remainingDigits = static_cast<int>(kMaxExactDoubleIntegerDecimalDigits - trimmed.GetSize());
-                        if ((0 <= exponent) && (exponent - remainingDigits < kExactPowersOfTenSize))
+                        auto remainingDigits = kMaxExactDoubleIntegerDecimalDigits - static_cast<int>(digits);
+                        if ((0 <= remainingDigits) && (0 <= exponent) &&
+                            (exponent - remainingDigits < kExactPowersOfTenSize))
                         {
-                            // The trimmed string was short and we can multiply it with
+                            // The significand was short and we can multiply it with
                             // 10^remaining_digits. As a result the remaining exponent now fits
                             // into a double too.
-                            result = static_cast<double>(ReadUInt64(trimmed, readDigits));
-                            assert(readDigits == trimmed.GetSize());
+                            result = static_cast<double>(significand);
                             result *= kExactPowersOfTen[remainingDigits];
                             result *= kExactPowersOfTen[exponent - remainingDigits];
                             return true;
@@ -2834,7 +2873,15 @@ namespace moe
                     DiyFp input;
                     size_t remainingDecimals;
                     ReadDiyFp(buffer, input, remainingDecimals);
+                    return DiyFpStrtod(input, buffer.GetSize(), remainingDecimals, exponent, result);
+                }
 
+                // Same as above, but takes the significand read from the buffer. digits is the
+                // count of decimal digits in the buffer, remainingDecimals the count of digits
+                // that were dropped (and rounded) from the significand.
+                static bool DiyFpStrtod(DiyFp input, size_t digits, size_t remainingDecimals, int exponent,
+                    double& result)
+                {
                     // Since we may have dropped some digits the input is not accurate.
                     // If remaining_decimals is different than 0 than the error is at most
                     // .5 ulp (unit in the last place).
@@ -2868,7 +2915,7 @@ namespace moe
                         DiyFp adjustmentPower = AdjustmentPowerOfTen(adjustmentExponent);
                         input.Multiply(adjustmentPower);
 
-                        if (kMaxUInt64DecimalDigits - static_cast<int>(buffer.GetSize()) >= adjustmentExponent)
+                        if (kMaxUInt64DecimalDigits - static_cast<int>(digits) >= adjustmentExponent)
                         {
                             // The product of input with the adjustment power fits into a 64 bit
                             // integer.
@@ -3039,6 +3086,44 @@ namespace moe
                         return Double(guess).NextDouble();
                 }
 
+                // Computes significand*10^exponent without a digit buffer, for callers that
+                // accumulate the digits while scanning. The significand must be exact, i.e. it
+                // holds all the non-zero digits of the input, and has exactly the given count of
+                // decimal digits (at most kMaxUInt64DecimalDigits).
+                // Tries the exact double arithmetic, Eisel-Lemire and then DiyFp. Returns false
+                // when the result cannot be decided without the Bignum comparison, in which case
+                // the caller has to fall back to Strtod with the original digits.
+                static bool FastStrtod(uint64_t significand, size_t digits, int exponent, double& result)
+                {
+                    assert(digits <= static_cast<size_t>(kMaxUInt64DecimalDigits));
+                    if (significand == 0)
+                    {
+                        result = 0.0;
+                        return true;
+                    }
+
+                    if (exponent + static_cast<int>(digits) - 1 >= kMaxDecimalPower)
+                    {
+                        result = Double::Infinity();
+                        return true;
+                    }
+
+                    if (exponent + static_cast<int>(digits) <= kMinDecimalPower)
+                    {
+                        result = 0.0;
+                        return true;
+                    }
+
+                    if (DoubleStrtod(significand, digits, exponent, result))
+                        return true;
+
+                    assert(EiselLemire::kMinDecimalExponent <= exponent);
+                    assert(exponent <= EiselLemire::kMaxDecimalExponent);
+                    if (EiselLemire::Compute(significand, exponent, result))
+                        return true;
+                    return DiyFpStrtod(DiyFp(significand, 0), digits, 0, exponent, result);
+                }
+
                 // The buffer must only contain digits in the range [0-9]. It must not
                 // contain a dot or a sign. It must not start with '0', and must not be empty.
                 static float Strtof(const ArrayView<T>& buffer, int exponent)
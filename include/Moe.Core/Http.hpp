@@ -15,6 +15,8 @@
 
 namespace moe
 {
+    class ChainBuffer;
+
     /**
      * @brief HTTP状态码
      */
@@ -550,6 +552,16 @@ namespace moe
          */
         bool Parse(BytesView input, size_t* processed=nullptr);
 
+        /**
+         * @brief 从分段缓冲区解析HTTP请求
+         * @param input 输入，处理过的数据会从头部消耗掉
+         * @return 解析是否完成（指示请求或响应结束）
+         *
+         * 逐个分段解析，不会合并数据。解析完成时未处理的数据（例如升级后的协议数据）保留在缓冲区中。
+         * 空的缓冲区不会被视作EOF。
+         */
+        bool Parse(ChainBuffer& input);
+
         /**
          * @brief 是否应当升级协议
          */
@@ -699,6 +711,14 @@ namespace moe
             }
         }
 
+        /**
+         * @brief 从分段缓冲区解析
+         * @param input 输入数据，解析后被清空
+         *
+         * 逐个分段解析，不会合并数据。
+         */
+        void Parse(ChainBuffer& input);
+
         /**
          * @brief 序列化追加到
          * @param out 输出
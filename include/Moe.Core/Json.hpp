@@ -3,11 +3,14 @@
  * @date 2017/10/6
  */
 #pragma once
+#include "Arena.hpp"
 #include "Exception.hpp"
 #include "ArrayView.hpp"
 
 #include <map>
+#include <memory>
 #include <vector>
+#include <iterator>
 
 namespace moe
 {
@@ -32,6 +35,7 @@ namespace moe
     public:
         using BoolType = bool;
         using NumberType = double;
+        using IntegerType = int64_t;
         using StringType = std::string;
         using ArrayType = std::vector<JsonValue>;
         using ObjectType = std::map<std::string, JsonValue>;
@@ -46,6 +50,7 @@ namespace moe
         JsonValue(std::nullptr_t)noexcept;
         JsonValue(BoolType val)noexcept;
         JsonValue(NumberType val)noexcept;
+        JsonValue(IntegerType val)noexcept;
         JsonValue(const StringType& val);
         JsonValue(const ArrayType& val);
         JsonValue(const ObjectType& val);
@@ -107,6 +112,7 @@ namespace moe
         void Set(std::nullptr_t)noexcept;
         void Set(BoolType val)noexcept;
         void Set(NumberType val)noexcept;
+        void Set(IntegerType val)noexcept;
         void Set(const StringType& val);
         void Set(const ArrayType& val);
         void Set(const ObjectType& val);
@@ -120,6 +126,20 @@ namespace moe
         void Set(const ArrayView<char>& val);
         void Set(std::initializer_list<JsonValue> val);
 
+        /**
+         * @brief 是否为精确保存的整数
+         *
+         * 由整数设置、或解析时没有小数和指数部分且在IntegerType范围内的数字会额外保存原始的整数值，使超过2^53的整数
+         * （如64位ID）不会经由double丢失精度。通过非const的Get<NumberType>取得引用后整数值被视为失效。
+         */
+        bool IsInteger()const noexcept { return m_iType == JsonValueTypes::Number && m_stValue.Number.HasInteger; }
+
+        /**
+         * @brief 获取整数值
+         * @exception InvalidCallException 类型不匹配或没有保存整数值时抛出异常
+         */
+        IntegerType GetInteger()const;
+
         /**
          * @brief 获取元素数量
          * @exception InvalidCallException 类型不匹配时抛出异常
@@ -241,10 +261,17 @@ namespace moe
         std::string& Stringify(std::string& str, uint32_t indent)const;
 
     private:
+        struct NumberStorage
+        {
+            NumberType Value;
+            IntegerType Integer;
+            bool HasInteger;  // Integer是否有效
+        };
+
         union JsonValueStorage
         {
             BoolType Bool;
-            NumberType Number;
+            NumberStorage Number;
             StringType String;
             ArrayType Array;
             ObjectType Object;
@@ -311,7 +338,8 @@ namespace moe
     {
         if (m_iType != JsonValueTypes::Number)
             MOE_THROW(InvalidCallException, "Bad access from {0}", m_iType);
-        return m_stValue.Number;
+        m_stValue.Number.HasInteger = false;  // 值可能经由引用被修改
+        return m_stValue.Number.Value;
     }
 
     template <>
@@ -351,7 +379,7 @@ namespace moe
     {
         if (m_iType != JsonValueTypes::Number)
             MOE_THROW(InvalidCallException, "Bad access from {0}", m_iType);
-        return m_stValue.Number;
+        return m_stValue.Number.Value;
     }
 
     template <>
@@ -380,12 +408,22 @@ namespace moe
 
     //////////////////////////////////////// </editor-fold>
 
+    /**
+     * @brief JSON SAX句柄
+     *
+     * 没有小数和指数部分、且在IntegerType范围内的数字通过OnJsonInteger给出，以保留原始的整数值。
+     * 默认实现将其转换为double后调用OnJsonNumber。
+     */
     class JsonSaxHandler
     {
     public:
         virtual void OnJsonNull() = 0;
         virtual void OnJsonBool(JsonValue::BoolType val) = 0;
         virtual void OnJsonNumber(JsonValue::NumberType val) = 0;
+        virtual void OnJsonInteger(JsonValue::IntegerType val)
+        {
+            OnJsonNumber(static_cast<JsonValue::NumberType>(val));
+        }
         virtual void OnJsonString(const JsonValue::StringType& val) = 0;
         virtual void OnJsonArrayBegin() = 0;
         virtual void OnJsonArrayEnd() = 0;
@@ -394,6 +432,32 @@ namespace moe
         virtual void OnJsonObjectEnd() = 0;
     };
 
+    /**
+     * @brief 零拷贝的JSON SAX句柄
+     *
+     * 与JsonSaxHandler相同，但字符串和键以ArrayView给出：没有转义的字符串直接指向输入数据，只有含转义的字符串才会在
+     * 解析器内部的缓冲区中解码。ArrayView不以'\0'结尾，且只在回调期间有效，需要保留时应自行拷贝。
+     */
+    class JsonSaxViewHandler
+    {
+    public:
+        virtual void OnJsonNull() = 0;
+        virtual void OnJsonBool(JsonValue::BoolType val) = 0;
+        virtual void OnJsonNumber(JsonValue::NumberType val) = 0;
+        virtual void OnJsonInteger(JsonValue::IntegerType val)
+        {
+            OnJsonNumber(static_cast<JsonValue::NumberType>(val));
+        }
+        virtual void OnJsonString(ArrayView<char> val) = 0;
+        virtual void OnJsonArrayBegin() = 0;
+        virtual void OnJsonArrayEnd() = 0;
+        virtual void OnJsonObjectBegin() = 0;
+        virtual void OnJsonObjectKey(ArrayView<char> key) = 0;
+        virtual void OnJsonObjectEnd() = 0;
+    };
+
+    class JsonDocument;
+
     /**
      * @brief JSON5扩展语法支持
      * @see https://github.com/json5/json5
@@ -421,6 +485,28 @@ namespace moe
             Parse(handler, arr, source);
         }
 
+        /**
+         * @brief 解析Json5，以ArrayView给出字符串
+         * @param handler 解析句柄
+         * @param data 数据
+         * @param source 数据源的名称
+         *
+         * Json5的字符串总是在内部缓冲区中解码，不会直接指向输入数据。
+         */
+        static void Parse(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source="Unknown");
+
+        inline static void Parse(JsonSaxViewHandler* handler, const char* data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data, ::strlen(data));
+            Parse(handler, arr, source);
+        }
+
+        inline static void Parse(JsonSaxViewHandler* handler, const std::string& data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data.c_str(), data.size());
+            Parse(handler, arr, source);
+        }
+
         /**
          * @brief 解析Json5
          * @param out 目标Json对象
@@ -455,6 +541,116 @@ namespace moe
             return ret;
         }
 
+        /**
+         * @brief 解析JSON5到扁平文档
+         * @param out 目标文档，解析失败时被清空
+         * @param data 数据，需要比文档活得更久
+         * @param source 数据源的名称
+         */
+        static void Parse(JsonDocument& out, ArrayView<char> data, const char* source="Unknown");
+
+        inline static std::string Stringify(const JsonValue& data)
+        {
+            std::string ret;
+            data.Stringify(ret);
+            return ret;
+        }
+    };
+
+    /**
+     * @brief 严格JSON支持
+     * @see https://tools.ietf.org/html/rfc8259
+     *
+     * 只接受RFC 8259定义的语法（不支持注释、单引号、标识符键、尾随逗号、Infinity/NaN及十六进制数），
+     * 换来更快的解析速度：直接在指针上扫描，不维护行列号（仅在出错时计算），并使用SIMD跳过空白及扫描字符串。
+     * 对两者都接受的输入产生相同的SAX事件序列，唯一的区别是以代理对形式转义的字符会被合并解码，孤立的代理项则被拒绝。
+     * 错误同样以LexicalException抛出并携带SourceName/Position/Line/Column信息。
+     */
+    class Json
+    {
+    public:
+        /**
+         * @brief 解析JSON
+         * @param handler 解析句柄
+         * @param data 数据
+         * @param source 数据源的名称
+         */
+        static void Parse(JsonSaxHandler* handler, ArrayView<char> data, const char* source="Unknown");
+
+        inline static void Parse(JsonSaxHandler* handler, const char* data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data, ::strlen(data));
+            Parse(handler, arr, source);
+        }
+
+        inline static void Parse(JsonSaxHandler* handler, const std::string& data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data.c_str(), data.size());
+            Parse(handler, arr, source);
+        }
+
+        /**
+         * @brief 解析JSON，以零拷贝的方式产生字符串
+         * @param handler 解析句柄
+         * @param data 数据
+         * @param source 数据源的名称
+         */
+        static void Parse(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source="Unknown");
+
+        inline static void Parse(JsonSaxViewHandler* handler, const char* data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data, ::strlen(data));
+            Parse(handler, arr, source);
+        }
+
+        inline static void Parse(JsonSaxViewHandler* handler, const std::string& data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data.c_str(), data.size());
+            Parse(handler, arr, source);
+        }
+
+        /**
+         * @brief 解析JSON
+         * @param out 目标Json对象
+         * @param data 数据
+         * @param source 数据源的名称
+         */
+        static void Parse(JsonValue& out, ArrayView<char> data, const char* source="Unknown");
+
+        inline static void Parse(JsonValue& out, const char* data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data, ::strlen(data));
+            Parse(out, arr, source);
+        }
+
+        inline static void Parse(JsonValue& out, const std::string& data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data.c_str(), data.size());
+            Parse(out, arr, source);
+        }
+
+        inline static JsonValue Parse(const char* data, const char* source="Unknown")
+        {
+            JsonValue ret;
+            Json::Parse(ret, data, source);
+            return ret;
+        }
+
+        inline static JsonValue Parse(const std::string& data, const char* source="Unknown")
+        {
+            JsonValue ret;
+            Json::Parse(ret, data, source);
+            return ret;
+        }
+
+        /**
+         * @brief 解析JSON到扁平文档
+         * @param out 目标文档，解析失败时被清空
+         * @param data 数据，需要比文档活得更久
+         * @param source 数据源的名称
+         */
+        static void Parse(JsonDocument& out, ArrayView<char> data, const char* source="Unknown");
+
         inline static std::string Stringify(const JsonValue& data)
         {
             std::string ret;
@@ -462,4 +658,463 @@ namespace moe
             return ret;
         }
     };
+
+    /**
+     * @brief 基于结构索引的两阶段JSON解析器
+     * @see https://arxiv.org/abs/1902.08318
+     *
+     * 语法与Json相同。第一阶段用SIMD一次扫描整个输入，标记出转义与字符串区间，并将字符串外的结构字符、字符串的起始引号
+     * 及其他值的起始位置记录到结构索引中；第二阶段沿索引递归下降产生SAX事件，只在取值时回到原始数据。
+     * 第一阶段的指令集（AVX2/SSE2/标量）在运行时根据CPU选择。
+     *
+     * 解析器持有索引缓冲区并在多次解析之间复用，适合连续解析大量文档。索引使用32位偏移，超过4GB的输入会退化为Json的
+     * 单遍解析。解析器不是线程安全的。
+     */
+    class JsonIndexedParser
+    {
+    public:
+        /**
+         * @brief 第一阶段使用的指令集
+         */
+        enum class InstructionSet
+        {
+            Scalar,
+            Sse2,
+            Avx2,
+        };
+
+        /**
+         * @brief 获取当前CPU支持的最佳指令集
+         */
+        static InstructionSet GetBestInstructionSet()noexcept;
+
+    public:
+        JsonIndexedParser();
+
+        /**
+         * @brief 以指定的指令集构造
+         * @param instructionSet 指令集，CPU不支持时降级到可用的最佳指令集
+         */
+        explicit JsonIndexedParser(InstructionSet instructionSet);
+
+    public:
+        /**
+         * @brief 获取使用的指令集
+         */
+        InstructionSet GetInstructionSet()const noexcept { return m_iInstructionSet; }
+
+        /**
+         * @brief 获取最近一次解析建立的结构索引
+         *
+         * 每个元素为一个结构字符或值的起始位置在输入中的偏移。
+         */
+        ArrayView<uint32_t> GetStructuralIndex()const noexcept
+        {
+            return ArrayView<uint32_t>(m_stIndex.data(), m_uIndexCount);
+        }
+
+        /**
+         * @brief 解析JSON
+         * @param handler 解析句柄
+         * @param data 数据
+         * @param source 数据源的名称
+         */
+        void Parse(JsonSaxHandler* handler, ArrayView<char> data, const char* source="Unknown");
+
+        void Parse(JsonSaxHandler* handler, const char* data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data, ::strlen(data));
+            Parse(handler, arr, source);
+        }
+
+        void Parse(JsonSaxHandler* handler, const std::string& data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data.c_str(), data.size());
+            Parse(handler, arr, source);
+        }
+
+        /**
+         * @brief 解析JSON，以零拷贝的方式产生字符串
+         * @param handler 解析句柄
+         * @param data 数据
+         * @param source 数据源的名称
+         */
+        void Parse(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source="Unknown");
+
+        void Parse(JsonSaxViewHandler* handler, const char* data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data, ::strlen(data));
+            Parse(handler, arr, source);
+        }
+
+        void Parse(JsonSaxViewHandler* handler, const std::string& data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data.c_str(), data.size());
+            Parse(handler, arr, source);
+        }
+
+        /**
+         * @brief 解析JSON
+         * @param out 目标Json对象
+         * @param data 数据
+         * @param source 数据源的名称
+         */
+        void Parse(JsonValue& out, ArrayView<char> data, const char* source="Unknown");
+
+        void Parse(JsonValue& out, const char* data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data, ::strlen(data));
+            Parse(out, arr, source);
+        }
+
+        void Parse(JsonValue& out, const std::string& data, const char* source="Unknown")
+        {
+            ArrayView<char> arr(data.c_str(), data.size());
+            Parse(out, arr, source);
+        }
+
+        JsonValue Parse(const char* data, const char* source="Unknown")
+        {
+            JsonValue ret;
+            Parse(ret, data, source);
+            return ret;
+        }
+
+        JsonValue Parse(const std::string& data, const char* source="Unknown")
+        {
+            JsonValue ret;
+            Parse(ret, data, source);
+            return ret;
+        }
+
+        /**
+         * @brief 解析JSON到扁平文档
+         * @param out 目标文档，解析失败时被清空
+         * @param data 数据，需要比文档活得更久
+         * @param source 数据源的名称
+         */
+        void Parse(JsonDocument& out, ArrayView<char> data, const char* source="Unknown");
+
+    private:
+        void BuildIndex(ArrayView<char> data);
+
+    private:
+        InstructionSet m_iInstructionSet;
+        std::vector<uint32_t> m_stIndex;  // 只增不减，避免反复分配及清零
+        size_t m_uIndexCount = 0;
+    };
+
+    /**
+     * @brief 扁平的只读JSON文档
+     *
+     * 整棵树按先序存放在一段连续的节点数组中，容器节点记录元素个数和子树占用的节点数，遍历时可以O(1)跳过整个子树。
+     * 不超过kMaxInlineStringSize字节的字符串（包括键）直接内联在节点中；较长的字符串在没有转义时指向输入数据，
+     * 含转义时解码到文档持有的Arena中。解析和析构都不会为单个节点分配内存，适合读取大体积的配置文件及接口响应。
+     *
+     * 注意到：
+     *  - 文档引用输入数据，输入需要比文档及由其得到的游标活得更久；
+     *  - 对象的成员按出现顺序保存，按键查找为线性查找。重复的键不会报错，查找时返回第一个；
+     *  - 单个字符串的长度及容器的元素个数不能超过4G；
+     *  - 文档可以移动，不可以复制。重新解析或清空后，之前得到的游标全部失效。
+     */
+    class JsonDocument
+    {
+        friend class Json5;
+        friend class Json;
+        friend class JsonIndexedParser;
+
+        enum class NodeTypes : uint8_t
+        {
+            Null,
+            Bool,
+            Number,
+            Integer,
+            String,
+            InlineString,
+            Array,
+            Object,
+        };
+
+        struct ValueNode
+        {
+            NodeTypes Type;
+            uint32_t Size;  // 字符串长度或容器的元素个数
+            union
+            {
+                JsonValue::BoolType Bool;
+                JsonValue::NumberType Number;
+                JsonValue::IntegerType Integer;
+                const char* String;
+                size_t Span;  // 容器子树占用的节点数（包含自身）
+            };
+        };
+
+        struct InlineStringNode
+        {
+            NodeTypes Type;
+            uint8_t Size;
+            char Chars[sizeof(ValueNode) - 2];
+        };
+
+        union Node
+        {
+            ValueNode Value;
+            InlineStringNode Inline;
+        };
+
+        class Builder;
+
+        static const Node kNullNode;
+
+        static const Node* Skip(const Node* node)noexcept
+        {
+            auto type = node->Value.Type;
+            return (type == NodeTypes::Array || type == NodeTypes::Object) ? node + node->Value.Span : node + 1;
+        }
+
+        static ArrayView<char> GetStringOf(const Node* node)noexcept
+        {
+            if (node->Value.Type == NodeTypes::InlineString)
+                return ArrayView<char>(node->Inline.Chars, node->Inline.Size);
+            assert(node->Value.Type == NodeTypes::String);
+            return ArrayView<char>(node->Value.String, node->Value.Size);
+        }
+
+    public:
+        /**
+         * @brief 内联存放的字符串的最大长度
+         */
+        static const size_t kMaxInlineStringSize = sizeof(InlineStringNode::Chars);
+
+        class Iterator;
+
+        /**
+         * @brief 只读游标
+         *
+         * 指向文档中的一个值，大小为一个指针，可以随意复制。默认构造的游标指向null。
+         */
+        class Cursor
+        {
+            friend class JsonDocument;
+            friend class Iterator;
+
+        public:
+            Cursor()noexcept
+                : m_pNode(&kNullNode) {}
+
+        public:
+            /**
+             * @brief 获取值类型
+             *
+             * 整数与其他数字一样返回Number。
+             */
+            JsonValueTypes GetType()const noexcept;
+
+            /**
+             * @brief 是否为null
+             */
+            bool IsNull()const noexcept { return m_pNode->Value.Type == NodeTypes::Null; }
+
+            /**
+             * @brief 是否是解析时保留了整数值的数字
+             */
+            bool IsInteger()const noexcept { return m_pNode->Value.Type == NodeTypes::Integer; }
+
+            /**
+             * @brief 获取布尔值
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             */
+            JsonValue::BoolType GetBool()const;
+
+            /**
+             * @brief 获取数字
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             */
+            JsonValue::NumberType GetNumber()const;
+
+            /**
+             * @brief 获取整数
+             * @exception InvalidCallException 类型不匹配或不是整数时抛出异常
+             */
+            JsonValue::IntegerType GetInteger()const;
+
+            /**
+             * @brief 获取字符串
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             *
+             * 返回的ArrayView不以'\0'结尾，与文档的生命周期相同。
+             */
+            ArrayView<char> GetString()const;
+
+            /**
+             * @brief 获取元素个数
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             *
+             * 针对ArrayType和ObjectType有效。
+             */
+            size_t GetElementCount()const;
+
+            /**
+             * @brief 检查是否存在元素
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             * @param key 键值
+             *
+             * 针对ObjectType可用。
+             */
+            bool HasElement(ArrayView<char> key)const { return FindElement(key) != nullptr; }
+            bool HasElement(const char* key)const { return HasElement(ToArrayView<char>(key)); }
+            bool HasElement(const std::string& key)const { return HasElement(ToArrayView<char>(key)); }
+
+            /**
+             * @brief 通过索引获取元素
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             * @exception OutOfRangeException 越界时抛出异常
+             * @param index 索引
+             *
+             * 只能针对Array值进行存取。需要逐个跳过前面的元素，顺序访问时应使用迭代器。
+             */
+            Cursor GetElementByIndex(size_t index)const;
+
+            /**
+             * @brief 通过键值获取元素
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             * @exception ObjectNotFoundException 键不存在时抛出异常
+             * @param key 键值
+             *
+             * 只能针对Object值进行存取。
+             */
+            Cursor GetElementByKey(ArrayView<char> key)const;
+            Cursor GetElementByKey(const char* key)const { return GetElementByKey(ToArrayView<char>(key)); }
+            Cursor GetElementByKey(const std::string& key)const { return GetElementByKey(ToArrayView<char>(key)); }
+
+            /**
+             * @brief 获取指向第一个元素的迭代器
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             *
+             * 针对ArrayType和ObjectType有效。
+             */
+            Iterator begin()const;
+
+            /**
+             * @brief 获取指向最后一个元素之后的迭代器
+             * @exception InvalidCallException 类型不匹配时抛出异常
+             */
+            Iterator end()const;
+
+            /**
+             * @brief 转换到JsonValue
+             * @exception ObjectExistsException 对象中存在重复的键时抛出异常
+             */
+            JsonValue ToJsonValue()const;
+
+        private:
+            explicit Cursor(const Node* node)noexcept
+                : m_pNode(node) {}
+
+            const Node* FindElement(ArrayView<char> key)const;
+
+        private:
+            const Node* m_pNode;
+        };
+
+        /**
+         * @brief 元素迭代器
+         *
+         * 解引用得到元素的游标。遍历对象时得到的是成员的值，成员的键通过GetKey获取。
+         */
+        class Iterator :
+            public std::iterator<std::forward_iterator_tag, Cursor, ptrdiff_t, void, Cursor>
+        {
+            friend class Cursor;
+
+        public:
+            Iterator()noexcept = default;
+
+            Cursor operator*()const noexcept
+            {
+                return Cursor(m_bMember ? m_pNode + 1 : m_pNode);
+            }
+
+            Iterator& operator++()noexcept
+            {
+                m_pNode = Skip(m_bMember ? m_pNode + 1 : m_pNode);
+                return *this;
+            }
+
+            Iterator operator++(int)noexcept
+            {
+                Iterator tmp(*this);
+                ++*this;
+                return tmp;
+            }
+
+            bool operator==(const Iterator& rhs)const noexcept
+            {
+                return m_pNode == rhs.m_pNode;
+            }
+
+            bool operator!=(const Iterator& rhs)const noexcept
+            {
+                return !(*this == rhs);
+            }
+
+            /**
+             * @brief 获取成员的键
+             *
+             * 只在遍历对象时有效。
+             */
+            ArrayView<char> GetKey()const noexcept
+            {
+                assert(m_bMember);
+                return GetStringOf(m_pNode);
+            }
+
+        private:
+            Iterator(const Node* node, bool member)noexcept
+                : m_pNode(node), m_bMember(member) {}
+
+        private:
+            const Node* m_pNode = nullptr;  // 遍历对象时指向成员的键
+            bool m_bMember = false;
+        };
+
+    public:
+        /**
+         * @brief 获取根节点
+         *
+         * 空文档的根节点为null。
+         */
+        Cursor GetRoot()const noexcept
+        {
+            return m_stNodes.empty() ? Cursor() : Cursor(m_stNodes.data());
+        }
+
+        /**
+         * @brief 是否为空
+         */
+        bool IsEmpty()const noexcept { return m_stNodes.empty(); }
+
+        /**
+         * @brief 获取节点个数
+         *
+         * 对象的每个成员占用键和值两个节点。
+         */
+        size_t GetNodeCount()const noexcept { return m_stNodes.size(); }
+
+        /**
+         * @brief 清空文档
+         *
+         * 节点数组和Arena的内存会被保留，用于下一次解析。
+         */
+        void Clear()noexcept
+        {
+            m_stNodes.clear();
+            if (m_pArena)
+                m_pArena->Reset();
+        }
+
+    private:
+        std::vector<Node> m_stNodes;
+        std::unique_ptr<Arena> m_pArena;  // 只在出现需要拷贝的字符串时才创建
+    };
 }
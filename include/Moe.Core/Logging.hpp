@@ -10,6 +10,7 @@
 #include <vector>
 #include <mutex>
 #include <algorithm>
+#include <unordered_map>
 
 #include "Time.hpp"
 #include "Utils.hpp"
@@ -18,6 +19,181 @@
 
 namespace moe
 {
+    namespace details
+    {
+        /**
+         * @brief 延迟格式化时参数的类型标记
+         *
+         * 每种标记对应StringUtils中的一种格式化器，保证延迟格式化的结果与直接格式化一致。
+         */
+        enum class LogArgumentType : uint8_t
+        {
+            Unsupported = 0,
+            Bool,
+            Char,
+            Int8,
+            UInt8,
+            Int16,
+            UInt16,
+            Int32,
+            UInt32,
+            Int64,
+            UInt64,
+            Float,
+            Double,
+            Enum,
+            Pointer,
+            Null,
+            CString,
+            String,
+            CharArrayView,
+        };
+
+        constexpr LogArgumentType GetLogIntegerArgumentType(bool isSigned, size_t size)noexcept
+        {
+            return size == 1 ? (isSigned ? LogArgumentType::Int8 : LogArgumentType::UInt8) :
+                size == 2 ? (isSigned ? LogArgumentType::Int16 : LogArgumentType::UInt16) :
+                size == 4 ? (isSigned ? LogArgumentType::Int32 : LogArgumentType::UInt32) :
+                size == 8 ? (isSigned ? LogArgumentType::Int64 : LogArgumentType::UInt64) :
+                LogArgumentType::Unsupported;
+        }
+
+        /**
+         * @brief 获取参数的类型标记
+         *
+         * 判定顺序与StringUtils::details::ToStringFormatterSelector一致。
+         * 自定义类型（ToString）及long double无法按值捕获，标记为Unsupported。
+         */
+        template <typename T, typename U = typename std::remove_cv<typename std::decay<T>::type>::type>
+        struct LogArgumentTypeOf :
+            public std::integral_constant<LogArgumentType,
+                std::is_same<U, bool>::value ? LogArgumentType::Bool :
+                std::is_same<T, char>::value ? LogArgumentType::Char :
+                std::is_integral<T>::value ? GetLogIntegerArgumentType(std::is_signed<T>::value, sizeof(T)) :
+                std::is_same<T, float>::value ? LogArgumentType::Float :
+                std::is_same<T, double>::value ? LogArgumentType::Double :
+                std::is_floating_point<T>::value ? LogArgumentType::Unsupported :
+                std::is_same<T, std::string>::value ? LogArgumentType::String :
+                (std::is_pointer<T>::value || std::is_array<T>::value) &&
+                    (std::is_same<U, char*>::value || std::is_same<U, const char*>::value) ? LogArgumentType::CString :
+                std::is_pointer<T>::value || std::is_array<T>::value ? LogArgumentType::Pointer :
+                std::is_same<U, std::nullptr_t>::value ? LogArgumentType::Null :
+                std::is_enum<T>::value ? LogArgumentType::Enum :
+                std::is_same<typename std::remove_cv<T>::type, ArrayView<char>>::value ?
+                    LogArgumentType::CharArrayView :
+                LogArgumentType::Unsupported>
+        {};
+
+        template <typename... Args>
+        struct LogArgumentsDeferrable;
+
+        template <>
+        struct LogArgumentsDeferrable<> :
+            public std::true_type
+        {};
+
+        template <typename T, typename... Args>
+        struct LogArgumentsDeferrable<T, Args...> :
+            public std::integral_constant<bool, LogArgumentTypeOf<T>::value != LogArgumentType::Unsupported &&
+                LogArgumentsDeferrable<Args...>::value>
+        {};
+
+        template <typename T>
+        void AppendLogArgumentRaw(std::string& out, const T& value)
+        {
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        inline void AppendLogArgumentString(std::string& out, LogArgumentType type, const char* str, size_t length)
+        {
+            out.push_back(static_cast<char>(type));
+            AppendLogArgumentRaw(out, static_cast<uint32_t>(length));
+            out.append(str, length);
+            out.push_back('\0');  // 保证可以直接作为C字符串使用
+        }
+
+        template <typename T, LogArgumentType Type>
+        void EncodeLogArgument(std::string& out, const T& value, std::integral_constant<LogArgumentType, Type>)
+        {
+            out.push_back(static_cast<char>(Type));
+            AppendLogArgumentRaw(out, value);
+        }
+
+        template <typename T>
+        void EncodeLogArgument(std::string& out, const T& value,
+            std::integral_constant<LogArgumentType, LogArgumentType::Bool>)
+        {
+            out.push_back(static_cast<char>(LogArgumentType::Bool));
+            out.push_back(value ? 1 : 0);
+        }
+
+        template <typename T>
+        void EncodeLogArgument(std::string& out, const T& value,
+            std::integral_constant<LogArgumentType, LogArgumentType::Enum>)
+        {
+            out.push_back(static_cast<char>(LogArgumentType::Enum));
+            AppendLogArgumentRaw(out, static_cast<uint32_t>(value));
+        }
+
+        template <typename T>
+        void EncodeLogArgument(std::string& out, const T& value,
+            std::integral_constant<LogArgumentType, LogArgumentType::Pointer>)
+        {
+            out.push_back(static_cast<char>(LogArgumentType::Pointer));
+            AppendLogArgumentRaw(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+        }
+
+        template <typename T>
+        void EncodeLogArgument(std::string& out, const T& value,
+            std::integral_constant<LogArgumentType, LogArgumentType::Null>)
+        {
+            MOE_UNUSED(value);
+            out.push_back(static_cast<char>(LogArgumentType::Null));
+        }
+
+        template <typename T>
+        void EncodeLogArgument(std::string& out, const T& value,
+            std::integral_constant<LogArgumentType, LogArgumentType::CString>)
+        {
+            const char* str = value;
+            if (!str)  // 与CStringToStringFormatter一致，输出null
+                out.push_back(static_cast<char>(LogArgumentType::Null));
+            else
+                AppendLogArgumentString(out, LogArgumentType::CString, str, std::char_traits<char>::length(str));
+        }
+
+        template <typename T>
+        void EncodeLogArgument(std::string& out, const T& value,
+            std::integral_constant<LogArgumentType, LogArgumentType::String>)
+        {
+            AppendLogArgumentString(out, LogArgumentType::String, value.data(), value.length());
+        }
+
+        template <typename T>
+        void EncodeLogArgument(std::string& out, const T& value,
+            std::integral_constant<LogArgumentType, LogArgumentType::CharArrayView>)
+        {
+            AppendLogArgumentString(out, LogArgumentType::CharArrayView, value.GetBuffer(), value.GetSize());
+        }
+
+        inline void EncodeLogArguments(std::string& out)
+        {
+            MOE_UNUSED(out);
+        }
+
+        /**
+         * @brief 按类型标记编码参数
+         *
+         * 每个参数编码为一字节的类型标记，后接按本机字节序存放的值；字符串类参数存放长度、内容及结尾的'\0'。
+         */
+        template <typename T, typename... Args>
+        void EncodeLogArguments(std::string& out, const T& first, const Args&... rest)
+        {
+            EncodeLogArgument(out, first, LogArgumentTypeOf<T>());
+            EncodeLogArguments(out, rest...);
+        }
+    }
+
     /**
      * @brief 日志系统
      *
@@ -45,6 +221,47 @@ namespace moe
             Fatal,
         };
 
+        static const unsigned kLevelCount = static_cast<unsigned>(Level::Fatal) + 1;
+
+        /**
+         * @brief 异步模式下队列满时的处理策略
+         */
+        enum class OverflowPolicy
+        {
+            Block,  // 阻塞等待后台线程消费
+            Drop,  // 丢弃当前日志（Fatal除外）
+            DropLowLevel,  // 丢弃低于Warn级别的日志，其余阻塞等待
+        };
+
+        static const size_t kDefaultAsyncQueueSize = 8192;
+
+        /**
+         * @brief 调用点限流策略
+         *
+         * 每个调用点（以Context中的File指针和Line区分）独立维护一个令牌桶：至多连续放行Burst条，之后按RatePerSecond的
+         * 速率恢复。超出限制的日志每SampleEvery条采样放行一条，其余被抑制并计数，由该调用点每隔ReportIntervalMs毫秒
+         * 汇总输出一条被抑制的条数。
+         * Clock可以替换限流使用的时间源（返回微秒），为nullptr时使用单调时钟，主要用于测试。
+         */
+        struct RateLimitPolicy
+        {
+            using ClockFunc = uint64_t(*)();
+
+            uint32_t Burst = 100;  // 突发上限
+            uint32_t RatePerSecond = 10;  // 令牌恢复速率
+            uint32_t SampleEvery = 0;  // 超出限制后的采样间隔，0表示不采样
+            uint32_t ReportIntervalMs = 10000;  // 汇总输出间隔，0表示只在Flush及关闭限流时输出
+            ClockFunc Clock = nullptr;  // 时间源（微秒），nullptr表示使用单调时钟
+
+            RateLimitPolicy() = default;
+            RateLimitPolicy(uint32_t burst, uint32_t ratePerSecond, uint32_t sampleEvery=0,
+                uint32_t reportIntervalMs=10000)noexcept
+                : Burst(burst), RatePerSecond(ratePerSecond), SampleEvery(sampleEvery),
+                ReportIntervalMs(reportIntervalMs) {}
+        };
+
+        static const size_t kDefaultRateLimitSites = 4096;
+
         /**
          * @brief 日志上下文
          *
@@ -96,6 +313,64 @@ namespace moe
 
         using FormatterPtr = std::shared_ptr<FormatterBase>;
 
+    private:
+        /**
+         * @brief 预编译的格式描述
+         *
+         * 格式描述在设置时被解析为字面量和字段组成的指令序列，格式化时顺序执行，不再重复解析格式和匹配变量名。
+         * 语法及容错行为与StringUtils::VariableFormat一致。
+         */
+        class FormatPattern
+        {
+        public:
+            /**
+             * @brief 编译格式描述
+             * @param format 格式描述
+             */
+            void Compile(const std::string& format);
+
+            /**
+             * @brief 格式化日志并追加到输出缓冲区末尾
+             */
+            void Render(std::string& dest, Level level, const Context& context, const char* msg)const;
+
+        private:
+            enum class Field : uint8_t
+            {
+                Literal,
+                Date,
+                ShortDate,
+                Time,
+                Level,
+                Thread,
+                Path,
+                File,
+                Func,
+                Line,
+                Msg,
+            };
+
+            struct Op
+            {
+                Field Kind;
+                bool LeftJustify;
+                char PaddingCharacter;
+                unsigned Padding;
+                uint32_t Offset;  // 字面量或格式化参数在m_stText中的位置
+                uint32_t Length;
+            };
+
+            static Field GetFieldByName(const ArrayView<char>& name)noexcept;
+            static bool IsFieldFormatValid(Field field, const ArrayView<char>& format);
+
+            void AppendLiteral(const char* str, size_t length);
+
+        private:
+            std::string m_stText;
+            std::vector<Op> m_stOps;
+        };
+
+    public:
         /**
          * @brief 一般文本格式化器
          *
@@ -114,6 +389,9 @@ namespace moe
         class PlainFormatter :
             public FormatterBase
         {
+        public:
+            PlainFormatter();
+
         public:
             /**
              * @brief 获取格式描述
@@ -123,8 +401,8 @@ namespace moe
             /**
              * @brief 设置格式描述
              */
-            void SetFormat(const std::string& format) { m_stFormat = format; }
-            void SetFormat(std::string&& format) { m_stFormat = std::move(format); }
+            void SetFormat(const std::string& format);
+            void SetFormat(std::string&& format);
 
         protected:
             void Format(std::string& dest, Level level, const Context& context, const char* msg)const override;
@@ -132,6 +410,7 @@ namespace moe
 
         private:
             std::string m_stFormat = "[{short_date} {time}][{level,-5}][0x{thread:H}][{file}:{line},{func}] {msg}";
+            FormatPattern m_stPattern;
         };
 
         /**
@@ -176,8 +455,8 @@ namespace moe
             /**
              * @brief 设置格式描述
              */
-            void SetFormat(const std::string& format) { m_stFormat = format; }
-            void SetFormat(std::string&& format) { m_stFormat = std::move(format); }
+            void SetFormat(const std::string& format);
+            void SetFormat(std::string&& format);
 
             /**
              * @brief 获取颜色
@@ -195,11 +474,7 @@ namespace moe
              * @param fg 前景色
              * @param bg 背景色
              */
-            void SetColor(Level level, Colors fg, Colors bg)
-            {
-                assert(static_cast<unsigned>(level) < CountOf(m_stColors));
-                m_stColors[static_cast<unsigned>(level)] = std::pair<Colors, Colors>(fg, bg);
-            }
+            void SetColor(Level level, Colors fg, Colors bg);
 
         protected:
             void Format(std::string& dest, Level level, const Context& context, const char* msg)const override;
@@ -207,7 +482,9 @@ namespace moe
 
         private:
             std::string m_stFormat = "[{short_date} {time}][{level,-5}][0x{thread:H}][{file}:{line},{func}] {msg}";
+            FormatPattern m_stPattern;
             std::pair<Colors, Colors> m_stColors[static_cast<unsigned>(Level::Fatal) + 1];
+            std::string m_stColorPrefix[static_cast<unsigned>(Level::Fatal) + 1];  // 预先生成的颜色控制序列
         };
 
         /**
@@ -215,6 +492,8 @@ namespace moe
          */
         class SinkBase
         {
+            friend class Logging;
+
         public:
             SinkBase() = default;
             SinkBase(const SinkBase& rhs);
@@ -285,6 +564,23 @@ namespace moe
                 size_t length)noexcept = 0;
             virtual void Flush()noexcept;
 
+            /**
+             * @brief 以二进制形式落地尚未格式化的日志
+             * @param level 日志级别
+             * @param context 日志上下文
+             * @param format 格式化文本，具有静态存储期
+             * @param args 编码后的参数
+             * @param length 参数长度
+             * @return 是否已经处理，返回false时日志会被格式化后交给Sink
+             *
+             * 仅在延迟格式化模式下被调用。
+             */
+            virtual bool SinkBinary(Level level, const Context& context, const char* format, const char* args,
+                size_t length)noexcept;
+
+        private:
+            void Write(Level level, const Context& context, const char* msg)noexcept;
+
         private:
             bool m_bAlwaysFlush = true;  // 默认应当总是Flush的，提高日志实时性
             Level m_iMinLevel = Level::Debug;
@@ -338,6 +634,66 @@ namespace moe
 #endif
         };
 
+        /**
+         * @brief 文件写入缓冲策略
+         *
+         * 启用后日志先进入写合并缓冲区，满足以下任一条件时一次性写出：
+         * - 缓冲的字节数将超过FlushBytes；
+         * - 缓冲中最早的日志已经等待了FlushIntervalMs毫秒（在下一次写入时检查，开启BackgroundFlush时由后台线程检查）；
+         * - 写入Fatal日志，或显式调用Logging::Flush。
+         */
+        struct BufferPolicy
+        {
+            size_t FlushBytes = 0;  // 缓冲区大小，0表示不缓冲
+            uint32_t FlushIntervalMs = 0;  // 最长缓冲时间，0表示不限时
+            bool BackgroundFlush = false;  // 是否由后台线程定期写出超时的缓冲
+
+            BufferPolicy() = default;
+            BufferPolicy(size_t flushBytes, uint32_t flushIntervalMs=0, bool backgroundFlush=false)noexcept
+                : FlushBytes(flushBytes), FlushIntervalMs(flushIntervalMs), BackgroundFlush(backgroundFlush) {}
+        };
+
+    private:
+        /**
+         * @brief 文件写合并缓冲区
+         *
+         * 由文件落地对象持有，调用方负责加锁。
+         */
+        class FileWriteBuffer
+        {
+        public:
+            const BufferPolicy& GetPolicy()const noexcept { return m_stPolicy; }
+            void SetPolicy(const BufferPolicy& policy)noexcept { m_stPolicy = policy; }
+            bool IsEnabled()const noexcept { return m_stPolicy.FlushBytes > 0; }
+            bool IsEmpty()const noexcept { return m_stBuffer.empty(); }
+
+            /**
+             * @brief 写入一行
+             * @param file 文件
+             * @param data 数据
+             * @param length 长度
+             * @param now 当前时间
+             * @param force 是否立即写出
+             */
+            void Write(FILE* file, const char* data, size_t length, Time::Timestamp now, bool force)noexcept;
+
+            /**
+             * @brief 写出缓冲的数据
+             */
+            void Flush(FILE* file)noexcept;
+
+            /**
+             * @brief 若缓冲已超时则写出
+             */
+            void FlushIfExpired(FILE* file, Time::Timestamp now)noexcept;
+
+        private:
+            BufferPolicy m_stPolicy;
+            std::string m_stBuffer;
+            Time::Timestamp m_ullFirstPendingTime = 0;
+        };
+
+    public:
         /**
          * @brief 基本文件落地实现
          */
@@ -347,8 +703,22 @@ namespace moe
         public:
             BasicFileSink(const char* path, bool truncate=false);
             BasicFileSink(const BasicFileSink& rhs);
+            ~BasicFileSink();
 
         public:
+            /**
+             * @brief 获取写入缓冲策略
+             */
+            const BufferPolicy& GetBufferPolicy()const noexcept { return m_stBuffer.GetPolicy(); }
+
+            /**
+             * @brief 设置写入缓冲策略
+             * @warning 非线程安全，需要在Commit前设置
+             *
+             * 启用缓冲时会关闭AlwaysFlush，由缓冲策略决定写出时机。
+             */
+            void SetBufferPolicy(const BufferPolicy& policy);
+
             std::shared_ptr<SinkBase> Clone()const override;
 
         protected:
@@ -356,9 +726,13 @@ namespace moe
                 size_t length)noexcept override;
             void Flush()noexcept override;
 
+        private:
+            static void OnFlushTimer(void* self, Time::Timestamp now)noexcept;
+
         private:
             std::mutex m_stLock;
             SharedFileHandle m_pFile;  // 虽然是Shared，实际上只有一个写者
+            FileWriteBuffer m_stBuffer;
         };
 
         /**
@@ -376,8 +750,22 @@ namespace moe
              */
             RotatingFileSink(const char* path, uint64_t size=16*1024*1024, unsigned count=5, bool alwaysSinkFirst=true);
             RotatingFileSink(const RotatingFileSink& rhs);
+            ~RotatingFileSink();
 
         public:
+            /**
+             * @brief 获取写入缓冲策略
+             */
+            const BufferPolicy& GetBufferPolicy()const noexcept { return m_stBuffer.GetPolicy(); }
+
+            /**
+             * @brief 设置写入缓冲策略
+             * @warning 非线程安全，需要在Commit前设置
+             *
+             * 启用缓冲时会关闭AlwaysFlush，由缓冲策略决定写出时机。滚动前会先写出缓冲的数据。
+             */
+            void SetBufferPolicy(const BufferPolicy& policy);
+
             std::shared_ptr<SinkBase> Clone()const override;
 
         protected:
@@ -386,6 +774,8 @@ namespace moe
             void Flush()noexcept override;
 
         private:
+            static void OnFlushTimer(void* self, Time::Timestamp now)noexcept;
+
             void MakeRotatingFilename(std::string& buf, unsigned index);
             void OpenCurrentFile();
             void Rotate();
@@ -402,43 +792,374 @@ namespace moe
             uint64_t m_uLastTryingOpenTime = 0;
             std::string m_stNameBuf1;
             std::string m_stNameBuf2;
+
+            FileWriteBuffer m_stBuffer;
+        };
+
+        /**
+         * @brief 二进制文件落地
+         *
+         * 延迟格式化模式下直接写出格式化串与编码后的参数，不在进程内格式化，由BinaryLogReader离线解码。
+         * 格式化串、文件名、函数名按指针去重，首次出现时写出一次定义。其余日志以文本形式写出。
+         * 设置的格式化器不生效，文件只能在相同架构的机器上解码。
+         */
+        class BinaryFileSink :
+            public SinkBase
+        {
+        public:
+            BinaryFileSink(const char* path, bool truncate=false);
+            BinaryFileSink(const BinaryFileSink& rhs);
+
+        public:
+            std::shared_ptr<SinkBase> Clone()const override;
+
+        protected:
+            void Sink(Level level, const Context& context, const char* msg, const char* formatted,
+                size_t length)noexcept override;
+            bool SinkBinary(Level level, const Context& context, const char* format, const char* args,
+                size_t length)noexcept override;
+            void Flush()noexcept override;
+
+        private:
+            struct State;
+
+            std::shared_ptr<State> m_pState;  // 副本之间共享文件及字符串表
+        };
+
+        /**
+         * @brief 二进制日志读取器
+         *
+         * 解码BinaryFileSink写出的文件。
+         */
+        class BinaryLogReader :
+            public NonCopyable
+        {
+        public:
+            BinaryLogReader(const char* path);
+
+        public:
+            /**
+             * @brief 读取下一条日志
+             * @param[out] level 日志级别
+             * @param[out] context 日志上下文，其中的字符串在读取器析构前有效
+             * @param[out] msg 格式化后的日志
+             * @return 是否读取成功，false表示已到达文件末尾
+             * @exception BadFormatException 文件损坏
+             */
+            bool Read(Level& level, Context& context, std::string& msg);
+
+            /**
+             * @brief 将剩余的所有日志转换为文本并交给落地对象
+             * @param sink 落地对象，例如指定了格式化器的BasicFileSink或TerminalSink
+             * @return 日志条数
+             * @exception BadFormatException 文件损坏
+             */
+            size_t Replay(SinkBase& sink);
+
+        private:
+            bool ReadBytes(void* buffer, size_t size);
+            const char* GetString(uint32_t id)const;
+
+        private:
+            UniqueFileHandle m_pFile;
+            std::unordered_map<uint32_t, std::string> m_stStrings;
+            std::string m_stArguments;
+        };
+
+        /**
+         * @brief 环形映射文件落地
+         *
+         * 日志写入预先分配大小的内存映射文件，文件被当作环形缓冲区使用，写满后覆盖最旧的日志。
+         * 写入只需一次原子加和内存拷贝，不产生系统调用；进程崩溃后最近的日志依旧保留在文件中，可以用RingFileReader导出。
+         * 重新打开同一文件时会接着已有的日志继续写入。
+         *
+         * 记录自带位置和校验和，写入过程中崩溃或被并发覆盖的记录会在读取时被丢弃。
+         * 默认不总是刷新，Flush仅发起异步回写。
+         */
+        class RingFileSink :
+            public SinkBase
+        {
+        public:
+            static const size_t kDefaultCapacity = 4 * 1024 * 1024;
+
+        public:
+            /**
+             * @brief 构造环形映射文件落地
+             * @param path 文件路径
+             * @param capacity 环形缓冲区大小，向上取整到8字节
+             */
+            RingFileSink(const char* path, size_t capacity=kDefaultCapacity);
+            RingFileSink(const RingFileSink& rhs);
+
+        public:
+            std::shared_ptr<SinkBase> Clone()const override;
+
+        protected:
+            void Sink(Level level, const Context& context, const char* msg, const char* formatted,
+                size_t length)noexcept override;
+            void Flush()noexcept override;
+
+        private:
+            struct State;
+
+            std::shared_ptr<State> m_pState;  // 副本之间共享映射及写入位置
+        };
+
+        /**
+         * @brief 环形映射文件读取器
+         *
+         * 按写入顺序导出RingFileSink文件中仍然完整的日志。
+         */
+        class RingFileReader :
+            public NonCopyable
+        {
+        public:
+            /**
+             * @brief 打开环形映射文件
+             * @param path 文件路径
+             * @exception BadFormatException 文件格式错误
+             */
+            RingFileReader(const char* path);
+
+        public:
+            /**
+             * @brief 获取完整日志条数
+             */
+            size_t GetCount()const noexcept { return m_stRecords.size(); }
+
+            /**
+             * @brief 读取下一条日志
+             * @param[out] level 日志级别
+             * @param[out] time 日志时间
+             * @param[out] msg 格式化后的日志
+             * @return 是否读取成功，false表示已读完
+             */
+            bool Read(Level& level, Time::Timestamp& time, std::string& msg);
+
+        private:
+            struct Record
+            {
+                uint64_t Position;
+                Level RecordLevel;
+                Time::Timestamp Time;
+                std::string Message;
+            };
+
+            std::vector<Record> m_stRecords;
+            size_t m_uNext = 0;
+        };
+
+
+    private:
+        /**
+         * @brief 日志级别过滤器
+         *
+         * 将上下限及展开后的级别掩码打包在一个原子量中，判断时只需一次读取和一次位测试。
+         */
+        class LevelFilter
+        {
+        public:
+            static const uint32_t kOverrideBit = 1u << 24;
+
+            static constexpr uint32_t Make(Level min, Level max, bool overrided=false)noexcept
+            {
+                return (((1u << (static_cast<uint32_t>(max) + 1)) - 1) & ~((1u << static_cast<uint32_t>(min)) - 1)) |
+                    (static_cast<uint32_t>(min) << 8) | (static_cast<uint32_t>(max) << 16) |
+                    (overrided ? kOverrideBit : 0);
+            }
+
+            static constexpr Level GetMinLevel(uint32_t state)noexcept
+            {
+                return static_cast<Level>((state >> 8) & 0xFF);
+            }
+
+            static constexpr Level GetMaxLevel(uint32_t state)noexcept
+            {
+                return static_cast<Level>((state >> 16) & 0xFF);
+            }
+
+        public:
+            LevelFilter(uint32_t state)noexcept
+                : m_uState(state) {}
+
+        public:
+            uint32_t Load()const noexcept { return m_uState.load(std::memory_order_relaxed); }
+            void Store(uint32_t state)noexcept { m_uState.store(state, std::memory_order_relaxed); }
+
+            bool ShouldLog(Level level)const noexcept
+            {
+                return ((Load() >> static_cast<uint32_t>(level)) & 1u) != 0;
+            }
+
+        private:
+            std::atomic<uint32_t> m_uState;
+        };
+
+    public:
+        /**
+         * @brief 模块日志
+         *
+         * 每个模块缓存自己的日志级别，判断是否输出只需一次原子读取和一次分支。
+         * 未单独设置级别时跟随全局级别，可以通过Logging::SetModuleLevel按名字调整某一模块的级别（例如单独打开网络模块的
+         * Debug日志）。
+         *
+         * 模块的生命周期不得超过所属的Logging对象，通常以静态变量的形式定义：
+         *   static Logging::Module s_stNetLog("net");
+         *   MOE_MODULE_LOG_DEBUG(s_stNetLog, "recv {0} bytes", size);
+         */
+        class Module :
+            public NonCopyable
+        {
+            friend class Logging;
+
+        public:
+            Module(const char* name, Logging& logging=Logging::GetInstance());
+            ~Module();
+
+        public:
+            /**
+             * @brief 获取模块名
+             */
+            const char* GetName()const noexcept { return m_stName.c_str(); }
+
+            /**
+             * @brief 获取所属的日志对象
+             */
+            Logging& GetLogging()const noexcept { return m_stLogging; }
+
+            /**
+             * @brief 获取模块日志最小输出级别（闭区间）
+             * @note 线程安全
+             */
+            Level GetMinLevel()const noexcept { return LevelFilter::GetMinLevel(m_stFilter.Load()); }
+
+            /**
+             * @brief 获取模块日志最大输出级别（闭区间）
+             * @note 线程安全
+             */
+            Level GetMaxLevel()const noexcept { return LevelFilter::GetMaxLevel(m_stFilter.Load()); }
+
+            /**
+             * @brief 是否单独设置了级别
+             * @note 线程安全
+             */
+            bool IsLevelOverrided()const noexcept { return (m_stFilter.Load() & LevelFilter::kOverrideBit) != 0; }
+
+            /**
+             * @brief 判断该日志级别是否应当被记录
+             * @note 线程安全
+             */
+            bool ShouldLog(Level level)const noexcept { return m_stFilter.ShouldLog(level); }
+
+            /**
+             * @brief 记录日志
+             * @note 线程安全
+             * @param level 日志级别
+             * @param context 日志上下文
+             * @param format 格式化文本
+             * @param args 格式化参数
+             *
+             * 仅检查模块级别，不受全局级别约束。
+             */
+            template <typename... Args>
+            void Log(Level level, const Context& context, const char* format, const Args&... args)noexcept
+            {
+                if (ShouldLog(level))
+                    PrecheckedLog(level, context, format, args...);
+            }
+
+            template <typename TChar = char, typename... Args>
+            void Log(Level level, const Context& context, const std::string& format, const Args&... args)noexcept
+            {
+                if (ShouldLog(level))
+                    PrecheckedLog(level, context, format, args...);
+            }
+
+            /**
+             * @brief 记录已通过级别检查的日志
+             * @note 线程安全
+             *
+             * 供MOE_MODULE_LOG宏使用，调用方须已经通过ShouldLog完成检查，此处不再重复判断级别。
+             */
+            template <typename... Args>
+            void PrecheckedLog(Level level, const Context& context, const char* format, const Args&... args)noexcept
+            {
+                if (m_stLogging.CheckRateLimit(level, context))
+                    m_stLogging.UncheckedLog(level, context, format, args...);
+            }
+
+            template <typename TChar = char, typename... Args>
+            void PrecheckedLog(Level level, const Context& context, const std::string& format,
+                const Args&... args)noexcept
+            {
+                if (m_stLogging.CheckRateLimit(level, context))
+                    m_stLogging.ImmediateLog(level, context, format.c_str(), args...);
+            }
+
+        private:
+            Logging& m_stLogging;
+            std::string m_stName;
+            LevelFilter m_stFilter;
         };
 
+    public:
         /**
          * @brief 获取全局唯一实例
          */
         static Logging& GetInstance()noexcept;
 
+    public:
+        Logging() = default;
+        ~Logging();
+
     public:
         /**
          * @brief 获取全局日志最小输出级别（闭区间）
          * @note 线程安全
          */
-        Level GetMinLevel()const noexcept { return m_iMinLevel.load(std::memory_order_relaxed); }
+        Level GetMinLevel()const noexcept { return LevelFilter::GetMinLevel(m_stFilter.Load()); }
 
         /**
          * @brief 设置全局日志最小输出级别（闭区间）
          * @note 线程安全
          */
-        void SetMinLevel(Level level)noexcept { m_iMinLevel.store(level, std::memory_order_relaxed); }
+        void SetMinLevel(Level level)noexcept;
 
         /**
          * @brief 获取全局日志最大输出级别（闭区间）
          * @note 线程安全
          */
-        Level GetMaxLevel()const noexcept { return m_iMaxLevel.load(std::memory_order_relaxed); }
+        Level GetMaxLevel()const noexcept { return LevelFilter::GetMaxLevel(m_stFilter.Load()); }
 
         /**
          * @brief 设置全局日志最大输出级别（闭区间）
          * @note 线程安全
          */
-        void SetMaxLevel(Level level)noexcept { m_iMaxLevel.store(level, std::memory_order_relaxed); }
+        void SetMaxLevel(Level level)noexcept;
 
         /**
          * @brief 判断该日志级别是否应当被记录
          * @note 线程安全
          */
-        bool ShouldLog(Level level)const noexcept { return GetMinLevel() <= level && level <= GetMaxLevel(); }
+        bool ShouldLog(Level level)const noexcept { return m_stFilter.ShouldLog(level); }
+
+        /**
+         * @brief 单独设置模块的日志级别（闭区间）
+         * @note 线程安全
+         * @param name 模块名
+         * @param min 最小输出级别
+         * @param max 最大输出级别
+         *
+         * 设置对已经存在和之后创建的同名模块均生效。
+         */
+        void SetModuleLevel(const char* name, Level min, Level max=Level::Fatal);
+
+        /**
+         * @brief 取消模块的单独设置，使其跟随全局级别
+         * @note 线程安全
+         * @param name 模块名
+         */
+        void ResetModuleLevel(const char* name);
 
         /**
          * @brief 删除所有落地对象
@@ -488,9 +1209,121 @@ namespace moe
          * @warning 非线程安全，只能在某一线程操作
          *
          * 方法会使当前对落地对象的修改生效。
+         * 新的落地对象列表以RCU方式发布，记录日志的一方无需加锁；方法会等待仍在使用旧列表的线程结束后再回收。
+         * 因此不能在落地对象的回调中调用。
          */
         void Commit();
 
+        /**
+         * @brief 是否启用延迟格式化
+         * @note 线程安全
+         */
+        bool IsDeferredFormat()const noexcept { return m_bDeferredFormat.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 设置是否启用延迟格式化
+         * @note 线程安全
+         *
+         * 启用后，若所有参数都能按值捕获（参见details::LogArgumentTypeOf），调用方只记录格式化串指针和编码后的参数，
+         * 格式化推迟到落地时进行：异步模式下在后台线程完成，BinaryFileSink则直接写出二进制记录供离线解码。
+         * 其余情况仍然在调用线程上格式化。
+         *
+         * 注意：启用后通过const char*传入的格式化串必须具有静态存储期（如字符串字面量）。
+         */
+        void SetDeferredFormat(bool v)noexcept { m_bDeferredFormat.store(v, std::memory_order_relaxed); }
+
+        /**
+         * @brief 启用异步模式
+         * @warning 非线程安全，只能在某一线程操作
+         * @param queueSize 队列容量，向上取整到2的幂
+         * @param policy 队列满时的处理策略
+         *
+         * 异步模式下，日志在调用线程完成格式化后写入有界的多生产者无锁环形队列，由后台线程批量分发给落地对象，
+         * AlwaysFlush的落地对象每批只刷新一次。Fatal级别的日志从不丢弃，且写入后会等待其落地并刷新所有落地对象。
+         * 若已处于异步模式，会先关闭再以新参数启用。
+         */
+        void EnableAsync(size_t queueSize=kDefaultAsyncQueueSize, OverflowPolicy policy=OverflowPolicy::Block);
+
+        /**
+         * @brief 关闭异步模式
+         * @warning 非线程安全，只能在某一线程操作
+         *
+         * 方法会等待队列中的日志全部写出后返回。
+         */
+        void DisableAsync()noexcept;
+
+        /**
+         * @brief 是否处于异步模式
+         * @note 线程安全
+         */
+        bool IsAsync()const noexcept { return m_pAsyncState.load(std::memory_order_relaxed) != nullptr; }
+
+        /**
+         * @brief 等待已提交的日志全部写出，并刷新所有落地对象
+         * @note 线程安全
+         */
+        void Flush()noexcept;
+
+        /**
+         * @brief 获取异步模式下因队列满而丢弃的日志数量
+         * @note 线程安全
+         */
+        uint64_t GetDroppedCount()const noexcept;
+
+        /**
+         * @brief 获取异步模式下因队列满而丢弃的指定级别的日志数量
+         * @note 线程安全
+         * @param level 日志级别
+         */
+        uint64_t GetDroppedCount(Level level)const noexcept
+        {
+            assert(static_cast<unsigned>(level) < kLevelCount);
+            return m_stDroppedCount[static_cast<unsigned>(level)].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 清空丢弃计数
+         * @note 线程安全
+         */
+        void ResetDroppedCount()noexcept;
+
+        /**
+         * @brief 启用调用点限流
+         * @warning 非线程安全，只能在某一线程操作
+         * @param policy 限流策略
+         * @param sites 最多跟踪的调用点个数，向上取整到2的幂，超出后新的调用点不受限制
+         *
+         * 用于防止单个调用点（例如依赖故障时的错误日志）刷屏、挤占磁盘及滚动掉有用的日志。
+         * Fatal日志以及没有文件信息的日志不受限制。若已启用，会先关闭再以新参数启用。
+         */
+        void EnableRateLimit(const RateLimitPolicy& policy, size_t sites=kDefaultRateLimitSites);
+
+        /**
+         * @brief 关闭调用点限流
+         * @warning 非线程安全，只能在某一线程操作
+         *
+         * 尚未汇总的抑制条数会在关闭前输出。
+         */
+        void DisableRateLimit()noexcept;
+
+        /**
+         * @brief 是否启用了调用点限流
+         * @note 线程安全
+         */
+        bool IsRateLimited()const noexcept { return m_pRateLimitState.load(std::memory_order_relaxed) != nullptr; }
+
+        /**
+         * @brief 获取因限流而被抑制的日志数量
+         * @note 线程安全
+         */
+        uint64_t GetSuppressedCount()const noexcept { return m_ullSuppressedCount.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 清空抑制计数
+         * @note 线程安全
+         */
+        void ResetSuppressedCount()noexcept { m_ullSuppressedCount.store(0, std::memory_order_relaxed); }
+
         /**
          * @brief 记录日志
          * @tparam Args 格式化参数
@@ -503,9 +1336,71 @@ namespace moe
         template <typename... Args>
         void Log(Level level, const Context& context, const char* format, const Args&... args)noexcept
         {
-            if (!ShouldLog(level))
-                return;
+            if (ShouldLog(level))
+                PrecheckedLog(level, context, format, args...);
+        }
+
+        /**
+         * @brief 记录日志
+         * @tparam Args 格式化参数
+         * @note 线程安全
+         * @param level 日志级别
+         * @param context 日志上下文
+         * @param format 格式化文本
+         * @param args 格式化参数
+         */
+        template <typename TChar = char, typename... Args>
+        void Log(Level level, const Context& context, const std::string& format, const Args&... args)noexcept
+        {
+            if (ShouldLog(level))
+                PrecheckedLog(level, context, format, args...);
+        }
+
+        /**
+         * @brief 记录已通过级别检查的日志
+         * @note 线程安全
+         * @param level 日志级别
+         * @param context 日志上下文
+         * @param format 格式化文本
+         * @param args 格式化参数
+         *
+         * 供MOE_LOG宏使用，调用方须已经通过ShouldLog完成检查，此处不再重复判断级别。
+         */
+        template <typename... Args>
+        void PrecheckedLog(Level level, const Context& context, const char* format, const Args&... args)noexcept
+        {
+            if (CheckRateLimit(level, context))
+                UncheckedLog(level, context, format, args...);
+        }
+
+        template <typename TChar = char, typename... Args>
+        void PrecheckedLog(Level level, const Context& context, const std::string& format, const Args&... args)noexcept
+        {
+            if (CheckRateLimit(level, context))
+                ImmediateLog(level, context, format.c_str(), args...);  // 格式化串的生命周期无法保证，不能延迟
+        }
+
+    private:
+        bool CheckRateLimit(Level level, const Context& context)const noexcept
+        {
+            if (m_pRateLimitState.load(std::memory_order_relaxed) == nullptr || level == Level::Fatal || !context.File)
+                return true;
+            return RateLimitAdmit(level, context);
+        }
 
+        template <typename... Args>
+        void UncheckedLog(Level level, const Context& context, const char* format, const Args&... args)noexcept
+        {
+            using Deferrable = std::integral_constant<bool, details::LogArgumentsDeferrable<Args...>::value>;
+            if (Deferrable::value && IsDeferredFormat())
+                DeferredLog(Deferrable(), level, context, format, args...);
+            else
+                ImmediateLog(level, context, format, args...);
+        }
+
+        template <typename... Args>
+        void ImmediateLog(Level level, const Context& context, const char* format, const Args&... args)noexcept
+        {
             std::string& formatted = GetFormatStringThreadCache();
             formatted.clear();
 
@@ -524,63 +1419,184 @@ namespace moe
             }
         }
 
-        /**
-         * @brief 记录日志
-         * @tparam Args 格式化参数
-         * @note 线程安全
-         * @param level 日志级别
-         * @param context 日志上下文
-         * @param format 格式化文本
-         * @param args 格式化参数
-         */
-        template <typename TChar = char, typename... Args>
-        void Log(Level level, const Context& context, const std::string& format, const Args&... args)noexcept
+        template <typename... Args>
+        void DeferredLog(std::true_type, Level level, const Context& context, const char* format,
+            const Args&... args)noexcept
+        {
+            std::string& encoded = GetFormatStringThreadCache();
+            encoded.clear();
+
+            try
+            {
+                details::EncodeLogArguments(encoded, args...);
+            }
+            catch (...)
+            {
+                Sink(Level::Fatal, context, kAllocErrorMsg);
+                return;
+            }
+            DeferredSink(level, context, format, encoded.data(), encoded.size());
+        }
+
+        template <typename... Args>
+        void DeferredLog(std::false_type, Level, const Context&, const char*, const Args&...)noexcept
         {
-            Log(level, context, format.c_str(), args...);
+            assert(false);
         }
 
     private:
+        struct AsyncState;
+        struct RateLimitState;
+        struct SuppressedReport;
+
+        static void OnRateLimitTimer(void* self, Time::Timestamp now)noexcept;
+
         std::string& GetFormatStringThreadCache()const noexcept;
+        const SinkContainerType* GetSinksInUse()const noexcept;
         void Sink(Level level, const Context& context, const char* msg)const noexcept;
+        void DeferredSink(Level level, const Context& context, const char* format, const char* args,
+            size_t length)const noexcept;
+        void DispatchDeferred(const SinkContainerType& sinks, Level level, const Context& context, const char* format,
+            const char* args, size_t length, bool flush)const noexcept;
+        void AsyncSink(AsyncState& state, Level level, const Context& context, const char* format, const char* data,
+            size_t length)const noexcept;
+        void AsyncWait(AsyncState& state, size_t ticket)const noexcept;
+        void AsyncWorker(AsyncState& state)noexcept;
+        void UpdateLevel(Level min, Level max)noexcept;  // 需持有m_stModuleLock
+        bool RateLimitAdmit(Level level, const Context& context)const noexcept;
+        void ReportSuppressed(bool force)const noexcept;
+        void SinkSuppressedReport(const SuppressedReport& report)const noexcept;
 
     private:
 #ifdef NDEBUG
-        std::atomic<Level> m_iMinLevel { Level::Info };
+        LevelFilter m_stFilter { LevelFilter::Make(Level::Info, Level::Fatal) };
 #else
-        std::atomic<Level> m_iMinLevel { Level::Debug };
+        LevelFilter m_stFilter { LevelFilter::Make(Level::Debug, Level::Fatal) };
 #endif
-        std::atomic<Level> m_iMaxLevel { Level::Fatal };
+
+        std::mutex m_stModuleLock;
+        std::vector<Module*> m_stModules;  // 已注册的模块
+        std::unordered_map<std::string, uint32_t> m_stModuleFilters;  // 单独设置的模块级别
 
         SinkContainerType m_stSinks;  // 当前正在修改的Sinks（非线程安全，无保护）
 
-        mutable std::mutex m_stLock;
-        SinkContainerPtr m_stSinksInUse;  // 当前正在使用的Sinks
+        std::atomic<SinkContainerType*> m_pSinksInUse { nullptr };  // 当前正在使用的Sinks，通过RCU发布和回收
+
+        std::atomic<bool> m_bDeferredFormat { false };
+        std::atomic<AsyncState*> m_pAsyncState { nullptr };  // 异步模式状态，nullptr表示同步模式
+        mutable std::atomic<unsigned> m_uAsyncUsers { 0 };  // 正在访问异步状态的生产者个数
+        mutable std::atomic<uint64_t> m_stDroppedCount[kLevelCount] {};
+        std::atomic<RateLimitState*> m_pRateLimitState { nullptr };  // 限流状态，通过RCU发布和回收
+        mutable std::atomic<uint64_t> m_ullSuppressedCount { 0 };
     };
 }
 
+/**
+ * 编译期日志级别（0~5，依次对应Debug~Fatal）
+ *
+ * 低于该级别的MOE_LOG_* / MOE_MODULE_LOG_*调用在预处理阶段即被删除，参数也不会被求值。
+ * 例如发布版本中定义MOE_LOG_ACTIVE_LEVEL=2以彻底移除Debug及Trace日志。
+ */
+#ifndef MOE_LOG_ACTIVE_LEVEL
+#define MOE_LOG_ACTIVE_LEVEL 0
+#endif
+
+#define MOE_LOG_DISCARD() \
+    do {} while (false)
+
 #define MOE_LOG(level, format, ...) \
     do { \
-        moe::Logging::GetInstance().Log(level, moe::Logging::Context(__FILE__, __LINE__, __FUNCTION__), format, \
-            ##__VA_ARGS__); \
+        const auto moeLogLevel_ = (level); \
+        auto& moeLogging_ = moe::Logging::GetInstance(); \
+        if (static_cast<int>(moeLogLevel_) >= MOE_LOG_ACTIVE_LEVEL && moeLogging_.ShouldLog(moeLogLevel_)) \
+        { \
+            moeLogging_.PrecheckedLog(moeLogLevel_, moe::Logging::Context(__FILE__, __LINE__, __FUNCTION__), \
+                format, ##__VA_ARGS__); \
+        } \
+    } while (false)
+
+#define MOE_MODULE_LOG(module, level, format, ...) \
+    do { \
+        const auto moeLogLevel_ = (level); \
+        auto& moeLogModule_ = (module); \
+        if (static_cast<int>(moeLogLevel_) >= MOE_LOG_ACTIVE_LEVEL && moeLogModule_.ShouldLog(moeLogLevel_)) \
+        { \
+            moeLogModule_.PrecheckedLog(moeLogLevel_, moe::Logging::Context(__FILE__, __LINE__, __FUNCTION__), \
+                format, ##__VA_ARGS__); \
+        } \
     } while (false)
 
+#if MOE_LOG_ACTIVE_LEVEL <= 0
 #define MOE_LOG_DEBUG(format, ...) \
     MOE_LOG(moe::Logging::Level::Debug, format, ##__VA_ARGS__)
+#define MOE_MODULE_LOG_DEBUG(module, format, ...) \
+    MOE_MODULE_LOG(module, moe::Logging::Level::Debug, format, ##__VA_ARGS__)
+#else
+#define MOE_LOG_DEBUG(format, ...) \
+    MOE_LOG_DISCARD()
+#define MOE_MODULE_LOG_DEBUG(module, format, ...) \
+    MOE_LOG_DISCARD()
+#endif
 
+#if MOE_LOG_ACTIVE_LEVEL <= 1
 #define MOE_LOG_TRACE(format, ...) \
     MOE_LOG(moe::Logging::Level::Trace, format, ##__VA_ARGS__)
+#define MOE_MODULE_LOG_TRACE(module, format, ...) \
+    MOE_MODULE_LOG(module, moe::Logging::Level::Trace, format, ##__VA_ARGS__)
+#else
+#define MOE_LOG_TRACE(format, ...) \
+    MOE_LOG_DISCARD()
+#define MOE_MODULE_LOG_TRACE(module, format, ...) \
+    MOE_LOG_DISCARD()
+#endif
 
+#if MOE_LOG_ACTIVE_LEVEL <= 2
 #define MOE_LOG_INFO(format, ...) \
     MOE_LOG(moe::Logging::Level::Info, format, ##__VA_ARGS__)
+#define MOE_MODULE_LOG_INFO(module, format, ...) \
+    MOE_MODULE_LOG(module, moe::Logging::Level::Info, format, ##__VA_ARGS__)
+#else
+#define MOE_LOG_INFO(format, ...) \
+    MOE_LOG_DISCARD()
+#define MOE_MODULE_LOG_INFO(module, format, ...) \
+    MOE_LOG_DISCARD()
+#endif
 
+#if MOE_LOG_ACTIVE_LEVEL <= 3
 #define MOE_LOG_WARN(format, ...) \
     MOE_LOG(moe::Logging::Level::Warn, format, ##__VA_ARGS__)
+#define MOE_MODULE_LOG_WARN(module, format, ...) \
+    MOE_MODULE_LOG(module, moe::Logging::Level::Warn, format, ##__VA_ARGS__)
+#else
+#define MOE_LOG_WARN(format, ...) \
+    MOE_LOG_DISCARD()
+#define MOE_MODULE_LOG_WARN(module, format, ...) \
+    MOE_LOG_DISCARD()
+#endif
 
+#if MOE_LOG_ACTIVE_LEVEL <= 4
 #define MOE_LOG_ERROR(format, ...) \
     MOE_LOG(moe::Logging::Level::Error, format, ##__VA_ARGS__)
+#define MOE_MODULE_LOG_ERROR(module, format, ...) \
+    MOE_MODULE_LOG(module, moe::Logging::Level::Error, format, ##__VA_ARGS__)
+#else
+#define MOE_LOG_ERROR(format, ...) \
+    MOE_LOG_DISCARD()
+#define MOE_MODULE_LOG_ERROR(module, format, ...) \
+    MOE_LOG_DISCARD()
+#endif
 
+#if MOE_LOG_ACTIVE_LEVEL <= 5
 #define MOE_LOG_FATAL(format, ...) \
     MOE_LOG(moe::Logging::Level::Fatal, format, ##__VA_ARGS__)
+#define MOE_MODULE_LOG_FATAL(module, format, ...) \
+    MOE_MODULE_LOG(module, moe::Logging::Level::Fatal, format, ##__VA_ARGS__)
+#else
+#define MOE_LOG_FATAL(format, ...) \
+    MOE_LOG_DISCARD()
+#define MOE_MODULE_LOG_FATAL(module, format, ...) \
+    MOE_LOG_DISCARD()
+#endif
 
 #define MOE_LOG_EXCEPTION(ex) \
     do { \
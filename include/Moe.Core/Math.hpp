@@ -2339,7 +2339,7 @@ namespace moe
             /**
              * @brief 转置
              */
-            void Transpose()const
+            Matrix4<T> Transpose()const
             {
                 return Matrix4<T>(
                     a[0][0], a[1][0], a[2][0], a[3][0],
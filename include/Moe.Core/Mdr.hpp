@@ -106,6 +106,24 @@ namespace moe
          */
         static uint64_t ReadVarint(Stream* stream)
         {
+            // 窗口中包含完整的变长整数时直接解码
+            auto window = stream->GetReadWindow();
+            auto p = window.GetBuffer();
+            auto size = std::min<size_t>(window.GetSize(), 10);
+            for (size_t i = 0; i < size; ++i)
+            {
+                if ((p[i] & 0x80) != 0)
+                    continue;
+                if (i == 9 && p[i] != 1)
+                    MOE_THROW(BadFormatException, "Varint is too big");
+
+                uint64_t ret = 0;
+                for (size_t j = 0; j <= i; ++j)
+                    ret |= (static_cast<uint64_t>(p[j] & 0x7F) << (7 * j));
+                stream->AdvanceRead(i + 1);
+                return ret;
+            }
+
             int b = 0;
             uint64_t ret = 0;
             uint32_t bits = 0;
@@ -140,22 +158,42 @@ namespace moe
         }
 
         /**
-         * @brief 写入变长整数
-         * @param stream 流
+         * @brief 编码变长整数
+         * @param out 输出缓冲区，至少10字节
          * @param value 值
+         * @return 编码后的字节数
          */
-        static void WriteVarint(Stream* stream, uint64_t value)
+        static size_t EncodeVarint(uint8_t* out, uint64_t value)noexcept
         {
-            unsigned pos = 0;
-            uint8_t bytes[10];
+            size_t pos = 0;
             do
             {
-                assert(pos < sizeof(bytes));
+                assert(pos < 10);
                 auto b = static_cast<unsigned char>(value & 0x7F);
                 value >>= 7;
                 b |= (value > 0 ? 0x80 : 0);
-                bytes[pos++] = b;
+                out[pos++] = b;
             } while (value > 0);
+            return pos;
+        }
+
+        /**
+         * @brief 写入变长整数
+         * @param stream 流
+         * @param value 值
+         */
+        static void WriteVarint(Stream* stream, uint64_t value)
+        {
+            uint8_t bytes[10];
+            auto pos = EncodeVarint(bytes, value);
+
+            auto window = stream->GetWriteWindow();
+            if (window.GetSize() >= pos)
+            {
+                ::memcpy(window.GetBuffer(), bytes, pos);
+                stream->AdvanceWrite(pos);
+                return;
+            }
             stream->Write(BytesView(bytes, pos), pos);
         }
 
@@ -672,6 +710,15 @@ namespace moe
 
             void ReadFixed32(uint32_t* out)
             {
+                auto window = m_pStream->GetReadWindow();
+                if (window.GetSize() >= 4)
+                {
+                    if (out)
+                        *out = details::LoadLE<uint32_t>(window.GetBuffer());
+                    m_pStream->AdvanceRead(4);
+                    return;
+                }
+
                 uint8_t buffer[4];
                 if (m_pStream->Read(MutableBytesView(buffer, 4), 4) != 4)
                     MOE_THROW(OutOfRangeException, "Eof");
@@ -681,6 +728,15 @@ namespace moe
 
             void ReadFixed64(uint64_t* out)
             {
+                auto window = m_pStream->GetReadWindow();
+                if (window.GetSize() >= 8)
+                {
+                    if (out)
+                        *out = details::LoadLE<uint64_t>(window.GetBuffer());
+                    m_pStream->AdvanceRead(8);
+                    return;
+                }
+
                 uint8_t buffer[8];
                 if (m_pStream->Read(MutableBytesView(buffer, 8), 8) != 8)
                     MOE_THROW(OutOfRangeException, "Eof");
@@ -919,32 +975,17 @@ namespace moe
 
             void Write(const std::string& value, TagType tag)
             {
-                FieldHead head = { tag, WireTypes::Buffer };
-                WriteHead(head);
-                WriteVarint(value.length());
-                if (value.length())
-                {
-                    m_pStream->Write(BytesView(reinterpret_cast<const uint8_t*>(value.data()), value.length()),
-                        value.length());
-                }
+                WriteBuffer(BytesView(reinterpret_cast<const uint8_t*>(value.data()), value.length()), tag);
             }
 
             void Write(const std::vector<uint8_t>& value, TagType tag)
             {
-                FieldHead head = { tag, WireTypes::Buffer };
-                WriteHead(head);
-                WriteVarint(value.size());
-                if (value.size())
-                    m_pStream->Write(BytesView(value.data(), value.size()), value.size());
+                WriteBuffer(BytesView(value.data(), value.size()), tag);
             }
 
             void Write(BytesView value, TagType tag)
             {
-                FieldHead head = { tag, WireTypes::Buffer };
-                WriteHead(head);
-                WriteVarint(value.GetSize());
-                if (value.GetSize())
-                    m_pStream->Write(value, value.GetSize());
+                WriteBuffer(value, tag);
             }
 
             template <typename TValue>
@@ -1030,6 +1071,24 @@ namespace moe
                 }
             }
 
+            void WriteBuffer(BytesView value, TagType tag)
+            {
+                // 字段头、长度和数据通过一次WriteV写出
+                uint8_t header[1 + 10 + 10];
+                size_t size = 0;
+                if (tag < 0xF)
+                    header[size++] = static_cast<uint8_t>((tag << 4) | static_cast<uint32_t>(WireTypes::Buffer));
+                else
+                {
+                    header[size++] = static_cast<uint8_t>(0xF0 | static_cast<uint32_t>(WireTypes::Buffer));
+                    size += Mdr::EncodeVarint(header + size, tag - 0xF);
+                }
+                size += Mdr::EncodeVarint(header + size, value.GetSize());
+
+                BytesView parts[2] = { BytesView(header, size), value };
+                m_pStream->WriteV(ArrayView<BytesView>(parts, value.IsEmpty() ? 1 : 2));
+            }
+
             void WriteFixed8(uint8_t value)
             {
                 m_pStream->WriteByte(value);
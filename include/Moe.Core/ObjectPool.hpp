@@ -7,10 +7,16 @@
 #include <cstdlib>
 #include <cstddef>
 #include <stdexcept>
+#include <mutex>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <algorithm>
+#include <vector>
 #include <functional>
 
 #include "Utils.hpp"
+#include "RefPtr.hpp"
 #include "Exception.hpp"
 
 namespace moe
@@ -34,18 +40,81 @@ namespace moe
                 MOE_UNUSED(p);
             }
         };
+
+        /**
+         * @brief 单写者计数器
+         *
+         * 只由所属线程修改，但允许其他线程随时读取（如汇总多线程对象池的统计信息）。
+         * 读写均为relaxed的原子操作，修改不使用读-改-写指令，在主流平台上与普通整数的开销相同。
+         */
+        template <typename T>
+        class SingleWriterCounter
+        {
+        public:
+            SingleWriterCounter(T value=T())noexcept
+                : m_stValue(value) {}
+
+            SingleWriterCounter& operator=(T value)noexcept
+            {
+                m_stValue.store(value, std::memory_order_relaxed);
+                return *this;
+            }
+
+            operator T()const noexcept
+            {
+                return m_stValue.load(std::memory_order_relaxed);
+            }
+
+            SingleWriterCounter& operator+=(T value)noexcept
+            {
+                m_stValue.store(m_stValue.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+                return *this;
+            }
+
+            SingleWriterCounter& operator-=(T value)noexcept
+            {
+                m_stValue.store(m_stValue.load(std::memory_order_relaxed) - value, std::memory_order_relaxed);
+                return *this;
+            }
+
+            SingleWriterCounter& operator++()noexcept
+            {
+                return *this += 1;
+            }
+
+            SingleWriterCounter& operator--()noexcept
+            {
+                return *this -= 1;
+            }
+
+        private:
+            std::atomic<T> m_stValue;
+        };
+
+        struct ConcurrentObjectPoolState;
     }
 
+    class ConcurrentObjectPool;
+
+    template <typename T>
+    class TypedPool;
+
     /**
      * @brief 基于定长对象的缓存分配器
      *
-     * 简单的FreeList，单线程下使用，适用于小对象的频繁分配释放。
+     * 简单的FreeList，单线程下使用，适用于小对象的频繁分配释放。多线程环境下请使用ConcurrentObjectPool。
      * 根据Benchmark的结果，无论如何，在Windows/Linux下，使用ObjectPool性能总是会好于直接的malloc/free。
      * 然而OSX下反而不如直接malloc/free。原因不明（cache miss?）。
      */
     class ObjectPool :
         public NonCopyable
     {
+        friend class ConcurrentObjectPool;
+        friend struct details::ConcurrentObjectPoolState;
+
+        template <typename T>
+        friend class TypedPool;
+
     public:
         static const unsigned kSmallSizeThreshold = 4096;  // 4K
         static const unsigned kSmallSizeBlockSize = 32;
@@ -54,6 +123,8 @@ namespace moe
         static const unsigned kLargeSizeBlockSize = 256;
         static const unsigned kLargeSizeBlocks = (kLargeSizeThreshold - kSmallSizeThreshold) / kLargeSizeBlockSize;
         static const unsigned kTotalBlocks = 1 + kSmallSizeBlocks + kLargeSizeBlocks;
+        static const unsigned kSlabSize = 64 * 1024;  // 64K
+        static const unsigned kSlabMaxNodeSize = kSmallSizeThreshold;
 
         template <typename T>
         struct Deleter
@@ -75,6 +146,64 @@ namespace moe
                 : Filename(file), Line(line) {}
         };
 
+        /**
+         * @brief 单个尺寸分级的统计信息
+         */
+        struct BucketStatistics
+        {
+            size_t NodeSize = 0;  // 节点大小，0表示直接从系统分配的超大对象
+            size_t AllocatedCount = 0;  // 持有的节点个数
+            size_t AllocatedSize = 0;  // 持有的字节数，超大对象为实际请求的大小
+            size_t FreeCount = 0;  // 空闲的节点个数
+            size_t PeakUsedCount = 0;  // 使用中节点个数的峰值
+            uint64_t AllocCalls = 0;  // 分配次数
+            uint64_t FreeCalls = 0;  // 释放次数
+            uint64_t FreeListHits = 0;  // 复用之前释放的节点完成分配的次数
+            uint64_t FreshAllocs = 0;  // 使用从未分配过的节点（新申请或从Slab中新切分）完成分配的次数
+            uint64_t SystemAllocCalls = 0;  // 向系统申请内存的次数（malloc或新的Slab）
+            uint64_t RequestedBytes = 0;  // 分配请求的总字节数
+
+            /**
+             * @brief 获取因尺寸取整浪费的字节数（累计）
+             */
+            uint64_t GetWastedBytes()const noexcept
+            {
+                return NodeSize == 0 ? 0 : AllocCalls * NodeSize - RequestedBytes;
+            }
+        };
+
+        /**
+         * @brief 对象池统计信息快照
+         */
+        struct Statistics
+        {
+            size_t AllocatedSize = 0;  // 总共分配的字节数
+            size_t FreeSize = 0;  // 空闲的字节数
+            std::vector<BucketStatistics> Buckets;  // 各个尺寸分级，仅包含被使用过的分级，按NodeSize升序排列
+
+            /**
+             * @brief 合并另一份统计信息
+             * @param rhs 统计信息
+             *
+             * 相同NodeSize的分级逐项相加。峰值同样相加，因此合并后的PeakUsedCount是各部分峰值之和，只是一个上界。
+             */
+            void Merge(const Statistics& rhs);
+        };
+
+        /**
+         * @brief 计算大小对应的尺寸分级
+         * @param sz 大小
+         * @return 分级下标，0表示超过kLargeSizeThreshold、直接从系统分配
+         */
+        static constexpr size_t GetSizeClass(size_t sz)noexcept
+        {
+            return sz == 0 ? 1 :
+                sz <= kSmallSizeThreshold ? (sz + (kSmallSizeBlockSize - 1)) / kSmallSizeBlockSize :
+                sz <= kLargeSizeThreshold ? (sz - kSmallSizeThreshold + (kLargeSizeBlockSize - 1)) /
+                    kLargeSizeBlockSize + kSmallSizeBlocks :
+                0;
+        }
+
         /**
          * @brief 通过指针获取对应的对象池
          */
@@ -85,6 +214,15 @@ namespace moe
          */
         static void Free(void* p)noexcept;
 
+        /**
+         * @brief 批量释放对象
+         * @param p 指针数组，可以包含nullptr
+         * @param count 个数
+         *
+         * 相邻且属于同一尺寸分级（Slab模式下为同一Slab）的指针会被整段归还，链表和计数只更新一次。
+         */
+        static void FreeBatch(void* const* p, size_t count)noexcept;
+
     private:
         enum class NodeStatus : uint32_t
         {
@@ -93,12 +231,14 @@ namespace moe
         };
 
         struct Bucket;
+        struct Slab;
 
         struct Node
         {
             struct {
                 NodeStatus Status = NodeStatus::Free;  // 节点状态
                 Bucket* Parent = nullptr;  // 父对象，nullptr表示从系统中分配的，直接对应malloc/free。
+                size_t Size = 0;  // 超大对象的实际大小，仅在Parent->NodeSize为0时有效
 #ifndef NDEBUG
                 Node* Prev = nullptr;  // 关联链中的上一个缓冲区
                 Node* Next = nullptr;  // 关联链中的下一个缓冲区
@@ -120,16 +260,45 @@ namespace moe
 #endif
         };
 
+        template <typename T>
+        using Counter = details::SingleWriterCounter<T>;
+
         struct Bucket
         {
             ObjectPool* Pool = nullptr;  // 父对象
             size_t NodeSize = 0;  // 单个节点的大小
-            size_t AllocatedCount = 0;  // 总共分配的大小
-            size_t FreeCount = 0;  // 空闲的大小
+            Counter<size_t> AllocatedCount;  // 总共分配的节点个数
+            Counter<size_t> FreeCount;  // 空闲的节点个数
+            Counter<size_t> LargeSize;  // 超大对象的总大小，仅在NodeSize为0时有效
+            Slab* PartialSlabs = nullptr;  // 存在空闲节点的Slab
+            Slab* FullSlabs = nullptr;  // 已经分配满的Slab
 #ifndef NDEBUG
             Node UseList;  // 正在使用的内存块
 #endif
             Node FreeList;  // 空闲的内存块
+
+            // 统计信息，线程缓存的统计信息会被其他线程汇总读取
+            Counter<size_t> PeakUsedCount;
+            Counter<uint64_t> AllocCalls;
+            Counter<uint64_t> FreeCalls;
+            Counter<uint64_t> FreeListHits;
+            Counter<uint64_t> FreshAllocs;
+            Counter<uint64_t> SystemAllocCalls;
+            Counter<uint64_t> RequestedBytes;
+
+            size_t GetAllocatedSize()const noexcept
+            {
+                return NodeSize == 0 ? static_cast<size_t>(LargeSize) : AllocatedCount * NodeSize;
+            }
+
+            void OnAlloc(size_t sz, size_t count=1)noexcept
+            {
+                AllocCalls += count;
+                RequestedBytes += sz * count;
+                size_t used = AllocatedCount - FreeCount;
+                if (used > PeakUsedCount)
+                    PeakUsedCount = used;
+            }
         };
 
         /**
@@ -146,12 +315,27 @@ namespace moe
 #endif
 
     public:
-        ObjectPool();
+        /**
+         * @brief 构造对象池
+         * @param slabMode 是否启用Slab模式
+         *
+         * Slab模式下，不超过kSlabMaxNodeSize的节点从按kSlabSize对齐的大页中切分，节点本身不再携带头部，
+         * 所属的Bucket通过对地址取掩码得到。这能显著降低小对象的内存开销，并且完全空闲的Slab可以通过CollectGarbage归还给系统。
+         * 代价是调试版本下Slab中的节点不会记录分配上下文。
+         */
+        explicit ObjectPool(bool slabMode=false);
         ~ObjectPool();
 
     public:
+        /**
+         * @brief 是否处于Slab模式
+         */
+        bool IsSlabMode()const noexcept { return m_bSlabMode; }
+
         /**
          * @brief 获取总共分配的数量（字节）
+         *
+         * 超大对象按实际请求的大小计算。
          */
         size_t GetAllocatedSize()const noexcept;
 
@@ -165,6 +349,18 @@ namespace moe
          */
         size_t GetUsedSize()const noexcept { return GetAllocatedSize() - GetFreeSize(); }
 
+        /**
+         * @brief 获取统计信息快照
+         */
+        Statistics GetStatistics()const;
+
+        /**
+         * @brief 清空统计计数
+         *
+         * 峰值会被重置为当前的使用量。
+         */
+        void ResetStatistics()noexcept;
+
         /**
          * @brief 获取内存泄漏报告对象
          */
@@ -185,6 +381,7 @@ namespace moe
          *
          * 当需要回收所有空闲对象时，设置 factor = 1。
          * 当 maxFree 不为0时，当回收超过该数量的内存后退出。
+         * Slab模式下，只有完全空闲的Slab会被整体归还给系统。
          */
         size_t CollectGarbage(unsigned factor=1, size_t maxFree=0)noexcept;
 
@@ -202,9 +399,9 @@ namespace moe
         {
             std::unique_ptr<void, Deleter<void>> ret;
 #ifndef NDEBUG
-            ret.reset(InternalAlloc(sz, context));
+            ret.reset(InternalAlloc(GetSizeClass(sz), sz, context));
 #else
-            ret.reset(InternalAlloc(sz));
+            ret.reset(InternalAlloc(GetSizeClass(sz), sz));
 #endif
             return ret;
         }
@@ -226,21 +423,332 @@ namespace moe
             return p;
         }
 
+        /**
+         * @brief 批量分配内存
+         * @param sz 单个对象的大小
+         * @param[out] out 输出的指针数组，至少容纳count个元素
+         * @param count 个数
+         * @param context 上下文，用于调试。仅调试版本有效。
+         *
+         * 空闲链表上的节点会被整段取出，计数只更新一次。得到的指针需要通过Free或FreeBatch释放。
+         * 分配失败时已经分配的部分会被归还，out中的内容未定义。
+         */
+#ifndef NDEBUG
+        void AllocBatch(size_t sz, void** out, size_t count, const AllocContext& context=EmptyRefOf<AllocContext>())
+        {
+            InternalAllocBatch(GetSizeClass(sz), sz, out, count, context);
+        }
+#else
+        void AllocBatch(size_t sz, void** out, size_t count)
+        {
+            InternalAllocBatch(GetSizeClass(sz), sz, out, count);
+        }
+#endif
+
     private:
 #ifndef NDEBUG
-        void* InternalAlloc(size_t sz, const AllocContext& context);
+        void* InternalAlloc(size_t sizeClass, size_t sz, const AllocContext& context);
+        void InternalAllocBatch(size_t sizeClass, size_t sz, void** out, size_t count, const AllocContext& context);
         void* InternalRealloc(void* p, size_t sz, const AllocContext& context);
 #else
-        void* InternalAlloc(size_t sz);
+        void* InternalAlloc(size_t sizeClass, size_t sz);
+        void InternalAllocBatch(size_t sizeClass, size_t sz, void** out, size_t count);
         void* InternalRealloc(void* p, size_t sz);
 #endif
-        void InternalFree(Node* p)noexcept;
+        void InternalFree(void* p, Slab* slab)noexcept;
+        void InternalFreeBatch(void* const* p, size_t count, Slab* slab)noexcept;
+        void LocalFree(void* p, Slab* slab)noexcept;
+        void LocalFreeBatch(void* const* p, size_t count, Slab* slab)noexcept;
+        void RemoteFree(void* p)noexcept;
+        void RemoteFreeBatch(void* const* p, size_t count)noexcept;
+        void DrainRemoteFree()noexcept;
+
+        Slab* NewSlab(Bucket& bucket);
+        void DeleteSlab(Slab* slab)noexcept;
+        void* SlabAlloc(Bucket& bucket, Slab* slab)noexcept;
+        size_t SlabAllocBatch(Bucket& bucket, Slab* slab, void** out, size_t count)noexcept;
+        void SlabFree(Slab* slab, void* p)noexcept;
+        void SlabFreeBatch(Slab* slab, void* const* p, size_t count)noexcept;
+        size_t CollectSlabs(Bucket& bucket, size_t maxNodes, size_t maxFree)noexcept;
+#ifndef NDEBUG
+        void ReportSlabLeaks(Bucket& bucket)noexcept;
+#endif
+
+        static size_t GetCapacityFromPointer(void* p)noexcept;
 
     private:
         Bucket m_stBuckets[kTotalBlocks];
         MemLeakReportCallback m_pLeakReporter;
+        bool m_bSlabMode = false;
+
+        // 仅当作为ConcurrentObjectPool的线程缓存时使用
+        bool m_bThreadCache = false;
+        std::atomic<std::thread::id> m_stOwnerThread;
+        std::atomic<void*> m_pRemoteFreeList;
     };
 
     template <typename T>
     using UniquePooledObject = std::unique_ptr<T, ObjectPool::Deleter<T>>;
+
+    /**
+     * @brief 类型化的对象池
+     * @tparam T 对象类型
+     *
+     * 对ObjectPool的包装，尺寸分级在编译期确定，分配的同时在内存上构造对象。
+     * 若T以RefBase<T, ObjectPool::Deleter<T>>为基类，可以通过AllocRef直接得到RefPtr。
+     */
+    template <typename T>
+    class TypedPool :
+        public NonCopyable
+    {
+        static_assert(alignof(T) <= 16, "Over-aligned type is not supported");
+
+        static const size_t kBatchChunkSize = 64;
+
+    public:
+        static const size_t kSizeClass = ObjectPool::GetSizeClass(sizeof(T));
+
+    public:
+        explicit TypedPool(ObjectPool& pool)noexcept
+            : m_stPool(pool) {}
+
+    public:
+        /**
+         * @brief 获取关联的对象池
+         */
+        ObjectPool& GetPool()const noexcept { return m_stPool; }
+
+        /**
+         * @brief 分配并构造对象
+         * @param args 构造参数
+         * @return 对象指针
+         */
+        template <typename... TArgs>
+        UniquePooledObject<T> Alloc(TArgs&&... args)
+        {
+            std::unique_ptr<void, ObjectPool::Deleter<void>> mem(RawAlloc());
+            auto obj = new(mem.get()) T(std::forward<TArgs>(args)...);
+            mem.release();
+            return UniquePooledObject<T>(obj);
+        }
+
+        /**
+         * @brief 分配并构造引用计数对象
+         * @param args 构造参数
+         * @return 引用计数指针
+         */
+        template <typename... TArgs>
+        RefPtr<T> AllocRef(TArgs&&... args)
+        {
+            return RefPtr<T>(Alloc(std::forward<TArgs>(args)...));
+        }
+
+        /**
+         * @brief 批量分配并构造对象
+         * @param[out] out 输出容器，新对象追加在末尾
+         * @param count 个数
+         * @param args 构造参数，每个对象都以相同的参数拷贝构造
+         *
+         * 内存按块通过ObjectPool::AllocBatch取得。若构造过程中抛出异常，out中保留已构造完毕的对象。
+         */
+        template <typename... TArgs>
+        void AllocBatch(std::vector<UniquePooledObject<T>>& out, size_t count, const TArgs&... args)
+        {
+            void* raw[kBatchChunkSize];
+
+            out.reserve(out.size() + count);
+            while (count > 0)
+            {
+                auto n = std::min(count, kBatchChunkSize);
+#ifndef NDEBUG
+                m_stPool.InternalAllocBatch(kSizeClass, sizeof(T), raw, n, EmptyRefOf<ObjectPool::AllocContext>());
+#else
+                m_stPool.InternalAllocBatch(kSizeClass, sizeof(T), raw, n);
+#endif
+
+                size_t i = 0;
+                try
+                {
+                    for (; i < n; ++i)
+                        out.emplace_back(new(raw[i]) T(args...));
+                }
+                catch (...)
+                {
+                    ObjectPool::FreeBatch(raw + i, n - i);
+                    throw;
+                }
+                count -= n;
+            }
+        }
+
+        /**
+         * @brief 批量析构并释放对象
+         * @param objects 对象容器，调用后被清空
+         *
+         * 对象可以来自任意对象池，相邻且同属一个分级的对象会被整段归还。
+         */
+        static void FreeBatch(std::vector<UniquePooledObject<T>>& objects)noexcept
+        {
+            void* raw[kBatchChunkSize];
+
+            size_t i = 0;
+            while (i < objects.size())
+            {
+                size_t n = 0;
+                for (; n < kBatchChunkSize && i < objects.size(); ++i)
+                {
+                    auto p = objects[i].release();
+                    if (!p)
+                        continue;
+                    details::Finalizer<T>()(p);
+                    raw[n++] = p;
+                }
+                ObjectPool::FreeBatch(raw, n);
+            }
+            objects.clear();
+        }
+
+    private:
+        void* RawAlloc()
+        {
+#ifndef NDEBUG
+            return m_stPool.InternalAlloc(kSizeClass, sizeof(T), EmptyRefOf<ObjectPool::AllocContext>());
+#else
+            return m_stPool.InternalAlloc(kSizeClass, sizeof(T));
+#endif
+        }
+
+    private:
+        ObjectPool& m_stPool;
+    };
+
+    template <typename T>
+    const size_t TypedPool<T>::kBatchChunkSize;
+
+    template <typename T>
+    const size_t TypedPool<T>::kSizeClass;
+
+    /**
+     * @brief 多线程对象池
+     *
+     * 每个线程持有一个独立的ObjectPool作为线程缓存，分配总是从当前线程的缓存中进行，无需加锁。
+     * 当对象在其他线程被释放时（ObjectPool::Free），节点会被压入所属缓存的无锁远程释放队列，并在所属线程下次分配时回收。
+     * 线程退出后其缓存会被标记为废弃，由后续新线程接管，因此已分配的对象可以安全地比分配它的线程活得更久。
+     *
+     * 分配得到的对象与ObjectPool完全兼容，可以使用ObjectPool::Free、ObjectPool::Deleter释放，
+     * ObjectPool::GetPoolFromPointer返回的是分配该对象的线程缓存。
+     *
+     * 注意：对象池析构时，所有线程都不能再持有其分配的对象。
+     */
+    class ConcurrentObjectPool :
+        public NonCopyable
+    {
+    public:
+        using AllocContext = ObjectPool::AllocContext;
+        using MemLeakReportCallback = ObjectPool::MemLeakReportCallback;
+
+        template <typename T>
+        using Deleter = ObjectPool::Deleter<T>;
+
+    public:
+        /**
+         * @brief 构造多线程对象池
+         * @param slabMode 线程缓存是否启用Slab模式，参见ObjectPool
+         */
+        explicit ConcurrentObjectPool(bool slabMode=false);
+        ~ConcurrentObjectPool();
+
+    public:
+        /**
+         * @brief 获取已创建的线程缓存个数
+         */
+        size_t GetThreadCacheCount()const noexcept;
+
+        /**
+         * @brief 获取所有线程缓存合并后的统计信息快照
+         *
+         * 计数器在各个线程中并发更新，快照中的各项不是在同一时刻读取的，彼此之间可能存在微小的出入。
+         * 峰值为各个线程缓存峰值之和。
+         */
+        ObjectPool::Statistics GetStatistics()const;
+
+        /**
+         * @brief 设置内存泄漏报告对象
+         * @param cb 回调
+         *
+         * 回调会在对象池析构、检查各个线程缓存时被调用。
+         */
+        void SetLeakReporter(const MemLeakReportCallback& cb);
+
+        /**
+         * @brief 从当前线程的缓存中回收空闲对象
+         * @param factor 系数，不小于1
+         * @param maxFree 最大回收数量，0表示不限制
+         * @return 回收掉的内存量（字节）
+         *
+         * 参见ObjectPool::CollectGarbage。
+         */
+        size_t CollectGarbage(unsigned factor=1, size_t maxFree=0);
+
+        /**
+         * @brief 分配内存
+         * @param sz 大小
+         * @param context 上下文，用于调试。仅调试版本有效。
+         * @return 指针
+         */
+#ifndef NDEBUG
+        std::unique_ptr<void, Deleter<void>> Alloc(size_t sz, const AllocContext& context=EmptyRefOf<AllocContext>())
+        {
+            return GetThreadCache()->Alloc(sz, context);
+        }
+#else
+        std::unique_ptr<void, Deleter<void>> Alloc(size_t sz)
+        {
+            return GetThreadCache()->Alloc(sz);
+        }
+#endif
+
+        /**
+         * @brief 批量分配内存
+         * @param sz 单个对象的大小
+         * @param[out] out 输出的指针数组，至少容纳count个元素
+         * @param count 个数
+         * @param context 上下文，用于调试。仅调试版本有效。
+         *
+         * 参见ObjectPool::AllocBatch。
+         */
+#ifndef NDEBUG
+        void AllocBatch(size_t sz, void** out, size_t count, const AllocContext& context=EmptyRefOf<AllocContext>())
+        {
+            GetThreadCache()->AllocBatch(sz, out, count, context);
+        }
+#else
+        void AllocBatch(size_t sz, void** out, size_t count)
+        {
+            GetThreadCache()->AllocBatch(sz, out, count);
+        }
+#endif
+
+        /**
+         * @brief 重新分配内存
+         * @param p 指针，可以由任意线程分配
+         * @param sz 大小
+         * @param context 上下文，用于调试。仅调试版本有效。
+         * @return 指针，即p
+         *
+         * 若p由其他线程分配，则总是在当前线程重新分配并拷贝数据。
+         */
+#ifndef NDEBUG
+        std::unique_ptr<void, Deleter<void>>& Realloc(std::unique_ptr<void, Deleter<void>>& p, size_t sz,
+            const AllocContext& context=EmptyRefOf<AllocContext>());
+#else
+        std::unique_ptr<void, Deleter<void>>& Realloc(std::unique_ptr<void, Deleter<void>>& p, size_t sz);
+#endif
+
+    private:
+        ObjectPool* GetThreadCache();
+
+    private:
+        std::shared_ptr<details::ConcurrentObjectPoolState> m_pState;
+    };
 }
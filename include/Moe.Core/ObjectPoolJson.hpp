@@ -0,0 +1,20 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#pragma once
+#include "Json.hpp"
+#include "ObjectPool.hpp"
+
+namespace moe
+{
+    /**
+     * @brief 将对象池统计信息输出到JSON
+     * @param[out] out 输出的JSON对象
+     * @param stat 统计信息，来自ObjectPool::GetStatistics或ConcurrentObjectPool::GetStatistics
+     * @return 即out
+     *
+     * 独立于ObjectPool实现，使对象池本身不依赖Json。
+     */
+    JsonValue& ToJson(JsonValue& out, const ObjectPool::Statistics& stat);
+}
@@ -248,6 +248,92 @@ namespace moe
             bool m_bAutoFree = false;
         };
 
+        /**
+         * @brief 内存映射文件
+         *
+         * 以读写方式映射整个文件。写入映射区的数据由操作系统负责回写，即便进程崩溃也会保留在文件中。
+         */
+        class MappedFile :
+            public NonCopyable
+        {
+        public:
+            MappedFile()noexcept;
+
+            /**
+             * @brief 映射文件
+             * @param path 文件路径
+             * @param sz 文件大小，为0时映射已有文件的全部内容（文件必须存在且非空），否则文件不存在时会被创建，
+             *           大小不一致时会被调整为sz
+             * @param readOnly 是否只读映射
+             */
+            MappedFile(const char* path, size_t sz=0, bool readOnly=false);
+
+            MappedFile(MappedFile&& org)noexcept;
+            ~MappedFile();
+
+            operator bool()const noexcept { return m_pData != nullptr; }
+            MappedFile& operator=(MappedFile&& rhs)noexcept;
+
+        public:
+            /**
+             * @brief 获取映射的大小
+             */
+            size_t GetSize()const noexcept { return m_uSize; }
+
+            /**
+             * @brief 获取映射的内存地址
+             */
+            const void* GetPointer()const noexcept { return m_pData; }
+            void* GetPointer()noexcept { return m_pData; }
+
+            /**
+             * @brief 是否只读
+             */
+            bool IsReadOnly()const noexcept { return m_bReadOnly; }
+
+            /**
+             * @brief 将映射区的修改写回文件
+             * @param wait 是否等待写回完成
+             */
+            void Sync(bool wait=true)noexcept;
+
+            /**
+             * @brief 解除映射并关闭文件
+             */
+            void Close()noexcept;
+
+        private:
+#ifdef MOE_WINDOWS
+            void* m_hFile = nullptr;
+            void* m_hMapping = nullptr;
+#else
+            int m_iFd = -1;
+#endif
+
+            size_t m_uSize = 0;
+            void* m_pData = nullptr;
+            bool m_bReadOnly = false;
+        };
+
+        //////////////////////////////////////// </editor-fold>
+        //////////////////////////////////////// <editor-fold desc="内存">
+
+        /**
+         * @brief 从系统直接分配内存页
+         * @param sz 大小，必须是2的幂，且不小于64K
+         * @return 按sz对齐的内存地址，失败返回nullptr
+         *
+         * 分配的内存需要使用FreeAlignedPages释放，释放后内存会立即归还给系统。
+         */
+        void* AllocAlignedPages(size_t sz)noexcept;
+
+        /**
+         * @brief 释放由AllocAlignedPages分配的内存页
+         * @param p 内存地址
+         * @param sz 大小，必须与分配时一致
+         */
+        void FreeAlignedPages(void* p, size_t sz)noexcept;
+
         //////////////////////////////////////// </editor-fold>
         //////////////////////////////////////// <editor-fold desc="多线程相关">
 
@@ -348,6 +434,68 @@ namespace moe
         uint64_t GetFileSize(FILE* f);
         uint64_t GetFileSize(const char* path);
 
+        /**
+         * @brief 设置文件的读写位置
+         * @exception ApiException 当发生平台相关错误时抛出
+         * @param f 文件描述符
+         * @param offset 偏移
+         * @param whence SEEK_SET/SEEK_CUR/SEEK_END
+         *
+         * 基于fseeko64（Windows下为_fseeki64）实现，支持超过2GB的偏移。
+         */
+        void SeekFile(FILE* f, int64_t offset, int whence);
+
+        /**
+         * @brief 获取文件的读写位置
+         * @exception ApiException 当发生平台相关错误时抛出
+         * @param f 文件描述符
+         * @return 当前位置（字节）
+         *
+         * 基于ftello64（Windows下为_ftelli64）实现，支持超过2GB的偏移。
+         */
+        uint64_t TellFile(FILE* f);
+
+        /**
+         * @brief 从指定偏移读取文件
+         * @exception ApiException 当发生平台相关错误时抛出
+         * @param f 文件描述符
+         * @param offset 偏移
+         * @param buffer 缓冲区
+         * @param size 读取大小
+         * @return 实际读取的字节数，小于size时表示到达文件末尾
+         *
+         * 基于pread（Windows下为带OVERLAPPED的ReadFile）实现，直接访问底层文件，绕过FILE的缓冲区。
+         * POSIX下不改变文件的读写位置，可以在多个线程上并发调用。
+         */
+        size_t ReadFileAt(FILE* f, uint64_t offset, void* buffer, size_t size);
+
+        /**
+         * @brief 向指定偏移写入文件
+         * @exception ApiException 当发生平台相关错误时抛出
+         * @param f 文件描述符
+         * @param offset 偏移
+         * @param buffer 数据
+         * @param size 写入大小
+         *
+         * 基于pwrite（Windows下为带OVERLAPPED的WriteFile）实现，语义同ReadFileAt。
+         */
+        void WriteFileAt(FILE* f, uint64_t offset, const void* buffer, size_t size);
+
+        /**
+         * @brief 在文件之间复制数据
+         * @exception ApiException 当发生平台相关错误时抛出
+         * @param dest 目标文件
+         * @param destOffset 目标文件中的偏移
+         * @param src 源文件
+         * @param srcOffset 源文件中的偏移
+         * @param count 最多复制的字节数
+         * @return 实际复制的字节数，小于count时表示源文件到达末尾
+         *
+         * Linux下依次尝试copy_file_range和sendfile，由内核直接完成复制；其他平台或内核不支持时退化为pread/pwrite。
+         * 该方法绕过FILE的缓冲区，调用后文件的读写位置是未定义的，调用方需要自行Flush和Seek。
+         */
+        size_t CopyFileData(FILE* dest, uint64_t destOffset, FILE* src, uint64_t srcOffset, size_t count);
+
         //////////////////////////////////////// </editor-fold>
     }
 }
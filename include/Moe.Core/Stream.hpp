@@ -3,12 +3,15 @@
  * @date 2017/7/14
  */
 #pragma once
+#include <cstdio>
+#include <cstring>
 #include <vector>
 #include <algorithm>
 
 #include "RefPtr.hpp"
 #include "Optional.hpp"
 #include "ArrayView.hpp"
+#include "Pal.hpp"
 
 namespace moe
 {
@@ -151,29 +154,72 @@ namespace moe
          */
         virtual void Write(BytesView view, size_t count) = 0;
 
+        /**
+         * @brief 分散读取
+         * @param buffers 缓冲区列表，按顺序依次填满
+         * @return 读取的总字节数，小于缓冲区总大小时表示到达流末尾
+         *
+         * 默认实现依次调用Read。
+         */
+        virtual size_t ReadV(ArrayView<MutableBytesView> buffers);
+
+        /**
+         * @brief 聚集写入
+         * @param buffers 数据列表，按顺序写入
+         *
+         * 默认实现依次调用Write，派生类可以一次性完成写入（例如文件流使用writev），从而免去拼接多段数据的拷贝。
+         */
+        virtual void WriteV(ArrayView<BytesView> buffers);
+
+        /**
+         * @brief 获取可以直接读取的连续缓冲区
+         * @return 从当前位置开始可以直接读取的数据，不支持时返回空
+         *
+         * 配合AdvanceRead使用，供BinaryReader等按字读取的场合直接访问底层缓冲区，避免逐字节的虚函数调用。
+         * 返回的缓冲区在下一次调用流的其他方法前有效。
+         */
+        virtual BytesView GetReadWindow();
+
+        /**
+         * @brief 在读取窗口内推进读写位置
+         * @param count 数量，不得超过GetReadWindow返回的大小
+         */
+        virtual void AdvanceRead(size_t count);
+
+        /**
+         * @brief 获取可以直接写入的连续缓冲区
+         * @return 从当前位置开始可以直接写入的空间，不支持时返回空
+         *
+         * 配合AdvanceWrite使用，返回的缓冲区在下一次调用流的其他方法前有效。
+         */
+        virtual MutableBytesView GetWriteWindow();
+
+        /**
+         * @brief 提交写入窗口中的数据并推进读写位置
+         * @param count 数量，不得超过GetWriteWindow返回的大小
+         */
+        virtual void AdvanceWrite(size_t count);
+
+        /**
+         * @brief 获取底层的文件句柄
+         * @return 文件句柄，不是文件流时返回nullptr
+         *
+         * CopyTo在两端都是文件时借助该句柄在内核中直接复制数据。
+         */
+        virtual FILE* GetFileHandle()const noexcept;
+
         /**
          * @brief 将流从当前位置全部复制到另一个流中
          * @param other 目标流
          * @return 复制数量
+         *
+         * 两端都是文件时由Pal::CopyFileData完成复制；
+         * 一端提供读写窗口（如内存流）时直接在窗口上进行单次拷贝；
+         * 否则经由线程局部的缓冲区中转。
          */
         size_t CopyTo(Stream* other)
         {
-            assert(other);
-
-            uint8_t buffer[256];
-            MutableBytesView view(buffer, sizeof(buffer));
-
-            size_t readCount = 0;
-            size_t totalCount = 0;
-            do
-            {
-                readCount = Read(view, view.GetSize());
-                if (readCount > 0)
-                    other->Write(view, readCount);
-                totalCount += readCount;
-            } while (readCount > 0);
-
-            return totalCount;
+            return CopyTo(other, static_cast<size_t>(-1));
         }
 
         /**
@@ -182,26 +228,7 @@ namespace moe
          * @param count 复制数量
          * @return 复制数量
          */
-        size_t CopyTo(Stream* other, size_t count)
-        {
-            assert(other);
-
-            uint8_t buffer[256];
-            MutableBytesView view(buffer, sizeof(buffer));
-
-            size_t readCount = 0;
-            size_t totalCount = 0;
-            do
-            {
-                readCount = Read(view, std::min(sizeof(buffer), count));
-                if (readCount > 0)
-                    other->Write(view, readCount);
-                totalCount += readCount;
-                count -= readCount;
-            } while (readCount > 0);
-
-            return totalCount;
-        }
+        size_t CopyTo(Stream* other, size_t count);
     };
 
     /**
@@ -227,6 +254,12 @@ namespace moe
         void SetLength(size_t length);
         void WriteByte(uint8_t b);
         void Write(BytesView view, size_t count);
+        size_t ReadV(ArrayView<MutableBytesView> buffers);
+        void WriteV(ArrayView<BytesView> buffers);
+        BytesView GetReadWindow();
+        void AdvanceRead(size_t count);
+        MutableBytesView GetWriteWindow();
+        void AdvanceWrite(size_t count);
 
     private:
         size_t m_uPosition = 0;
@@ -256,16 +289,264 @@ namespace moe
         void SetLength(size_t length);
         void WriteByte(uint8_t b);
         void Write(BytesView view, size_t count);
+        size_t ReadV(ArrayView<MutableBytesView> buffers);
+        void WriteV(ArrayView<BytesView> buffers);
+        BytesView GetReadWindow();
+        void AdvanceRead(size_t count);
 
     private:
         size_t m_uPosition = 0;
         std::vector<uint8_t>& m_stVec;
     };
 
+    /**
+     * @brief 文件流
+     *
+     * 基于C标准库FILE的流实现。
+     * 除顺序读写外，ReadAt/WriteAt提供基于pread/pwrite的定位读写，不改变流的当前位置。
+     */
+    class FileStream :
+        public Stream
+    {
+    public:
+        /**
+         * @brief 打开文件
+         * @exception ApiException 打开失败时抛出
+         * @param path 路径
+         * @param mode 打开模式，同fopen
+         */
+        FileStream(const char* path, const char* mode="rb");
+        ~FileStream();
+
+    public:
+        bool IsReadable()const noexcept;
+        bool IsWriteable()const noexcept;
+        bool IsSeekable()const noexcept;
+        size_t GetLength()const;
+        size_t GetPosition()const;
+        void Flush();
+        int ReadByte();
+        size_t Read(MutableBytesView out, size_t count);
+        size_t Seek(int64_t offset, StreamSeekOrigin origin);
+        void SetLength(size_t length);
+        void WriteByte(uint8_t b);
+        void Write(BytesView view, size_t count);
+        void WriteV(ArrayView<BytesView> buffers);
+        FILE* GetFileHandle()const noexcept;
+
+        /**
+         * @brief 从指定位置读取
+         * @exception ApiException 读取失败时抛出
+         * @param offset 文件中的偏移
+         * @param out 输出缓冲区
+         * @param count 数量
+         * @return 实际读取的数量，小于count时表示到达文件末尾
+         *
+         * 不经过FILE的缓冲区，也不改变流的当前位置。若流可写，会先写出FILE中缓冲的数据。
+         */
+        size_t ReadAt(uint64_t offset, MutableBytesView out, size_t count);
+
+        /**
+         * @brief 向指定位置写入
+         * @exception ApiException 写入失败时抛出
+         * @param offset 文件中的偏移
+         * @param view 数据
+         * @param count 数量
+         *
+         * 不经过FILE的缓冲区，也不改变流的当前位置。以追加模式打开的文件在POSIX下总是写到末尾。
+         */
+        void WriteAt(uint64_t offset, BytesView view, size_t count);
+
+    private:
+        FILE* m_pFile = nullptr;
+        bool m_bReadable = false;
+        bool m_bWriteable = false;
+    };
+
+    /**
+     * @brief 内存映射文件流
+     *
+     * 以只读方式映射整个文件，读取直接访问映射区，GetView可以零拷贝地获取文件全部内容，
+     * 从而将大文件直接交给TextReader、Json5::Parse或Mdr::Reader处理，而无需先读入内存。
+     */
+    class MmapStream :
+        public Stream
+    {
+    public:
+        /**
+         * @brief 映射文件
+         * @exception ApiException 打开或映射失败时抛出
+         * @param path 路径
+         */
+        MmapStream(const char* path);
+
+    public:
+        /**
+         * @brief 获取文件的全部内容
+         *
+         * 返回的视图在流析构前有效。
+         */
+        BytesView GetView()const noexcept { return m_stView; }
+
+        bool IsReadable()const noexcept;
+        bool IsWriteable()const noexcept;
+        bool IsSeekable()const noexcept;
+        size_t GetLength()const;
+        size_t GetPosition()const;
+        void Flush();
+        int ReadByte();
+        size_t Read(MutableBytesView out, size_t count);
+        size_t Seek(int64_t offset, StreamSeekOrigin origin);
+        void SetLength(size_t length);
+        void WriteByte(uint8_t b);
+        void Write(BytesView view, size_t count);
+        BytesView GetReadWindow();
+        void AdvanceRead(size_t count);
+
+    private:
+        Pal::MappedFile m_stFile;
+        BytesView m_stView;
+        BytesViewStream m_stStream;
+    };
+
+    /**
+     * @brief 带缓冲的流包装器
+     *
+     * 在底层流之上维护一块读写缓冲区，ReadByte/WriteByte等小粒度操作在缓冲区内完成，只在缓冲区耗尽或写满时访问底层流。
+     * 同时提供读写窗口，BinaryReader/BinaryWriter及Mdr可以直接按字读写缓冲区。
+     *
+     * 注意到：
+     *  - 包装器不会持有底层流对象；
+     *  - 缓冲的写入在Flush、Seek、切换为读取或析构时写出；
+     *  - 读写交替时底层流需要支持Seek，以便退回预读的数据。
+     */
+    class BufferedStream final :
+        public Stream
+    {
+    public:
+        static const size_t kDefaultBufferSize = 4096;
+
+    public:
+        BufferedStream(Stream* stream, size_t bufferSize=kDefaultBufferSize);
+        ~BufferedStream();
+
+    public:
+        /**
+         * @brief 获取底层流
+         */
+        Stream* GetStream()const noexcept { return m_pStream; }
+
+        bool IsReadable()const noexcept;
+        bool IsWriteable()const noexcept;
+        bool IsSeekable()const noexcept;
+        size_t GetLength()const;
+        size_t GetPosition()const;
+        void Flush();
+
+        int ReadByte()
+        {
+            if (m_uReadPosition < m_uReadEnd)
+                return m_stBuffer[m_uReadPosition++];
+            return ReadByteSlow();
+        }
+
+        size_t Read(MutableBytesView out, size_t count);
+        size_t Seek(int64_t offset, StreamSeekOrigin origin);
+        void SetLength(size_t length);
+
+        void WriteByte(uint8_t b)
+        {
+            if (m_uReadEnd == 0 && m_uWriteEnd < m_stBuffer.size())
+                m_stBuffer[m_uWriteEnd++] = b;
+            else
+                WriteByteSlow(b);
+        }
+
+        void Write(BytesView view, size_t count);
+        void WriteV(ArrayView<BytesView> buffers);
+
+        BytesView GetReadWindow()
+        {
+            if (m_uReadPosition == m_uReadEnd)
+                FillReadBuffer();
+            return BytesView(m_stBuffer.data() + m_uReadPosition, m_uReadEnd - m_uReadPosition);
+        }
+
+        void AdvanceRead(size_t count)
+        {
+            assert(m_uReadPosition + count <= m_uReadEnd);
+            m_uReadPosition += count;
+        }
+
+        MutableBytesView GetWriteWindow()
+        {
+            if (m_uReadEnd != 0 || m_uWriteEnd == m_stBuffer.size())
+                PrepareWrite();
+            return MutableBytesView(m_stBuffer.data() + m_uWriteEnd, m_stBuffer.size() - m_uWriteEnd);
+        }
+
+        void AdvanceWrite(size_t count)
+        {
+            assert(m_uReadEnd == 0 && m_uWriteEnd + count <= m_stBuffer.size());
+            m_uWriteEnd += count;
+        }
+
+    private:
+        int ReadByteSlow();
+        void WriteByteSlow(uint8_t b);
+        void FillReadBuffer();
+        void DiscardReadBuffer();
+        void FlushWriteBuffer();
+        void PrepareWrite();
+
+    private:
+        Stream* m_pStream = nullptr;
+        std::vector<uint8_t> m_stBuffer;
+        size_t m_uReadPosition = 0;  // 读缓冲区中的当前位置
+        size_t m_uReadEnd = 0;  // 读缓冲区中有效数据的末尾，非0表示处于读模式
+        size_t m_uWriteEnd = 0;  // 写缓冲区中待写出数据的末尾，非0表示处于写模式
+    };
+
+    namespace details
+    {
+        template <typename T>
+        inline T LoadLE(const uint8_t* p)noexcept
+        {
+            T ret = 0;
+            for (size_t i = 0; i < sizeof(T); ++i)
+                ret |= static_cast<T>(static_cast<T>(p[i]) << (8 * i));
+            return ret;
+        }
+
+        template <typename T>
+        inline T LoadBE(const uint8_t* p)noexcept
+        {
+            T ret = 0;
+            for (size_t i = 0; i < sizeof(T); ++i)
+                ret |= static_cast<T>(static_cast<T>(p[i]) << (8 * (sizeof(T) - 1 - i)));
+            return ret;
+        }
+
+        template <typename T>
+        inline void StoreLE(uint8_t* p, T value)noexcept
+        {
+            for (size_t i = 0; i < sizeof(T); ++i)
+                p[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+        }
+
+        template <typename T>
+        inline void StoreBE(uint8_t* p, T value)noexcept
+        {
+            for (size_t i = 0; i < sizeof(T); ++i)
+                p[i] = static_cast<uint8_t>((value >> (8 * (sizeof(T) - 1 - i))) & 0xFF);
+        }
+    }
+
     /**
      * @brief 二进制读取器
      *
      * 封装了流上的一系列二进制转换操作。
+     * 流提供读取窗口时（例如BytesViewStream、BufferedStream）整字直接从窗口中读取，否则退化为一次Read调用。
      * 注意到读取器不会持有Stream对象。
      */
     template <typename T = Stream>
@@ -287,98 +568,47 @@ namespace moe
             return static_cast<uint8_t>(b);
         }
 
-        uint16_t ReadUInt16LE()
-        {
-            auto a = ReadUInt8();
-            auto b = ReadUInt8();
-            return a | (b << 8);
-        }
-
-        uint32_t ReadUInt32LE()
-        {
-            auto a = ReadUInt8();
-            auto b = ReadUInt8();
-            auto c = ReadUInt8();
-            auto d = ReadUInt8();
-            return a | (b << 8) | (c << 16) | (d << 24);
-        }
-
-        uint64_t ReadUInt64LE()
-        {
-            uint64_t a = ReadUInt8();
-            uint64_t b = ReadUInt8();
-            uint64_t c = ReadUInt8();
-            uint64_t d = ReadUInt8();
-            uint64_t e = ReadUInt8();
-            uint64_t f = ReadUInt8();
-
-            uint64_t g = ReadUInt8();
-            uint64_t h = ReadUInt8();
-            return a | (b << 8) | (c << 16) | (d << 24) | (e << 32) | (f << 40) | (g << 48) | (h << 56);
-        }
+        uint16_t ReadUInt16LE() { return ReadInteger<uint16_t, false>(); }
+        uint32_t ReadUInt32LE() { return ReadInteger<uint32_t, false>(); }
+        uint64_t ReadUInt64LE() { return ReadInteger<uint64_t, false>(); }
 
         char ReadInt8()
         {
-            return reinterpret_cast<char>(ReadUInt8());
+            return static_cast<char>(ReadUInt8());
         }
 
         int16_t ReadInt16LE()
         {
-            return reinterpret_cast<int16_t>(ReadUInt16LE());
+            return static_cast<int16_t>(ReadUInt16LE());
         }
 
         int32_t ReadInt32LE()
         {
-            return reinterpret_cast<int32_t>(ReadUInt32LE());
+            return static_cast<int32_t>(ReadUInt32LE());
         }
 
         int64_t ReadInt64LE()
         {
-            return reinterpret_cast<int64_t>(ReadUInt64LE());
+            return static_cast<int64_t>(ReadUInt64LE());
         }
 
-        uint16_t ReadUInt16BE()
-        {
-            auto b = ReadUInt8();
-            auto a = ReadUInt8();
-            return a | (b << 8);
-        }
-
-        uint32_t ReadUInt32BE()
-        {
-            auto d = ReadUInt8();
-            auto c = ReadUInt8();
-            auto b = ReadUInt8();
-            auto a = ReadUInt8();
-            return a | (b << 8) | (c << 16) | (d << 24);
-        }
-
-        uint64_t ReadUInt64BE()
-        {
-            uint64_t h = ReadUInt8();
-            uint64_t g = ReadUInt8();
-            uint64_t f = ReadUInt8();
-            uint64_t e = ReadUInt8();
-            uint64_t d = ReadUInt8();
-            uint64_t c = ReadUInt8();
-            uint64_t b = ReadUInt8();
-            uint64_t a = ReadUInt8();
-            return a | (b << 8) | (c << 16) | (d << 24) | (e << 32) | (f << 40) | (g << 48) | (h << 56);
-        }
+        uint16_t ReadUInt16BE() { return ReadInteger<uint16_t, true>(); }
+        uint32_t ReadUInt32BE() { return ReadInteger<uint32_t, true>(); }
+        uint64_t ReadUInt64BE() { return ReadInteger<uint64_t, true>(); }
 
         int16_t ReadInt16BE()
         {
-            return reinterpret_cast<int16_t>(ReadUInt16LE());
+            return static_cast<int16_t>(ReadUInt16BE());
         }
 
         int32_t ReadInt32BE()
         {
-            return reinterpret_cast<int32_t>(ReadUInt32LE());
+            return static_cast<int32_t>(ReadUInt32BE());
         }
 
         int64_t ReadInt64BE()
         {
-            return reinterpret_cast<int64_t>(ReadUInt64LE());
+            return static_cast<int64_t>(ReadUInt64BE());
         }
 
         std::string ReadString(size_t length)
@@ -387,7 +617,7 @@ namespace moe
             ret.resize(length, '\0');
 
             MutableBytesView view(const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(ret.data())), ret.length());
-            auto count = m_pStream->ReadBytes(view, ret.length());
+            auto count = m_pStream->Read(view, ret.length());
             if (count < length)
                 MOE_THROW(OutOfRangeException, "Expect {0}, but read {1}", length, count);
 
@@ -395,6 +625,26 @@ namespace moe
             return ret;
         }
 
+    private:
+        template <typename TInt, bool BigEndian>
+        TInt ReadInteger()
+        {
+            auto window = m_pStream->GetReadWindow();
+            if (window.GetSize() >= sizeof(TInt))
+            {
+                auto ret = BigEndian ? details::LoadBE<TInt>(window.GetBuffer()) :
+                    details::LoadLE<TInt>(window.GetBuffer());
+                m_pStream->AdvanceRead(sizeof(TInt));
+                return ret;
+            }
+
+            uint8_t buffer[sizeof(TInt)];
+            auto count = m_pStream->Read(MutableBytesView(buffer, sizeof(buffer)), sizeof(buffer));
+            if (count < sizeof(buffer))
+                MOE_THROW(OutOfRangeException, "Expect {0}, but read {1}", sizeof(buffer), count);
+            return BigEndian ? details::LoadBE<TInt>(buffer) : details::LoadLE<TInt>(buffer);
+        }
+
     private:
         T* m_pStream;
     };
@@ -403,6 +653,7 @@ namespace moe
      * @brief 二进制写入器
      *
      * 封装了流上的一系列二进制转换操作。
+     * 流提供写入窗口时（例如BytesViewStream、BufferedStream）整字直接写入窗口，否则退化为一次Write调用。
      * 注意到写入器不会持有Stream对象。
      */
     template <typename T = Stream>
@@ -421,31 +672,9 @@ namespace moe
             m_pStream->WriteByte(b);
         }
 
-        void WriteUInt16LE(uint16_t value)
-        {
-            m_pStream->WriteByte(value & 0xFF);
-            m_pStream->WriteByte((value >> 8) & 0xFF);
-        }
-
-        void WriteUInt32LE(uint32_t value)
-        {
-            m_pStream->WriteByte(value & 0xFF);
-            m_pStream->WriteByte((value >> 8) & 0xFF);
-            m_pStream->WriteByte((value >> 16) & 0xFF);
-            m_pStream->WriteByte((value >> 24) & 0xFF);
-        }
-
-        void WriteUInt64LE(uint64_t value)
-        {
-            m_pStream->WriteByte(value & 0xFF);
-            m_pStream->WriteByte((value >> 8) & 0xFF);
-            m_pStream->WriteByte((value >> 16) & 0xFF);
-            m_pStream->WriteByte((value >> 24) & 0xFF);
-            m_pStream->WriteByte((value >> 32) & 0xFF);
-            m_pStream->WriteByte((value >> 40) & 0xFF);
-            m_pStream->WriteByte((value >> 48) & 0xFF);
-            m_pStream->WriteByte((value >> 56) & 0xFF);
-        }
+        void WriteUInt16LE(uint16_t value) { WriteInteger<uint16_t, false>(value); }
+        void WriteUInt32LE(uint32_t value) { WriteInteger<uint32_t, false>(value); }
+        void WriteUInt64LE(uint64_t value) { WriteInteger<uint64_t, false>(value); }
 
         void WriteInt8(char value)
         {
@@ -467,31 +696,9 @@ namespace moe
             WriteUInt64LE(static_cast<uint64_t>(value));
         }
 
-        void WriteUInt16BE(uint16_t value)
-        {
-            m_pStream->WriteByte((value >> 8) & 0xFF);
-            m_pStream->WriteByte(value & 0xFF);
-        }
-
-        void WriteUInt32BE(uint32_t value)
-        {
-            m_pStream->WriteByte((value >> 24) & 0xFF);
-            m_pStream->WriteByte((value >> 16) & 0xFF);
-            m_pStream->WriteByte((value >> 8) & 0xFF);
-            m_pStream->WriteByte(value & 0xFF);
-        }
-
-        void WriteUInt64BE(uint64_t value)
-        {
-            m_pStream->WriteByte((value >> 56) & 0xFF);
-            m_pStream->WriteByte((value >> 48) & 0xFF);
-            m_pStream->WriteByte((value >> 40) & 0xFF);
-            m_pStream->WriteByte((value >> 32) & 0xFF);
-            m_pStream->WriteByte((value >> 24) & 0xFF);
-            m_pStream->WriteByte((value >> 16) & 0xFF);
-            m_pStream->WriteByte((value >> 8) & 0xFF);
-            m_pStream->WriteByte(value & 0xFF);
-        }
+        void WriteUInt16BE(uint16_t value) { WriteInteger<uint16_t, true>(value); }
+        void WriteUInt32BE(uint32_t value) { WriteInteger<uint32_t, true>(value); }
+        void WriteUInt64BE(uint64_t value) { WriteInteger<uint64_t, true>(value); }
 
         void WriteInt16BE(int16_t value)
         {
@@ -508,6 +715,29 @@ namespace moe
             WriteUInt64BE(static_cast<uint64_t>(value));
         }
 
+    private:
+        template <typename TInt, bool BigEndian>
+        void WriteInteger(TInt value)
+        {
+            auto window = m_pStream->GetWriteWindow();
+            if (window.GetSize() >= sizeof(TInt))
+            {
+                if (BigEndian)
+                    details::StoreBE<TInt>(window.GetBuffer(), value);
+                else
+                    details::StoreLE<TInt>(window.GetBuffer(), value);
+                m_pStream->AdvanceWrite(sizeof(TInt));
+                return;
+            }
+
+            uint8_t buffer[sizeof(TInt)];
+            if (BigEndian)
+                details::StoreBE<TInt>(buffer, value);
+            else
+                details::StoreLE<TInt>(buffer, value);
+            m_pStream->Write(BytesView(buffer, sizeof(buffer)), sizeof(buffer));
+        }
+
     private:
         T* m_pStream;
     };
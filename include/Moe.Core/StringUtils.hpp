@@ -1597,275 +1597,297 @@ namespace moe
             using ToStringFormatterSelector = ToStringFormatterSelectBoolOrNot<TChar, T>;
         }
 
-        /**
-         * @brief 字符串格式化
-         * @tparam TChar 字符类型
-         * @tparam Args 参数类型
-         * @param[out] out 输出结果
-         * @param format 格式化文本
-         * @param args 参数列表
-         * @see https://github.com/dotnet/coreclr/blob/master/src/mscorlib/shared/System/Text/StringBuilder.cs
-         *
-         * 格式化字符串格式（扩展但不完全兼容C#语法）：
-         *   Hole := '{' Indexer ws* (',' ws* PaddingCount ('[' PaddingCharacter ']')? ws* )? (':' ws* Format )? ws* '}'
-         *   Indexer := [0-9]+
-         *   PaddingCount := '-'? [0-9]+
-         *   PaddingCharacter := .  // PaddingCharacter为扩展语法
-         *   Format := [^} ]  // C#允许在Format中对'{'和'}'进行转义，这个语法被去除了
-         *   ws := ' '
-         *
-         * 正文中，连续的"{{"会被转换为"{"，连续的"}}"同理。
-         * 注意到该实现不会抛出异常（但用户自定义ToString函数可以抛出异常），如果格式字符串出现任何问题会原封不同拷贝到结果中。
-         * 这也意味着正文中出现的独立'}'不会被当成未配对括号抛出异常（而被直接拷贝到结果中）。
-         *
-         * 支持的格式化语法如下：
-         *   - 布尔类型：
-         *     - 默认：true/false
-         *     - .* '|' .*：用户定义的假值和真值
-         *   - 整数类型：
-         *     - 默认：以十进制转换到字符串
-         *     - D: 以十进制转换到字符串（同默认）
-         *     - H：以大写十六进制转换到字符串（有符号数会被转换到对应的无符号整形表示）
-         *     - h：以小写十六进制转换到字符串（有符号数会被转换到对应的无符号整形表示）
-         *   - 浮点类型：
-         *     - 默认：以浮点数的最短表示进行输出
-         *     - S：以浮点数的最短表示进行输出（同默认）
-         *     - E：以科学计数法表示，尽可能保留足够多的小数
-         *     - E[0-9]+：以科学计数法表示，后接需要的小数位数 [0, 20]
-         *     - P[0-9]+: 以有效数字表达，后接需要的有效数字位数 [1, 21]
-         *     - F[0-9]+：以定点小数表达，后接需要的定点小数位数 [0, 20]
-         *   - const TChar* 或者 const TChar[] / std::basic_string<TChar>：
-         *     - 默认：直接拷贝
-         *   - 其他指针：
-         *     - 默认：以十六进制展示（0x??...）
-         *   - nullptr_t：
-         *     - 默认：以null展示
-         *   - 用户自定义类型：
-         *     - 默认：调用 ToString(const ArrayView<TChar>&)，若不可用，调用 ToString()
-         */
-        template <typename TChar = char, typename... Args>
-        void Format(std::basic_string<TChar>& out, const ArrayView<TChar>& format, const Args&... args)
+        namespace details
         {
-            static const unsigned kIndexLimit = 1000000u;
-            static const unsigned kWidthLimit = 1000000u;
+            /**
+             * @brief 使用类型擦除后的参数进行格式化
+             * @tparam TChar 字符类型
+             * @param[out] out 输出结果
+             * @param format 格式化文本
+             * @param objects 参数对象地址
+             * @param formatters 参数对应的格式化函数
+             * @param count 参数个数
+             *
+             * 格式化语法参见Format函数。
+             */
+            template <typename TChar>
+            void FormatArguments(std::basic_string<TChar>& out, const ArrayView<TChar>& format,
+                const void* const* objects, const ToStringFormatter<TChar>* formatters, size_t count)
+            {
+                static const unsigned kIndexLimit = 1000000u;
+                static const unsigned kWidthLimit = 1000000u;
 
-            out.clear();
-            out.reserve(format.GetSize());
+                out.clear();
+                out.reserve(format.GetSize());
 
-            TChar ch = '\0';
-            size_t pos = 0;
-            size_t len = format.GetSize();
-            const void* objects[] = { static_cast<const void*>(&args)..., nullptr };  // FIX: MSVC不能分配大小为0的数组
-            details::ToStringFormatter<TChar> formatters[] = {
-                details::ToStringFormatterSelector<TChar, Args>::AppendToString..., nullptr
-            };
-            static_assert(std::extent<decltype(objects)>::value == std::extent<decltype(formatters)>::value,
-                "Unexpected condition");
+                TChar ch = '\0';
+                size_t pos = 0;
+                size_t len = format.GetSize();
 
-            while (true)
-            {
-                // 不断读取并寻找 '{'
-                while (pos < len)
+                while (true)
                 {
-                    ch = format[pos++];
-
-                    if (ch == '}')
-                    {
-                        // 将连续的 '}}' 转义成 '}'
-                        // 单个情况下在C#中属于错误配对异常，在这直接做容错处理，不管。
-                        if (pos < len && format[pos] == '}')
-                            ++pos;
-                    }
-                    else if (ch == '{')
+                    // 不断读取并寻找 '{'
+                    while (pos < len)
                     {
-                        // 将连续的 '{{' 转义成 '{'
-                        if (pos < len && format[pos] == '{')
-                            ++pos;
-                        else
+                        ch = format[pos++];
+
+                        if (ch == '}')
                         {
-                            --pos;
-                            break;
+                            // 将连续的 '}}' 转义成 '}'
+                            // 单个情况下在C#中属于错误配对异常，在这直接做容错处理，不管。
+                            if (pos < len && format[pos] == '}')
+                                ++pos;
+                        }
+                        else if (ch == '{')
+                        {
+                            // 将连续的 '{{' 转义成 '{'
+                            if (pos < len && format[pos] == '{')
+                                ++pos;
+                            else
+                            {
+                                --pos;
+                                break;
+                            }
                         }
-                    }
-
-                    out.append(1, ch);
-                }
-
-                // 字符串处理完毕
-                if (pos == len)
-                    break;
-
-                // 开始解析格式化语法
-                size_t holeStart = pos++;  // 记录当前开始的位置，可以方便做容错
-                unsigned index = 0;
-                bool leftJustify = false;
-                unsigned padding = 0;
-                TChar paddingCharacter = ' ';
-                ArrayView<TChar> formatDescriptor;
-                size_t outputPos = 0, outputLength = 0;
-
-                // 解析Indexer部分
-                if (pos == len)
-                    goto badFormat;
-
-                ch = format[pos];
-                if (!(ch >= '0' && ch <= '9'))
-                    goto badFormat;
 
-                do
-                {
-                    index = index * 10 + ch - '0';
+                        out.append(1, ch);
+                    }
 
-                    if ((++pos) == len)
+                    // 字符串处理完毕
+                    if (pos == len)
+                        break;
+
+                    // 开始解析格式化语法
+                    size_t holeStart = pos++;  // 记录当前开始的位置，可以方便做容错
+                    unsigned index = 0;
+                    bool leftJustify = false;
+                    unsigned padding = 0;
+                    TChar paddingCharacter = ' ';
+                    ArrayView<TChar> formatDescriptor;
+                    size_t outputPos = 0, outputLength = 0;
+
+                    // 解析Indexer部分
+                    if (pos == len)
                         goto badFormat;
 
                     ch = format[pos];
-                } while (ch >= '0' && ch <= '9' && index < kIndexLimit);
-
-                if (index >= std::extent<decltype(formatters)>::value - 1)  // 索引越界
-                    goto badFormat;
-
-                while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
-                    ++pos;
-
-                // 解析Padding部分
-                if (ch == ',')
-                {
-                    ++pos;
-                    while (pos < len && format[pos] == ' ')  // 读取可选的空白
-                        ++pos;
-
-                    if (pos == len)  // 索引越界
+                    if (!(ch >= '0' && ch <= '9'))
                         goto badFormat;
 
-                    if ((ch = format[pos]) == '-')  // 是否存在一个减号
+                    do
                     {
-                        leftJustify = true;  // 此时左对齐
+                        index = index * 10 + ch - '0';
 
                         if ((++pos) == len)
                             goto badFormat;
 
                         ch = format[pos];
-                    }
+                    } while (ch >= '0' && ch <= '9' && index < kIndexLimit);
 
-                    if (!(ch >= '0' && ch <= '9'))  // 非法字符
+                    if (index >= count)  // 索引越界
                         goto badFormat;
 
-                    do
+                    while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+                        ++pos;
+
+                    // 解析Padding部分
+                    if (ch == ',')
                     {
-                        padding = padding * 10 + ch - '0';
+                        ++pos;
+                        while (pos < len && format[pos] == ' ')  // 读取可选的空白
+                            ++pos;
 
-                        if ((++pos) == len)
+                        if (pos == len)  // 索引越界
                             goto badFormat;
 
-                        ch = format[pos];
-                    } while (ch >= '0' && ch <= '9' && padding < kWidthLimit);
+                        if ((ch = format[pos]) == '-')  // 是否存在一个减号
+                        {
+                            leftJustify = true;  // 此时左对齐
 
-                    // 扩展语法：如果紧跟一个'['，则读取PaddingCharacter
-                    if (ch == '[')
-                    {
-                        if ((++pos) == len)
-                            goto badFormat;
+                            if ((++pos) == len)
+                                goto badFormat;
 
-                        // 读取PaddingCharacter
-                        paddingCharacter = format[pos];
+                            ch = format[pos];
+                        }
 
-                        if ((++pos) == len)
+                        if (!(ch >= '0' && ch <= '9'))  // 非法字符
                             goto badFormat;
 
-                        // 后面必须紧跟一个']'
-                        ch = format[pos];
-                        if (ch != ']')
-                            goto badFormat;
+                        do
+                        {
+                            padding = padding * 10 + ch - '0';
 
-                        if ((++pos) == len)
-                            goto badFormat;
+                            if ((++pos) == len)
+                                goto badFormat;
 
-                        ch = format[pos];
-                    }
+                            ch = format[pos];
+                        } while (ch >= '0' && ch <= '9' && padding < kWidthLimit);
 
-                    while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
-                        ++pos;
-                }
+                        // 扩展语法：如果紧跟一个'['，则读取PaddingCharacter
+                        if (ch == '[')
+                        {
+                            if ((++pos) == len)
+                                goto badFormat;
 
-                // 读取可选的格式化字段
-                if (ch == ':')
-                {
-                    size_t descriptorStart = 0;
+                            // 读取PaddingCharacter
+                            paddingCharacter = format[pos];
 
-                    ++pos;
-                    while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
-                        ++pos;
+                            if ((++pos) == len)
+                                goto badFormat;
 
-                    if (pos == len)
-                        goto badFormat;
+                            // 后面必须紧跟一个']'
+                            ch = format[pos];
+                            if (ch != ']')
+                                goto badFormat;
 
-                    descriptorStart = pos;
-                    while (pos < len && !(ch == '}' || ch == ' '))
+                            if ((++pos) == len)
+                                goto badFormat;
+
+                            ch = format[pos];
+                        }
+
+                        while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+                            ++pos;
+                    }
+
+                    // 读取可选的格式化字段
+                    if (ch == ':')
                     {
+                        size_t descriptorStart = 0;
+
                         ++pos;
-                        ch = format[pos];
-                    }
+                        while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+                            ++pos;
 
-                    if (pos == len)
-                        goto badFormat;
+                        if (pos == len)
+                            goto badFormat;
 
-                    if (pos != descriptorStart)
-                        formatDescriptor = ArrayView<TChar>(&format[descriptorStart], pos - descriptorStart);
+                        descriptorStart = pos;
+                        while (pos < len && !(ch == '}' || ch == ' '))
+                        {
+                            ++pos;
+                            ch = format[pos];
+                        }
 
-                    while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
-                        ++pos;
-                }
+                        if (pos == len)
+                            goto badFormat;
 
-                // 此时，format[pos]必然为一个'}'
-                if (ch != '}')
-                    goto badFormat;
-                ++pos;
+                        if (pos != descriptorStart)
+                            formatDescriptor = ArrayView<TChar>(&format[descriptorStart], pos - descriptorStart);
 
-                // 基本格式化参数收集完成，开始进行格式化处理
-                // 格式化函数保证在字符串末尾插入，因此先记录当前输出的位置，后续需要用来调整Padding
-                outputPos = out.length();
+                        while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+                            ++pos;
+                    }
 
-                // 执行格式化函数进行输出
-                assert(formatters[index]);
-                if (!formatters[index](out, objects[index], formatDescriptor))
-                {
-                    // 如果转换失败，格式化函数会进行清理
-                    assert(out.length() == outputPos);
-                    goto badFormat;
-                }
+                    // 此时，format[pos]必然为一个'}'
+                    if (ch != '}')
+                        goto badFormat;
+                    ++pos;
 
-                outputLength = out.length() - outputPos;
-                if (outputLength < padding)  // 需要进行补齐操作
-                {
-                    assert(outputPos + padding == out.length() + (padding - outputLength));
-                    out.resize(outputPos + padding);
+                    // 基本格式化参数收集完成，开始进行格式化处理
+                    // 格式化函数保证在字符串末尾插入，因此先记录当前输出的位置，后续需要用来调整Padding
+                    outputPos = out.length();
 
-                    size_t paddingPos = 0;
-                    if (leftJustify)
-                        paddingPos = outputPos + outputLength;
-                    else
+                    // 执行格式化函数进行输出
+                    assert(formatters[index]);
+                    if (!formatters[index](out, objects[index], formatDescriptor))
                     {
-                        // 需要对字符串做移动操作
-                        ::memmove(&out[out.length() - outputLength], out.data() + outputPos, outputLength *
-                            sizeof(TChar));
+                        // 如果转换失败，格式化函数会进行清理
+                        assert(out.length() == outputPos);
+                        goto badFormat;
+                    }
 
-                        paddingPos = outputPos;
+                    outputLength = out.length() - outputPos;
+                    if (outputLength < padding)  // 需要进行补齐操作
+                    {
+                        assert(outputPos + padding == out.length() + (padding - outputLength));
+                        out.resize(outputPos + padding);
+
+                        size_t paddingPos = 0;
+                        if (leftJustify)
+                            paddingPos = outputPos + outputLength;
+                        else
+                        {
+                            // 需要对字符串做移动操作
+                            ::memmove(&out[out.length() - outputLength], out.data() + outputPos, outputLength *
+                                sizeof(TChar));
+
+                            paddingPos = outputPos;
+                        }
+
+                        // 填充Padding字符
+                        for (size_t i = paddingPos, paddingEnd = paddingPos + padding - outputLength; i < paddingEnd; ++i)
+                            out[i] = paddingCharacter;
                     }
 
-                    // 填充Padding字符
-                    for (size_t i = paddingPos, paddingEnd = paddingPos + padding - outputLength; i < paddingEnd; ++i)
-                        out[i] = paddingCharacter;
+                    continue;  // 完成一个字符串的格式化操作
+
+                badFormat:
+                    // 错误恢复，直接将从holeStart开始到当前pos位置的所有字符放入结果
+                    if (pos < len)
+                        ++pos;
+                    out.append(&format[holeStart], pos - holeStart);
                 }
+            }
+        }
 
-                continue;  // 完成一个字符串的格式化操作
+        /**
+         * @brief 字符串格式化
+         * @tparam TChar 字符类型
+         * @tparam Args 参数类型
+         * @param[out] out 输出结果
+         * @param format 格式化文本
+         * @param args 参数列表
+         * @see https://github.com/dotnet/coreclr/blob/master/src/mscorlib/shared/System/Text/StringBuilder.cs
+         *
+         * 格式化字符串格式（扩展但不完全兼容C#语法）：
+         *   Hole := '{' Indexer ws* (',' ws* PaddingCount ('[' PaddingCharacter ']')? ws* )? (':' ws* Format )? ws* '}'
+         *   Indexer := [0-9]+
+         *   PaddingCount := '-'? [0-9]+
+         *   PaddingCharacter := .  // PaddingCharacter为扩展语法
+         *   Format := [^} ]  // C#允许在Format中对'{'和'}'进行转义，这个语法被去除了
+         *   ws := ' '
+         *
+         * 正文中，连续的"{{"会被转换为"{"，连续的"}}"同理。
+         * 注意到该实现不会抛出异常（但用户自定义ToString函数可以抛出异常），如果格式字符串出现任何问题会原封不同拷贝到结果中。
+         * 这也意味着正文中出现的独立'}'不会被当成未配对括号抛出异常（而被直接拷贝到结果中）。
+         *
+         * 支持的格式化语法如下：
+         *   - 布尔类型：
+         *     - 默认：true/false
+         *     - .* '|' .*：用户定义的假值和真值
+         *   - 整数类型：
+         *     - 默认：以十进制转换到字符串
+         *     - D: 以十进制转换到字符串（同默认）
+         *     - H：以大写十六进制转换到字符串（有符号数会被转换到对应的无符号整形表示）
+         *     - h：以小写十六进制转换到字符串（有符号数会被转换到对应的无符号整形表示）
+         *   - 浮点类型：
+         *     - 默认：以浮点数的最短表示进行输出
+         *     - S：以浮点数的最短表示进行输出（同默认）
+         *     - E：以科学计数法表示，尽可能保留足够多的小数
+         *     - E[0-9]+：以科学计数法表示，后接需要的小数位数 [0, 20]
+         *     - P[0-9]+: 以有效数字表达，后接需要的有效数字位数 [1, 21]
+         *     - F[0-9]+：以定点小数表达，后接需要的定点小数位数 [0, 20]
+         *   - const TChar* 或者 const TChar[] / std::basic_string<TChar>：
+         *     - 默认：直接拷贝
+         *   - 其他指针：
+         *     - 默认：以十六进制展示（0x??...）
+         *   - nullptr_t：
+         *     - 默认：以null展示
+         *   - 用户自定义类型：
+         *     - 默认：调用 ToString(const ArrayView<TChar>&)，若不可用，调用 ToString()
+         */
+        template <typename TChar = char, typename... Args>
+        void Format(std::basic_string<TChar>& out, const ArrayView<TChar>& format, const Args&... args)
+        {
+            const void* objects[] = { static_cast<const void*>(&args)..., nullptr };  // FIX: MSVC不能分配大小为0的数组
+            details::ToStringFormatter<TChar> formatters[] = {
+                details::ToStringFormatterSelector<TChar, Args>::AppendToString..., nullptr
+            };
+            static_assert(std::extent<decltype(objects)>::value == std::extent<decltype(formatters)>::value,
+                "Unexpected condition");
 
-            badFormat:
-                // 错误恢复，直接将从holeStart开始到当前pos位置的所有字符放入结果
-                if (pos < len)
-                    ++pos;
-                out.append(&format[holeStart], pos - holeStart);
-            }
+            details::FormatArguments(out, format, objects, formatters, sizeof...(Args));
         }
 
         template <typename TChar = char, typename... Args>
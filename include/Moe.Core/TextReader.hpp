@@ -33,6 +33,11 @@ namespace moe
          */
         const char* GetSourceName()const noexcept { return m_stSourceName.c_str(); }
 
+        /**
+         * @brief 获取缓冲区
+         */
+        ArrayView<char> GetBuffer()const noexcept { return m_stBuffer; }
+
         /**
          * @brief 获取总长度
          * @return 总长度
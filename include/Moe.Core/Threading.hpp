@@ -155,5 +155,42 @@ namespace moe
             bool m_bEventSet;
             bool m_bAutoReset;
         };
+
+        /**
+         * @brief 基于纪元的RCU
+         *
+         * 读者通过ReadLock/ReadUnlock（或ReadGuard）进出读端临界区，只写入线程私有的槽位，读端无等待且可嵌套。
+         * 写者原子地替换共享指针后调用Synchronize，等待替换前进入临界区的读者全部离开，之后即可安全回收旧对象。
+         * 全局共享同一组线程槽位。
+         *
+         * 注意：不能在读端临界区内调用Synchronize，否则将死锁。
+         */
+        class Rcu
+        {
+        public:
+            class ReadGuard :
+                public NonCopyable
+            {
+            public:
+                ReadGuard()noexcept { ReadLock(); }
+                ~ReadGuard() { ReadUnlock(); }
+            };
+
+        public:
+            /**
+             * @brief 进入读端临界区
+             */
+            static void ReadLock()noexcept;
+
+            /**
+             * @brief 离开读端临界区
+             */
+            static void ReadUnlock()noexcept;
+
+            /**
+             * @brief 等待当前所有读端临界区结束
+             */
+            static void Synchronize()noexcept;
+        };
     }
 }
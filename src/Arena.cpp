@@ -0,0 +1,152 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <Moe.Core/Arena.hpp>
+
+#include <algorithm>
+
+using namespace std;
+using namespace moe;
+
+const size_t Arena::kDefaultAlignment;
+const size_t Arena::kChunkHeaderSize;
+const size_t Arena::kDefaultChunkSize;
+
+Arena::Arena(size_t chunkSize)noexcept
+    : m_uChunkSize(max<size_t>(chunkSize, kDefaultAlignment))
+{
+}
+
+Arena::~Arena()
+{
+    RunFinalizers(nullptr);
+
+    auto p = m_pHead;
+    while (p)
+    {
+        auto next = p->Next;
+        ::free(p);
+        p = next;
+    }
+}
+
+size_t Arena::GetUsedSize()const noexcept
+{
+    if (!m_pCurrent)
+        return 0;
+
+    size_t ret = 0;
+    for (auto p = m_pHead; p != m_pCurrent; p = p->Next)
+    {
+        assert(p);
+        ret += p->Size;
+    }
+    return ret + (m_pCursor - GetChunkData(m_pCurrent));
+}
+
+size_t Arena::GetCapacity()const noexcept
+{
+    size_t ret = 0;
+    for (auto p = m_pHead; p; p = p->Next)
+        ret += p->Size;
+    return ret;
+}
+
+void Arena::Rewind(const Checkpoint& checkpoint)noexcept
+{
+    RunFinalizers(checkpoint.m_pFinalizers);
+
+    if (!checkpoint.m_pChunk)  // 检查点位于任何分配之前
+    {
+        Reset();
+        return;
+    }
+
+    m_pCurrent = checkpoint.m_pChunk;
+    m_pCursor = checkpoint.m_pCursor;
+    m_pEnd = GetChunkData(m_pCurrent) + m_pCurrent->Size;
+    assert(m_pCursor >= GetChunkData(m_pCurrent) && m_pCursor <= m_pEnd);
+}
+
+void Arena::Reset()noexcept
+{
+    RunFinalizers(nullptr);
+
+    m_pCurrent = m_pHead;
+    if (m_pCurrent)
+    {
+        m_pCursor = GetChunkData(m_pCurrent);
+        m_pEnd = m_pCursor + m_pCurrent->Size;
+    }
+    else
+        m_pCursor = m_pEnd = nullptr;
+}
+
+size_t Arena::Shrink()noexcept
+{
+    if (!m_pCurrent)
+        return 0;
+
+    size_t ret = 0;
+    auto p = m_pCurrent->Next;
+    while (p)
+    {
+        auto next = p->Next;
+        ret += p->Size + kChunkHeaderSize;
+        ::free(p);
+        p = next;
+    }
+    m_pCurrent->Next = nullptr;
+    return ret;
+}
+
+void* Arena::AllocSlow(size_t sz, size_t align)
+{
+    // 块的数据区按kDefaultAlignment对齐，更大的对齐要求需要额外的空间
+    auto need = sz + (align > kDefaultAlignment ? align - kDefaultAlignment : 0);
+    if (need < sz)
+        throw bad_alloc();
+
+    // 优先复用当前块之后已经申请过的块（Reset或Rewind之后）
+    auto next = m_pCurrent ? m_pCurrent->Next : m_pHead;
+    Chunk* chunk = nullptr;
+    if (next && next->Size >= need)
+        chunk = next;
+    else
+    {
+        auto size = max(need, m_uChunkSize);
+        if (size + kChunkHeaderSize < size)
+            throw bad_alloc();
+
+        chunk = static_cast<Chunk*>(::malloc(size + kChunkHeaderSize));
+        if (!chunk)
+            throw bad_alloc();
+        chunk->Size = size;
+
+        // 插入到当前块之后
+        chunk->Next = next;
+        if (m_pCurrent)
+            m_pCurrent->Next = chunk;
+        else
+            m_pHead = chunk;
+    }
+
+    m_pCurrent = chunk;
+    m_pEnd = GetChunkData(chunk) + chunk->Size;
+
+    auto p = AlignUp(GetChunkData(chunk), align);
+    assert(p + sz <= m_pEnd);
+    m_pCursor = p + sz;
+    return p;
+}
+
+void Arena::RunFinalizers(Finalizer* until)noexcept
+{
+    while (m_pFinalizers && m_pFinalizers != until)
+    {
+        auto f = m_pFinalizers;
+        m_pFinalizers = f->Prev;
+        f->Func(f->Object);
+    }
+}
@@ -0,0 +1,385 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <Moe.Core/ChainBuffer.hpp>
+
+using namespace std;
+using namespace moe;
+
+//////////////////////////////////////////////////////////////////////////////// ChainBuffer
+
+const size_t ChainBuffer::kDefaultChunkSize;
+
+ChainBuffer::ChainBuffer(ObjectPool& pool, size_t chunkSize)
+    : m_pPool(&pool), m_uChunkSize(chunkSize)
+{
+    assert(chunkSize > 0);
+}
+
+ChainBuffer::ChainBuffer(ChainBuffer&& rhs)noexcept
+    : m_pPool(rhs.m_pPool), m_uChunkSize(rhs.m_uChunkSize), m_uSize(rhs.m_uSize),
+    m_stSegments(std::move(rhs.m_stSegments)), m_pReserved(rhs.m_pReserved)
+{
+    rhs.m_uSize = 0;
+    rhs.m_stSegments.clear();
+    rhs.m_pReserved = nullptr;
+}
+
+ChainBuffer::~ChainBuffer()
+{
+    Clear();
+    if (m_pReserved)
+        ReleaseChunk(m_pReserved);
+}
+
+ChainBuffer& ChainBuffer::operator=(ChainBuffer&& rhs)noexcept
+{
+    if (this == &rhs)
+        return *this;
+
+    Clear();
+    if (m_pReserved)
+        ReleaseChunk(m_pReserved);
+
+    m_pPool = rhs.m_pPool;
+    m_uChunkSize = rhs.m_uChunkSize;
+    m_uSize = rhs.m_uSize;
+    m_stSegments = std::move(rhs.m_stSegments);
+    m_pReserved = rhs.m_pReserved;
+
+    rhs.m_uSize = 0;
+    rhs.m_stSegments.clear();
+    rhs.m_pReserved = nullptr;
+    return *this;
+}
+
+void ChainBuffer::Clear()noexcept
+{
+    for (auto& segment : m_stSegments)
+        RecycleChunk(segment.Block);
+    m_stSegments.clear();
+    m_uSize = 0;
+}
+
+void ChainBuffer::Append(BytesView data)
+{
+    size_t pos = 0;
+    while (pos < data.GetSize())
+    {
+        auto window = PrepareAppend();
+        auto n = std::min(window.GetSize(), data.GetSize() - pos);
+        ::memcpy(window.GetBuffer(), data.GetBuffer() + pos, n);
+        CommitAppend(n);
+        pos += n;
+    }
+}
+
+void ChainBuffer::Append(ChainBuffer&& other)
+{
+    assert(&other != this);
+
+    for (auto& segment : other.m_stSegments)
+        m_stSegments.push_back(segment);
+    m_uSize += other.m_uSize;
+
+    other.m_stSegments.clear();
+    other.m_uSize = 0;
+}
+
+void ChainBuffer::Prepend(BytesView data)
+{
+    size_t remain = data.GetSize();
+    while (remain > 0)
+    {
+        if (m_stSegments.empty() || m_stSegments.front().Block->RefCount != 1 || m_stSegments.front().Begin == 0)
+        {
+            // 新块从末尾开始向前填充
+            auto chunk = AllocChunk();
+            Segment segment = { chunk, chunk->Capacity, chunk->Capacity };
+            m_stSegments.push_front(segment);
+        }
+
+        auto& front = m_stSegments.front();
+        auto n = std::min(front.Begin, remain);
+        front.Begin -= n;
+        remain -= n;
+        ::memcpy(front.Block->GetData() + front.Begin, data.GetBuffer() + remain, n);
+        m_uSize += n;
+    }
+}
+
+MutableBytesView ChainBuffer::PrepareAppend()
+{
+    auto tail = GetWritableTail();
+    if (tail)
+        return MutableBytesView(tail->Block->GetData() + tail->End, tail->Block->Capacity - tail->End);
+
+    if (!m_pReserved)
+        m_pReserved = AllocChunk();
+    return MutableBytesView(m_pReserved->GetData(), m_pReserved->Capacity);
+}
+
+void ChainBuffer::CommitAppend(size_t count)
+{
+    if (count == 0)
+        return;
+
+    auto tail = GetWritableTail();
+    if (tail)
+    {
+        assert(tail->End + count <= tail->Block->Capacity);
+        tail->End += count;
+    }
+    else
+    {
+        assert(m_pReserved && count <= m_pReserved->Capacity);
+        Segment segment = { m_pReserved, 0, count };
+        m_stSegments.push_back(segment);
+        m_pReserved = nullptr;
+    }
+    m_uSize += count;
+}
+
+size_t ChainBuffer::Consume(size_t count)noexcept
+{
+    size_t total = 0;
+    while (total < count && !m_stSegments.empty())
+    {
+        auto& front = m_stSegments.front();
+        auto n = std::min(count - total, front.End - front.Begin);
+        front.Begin += n;
+        total += n;
+
+        if (front.Begin == front.End)
+        {
+            RecycleChunk(front.Block);
+            m_stSegments.pop_front();
+        }
+    }
+    m_uSize -= total;
+    return total;
+}
+
+ChainBuffer ChainBuffer::Split(size_t count)
+{
+    ChainBuffer ret(*m_pPool, m_uChunkSize);
+
+    count = std::min(count, m_uSize);
+    while (ret.m_uSize < count)
+    {
+        auto& front = m_stSegments.front();
+        auto n = std::min(count - ret.m_uSize, front.End - front.Begin);
+        if (n == front.End - front.Begin)
+        {
+            ret.m_stSegments.push_back(front);
+            m_stSegments.pop_front();
+        }
+        else
+        {
+            // 边界上的块由两者共享
+            Segment segment = { front.Block, front.Begin, front.Begin + n };
+            ret.m_stSegments.push_back(segment);
+            ++front.Block->RefCount;
+            front.Begin += n;
+        }
+        ret.m_uSize += n;
+        m_uSize -= n;
+    }
+    return ret;
+}
+
+size_t ChainBuffer::CopyTo(MutableBytesView out, size_t offset)const noexcept
+{
+    size_t total = 0;
+    for (size_t i = 0; i < m_stSegments.size() && total < out.GetSize(); ++i)
+    {
+        auto segment = GetSegment(i);
+        if (offset >= segment.GetSize())
+        {
+            offset -= segment.GetSize();
+            continue;
+        }
+
+        auto n = std::min(segment.GetSize() - offset, out.GetSize() - total);
+        ::memcpy(out.GetBuffer() + total, segment.GetBuffer() + offset, n);
+        total += n;
+        offset = 0;
+    }
+    return total;
+}
+
+size_t ChainBuffer::Gather(MutableArrayView<BytesView> out, size_t offset)const noexcept
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_stSegments.size() && count < out.GetSize(); ++i)
+    {
+        auto segment = GetSegment(i);
+        if (offset >= segment.GetSize())
+        {
+            offset -= segment.GetSize();
+            continue;
+        }
+
+        out[count++] = BytesView(segment.GetBuffer() + offset, segment.GetSize() - offset);
+        offset = 0;
+    }
+    return count;
+}
+
+ChainBuffer::Chunk* ChainBuffer::AllocChunk()
+{
+    if (m_pReserved)
+    {
+        auto ret = m_pReserved;
+        m_pReserved = nullptr;
+        return ret;
+    }
+
+    auto p = m_pPool->Alloc(sizeof(Chunk) + m_uChunkSize);
+    auto ret = static_cast<Chunk*>(p.release());
+    ret->RefCount = 1;
+    ret->Capacity = m_uChunkSize;
+    return ret;
+}
+
+void ChainBuffer::RecycleChunk(Chunk* chunk)noexcept
+{
+    // 保留一个独占的块以备下次分配，避免收发循环中反复向对象池申请
+    if (chunk->RefCount == 1 && !m_pReserved)
+        m_pReserved = chunk;
+    else
+        ReleaseChunk(chunk);
+}
+
+void ChainBuffer::ReleaseChunk(Chunk* chunk)noexcept
+{
+    assert(chunk->RefCount > 0);
+    if (--chunk->RefCount == 0)
+        ObjectPool::Free(chunk);
+}
+
+ChainBuffer::Segment* ChainBuffer::GetWritableTail()noexcept
+{
+    if (m_stSegments.empty())
+        return nullptr;
+
+    auto& tail = m_stSegments.back();
+    if (tail.Block->RefCount != 1 || tail.End == tail.Block->Capacity)
+        return nullptr;
+    return &tail;
+}
+
+//////////////////////////////////////////////////////////////////////////////// ChainBufferStream
+
+ChainBufferStream::ChainBufferStream(ChainBuffer& buffer)
+    : m_stBuffer(buffer)
+{
+}
+
+bool ChainBufferStream::IsReadable()const noexcept
+{
+    return true;
+}
+
+bool ChainBufferStream::IsWriteable()const noexcept
+{
+    return true;
+}
+
+bool ChainBufferStream::IsSeekable()const noexcept
+{
+    return false;
+}
+
+size_t ChainBufferStream::GetLength()const
+{
+    return m_uPosition + m_stBuffer.GetSize();
+}
+
+size_t ChainBufferStream::GetPosition()const
+{
+    return m_uPosition;
+}
+
+void ChainBufferStream::Flush()
+{
+}
+
+int ChainBufferStream::ReadByte()
+{
+    if (m_stBuffer.IsEmpty())
+        return -1;
+
+    auto ret = m_stBuffer.GetSegment(0)[0];
+    m_stBuffer.Consume(1);
+    ++m_uPosition;
+    return ret;
+}
+
+size_t ChainBufferStream::Read(MutableBytesView out, size_t count)
+{
+    assert(out.GetSize() >= count);
+    count = std::min(count, out.GetSize());
+
+    auto n = m_stBuffer.CopyTo(MutableBytesView(out.GetBuffer(), count));
+    m_stBuffer.Consume(n);
+    m_uPosition += n;
+    return n;
+}
+
+size_t ChainBufferStream::Seek(int64_t offset, StreamSeekOrigin origin)
+{
+    MOE_UNUSED(offset);
+    MOE_UNUSED(origin);
+    MOE_THROW(OperationNotSupportException, "ChainBufferStream is not seekable");
+}
+
+void ChainBufferStream::SetLength(size_t length)
+{
+    MOE_UNUSED(length);
+    MOE_THROW(OperationNotSupportException, "ChainBufferStream cannot reset size");
+}
+
+void ChainBufferStream::WriteByte(uint8_t b)
+{
+    auto window = m_stBuffer.PrepareAppend();
+    window[0] = b;
+    m_stBuffer.CommitAppend(1);
+}
+
+void ChainBufferStream::Write(BytesView view, size_t count)
+{
+    assert(view.GetSize() >= count);
+    count = std::min(count, view.GetSize());
+    m_stBuffer.Append(BytesView(view.GetBuffer(), count));
+}
+
+void ChainBufferStream::WriteV(ArrayView<BytesView> buffers)
+{
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+        m_stBuffer.Append(buffers[i]);
+}
+
+BytesView ChainBufferStream::GetReadWindow()
+{
+    if (m_stBuffer.IsEmpty())
+        return BytesView();
+    return m_stBuffer.GetSegment(0);
+}
+
+void ChainBufferStream::AdvanceRead(size_t count)
+{
+    assert(!m_stBuffer.IsEmpty() && count <= m_stBuffer.GetSegment(0).GetSize());
+    m_uPosition += m_stBuffer.Consume(count);
+}
+
+MutableBytesView ChainBufferStream::GetWriteWindow()
+{
+    return m_stBuffer.PrepareAppend();
+}
+
+void ChainBufferStream::AdvanceWrite(size_t count)
+{
+    m_stBuffer.CommitAppend(count);
+}
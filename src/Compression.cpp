@@ -0,0 +1,645 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <Moe.Core/Compression.hpp>
+#include <Moe.Core/Exception.hpp>
+
+using namespace std;
+using namespace moe;
+using namespace Compression;
+
+//////////////////////////////////////////////////////////////////////////////// Lz4
+
+namespace
+{
+    static const size_t kMinMatch = 4;
+    static const size_t kLastLiterals = 5;  // 最后5个字节必须是字面量
+    static const size_t kMatchFindLimit = 12;  // 最后一个匹配必须在末尾12字节之前开始
+    static const size_t kMaxDistance = 65535;
+    static const unsigned kHashLog = 12;
+    static const size_t kMaxInputSize = 0x7E000000;  // 与LZ4_MAX_INPUT_SIZE一致
+
+    enum class DecodeResult
+    {
+        Ok,
+        BadFormat,
+        OutputTooSmall,
+    };
+
+    inline uint32_t Read32(const uint8_t* p)noexcept
+    {
+        uint32_t ret;
+        ::memcpy(&ret, p, sizeof(ret));
+        return ret;
+    }
+
+    inline uint32_t Hash(uint32_t sequence)noexcept
+    {
+        return (sequence * 2654435761u) >> (32 - kHashLog);
+    }
+
+    uint8_t* WriteLength(uint8_t* op, size_t length)noexcept
+    {
+        while (length >= 255)
+        {
+            *op++ = 255;
+            length -= 255;
+        }
+        *op++ = static_cast<uint8_t>(length);
+        return op;
+    }
+
+    /**
+     * @brief 写出一个序列
+     * @return 输出位置，空间不足时返回nullptr
+     */
+    uint8_t* WriteSequence(uint8_t* op, uint8_t* oend, const uint8_t* literals, size_t literalLength, size_t offset,
+        size_t matchLength)noexcept
+    {
+        // token + 字面量长度 + 字面量 + 偏移 + 匹配长度
+        auto required = 1 + literalLength / 255 + 1 + literalLength + (offset ? 2 + matchLength / 255 + 1 : 0);
+        if (static_cast<size_t>(oend - op) < required)
+            return nullptr;
+
+        auto token = op++;
+        if (literalLength >= 15)
+        {
+            *token = 15 << 4;
+            op = WriteLength(op, literalLength - 15);
+        }
+        else
+            *token = static_cast<uint8_t>(literalLength << 4);
+
+        if (literalLength > 0)
+            ::memcpy(op, literals, literalLength);
+        op += literalLength;
+
+        if (offset == 0)  // 最后的字面量
+            return op;
+
+        *op++ = static_cast<uint8_t>(offset & 0xFF);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+
+        matchLength -= kMinMatch;
+        if (matchLength >= 15)
+        {
+            *token |= 15;
+            op = WriteLength(op, matchLength - 15);
+        }
+        else
+            *token |= static_cast<uint8_t>(matchLength);
+        return op;
+    }
+
+    /**
+     * @brief 压缩
+     * @return 压缩后大小，输出空间不足时返回0
+     */
+    size_t CompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity)noexcept
+    {
+        uint32_t table[1u << kHashLog];
+        ::memset(table, 0, sizeof(table));
+
+        const uint8_t* ip = src;
+        const uint8_t* anchor = src;
+        const uint8_t* iend = src + srcSize;
+        uint8_t* op = dst;
+        uint8_t* oend = dst + dstCapacity;
+
+        if (srcSize >= kMatchFindLimit + 1)
+        {
+            const uint8_t* mflimit = iend - kMatchFindLimit;
+            const uint8_t* matchLimit = iend - kLastLiterals;
+
+            ++ip;
+            while (ip < mflimit)
+            {
+                // 查找匹配，长时间未命中时加大步长
+                auto sequence = Read32(ip);
+                auto h = Hash(sequence);
+                auto ref = src + table[h];
+                table[h] = static_cast<uint32_t>(ip - src);
+                if (ref >= ip || static_cast<size_t>(ip - ref) > kMaxDistance || Read32(ref) != sequence)
+                {
+                    ip += 1 + (static_cast<size_t>(ip - anchor) >> 6);
+                    continue;
+                }
+
+                // 向前扩展
+                while (ip > anchor && ref > src && ip[-1] == ref[-1])
+                {
+                    --ip;
+                    --ref;
+                }
+
+                // 向后扩展
+                size_t matchLength = kMinMatch;
+                while (ip + matchLength < matchLimit && ip[matchLength] == ref[matchLength])
+                    ++matchLength;
+
+                op = WriteSequence(op, oend, anchor, static_cast<size_t>(ip - anchor), static_cast<size_t>(ip - ref),
+                    matchLength);
+                if (!op)
+                    return 0;
+
+                ip += matchLength;
+                anchor = ip;
+
+                if (ip < mflimit)
+                    table[Hash(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+            }
+        }
+
+        op = WriteSequence(op, oend, anchor, static_cast<size_t>(iend - anchor), 0, 0);
+        if (!op)
+            return 0;
+        return static_cast<size_t>(op - dst);
+    }
+
+    DecodeResult DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity,
+        size_t& size)noexcept
+    {
+        const uint8_t* ip = src;
+        const uint8_t* iend = src + srcSize;
+        uint8_t* op = dst;
+        uint8_t* oend = dst + dstCapacity;
+
+        while (true)
+        {
+            if (ip >= iend)
+                return DecodeResult::BadFormat;
+
+            // 字面量
+            auto token = *ip++;
+            size_t literalLength = token >> 4;
+            if (literalLength == 15)
+            {
+                uint8_t b = 0;
+                do
+                {
+                    if (ip >= iend)
+                        return DecodeResult::BadFormat;
+                    b = *ip++;
+                    literalLength += b;
+                } while (b == 255);
+            }
+
+            if (static_cast<size_t>(iend - ip) < literalLength)
+                return DecodeResult::BadFormat;
+            if (static_cast<size_t>(oend - op) < literalLength)
+                return DecodeResult::OutputTooSmall;
+            if (literalLength > 0)
+                ::memcpy(op, ip, literalLength);
+            ip += literalLength;
+            op += literalLength;
+
+            // 最后一个序列只有字面量
+            if (ip == iend)
+                break;
+
+            // 匹配
+            if (iend - ip < 2)
+                return DecodeResult::BadFormat;
+            size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<size_t>(op - dst))
+                return DecodeResult::BadFormat;
+
+            size_t matchLength = token & 0x0F;
+            if (matchLength == 15)
+            {
+                uint8_t b = 0;
+                do
+                {
+                    if (ip >= iend)
+                        return DecodeResult::BadFormat;
+                    b = *ip++;
+                    matchLength += b;
+                } while (b == 255);
+            }
+            matchLength += kMinMatch;
+
+            if (static_cast<size_t>(oend - op) < matchLength)
+                return DecodeResult::OutputTooSmall;
+
+            const uint8_t* ref = op - offset;
+            if (offset >= matchLength)
+                ::memcpy(op, ref, matchLength);
+            else
+            {
+                // 重叠复制
+                for (size_t i = 0; i < matchLength; ++i)
+                    op[i] = ref[i];
+            }
+            op += matchLength;
+        }
+
+        size = static_cast<size_t>(op - dst);
+        return DecodeResult::Ok;
+    }
+}
+
+size_t Lz4::Compress(BytesView input, MutableBytesView output)
+{
+    if (input.GetSize() > kMaxInputSize)
+        MOE_THROW(BadArgumentException, "Input is too large");
+
+    auto ret = CompressBlock(input.GetBuffer(), input.GetSize(), output.GetBuffer(), output.GetSize());
+    if (ret == 0)
+        MOE_THROW(OutOfRangeException, "Output buffer is too small");
+    return ret;
+}
+
+void Lz4::Compress(std::vector<uint8_t>& out, BytesView input)
+{
+    if (input.GetSize() > kMaxInputSize)
+        MOE_THROW(BadArgumentException, "Input is too large");
+
+    auto offset = out.size();
+    out.resize(offset + GetMaxCompressedSize(input.GetSize()));
+
+    auto ret = CompressBlock(input.GetBuffer(), input.GetSize(), out.data() + offset, out.size() - offset);
+    assert(ret > 0);
+    out.resize(offset + ret);
+}
+
+size_t Lz4::Decompress(BytesView input, MutableBytesView output)
+{
+    size_t ret = 0;
+    switch (DecompressBlock(input.GetBuffer(), input.GetSize(), output.GetBuffer(), output.GetSize(), ret))
+    {
+        case DecodeResult::Ok:
+            return ret;
+        case DecodeResult::OutputTooSmall:
+            MOE_THROW(OutOfRangeException, "Output buffer is too small");
+        default:
+            MOE_THROW(BadFormatException, "Corrupted LZ4 block");
+    }
+}
+
+void Lz4::Decompress(std::vector<uint8_t>& out, BytesView input)
+{
+    // LZ4的压缩率不会超过255:1
+    auto offset = out.size();
+    auto maxSize = input.GetSize() * 255 + 16;
+    auto capacity = std::min(std::max<size_t>(input.GetSize() * 4, 256), maxSize);
+    while (true)
+    {
+        out.resize(offset + capacity);
+
+        size_t ret = 0;
+        auto result = DecompressBlock(input.GetBuffer(), input.GetSize(), out.data() + offset, capacity, ret);
+        if (result == DecodeResult::Ok)
+        {
+            out.resize(offset + ret);
+            return;
+        }
+
+        if (result == DecodeResult::BadFormat || capacity >= maxSize)
+        {
+            out.resize(offset);
+            MOE_THROW(BadFormatException, "Corrupted LZ4 block");
+        }
+        capacity = std::min(capacity * 2, maxSize);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// Lz4CompressStream
+
+namespace
+{
+    static const uint8_t kStreamMagic[4] = { 'M', 'L', 'Z', '4' };
+    static const uint32_t kStoredFlag = 0x80000000u;
+}
+
+const size_t Lz4CompressStream::kDefaultBlockSize;
+const size_t Lz4CompressStream::kMaxBlockSize;
+
+Lz4CompressStream::Lz4CompressStream(Stream* stream, size_t blockSize)
+    : m_pStream(stream), m_stBlock(std::min(std::max<size_t>(blockSize, 256), kMaxBlockSize))
+{
+    assert(stream);
+    m_stCompressed.resize(Lz4::GetMaxCompressedSize(m_stBlock.size()) + 8);
+}
+
+Lz4CompressStream::~Lz4CompressStream()
+{
+    try
+    {
+        Finish();
+    }
+    catch (...)
+    {
+    }
+}
+
+void Lz4CompressStream::Finish()
+{
+    if (m_bFinished)
+        return;
+
+    FlushBlock();
+    m_bFinished = true;
+
+    uint8_t end[4] = { 0, 0, 0, 0 };
+    m_pStream->Write(BytesView(end, 4), 4);
+}
+
+bool Lz4CompressStream::IsReadable()const noexcept
+{
+    return false;
+}
+
+bool Lz4CompressStream::IsWriteable()const noexcept
+{
+    return !m_bFinished;
+}
+
+bool Lz4CompressStream::IsSeekable()const noexcept
+{
+    return false;
+}
+
+size_t Lz4CompressStream::GetLength()const
+{
+    return m_uTotal + m_uBlockEnd;
+}
+
+size_t Lz4CompressStream::GetPosition()const
+{
+    return m_uTotal + m_uBlockEnd;
+}
+
+void Lz4CompressStream::Flush()
+{
+    FlushBlock();
+    m_pStream->Flush();
+}
+
+int Lz4CompressStream::ReadByte()
+{
+    MOE_THROW(OperationNotSupportException, "Lz4CompressStream is write-only");
+}
+
+size_t Lz4CompressStream::Read(MutableBytesView out, size_t count)
+{
+    MOE_UNUSED(out);
+    MOE_UNUSED(count);
+    MOE_THROW(OperationNotSupportException, "Lz4CompressStream is write-only");
+}
+
+size_t Lz4CompressStream::Seek(int64_t offset, StreamSeekOrigin origin)
+{
+    MOE_UNUSED(offset);
+    MOE_UNUSED(origin);
+    MOE_THROW(OperationNotSupportException, "Lz4CompressStream is not seekable");
+}
+
+void Lz4CompressStream::SetLength(size_t length)
+{
+    MOE_UNUSED(length);
+    MOE_THROW(OperationNotSupportException, "Lz4CompressStream is not seekable");
+}
+
+void Lz4CompressStream::WriteByte(uint8_t b)
+{
+    if (m_uBlockEnd == m_stBlock.size() || m_bFinished)
+        FlushBlock();
+    m_stBlock[m_uBlockEnd++] = b;
+}
+
+void Lz4CompressStream::Write(BytesView view, size_t count)
+{
+    assert(view.GetSize() >= count);
+    count = std::min(count, view.GetSize());
+
+    auto p = view.GetBuffer();
+    while (count > 0)
+    {
+        if (m_uBlockEnd == m_stBlock.size() || m_bFinished)
+            FlushBlock();
+
+        auto n = std::min(count, m_stBlock.size() - m_uBlockEnd);
+        ::memcpy(m_stBlock.data() + m_uBlockEnd, p, n);
+        m_uBlockEnd += n;
+        p += n;
+        count -= n;
+    }
+}
+
+MutableBytesView Lz4CompressStream::GetWriteWindow()
+{
+    if (m_uBlockEnd == m_stBlock.size() || m_bFinished)
+        FlushBlock();
+    return MutableBytesView(m_stBlock.data() + m_uBlockEnd, m_stBlock.size() - m_uBlockEnd);
+}
+
+void Lz4CompressStream::AdvanceWrite(size_t count)
+{
+    assert(m_uBlockEnd + count <= m_stBlock.size());
+    m_uBlockEnd += count;
+}
+
+void Lz4CompressStream::WriteHeader()
+{
+    m_pStream->Write(BytesView(kStreamMagic, 4), 4);
+    m_bHeaderWritten = true;
+}
+
+void Lz4CompressStream::FlushBlock()
+{
+    if (m_bFinished)
+        MOE_THROW(InvalidCallException, "Stream is finished");
+    if (!m_bHeaderWritten)
+        WriteHeader();
+    if (m_uBlockEnd == 0)
+        return;
+
+    // 压缩后没有变小时直接存储原始数据
+    auto header = m_stCompressed.data();
+    auto compressed = CompressBlock(m_stBlock.data(), m_uBlockEnd, header + 8, m_stCompressed.size() - 8);
+    if (compressed == 0 || compressed >= m_uBlockEnd)
+    {
+        details::StoreLE<uint32_t>(header, static_cast<uint32_t>(m_uBlockEnd) | kStoredFlag);
+        BytesView parts[2] = { BytesView(header, 4), BytesView(m_stBlock.data(), m_uBlockEnd) };
+        m_pStream->WriteV(ArrayView<BytesView>(parts, 2));
+    }
+    else
+    {
+        details::StoreLE<uint32_t>(header, static_cast<uint32_t>(compressed));
+        details::StoreLE<uint32_t>(header + 4, static_cast<uint32_t>(m_uBlockEnd));
+        m_pStream->Write(BytesView(header, compressed + 8), compressed + 8);
+    }
+
+    m_uTotal += m_uBlockEnd;
+    m_uBlockEnd = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////// Lz4DecompressStream
+
+Lz4DecompressStream::Lz4DecompressStream(Stream* stream)
+    : m_pStream(stream)
+{
+    assert(stream);
+
+    uint8_t magic[4];
+    if (m_pStream->Read(MutableBytesView(magic, 4), 4) != 4 || ::memcmp(magic, kStreamMagic, 4) != 0)
+        MOE_THROW(BadFormatException, "Bad LZ4 stream header");
+}
+
+bool Lz4DecompressStream::IsReadable()const noexcept
+{
+    return true;
+}
+
+bool Lz4DecompressStream::IsWriteable()const noexcept
+{
+    return false;
+}
+
+bool Lz4DecompressStream::IsSeekable()const noexcept
+{
+    return false;
+}
+
+size_t Lz4DecompressStream::GetLength()const
+{
+    MOE_THROW(OperationNotSupportException, "Length of Lz4DecompressStream is unknown");
+}
+
+size_t Lz4DecompressStream::GetPosition()const
+{
+    return m_uTotal - (m_uBlockEnd - m_uReadPosition);
+}
+
+void Lz4DecompressStream::Flush()
+{
+}
+
+int Lz4DecompressStream::ReadByte()
+{
+    if (m_uReadPosition == m_uBlockEnd && !ReadBlock())
+        return -1;
+    return m_stBlock[m_uReadPosition++];
+}
+
+size_t Lz4DecompressStream::Read(MutableBytesView out, size_t count)
+{
+    assert(out.GetSize() >= count);
+    count = std::min(count, out.GetSize());
+
+    size_t total = 0;
+    while (total < count)
+    {
+        if (m_uReadPosition == m_uBlockEnd && !ReadBlock())
+            break;
+
+        auto n = std::min(count - total, m_uBlockEnd - m_uReadPosition);
+        ::memcpy(out.GetBuffer() + total, m_stBlock.data() + m_uReadPosition, n);
+        m_uReadPosition += n;
+        total += n;
+    }
+    return total;
+}
+
+size_t Lz4DecompressStream::Seek(int64_t offset, StreamSeekOrigin origin)
+{
+    MOE_UNUSED(offset);
+    MOE_UNUSED(origin);
+    MOE_THROW(OperationNotSupportException, "Lz4DecompressStream is not seekable");
+}
+
+void Lz4DecompressStream::SetLength(size_t length)
+{
+    MOE_UNUSED(length);
+    MOE_THROW(OperationNotSupportException, "Lz4DecompressStream is read-only");
+}
+
+void Lz4DecompressStream::WriteByte(uint8_t b)
+{
+    MOE_UNUSED(b);
+    MOE_THROW(OperationNotSupportException, "Lz4DecompressStream is read-only");
+}
+
+void Lz4DecompressStream::Write(BytesView view, size_t count)
+{
+    MOE_UNUSED(view);
+    MOE_UNUSED(count);
+    MOE_THROW(OperationNotSupportException, "Lz4DecompressStream is read-only");
+}
+
+BytesView Lz4DecompressStream::GetReadWindow()
+{
+    if (m_uReadPosition == m_uBlockEnd)
+        ReadBlock();
+    return BytesView(m_stBlock.data() + m_uReadPosition, m_uBlockEnd - m_uReadPosition);
+}
+
+void Lz4DecompressStream::AdvanceRead(size_t count)
+{
+    assert(m_uReadPosition + count <= m_uBlockEnd);
+    m_uReadPosition += count;
+}
+
+bool Lz4DecompressStream::ReadBlock()
+{
+    assert(m_uReadPosition == m_uBlockEnd);
+    if (m_bEof)
+        return false;
+
+    uint8_t header[4] = {};
+    if (m_pStream->Read(MutableBytesView(header, 4), 4) != 4)
+        MOE_THROW(BadFormatException, "Unexpected end of LZ4 stream");
+
+    auto length = details::LoadLE<uint32_t>(header);
+    if (length == 0)
+    {
+        m_bEof = true;
+        return false;
+    }
+
+    m_uReadPosition = m_uBlockEnd = 0;
+    if ((length & kStoredFlag) != 0)
+    {
+        // 未压缩块
+        length &= ~kStoredFlag;
+        if (length == 0)
+            MOE_THROW(BadFormatException, "Empty LZ4 block");
+        if (length > Lz4CompressStream::kMaxBlockSize)
+            MOE_THROW(BadFormatException, "LZ4 block is too large");
+
+        if (m_stBlock.size() < length)
+            m_stBlock.resize(length);
+        if (m_pStream->Read(MutableBytesView(m_stBlock.data(), length), length) != length)
+            MOE_THROW(BadFormatException, "Unexpected end of LZ4 stream");
+        m_uBlockEnd = length;
+    }
+    else
+    {
+        if (m_pStream->Read(MutableBytesView(header, 4), 4) != 4)
+            MOE_THROW(BadFormatException, "Unexpected end of LZ4 stream");
+
+        auto original = details::LoadLE<uint32_t>(header);
+        if (original == 0)
+            MOE_THROW(BadFormatException, "Empty LZ4 block");
+        if (original > Lz4CompressStream::kMaxBlockSize || length > Lz4::GetMaxCompressedSize(original))
+            MOE_THROW(BadFormatException, "LZ4 block is too large");
+
+        if (m_stCompressed.size() < length)
+            m_stCompressed.resize(length);
+        if (m_pStream->Read(MutableBytesView(m_stCompressed.data(), length), length) != length)
+            MOE_THROW(BadFormatException, "Unexpected end of LZ4 stream");
+
+        if (m_stBlock.size() < original)
+            m_stBlock.resize(original);
+        size_t size = 0;
+        auto result = DecompressBlock(m_stCompressed.data(), length, m_stBlock.data(), original, size);
+        if (result != DecodeResult::Ok || size != original)
+            MOE_THROW(BadFormatException, "Corrupted LZ4 block");
+        m_uBlockEnd = size;
+    }
+
+    m_uTotal += m_uBlockEnd;
+    return true;
+}
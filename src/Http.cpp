@@ -4,6 +4,7 @@
  * @date 2018/8/5
  */
 #include <Moe.Core/Http.hpp>
+#include <Moe.Core/ChainBuffer.hpp>
 
 using namespace std;
 using namespace moe;
@@ -1178,7 +1179,7 @@ size_t HttpParserBase::ParseImpl(BytesView input)
                                 ++m_uIndex;
                                 if (m_uIndex > strlen(kContentLength) || c != kContentLength[m_uIndex])
                                     m_uHeaderState = HEADER_STATE_GENERAL;
-                                else if (m_uIndex + 1 == sizeof(kContentLength))
+                                else if (m_uIndex + 1 == strlen(kContentLength))
                                     m_uHeaderState = HEADER_STATE_CONTENT_LENGTH;
                                 break;
                             case HEADER_STATE_MATCHING_TRANSFER_ENCODING:
@@ -1620,7 +1621,7 @@ size_t HttpParserBase::ParseImpl(BytesView input)
 
                         if (bodyMark)
                         {
-                            OnBody(BytesView(bodyMark, p - bodyMark));
+                            OnBody(BytesView(bodyMark, p - bodyMark + 1));  // p指向Body的最后一个字节
                             bodyMark = nullptr;
                         }
                         continue;
@@ -1950,6 +1951,23 @@ bool HttpProtocol::Parse(BytesView input, size_t* processed)
     return (m_uState == HTTP_STATE_COMPLETE || m_uState == HTTP_STATE_UPGRADED);
 }
 
+bool HttpProtocol::Parse(ChainBuffer& input)
+{
+    while (!input.IsEmpty())
+    {
+        auto segment = input.GetSegment(0);
+
+        size_t processed = 0;
+        auto done = Parse(segment, &processed);
+        input.Consume(processed);
+        if (done)
+            return true;
+        if (processed < segment.GetSize())
+            break;
+    }
+    return false;
+}
+
 bool HttpProtocol::IsUpgraded()const noexcept
 {
     if (m_stHeaders.Contains(kUpgradeString) && m_stHeaders.Contains(kConnectionString) &&
@@ -2211,6 +2229,13 @@ void WebSocketProtocol::Reset()noexcept
     m_uBodyRead = 0;
 }
 
+void WebSocketProtocol::Parse(ChainBuffer& input)
+{
+    for (size_t i = 0; i < input.GetSegmentCount(); ++i)
+        Parse(input.GetSegment(i));
+    input.Clear();
+}
+
 void WebSocketProtocol::ParseImpl(BytesView input)
 {
     auto p = input.GetBuffer();
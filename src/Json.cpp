@@ -10,6 +10,25 @@
 #include <algorithm>
 #include <climits>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOE_JSON_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// AVX2代码只在运行时检测到CPU支持后才会执行，因此不要求编译目标本身开启AVX2
+#if defined(MOE_JSON_USE_SSE2) && (defined(_MSC_VER) || defined(__GNUC__))
+#define MOE_JSON_USE_AVX2
+#include <immintrin.h>
+#if defined(__GNUC__)
+#define MOE_JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MOE_JSON_TARGET_AVX2
+#endif
+#endif
+
 using namespace std;
 using namespace moe;
 
@@ -113,6 +132,11 @@ JsonValue::JsonValue(NumberType val)noexcept
     Set(val);
 }
 
+JsonValue::JsonValue(IntegerType val)noexcept
+{
+    Set(val);
+}
+
 JsonValue::JsonValue(const StringType& val)
 {
     Set(val);
@@ -303,7 +327,7 @@ bool JsonValue::operator==(BoolType rhs)const noexcept
 
 bool JsonValue::operator==(NumberType rhs)const noexcept
 {
-    return m_iType == JsonValueTypes::Number && m_stValue.Number == rhs;
+    return m_iType == JsonValueTypes::Number && m_stValue.Number.Value == rhs;
 }
 
 bool JsonValue::operator==(const char* rhs)const noexcept
@@ -328,7 +352,9 @@ bool JsonValue::operator==(const JsonValue& rhs)const noexcept
         case JsonValueTypes::Bool:
             return m_stValue.Bool == rhs.m_stValue.Bool;
         case JsonValueTypes::Number:
-            return m_stValue.Number == rhs.m_stValue.Number;
+            if (m_stValue.Number.HasInteger && rhs.m_stValue.Number.HasInteger)
+                return m_stValue.Number.Integer == rhs.m_stValue.Number.Integer;
+            return m_stValue.Number.Value == rhs.m_stValue.Number.Value;
         case JsonValueTypes::String:
             return m_stValue.String == rhs.m_stValue.String;
         case JsonValueTypes::Array:
@@ -421,7 +447,19 @@ void JsonValue::Set(NumberType val)noexcept
 {
     Reset();
 
-    m_stValue.Number = val;
+    m_stValue.Number.Value = val;
+    m_stValue.Number.Integer = 0;
+    m_stValue.Number.HasInteger = false;
+    m_iType = JsonValueTypes::Number;
+}
+
+void JsonValue::Set(IntegerType val)noexcept
+{
+    Reset();
+
+    m_stValue.Number.Value = static_cast<NumberType>(val);
+    m_stValue.Number.Integer = val;
+    m_stValue.Number.HasInteger = true;
     m_iType = JsonValueTypes::Number;
 }
 
@@ -475,10 +513,7 @@ void JsonValue::Set(ObjectType&& val)
 
 void JsonValue::Set(int val)noexcept
 {
-    Reset();
-
-    m_stValue.Number = val;
-    m_iType = JsonValueTypes::Number;
+    Set(static_cast<IntegerType>(val));
 }
 
 void JsonValue::Set(const char* val)
@@ -509,6 +544,15 @@ void JsonValue::Set(std::initializer_list<JsonValue> val)
         m_stValue.Array.push_back(*it);
 }
 
+JsonValue::IntegerType JsonValue::GetInteger()const
+{
+    if (m_iType != JsonValueTypes::Number)
+        MOE_THROW(InvalidCallException, "Bad access from {0}", m_iType);
+    if (!m_stValue.Number.HasInteger)
+        MOE_THROW(InvalidCallException, "Number {0} is not an integer", m_stValue.Number.Value);
+    return m_stValue.Number.Integer;
+}
+
 size_t JsonValue::GetElementCount()const
 {
     switch (m_iType)
@@ -729,7 +773,11 @@ std::string& JsonValue::StringifyInline(std::string& str)const
 
                 auto pos = str.length();
                 str.resize(pos + kPreAllocate);
-                auto count = Convert::ToShortestString(m_stValue.Number, &str[pos], kPreAllocate);
+                size_t count = 0;
+                if (m_stValue.Number.HasInteger)
+                    count = Convert::ToDecimalString(m_stValue.Number.Integer, &str[pos], kPreAllocate);
+                else
+                    count = Convert::ToShortestString(m_stValue.Number.Value, &str[pos], kPreAllocate);
                 str.resize(pos + count);
             }
             break;
@@ -871,15 +919,480 @@ std::string& JsonValue::Stringify(std::string& str, uint32_t indent)const
     return str;
 }
 
+//////////////////////////////////////////////////////////////////////////////// JsonDocument
+
+const JsonDocument::Node JsonDocument::kNullNode = {};
+const size_t JsonDocument::kMaxInlineStringSize;
+
+class JsonDocument::Builder :
+    public JsonSaxViewHandler
+{
+    struct ContainerState
+    {
+        size_t Index;
+        size_t Count;
+    };
+
+public:
+    Builder(JsonDocument& document, ArrayView<char> input)
+        : m_stDocument(document), m_pInputBegin(input.GetBuffer()), m_pInputEnd(input.GetBuffer() + input.GetSize())
+    {
+        m_stDocument.Clear();
+    }
+
+    ~Builder()
+    {
+        // 解析失败时不保留不完整的文档
+        if (!m_bFinished)
+            m_stDocument.Clear();
+    }
+
+public:
+    void Finish()noexcept
+    {
+        assert(m_stStack.empty());
+        m_bFinished = true;
+    }
+
+protected:  // implement for JsonSaxViewHandler
+    void OnJsonNull()override
+    {
+        AddNode(NodeTypes::Null);
+    }
+
+    void OnJsonBool(JsonValue::BoolType val)override
+    {
+        AddNode(NodeTypes::Bool).Bool = val;
+    }
+
+    void OnJsonNumber(JsonValue::NumberType val)override
+    {
+        AddNode(NodeTypes::Number).Number = val;
+    }
+
+    void OnJsonInteger(JsonValue::IntegerType val)override
+    {
+        AddNode(NodeTypes::Integer).Integer = val;
+    }
+
+    void OnJsonString(ArrayView<char> val)override
+    {
+        if (!m_stStack.empty())
+            ++m_stStack.back().Count;
+        AddString(val);
+    }
+
+    void OnJsonArrayBegin()override
+    {
+        BeginContainer(NodeTypes::Array);
+    }
+
+    void OnJsonArrayEnd()override
+    {
+        EndContainer();
+    }
+
+    void OnJsonObjectBegin()override
+    {
+        BeginContainer(NodeTypes::Object);
+    }
+
+    void OnJsonObjectKey(ArrayView<char> key)override
+    {
+        AddString(key);
+    }
+
+    void OnJsonObjectEnd()override
+    {
+        EndContainer();
+    }
+
+private:
+    ValueNode& AddNode(NodeTypes type)
+    {
+        if (!m_stStack.empty())
+            ++m_stStack.back().Count;
+
+        auto& nodes = m_stDocument.m_stNodes;
+        nodes.emplace_back();
+        auto& node = nodes.back().Value;
+        node.Type = type;
+        return node;
+    }
+
+    void AddString(ArrayView<char> val)
+    {
+        auto size = val.GetSize();
+        if (size > numeric_limits<uint32_t>::max())
+            MOE_THROW(OutOfRangeException, "String is too long");
+
+        auto& nodes = m_stDocument.m_stNodes;
+        nodes.emplace_back();
+        auto& node = nodes.back();
+        if (size <= kMaxInlineStringSize)
+        {
+            node.Inline.Type = NodeTypes::InlineString;
+            node.Inline.Size = static_cast<uint8_t>(size);
+            if (size > 0)
+                ::memcpy(node.Inline.Chars, val.GetBuffer(), size);
+            return;
+        }
+
+        node.Value.Type = NodeTypes::String;
+        node.Value.Size = static_cast<uint32_t>(size);
+        if (val.GetBuffer() >= m_pInputBegin && val.GetBuffer() + size <= m_pInputEnd)
+        {
+            node.Value.String = val.GetBuffer();
+            return;
+        }
+
+        // 含转义的字符串只在回调期间有效，需要拷贝一份
+        auto& arena = m_stDocument.m_pArena;
+        if (!arena)
+            arena.reset(new Arena());
+        auto p = static_cast<char*>(arena->Alloc(size, 1));
+        ::memcpy(p, val.GetBuffer(), size);
+        node.Value.String = p;
+    }
+
+    void BeginContainer(NodeTypes type)
+    {
+        AddNode(type);
+
+        ContainerState state = { m_stDocument.m_stNodes.size() - 1, 0 };
+        m_stStack.push_back(state);
+    }
+
+    void EndContainer()
+    {
+        assert(!m_stStack.empty());
+
+        auto& state = m_stStack.back();
+        if (state.Count > numeric_limits<uint32_t>::max())
+            MOE_THROW(OutOfRangeException, "Too many elements in container");
+
+        auto& nodes = m_stDocument.m_stNodes;
+        auto& node = nodes[state.Index].Value;
+        node.Size = static_cast<uint32_t>(state.Count);
+        node.Span = nodes.size() - state.Index;
+        m_stStack.pop_back();
+    }
+
+private:
+    JsonDocument& m_stDocument;
+    const char* m_pInputBegin = nullptr;
+    const char* m_pInputEnd = nullptr;
+    vector<ContainerState> m_stStack;
+    bool m_bFinished = false;
+};
+
+JsonValueTypes JsonDocument::Cursor::GetType()const noexcept
+{
+    switch (m_pNode->Value.Type)
+    {
+        case NodeTypes::Bool:
+            return JsonValueTypes::Bool;
+        case NodeTypes::Number:
+        case NodeTypes::Integer:
+            return JsonValueTypes::Number;
+        case NodeTypes::String:
+        case NodeTypes::InlineString:
+            return JsonValueTypes::String;
+        case NodeTypes::Array:
+            return JsonValueTypes::Array;
+        case NodeTypes::Object:
+            return JsonValueTypes::Object;
+        default:
+            return JsonValueTypes::Null;
+    }
+}
+
+JsonValue::BoolType JsonDocument::Cursor::GetBool()const
+{
+    if (m_pNode->Value.Type != NodeTypes::Bool)
+        MOE_THROW(InvalidCallException, "Bad access from {0}", GetType());
+    return m_pNode->Value.Bool;
+}
+
+JsonValue::NumberType JsonDocument::Cursor::GetNumber()const
+{
+    if (m_pNode->Value.Type == NodeTypes::Integer)
+        return static_cast<JsonValue::NumberType>(m_pNode->Value.Integer);
+    if (m_pNode->Value.Type != NodeTypes::Number)
+        MOE_THROW(InvalidCallException, "Bad access from {0}", GetType());
+    return m_pNode->Value.Number;
+}
+
+JsonValue::IntegerType JsonDocument::Cursor::GetInteger()const
+{
+    if (m_pNode->Value.Type == NodeTypes::Number)
+        MOE_THROW(InvalidCallException, "Number {0} is not an integer", m_pNode->Value.Number);
+    if (m_pNode->Value.Type != NodeTypes::Integer)
+        MOE_THROW(InvalidCallException, "Bad access from {0}", GetType());
+    return m_pNode->Value.Integer;
+}
+
+ArrayView<char> JsonDocument::Cursor::GetString()const
+{
+    if (m_pNode->Value.Type != NodeTypes::String && m_pNode->Value.Type != NodeTypes::InlineString)
+        MOE_THROW(InvalidCallException, "Bad access from {0}", GetType());
+    return GetStringOf(m_pNode);
+}
+
+size_t JsonDocument::Cursor::GetElementCount()const
+{
+    if (m_pNode->Value.Type != NodeTypes::Array && m_pNode->Value.Type != NodeTypes::Object)
+        MOE_THROW(InvalidCallException, "Bad operation on type {0}", GetType());
+    return m_pNode->Value.Size;
+}
+
+JsonDocument::Cursor JsonDocument::Cursor::GetElementByIndex(size_t index)const
+{
+    if (m_pNode->Value.Type != NodeTypes::Array)
+        MOE_THROW(InvalidCallException, "Bad operation on type {0}", GetType());
+    if (index >= m_pNode->Value.Size)
+        MOE_THROW(OutOfRangeException, "Index {0} out of range", index);
+
+    auto p = m_pNode + 1;
+    for (size_t i = 0; i < index; ++i)
+        p = Skip(p);
+    return Cursor(p);
+}
+
+JsonDocument::Cursor JsonDocument::Cursor::GetElementByKey(ArrayView<char> key)const
+{
+    auto p = FindElement(key);
+    if (!p)
+        MOE_THROW(ObjectNotFoundException, "Key \"{0}\" not found", string(key.GetBuffer(), key.GetSize()));
+    return Cursor(p);
+}
+
+JsonDocument::Iterator JsonDocument::Cursor::begin()const
+{
+    if (m_pNode->Value.Type != NodeTypes::Array && m_pNode->Value.Type != NodeTypes::Object)
+        MOE_THROW(InvalidCallException, "Bad operation on type {0}", GetType());
+    return Iterator(m_pNode + 1, m_pNode->Value.Type == NodeTypes::Object);
+}
+
+JsonDocument::Iterator JsonDocument::Cursor::end()const
+{
+    if (m_pNode->Value.Type != NodeTypes::Array && m_pNode->Value.Type != NodeTypes::Object)
+        MOE_THROW(InvalidCallException, "Bad operation on type {0}", GetType());
+    return Iterator(Skip(m_pNode), m_pNode->Value.Type == NodeTypes::Object);
+}
+
+JsonValue JsonDocument::Cursor::ToJsonValue()const
+{
+    switch (m_pNode->Value.Type)
+    {
+        case NodeTypes::Bool:
+            return JsonValue(m_pNode->Value.Bool);
+        case NodeTypes::Number:
+            return JsonValue(m_pNode->Value.Number);
+        case NodeTypes::Integer:
+            return JsonValue(m_pNode->Value.Integer);
+        case NodeTypes::String:
+        case NodeTypes::InlineString:
+            return JsonValue(GetStringOf(m_pNode));
+        case NodeTypes::Array:
+            {
+                JsonValue ret = JsonValue::ArrayType();
+                ret.Get<JsonValue::ArrayType>().reserve(m_pNode->Value.Size);
+                for (auto it = begin(); it != end(); ++it)
+                    ret.Append((*it).ToJsonValue());
+                return ret;
+            }
+        case NodeTypes::Object:
+            {
+                JsonValue ret = JsonValue::ObjectType();
+                for (auto it = begin(); it != end(); ++it)
+                {
+                    auto key = it.GetKey();
+                    ret.Append(string(key.GetBuffer(), key.GetSize()), (*it).ToJsonValue());
+                }
+                return ret;
+            }
+        default:
+            return JsonValue();
+    }
+}
+
+const JsonDocument::Node* JsonDocument::Cursor::FindElement(ArrayView<char> key)const
+{
+    if (m_pNode->Value.Type != NodeTypes::Object)
+        MOE_THROW(InvalidCallException, "Bad operation on type {0}", GetType());
+
+    // 成员按键、值交替存放
+    auto p = m_pNode + 1;
+    for (size_t i = 0; i < m_pNode->Value.Size; ++i)
+    {
+        auto name = GetStringOf(p);
+        if (name.GetSize() == key.GetSize() && (key.GetSize() == 0 ||
+            ::memcmp(name.GetBuffer(), key.GetBuffer(), key.GetSize()) == 0))
+        {
+            return p + 1;
+        }
+        p = Skip(p + 1);
+    }
+    return nullptr;
+}
+
 //////////////////////////////////////////////////////////////////////////////// Json5
 
 namespace
 {
+    /**
+     * @brief 十进制数字累加器
+     *
+     * 解析器在扫描数字时逐位送入，最多在64位整数中保留19位有效数字：整数部分多出的数字计入指数，小数部分多出的数字被
+     * 丢弃。只要丢弃的都是0，结果就是精确的，可以直接得出整数或经由Convert的快速路径得出double；否则需要由调用方
+     * 回退到Convert::ParseDouble，以Bignum完成精确转换。
+     */
+    class DecimalAccumulator
+    {
+    public:
+        static const int kMaxSignificantDigits = 19;
+        static const int kMaxExplicitExponent = 100000;
+
+    public:
+        void Reset()noexcept
+        {
+            m_uSignificand = 0;
+            m_iDigits = 0;
+            m_iExponent = 0;
+            m_iExplicitExponent = 0;
+            m_bExplicitExponentNegative = false;
+            m_bIntegral = true;
+            m_bExact = true;
+            m_bHasDigits = false;
+            m_bExpectExponentDigit = false;
+        }
+
+        void AddIntegerDigit(char ch)noexcept
+        {
+            m_bHasDigits = true;
+            if (m_iDigits < kMaxSignificantDigits)
+            {
+                if (m_uSignificand != 0 || ch != '0')
+                {
+                    m_uSignificand = m_uSignificand * 10 + static_cast<uint64_t>(ch - '0');
+                    ++m_iDigits;
+                }
+            }
+            else
+            {
+                ++m_iExponent;
+                if (ch != '0')
+                    m_bExact = false;
+            }
+        }
+
+        void BeginFraction()noexcept
+        {
+            m_bIntegral = false;
+        }
+
+        void AddFractionDigit(char ch)noexcept
+        {
+            m_bHasDigits = true;
+            if (m_iDigits < kMaxSignificantDigits)
+            {
+                if (m_uSignificand != 0 || ch != '0')
+                {
+                    m_uSignificand = m_uSignificand * 10 + static_cast<uint64_t>(ch - '0');
+                    ++m_iDigits;
+                }
+                --m_iExponent;
+            }
+            else if (ch != '0')
+                m_bExact = false;
+        }
+
+        void BeginExponent(bool negative)noexcept
+        {
+            m_bIntegral = false;
+            m_bExplicitExponentNegative = negative;
+            m_bExpectExponentDigit = true;
+        }
+
+        void AddExponentDigit(char ch)noexcept
+        {
+            m_bExpectExponentDigit = false;
+            if (m_iExplicitExponent < kMaxExplicitExponent)
+                m_iExplicitExponent = m_iExplicitExponent * 10 + (ch - '0');
+            else
+                m_bExact = false;  // 交由回退路径处理
+        }
+
+        /**
+         * @brief 转换到整数
+         * @param negative 是否带有负号
+         * @param[out] result 结果
+         * @return 是否为IntegerType范围内的整数
+         *
+         * "-0"不被视作整数，以保留double的符号。
+         */
+        bool ToInteger(bool negative, JsonValue::IntegerType& result)const noexcept
+        {
+            static const uint64_t kMaxPositive = static_cast<uint64_t>(numeric_limits<int64_t>::max());
+
+            if (!m_bIntegral || !m_bExact || !m_bHasDigits || m_iExponent != 0)
+                return false;
+
+            if (!negative)
+            {
+                if (m_uSignificand > kMaxPositive)
+                    return false;
+                result = static_cast<int64_t>(m_uSignificand);
+            }
+            else
+            {
+                if (m_uSignificand == 0 || m_uSignificand > kMaxPositive + 1)
+                    return false;
+                result = (m_uSignificand == kMaxPositive + 1) ? numeric_limits<int64_t>::min() :
+                    -static_cast<int64_t>(m_uSignificand);
+            }
+            return true;
+        }
+
+        /**
+         * @brief 转换到浮点数
+         * @param negative 是否带有负号
+         * @param[out] result 结果
+         * @return 是否转换成功，失败时需要回退到Convert::ParseDouble
+         */
+        bool ToDouble(bool negative, double& result)const noexcept
+        {
+            if (!m_bExact || !m_bHasDigits || m_bExpectExponentDigit)
+                return false;
+
+            auto exponent = m_iExponent + (m_bExplicitExponentNegative ? -m_iExplicitExponent : m_iExplicitExponent);
+            if (!Convert::details::StringToDoubleConverter<char>::FastStrtod(m_uSignificand,
+                static_cast<size_t>(m_iDigits), exponent, result))
+                return false;
+
+            if (negative)
+                result = -result;
+            return true;
+        }
+
+    private:
+        uint64_t m_uSignificand = 0;
+        int m_iDigits = 0;
+        int m_iExponent = 0;
+        int m_iExplicitExponent = 0;
+        bool m_bExplicitExponentNegative = false;
+        bool m_bIntegral = true;
+        bool m_bExact = true;
+        bool m_bHasDigits = false;
+        bool m_bExpectExponentDigit = false;
+    };
+
     class Json5Parser :
         public Parser
     {
     public:
-        Json5Parser(JsonSaxHandler* handler)
+        Json5Parser(JsonSaxViewHandler* handler)
             : m_pHandler(handler) {}
 
     public:
@@ -1089,15 +1602,16 @@ namespace
             }
 
             int base = 10;
+            auto& reader = *GetReader();
+            auto start = reader.GetPosition();
 
-            m_stStringBuffer.clear();
+            m_stNumber.Reset();
             if (c == '0')
             {
-                m_stStringBuffer.push_back(Next());
+                Next();
 
                 if (c == 'x' || c == 'X')
                 {
-                    m_stStringBuffer.push_back('x');
                     Next();
 
                     if (!(('0' <= c && c <= '9') || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F')))
@@ -1107,69 +1621,85 @@ namespace
                 }
                 else if ('0' <= c && c <= '9')
                     ThrowError("Unexpected character {0}", PrintChar(c));
+                else
+                    m_stNumber.AddIntegerDigit('0');
             }
 
             switch (base)
             {
                 case 10:
                     while ('0' <= c && c <= '9')
-                        m_stStringBuffer.push_back(Next());
+                        m_stNumber.AddIntegerDigit(Next());
 
                     if (c == '.')
                     {
-                        m_stStringBuffer.push_back(Next());
+                        Next();
+                        m_stNumber.BeginFraction();
 
                         while ('0' <= c && c <= '9')
-                            m_stStringBuffer.push_back(Next());
+                            m_stNumber.AddFractionDigit(Next());
                     }
                     if (c == 'e' || c == 'E')
                     {
-                        m_stStringBuffer.push_back(Next());
+                        Next();
 
+                        bool negative = false;
                         if (c == '-' || c == '+')
-                            m_stStringBuffer.push_back(Next());
+                            negative = (Next() == '-');
+                        m_stNumber.BeginExponent(negative);
 
                         while ('0' <= c && c <= '9')
-                            m_stStringBuffer.push_back(Next());
+                            m_stNumber.AddExponentDigit(Next());
                     }
                     break;
                 case 16:
                     while (('0' <= c && c <= '9') || ('A' <= c && c <= 'F') || ('a' <= c && c <= 'f'))
-                        m_stStringBuffer.push_back(Next());
+                        Next();
                     break;
                 default:
                     assert(false);
                     break;
             }
 
+            // 数字中不含换行，直接从输入中取出原文，无需逐字符拷贝
+            auto text = reader.GetBuffer().Slice(start, reader.GetPosition());
             if (base == 16)
             {
                 size_t processed = 0;
-                auto result = Convert::ParseInt(m_stStringBuffer.c_str(), m_stStringBuffer.length(), processed);
-                if (processed != m_stStringBuffer.length())
-                    ThrowError("Parse int \"{0}\" failed", m_stStringBuffer);
+                auto result = Convert::ParseInt(text.GetBuffer(), text.GetSize(), processed);
+                if (processed != text.GetSize())
+                    ThrowError("Parse int \"{0}\" failed", string(text.GetBuffer(), text.GetSize()));
 
                 result = (sign == '-' ? -result : result);
 
-                m_pHandler->OnJsonNumber(static_cast<JsonValue::NumberType>(result));
+                m_pHandler->OnJsonInteger(result);
             }
             else
             {
-                size_t processed = 0;
-                auto result = Convert::ParseDouble(m_stStringBuffer.c_str(), m_stStringBuffer.length(), processed);
-                if (processed != m_stStringBuffer.length())
-                    ThrowError("Parse double \"{0}\" failed", m_stStringBuffer);
+                JsonValue::IntegerType integer = 0;
+                double result = 0;
+                if (m_stNumber.ToInteger(sign == '-', integer))
+                    m_pHandler->OnJsonInteger(integer);
+                else if (m_stNumber.ToDouble(sign == '-', result))
+                    m_pHandler->OnJsonNumber(result);
+                else
+                {
+                    size_t processed = 0;
+                    result = Convert::ParseDouble(text.GetBuffer(), text.GetSize(), processed);
+                    if (processed != text.GetSize())
+                        ThrowError("Parse double \"{0}\" failed", string(text.GetBuffer(), text.GetSize()));
 
-                result = (sign == '-' ? -result : result);
+                    result = (sign == '-' ? -result : result);
 
-                m_pHandler->OnJsonNumber(result);
+                    m_pHandler->OnJsonNumber(result);
+                }
             }
         }
 
         void ParseString()
         {
             ReadString();
-            m_pHandler->OnJsonString(m_stStringBuffer);
+            m_pHandler->OnJsonString(ToArrayView<char>(m_stStringBuffer));
         }
 
         void ParseArray()
@@ -1230,7 +1760,7 @@ namespace
                 else
                     ReadIdentifier();
 
-                m_pHandler->OnJsonObjectKey(m_stStringBuffer);
+                m_pHandler->OnJsonObjectKey(ToArrayView<char>(m_stStringBuffer));
 
                 SkipIgnorable();
                 Accept(':');
@@ -1350,70 +1880,153 @@ namespace
         }
 
     public:
-        JsonSaxHandler* m_pHandler = nullptr;
+        JsonSaxViewHandler* m_pHandler = nullptr;
         std::string m_stStringBuffer;
+        DecimalAccumulator m_stNumber;
     };
 
-    class SaxHandler :
-        public JsonSaxHandler
+    /**
+     * @brief 将零拷贝的事件转发给JsonSaxHandler
+     */
+    class SaxHandlerAdapter :
+        public JsonSaxViewHandler
     {
     public:
-        SaxHandler(JsonValue& out)
-        {
-            m_stStack.push(&out);
-        }
+        SaxHandlerAdapter(JsonSaxHandler* handler)
+            : m_pHandler(handler) {}
 
-    protected:  // implement for JsonSaxHandler
+    protected:  // implement for JsonSaxViewHandler
         void OnJsonNull()override
         {
-            JsonValue& top = *m_stStack.top();
-
-            if (m_stStack.size() == 1)
-                top.Reset();
-            else if (top.Is<JsonValue::ArrayType>())
-                top.Append(JsonValue());
-            else if (top.Is<JsonValue::ObjectType>())
-                top.Append(m_stKey, JsonValue());
-            else
-                assert(false);
+            m_pHandler->OnJsonNull();
         }
 
         void OnJsonBool(JsonValue::BoolType val)override
         {
-            JsonValue& top = *m_stStack.top();
-
-            if (m_stStack.size() == 1)
-                top.Set(val);
-            else if (top.Is<JsonValue::ArrayType>())
-                top.Append(JsonValue(val));
-            else if (top.Is<JsonValue::ObjectType>())
-                top.Append(m_stKey, JsonValue(val));
-            else
-                assert(false);
+            m_pHandler->OnJsonBool(val);
         }
 
         void OnJsonNumber(JsonValue::NumberType val)override
         {
-            JsonValue& top = *m_stStack.top();
+            m_pHandler->OnJsonNumber(val);
+        }
 
-            if (m_stStack.size() == 1)
-                top.Set(val);
-            else if (top.Is<JsonValue::ArrayType>())
-                top.Append(JsonValue(val));
-            else if (top.Is<JsonValue::ObjectType>())
-                top.Append(m_stKey, JsonValue(val));
-            else
-                assert(false);
+        void OnJsonInteger(JsonValue::IntegerType val)override
+        {
+            m_pHandler->OnJsonInteger(val);
         }
 
-        void OnJsonString(const JsonValue::StringType& val)override
+        void OnJsonString(ArrayView<char> val)override
         {
-            JsonValue& top = *m_stStack.top();
+            m_stBuffer.assign(val.GetBuffer(), val.GetSize());
+            m_pHandler->OnJsonString(m_stBuffer);
+        }
 
-            if (m_stStack.size() == 1)
-                top.Set(val);
-            else if (top.Is<JsonValue::ArrayType>())
-                top.Append(JsonValue(val));
+        void OnJsonArrayBegin()override
+        {
+            m_pHandler->OnJsonArrayBegin();
+        }
+
+        void OnJsonArrayEnd()override
+        {
+            m_pHandler->OnJsonArrayEnd();
+        }
+
+        void OnJsonObjectBegin()override
+        {
+            m_pHandler->OnJsonObjectBegin();
+        }
+
+        void OnJsonObjectKey(ArrayView<char> key)override
+        {
+            m_stBuffer.assign(key.GetBuffer(), key.GetSize());
+            m_pHandler->OnJsonObjectKey(m_stBuffer);
+        }
+
+        void OnJsonObjectEnd()override
+        {
+            m_pHandler->OnJsonObjectEnd();
+        }
+
+    private:
+        JsonSaxHandler* m_pHandler = nullptr;
+        string m_stBuffer;
+    };
+
+    class SaxHandler :
+        public JsonSaxViewHandler
+    {
+    public:
+        SaxHandler(JsonValue& out)
+        {
+            m_stStack.push(&out);
+        }
+
+    protected:  // implement for JsonSaxViewHandler
+        void OnJsonNull()override
+        {
+            JsonValue& top = *m_stStack.top();
+
+            if (m_stStack.size() == 1)
+                top.Reset();
+            else if (top.Is<JsonValue::ArrayType>())
+                top.Append(JsonValue());
+            else if (top.Is<JsonValue::ObjectType>())
+                top.Append(m_stKey, JsonValue());
+            else
+                assert(false);
+        }
+
+        void OnJsonBool(JsonValue::BoolType val)override
+        {
+            JsonValue& top = *m_stStack.top();
+
+            if (m_stStack.size() == 1)
+                top.Set(val);
+            else if (top.Is<JsonValue::ArrayType>())
+                top.Append(JsonValue(val));
+            else if (top.Is<JsonValue::ObjectType>())
+                top.Append(m_stKey, JsonValue(val));
+            else
+                assert(false);
+        }
+
+        void OnJsonNumber(JsonValue::NumberType val)override
+        {
+            JsonValue& top = *m_stStack.top();
+
+            if (m_stStack.size() == 1)
+                top.Set(val);
+            else if (top.Is<JsonValue::ArrayType>())
+                top.Append(JsonValue(val));
+            else if (top.Is<JsonValue::ObjectType>())
+                top.Append(m_stKey, JsonValue(val));
+            else
+                assert(false);
+        }
+
+        void OnJsonInteger(JsonValue::IntegerType val)override
+        {
+            JsonValue& top = *m_stStack.top();
+
+            if (m_stStack.size() == 1)
+                top.Set(val);
+            else if (top.Is<JsonValue::ArrayType>())
+                top.Append(JsonValue(val));
+            else if (top.Is<JsonValue::ObjectType>())
+                top.Append(m_stKey, JsonValue(val));
+            else
+                assert(false);
+        }
+
+        void OnJsonString(ArrayView<char> val)override
+        {
+            JsonValue& top = *m_stStack.top();
+
+            if (m_stStack.size() == 1)
+                top.Set(val);
+            else if (top.Is<JsonValue::ArrayType>())
+                top.Append(JsonValue(val));
             else if (top.Is<JsonValue::ObjectType>())
                 top.Append(m_stKey, JsonValue(val));
             else
@@ -1476,9 +2089,9 @@ namespace
                 assert(false);
         }
 
-        void OnJsonObjectKey(const std::string& key)override
+        void OnJsonObjectKey(ArrayView<char> key)override
         {
-            m_stKey = key;
+            m_stKey.assign(key.GetBuffer(), key.GetSize());
         }
 
         void OnJsonObjectEnd()override
@@ -1498,6 +2111,12 @@ namespace
 }
 
 void Json5::Parse(JsonSaxHandler* handler, ArrayView<char> data, const char* source)
+{
+    SaxHandlerAdapter adapter(handler);
+    Parse(&adapter, data, source);
+}
+
+void Json5::Parse(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source)
 {
     Json5Parser parser(handler);
     TextReader reader(data, source);
@@ -1513,3 +2132,1158 @@ void Json5::Parse(JsonValue& out, ArrayView<char> data, const char* source)
 
     parser.Run(reader);
 }
+
+void Json5::Parse(JsonDocument& out, ArrayView<char> data, const char* source)
+{
+    JsonDocument::Builder builder(out, data);
+    Json5Parser parser(&builder);
+    TextReader reader(data, source);
+
+    parser.Run(reader);
+    builder.Finish();
+}
+
+//////////////////////////////////////////////////////////////////////////////// Json
+
+namespace
+{
+#ifdef MOE_JSON_USE_SSE2
+    inline unsigned FirstSetBit(unsigned mask)noexcept
+    {
+        assert(mask != 0);
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+#endif
+
+    /**
+     * @brief 严格JSON解析器的公共部分
+     *
+     * 不经过TextReader，直接在指针上扫描。行列号只在抛出异常时从头计算，规则与TextReader一致。
+     */
+    class JsonParserBase
+    {
+    public:
+        JsonParserBase(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source)
+            : m_pHandler(handler), m_pSource(source), m_pBegin(data.GetBuffer()),
+            m_pEnd(data.GetBuffer() + data.GetSize()), m_pCurrent(data.GetBuffer()) {}
+
+    protected:
+        static bool IsWhitespace(char ch)noexcept
+        {
+            return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+        }
+
+        static bool IsDigit(char ch)noexcept
+        {
+            return '0' <= ch && ch <= '9';
+        }
+
+        static bool IsStringStop(char ch)noexcept
+        {
+            return ch == '"' || ch == '\\' || static_cast<uint8_t>(ch) <= 0x1F;
+        }
+
+        char CharAt(const char* p)const noexcept
+        {
+            return p < m_pEnd ? *p : '\0';
+        }
+
+        template <typename... Args>
+        void ThrowError(const char* at, const char* format, const Args&... args)
+        {
+            assert(m_pBegin <= at && at <= m_pEnd);
+
+            uint32_t line = 1;
+            uint32_t column = 1;
+            for (auto p = m_pBegin; p < at; ++p)
+            {
+                ++column;
+                if (*p == '\n' || (*p == '\r' && CharAt(p + 1) != '\n'))
+                {
+                    ++line;
+                    column = 1;
+                }
+            }
+            auto position = static_cast<size_t>(at - m_pBegin);
+
+            LexicalException ex;
+            ex.SetSourceFile(__FILE__);
+            ex.SetFunctionName(__FUNCTION__);
+            ex.SetLineNumber(__LINE__);
+            ex.SetDescription(StringUtils::Format("{0}:{1}:{2}:{3}: {4}", m_pSource, position, line, column,
+                StringUtils::Format(format, args...)));
+
+            // 额外数据
+            ex.SetInfo("SourceName", m_pSource);
+            ex.SetInfo("Position", position);
+            ex.SetInfo("Line", line);
+            ex.SetInfo("Column", column);
+
+            throw ex;
+        }
+
+        const char* ScanString(const char* p)const noexcept
+        {
+#ifdef MOE_JSON_USE_SSE2
+            const auto quote = _mm_set1_epi8('"');
+            const auto backslash = _mm_set1_epi8('\\');
+            const auto control = _mm_set1_epi8(0x1F);
+            while (m_pEnd - p >= 16)
+            {
+                auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+                // 无符号比较x <= 0x1F等价于max(x, 0x1F) == 0x1F
+                auto stop = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                    _mm_cmpeq_epi8(chunk, backslash)), _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+                auto mask = static_cast<unsigned>(_mm_movemask_epi8(stop));
+                if (mask != 0)
+                    return p + FirstSetBit(mask);
+                p += 16;
+            }
+#endif
+
+            while (p < m_pEnd && !IsStringStop(*p))
+                ++p;
+            return p;
+        }
+
+        void BufferUnicodeCharacter(const char* at, char32_t ch)
+        {
+            uint32_t count = 0;
+            array<char, Encoding::Utf8::Encoder::kMaxOutputCount> buffer;
+            Encoding::Utf8::Encoder encoder;
+
+            if (Encoding::EncodingResult::Accept != encoder(ch, buffer, count))
+                ThrowError(at, "Encoding {0} to utf-8 failed", (int)ch);
+
+            m_stStringBuffer.append(buffer.data(), count);
+        }
+
+        char32_t ReadHex4(const char* p)
+        {
+            char32_t u32 = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                int hex = 0;
+                if (!StringUtils::HexDigitToNumber(hex, CharAt(p + i)))
+                {
+                    ThrowError(std::min(p + i, m_pEnd), "Unexpected hex character {0}",
+                        Parser::PrintChar(CharAt(p + i)));
+                }
+                u32 = (u32 << 4) + hex;
+            }
+            return u32;
+        }
+
+        const char* ReadEscape(const char* p)
+        {
+            assert(*p == '\\');
+
+            char ch = CharAt(p + 1);
+            switch (ch)
+            {
+                case '"':
+                    m_stStringBuffer.push_back('"');
+                    break;
+                case '\\':
+                    m_stStringBuffer.push_back('\\');
+                    break;
+                case '/':
+                    m_stStringBuffer.push_back('/');
+                    break;
+                case 'b':
+                    m_stStringBuffer.push_back('\b');
+                    break;
+                case 'f':
+                    m_stStringBuffer.push_back('\f');
+                    break;
+                case 'n':
+                    m_stStringBuffer.push_back('\n');
+                    break;
+                case 'r':
+                    m_stStringBuffer.push_back('\r');
+                    break;
+                case 't':
+                    m_stStringBuffer.push_back('\t');
+                    break;
+                case 'u':
+                    {
+                        auto start = p;
+                        char32_t u32 = ReadHex4(p + 2);
+                        p += 6;
+
+                        // 代理对必须成对出现并被合并
+                        if (0xD800 <= u32 && u32 <= 0xDBFF)
+                        {
+                            if (CharAt(p) != '\\' || CharAt(p + 1) != 'u')
+                                ThrowError(std::min(p, m_pEnd), "Expect low surrogate");
+                            char32_t low = ReadHex4(p + 2);
+                            if (low < 0xDC00 || low > 0xDFFF)
+                                ThrowError(p, "Bad low surrogate {0}", (int)low);
+                            u32 = 0x10000 + ((u32 - 0xD800) << 10) + (low - 0xDC00);
+                            p += 6;
+                        }
+                        else if (0xDC00 <= u32 && u32 <= 0xDFFF)
+                            ThrowError(start, "Unexpected low surrogate {0}", (int)u32);
+
+                        BufferUnicodeCharacter(start, u32);
+                    }
+                    return p;
+                default:
+                    if (p + 1 >= m_pEnd)
+                        ThrowError(m_pEnd, "Unterminated string");
+                    ThrowError(p + 1, "Unexpected escape character {0}", Parser::PrintChar(ch));
+                    break;
+            }
+            return p + 2;
+        }
+
+        ArrayView<char> ReadString()
+        {
+            assert(*m_pCurrent == '"');
+
+            // 没有转义的字符串直接引用输入数据
+            auto p = m_pCurrent + 1;
+            auto stop = ScanString(p);
+            if (stop != m_pEnd && *stop == '"')
+            {
+                m_pCurrent = stop + 1;
+                return ArrayView<char>(p, static_cast<size_t>(stop - p));
+            }
+
+            m_stStringBuffer.clear();
+            while (true)
+            {
+                m_stStringBuffer.append(p, stop);
+
+                if (stop == m_pEnd)
+                    ThrowError(stop, "Unterminated string");
+                else if (*stop == '"')
+                {
+                    m_pCurrent = stop + 1;
+                    return ToArrayView<char>(m_stStringBuffer);
+                }
+                else if (*stop == '\\')
+                    p = ReadEscape(stop);
+                else
+                    ThrowError(stop, "Unexpected character {0}", Parser::PrintChar(*stop));  // 控制字符必须被escape
+
+                stop = ScanString(p);
+            }
+        }
+
+        void AcceptWord(const char* word, size_t length)
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                auto ch = CharAt(m_pCurrent + i);
+                if (ch != word[i])
+                {
+                    ThrowError(std::min(m_pCurrent + i, m_pEnd), "Expect {0}, but found {1}",
+                        Parser::PrintChar(word[i]), Parser::PrintChar(ch));
+                }
+            }
+            m_pCurrent += length;
+        }
+
+        void ParseNumber()
+        {
+            auto p = m_pCurrent;
+            bool negative = false;
+
+            if (*p == '-')
+            {
+                negative = true;
+                ++p;
+            }
+
+            // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+            // 扫描的同时累加有效数字，通常无需再经过Convert::ParseDouble
+            auto start = p;
+            m_stNumber.Reset();
+            if (CharAt(p) == '0')
+                m_stNumber.AddIntegerDigit(*p++);
+            else if (IsDigit(CharAt(p)))
+            {
+                do
+                {
+                    m_stNumber.AddIntegerDigit(*p);
+                } while (IsDigit(CharAt(++p)));
+            }
+            else
+                ThrowError(std::min(p, m_pEnd), "Unexpected character {0}", Parser::PrintChar(CharAt(p)));
+
+            if (CharAt(p) == '.')
+            {
+                m_stNumber.BeginFraction();
+                if (!IsDigit(CharAt(++p)))
+                    ThrowError(std::min(p, m_pEnd), "Unexpected character {0}", Parser::PrintChar(CharAt(p)));
+                do
+                {
+                    m_stNumber.AddFractionDigit(*p);
+                } while (IsDigit(CharAt(++p)));
+            }
+
+            char ch = CharAt(p);
+            if (ch == 'e' || ch == 'E')
+            {
+                ch = CharAt(++p);
+                m_stNumber.BeginExponent(ch == '-');
+                if (ch == '+' || ch == '-')
+                    ch = CharAt(++p);
+                if (!IsDigit(ch))
+                    ThrowError(std::min(p, m_pEnd), "Unexpected character {0}", Parser::PrintChar(ch));
+                do
+                {
+                    m_stNumber.AddExponentDigit(*p);
+                } while (IsDigit(CharAt(++p)));
+            }
+
+            JsonValue::IntegerType integer = 0;
+            if (m_stNumber.ToInteger(negative, integer))
+            {
+                m_pCurrent = p;
+                m_pHandler->OnJsonInteger(integer);
+                return;
+            }
+
+            double result = 0;
+            if (!m_stNumber.ToDouble(negative, result))
+            {
+                size_t processed = 0;
+                auto length = static_cast<size_t>(p - start);
+                result = Convert::ParseDouble(start, length, processed);
+                if (processed != length)
+                    ThrowError(start, "Parse double \"{0}\" failed", string(start, length));
+                result = negative ? -result : result;
+            }
+
+            m_pCurrent = p;
+            m_pHandler->OnJsonNumber(result);
+        }
+
+    protected:
+        JsonSaxViewHandler* m_pHandler = nullptr;
+        const char* m_pSource = nullptr;
+        const char* m_pBegin = nullptr;
+        const char* m_pEnd = nullptr;
+        const char* m_pCurrent = nullptr;
+        std::string m_stStringBuffer;
+        DecimalAccumulator m_stNumber;
+    };
+
+    /**
+     * @brief 严格JSON解析器
+     *
+     * 单遍扫描，边跳过空白边解析。
+     */
+    class JsonParser :
+        public JsonParserBase
+    {
+    public:
+        JsonParser(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source)
+            : JsonParserBase(handler, data, source) {}
+
+    public:
+        void Run()
+        {
+            m_stStringBuffer.clear();
+
+            SkipWhitespace();
+            ParseValue();
+            SkipWhitespace();
+
+            if (m_pCurrent != m_pEnd)
+                ThrowError(m_pCurrent, "Bad tailing character {0}", Parser::PrintChar(*m_pCurrent));
+        }
+
+    private:
+        void SkipWhitespace()noexcept
+        {
+            auto p = m_pCurrent;
+
+            // 紧凑的JSON中值之间通常没有空白，先判断一次以免进入向量化路径
+            if (p == m_pEnd || !IsWhitespace(*p))
+                return;
+
+#ifdef MOE_JSON_USE_SSE2
+            const auto space = _mm_set1_epi8(' ');
+            const auto tab = _mm_set1_epi8('\t');
+            const auto lf = _mm_set1_epi8('\n');
+            const auto cr = _mm_set1_epi8('\r');
+            while (m_pEnd - p >= 16)
+            {
+                auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                auto ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+                auto mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFFu;
+                if (mask != 0)
+                {
+                    m_pCurrent = p + FirstSetBit(mask);
+                    return;
+                }
+                p += 16;
+            }
+#endif
+
+            while (p < m_pEnd && IsWhitespace(*p))
+                ++p;
+            m_pCurrent = p;
+        }
+
+        void ParseArray()
+        {
+            assert(*m_pCurrent == '[');
+            ++m_pCurrent;
+            SkipWhitespace();
+
+            m_pHandler->OnJsonArrayBegin();
+
+            if (CharAt(m_pCurrent) == ']')
+            {
+                ++m_pCurrent;
+                m_pHandler->OnJsonArrayEnd();
+                return;
+            }
+
+            while (true)
+            {
+                ParseValue();
+                SkipWhitespace();
+
+                if (m_pCurrent == m_pEnd)
+                    ThrowError(m_pCurrent, "Unterminated array");
+                else if (*m_pCurrent == ']')
+                {
+                    ++m_pCurrent;
+                    m_pHandler->OnJsonArrayEnd();
+                    return;
+                }
+                else if (*m_pCurrent != ',')
+                    ThrowError(m_pCurrent, "Expect ',' or ']', but found {0}", Parser::PrintChar(*m_pCurrent));
+
+                ++m_pCurrent;
+                SkipWhitespace();
+            }
+        }
+
+        void ParseObject()
+        {
+            assert(*m_pCurrent == '{');
+            ++m_pCurrent;
+            SkipWhitespace();
+
+            m_pHandler->OnJsonObjectBegin();
+
+            if (CharAt(m_pCurrent) == '}')
+            {
+                ++m_pCurrent;
+                m_pHandler->OnJsonObjectEnd();
+                return;
+            }
+
+            while (true)
+            {
+                if (m_pCurrent == m_pEnd)
+                    ThrowError(m_pCurrent, "Unterminated object");
+                else if (*m_pCurrent != '"')
+                    ThrowError(m_pCurrent, "Expect '\"', but found {0}", Parser::PrintChar(*m_pCurrent));
+
+                m_pHandler->OnJsonObjectKey(ReadString());
+
+                SkipWhitespace();
+                if (CharAt(m_pCurrent) != ':')
+                    ThrowError(m_pCurrent, "Expect ':', but found {0}", Parser::PrintChar(CharAt(m_pCurrent)));
+                ++m_pCurrent;
+                SkipWhitespace();
+
+                ParseValue();
+                SkipWhitespace();
+
+                if (m_pCurrent == m_pEnd)
+                    ThrowError(m_pCurrent, "Unterminated object");
+                else if (*m_pCurrent == '}')
+                {
+                    ++m_pCurrent;
+                    m_pHandler->OnJsonObjectEnd();
+                    return;
+                }
+                else if (*m_pCurrent != ',')
+                    ThrowError(m_pCurrent, "Expect ',' or '}}', but found {0}", Parser::PrintChar(*m_pCurrent));
+
+                ++m_pCurrent;
+                SkipWhitespace();
+            }
+        }
+
+        void ParseValue()
+        {
+            switch (CharAt(m_pCurrent))
+            {
+                case '{':
+                    ParseObject();
+                    break;
+                case '[':
+                    ParseArray();
+                    break;
+                case '"':
+                    m_pHandler->OnJsonString(ReadString());
+                    break;
+                case 't':
+                    AcceptWord("true", 4);
+                    m_pHandler->OnJsonBool(true);
+                    break;
+                case 'f':
+                    AcceptWord("false", 5);
+                    m_pHandler->OnJsonBool(false);
+                    break;
+                case 'n':
+                    AcceptWord("null", 4);
+                    m_pHandler->OnJsonNull();
+                    break;
+                case '-':
+                case '0':
+                case '1':
+                case '2':
+                case '3':
+                case '4':
+                case '5':
+                case '6':
+                case '7':
+                case '8':
+                case '9':
+                    ParseNumber();
+                    break;
+                default:
+                    ThrowError(m_pCurrent, "Unexpected character {0}", Parser::PrintChar(CharAt(m_pCurrent)));
+                    break;
+            }
+        }
+    };
+}
+
+void Json::Parse(JsonSaxHandler* handler, ArrayView<char> data, const char* source)
+{
+    SaxHandlerAdapter adapter(handler);
+    Parse(&adapter, data, source);
+}
+
+void Json::Parse(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source)
+{
+    JsonParser parser(handler, data, source);
+    parser.Run();
+}
+
+void Json::Parse(JsonValue& out, ArrayView<char> data, const char* source)
+{
+    SaxHandler handler(out);
+    JsonParser parser(&handler, data, source);
+    parser.Run();
+}
+
+void Json::Parse(JsonDocument& out, ArrayView<char> data, const char* source)
+{
+    JsonDocument::Builder builder(out, data);
+    JsonParser parser(&builder, data, source);
+    parser.Run();
+    builder.Finish();
+}
+
+//////////////////////////////////////////////////////////////////////////////// JsonIndexedParser
+
+namespace
+{
+    /**
+     * @brief 64字节块的字符分类
+     *
+     * 每一位对应块中的一个字节。
+     */
+    struct BlockMasks
+    {
+        uint64_t Backslash;
+        uint64_t Quote;
+        uint64_t Whitespace;
+        uint64_t Operator;  // {}[]:,
+    };
+
+    /**
+     * @brief 跨块传递的扫描状态
+     */
+    struct IndexState
+    {
+        uint64_t PrevEscaped = 0;  // 上一块末尾的反斜杠转义了本块的首字节
+        uint64_t PrevInString = 0;  // 上一块结束时位于字符串中，全1或全0
+        uint64_t PrevScalar = 0;  // 上一块的末字节属于标量
+    };
+
+    inline unsigned CountTrailingZeros(uint64_t mask)noexcept
+    {
+        assert(mask != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index = 0;
+        _BitScanForward64(&index, mask);
+        return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+        unsigned ret = 0;
+        while ((mask & 1u) == 0)
+        {
+            mask >>= 1;
+            ++ret;
+        }
+        return ret;
+#endif
+    }
+
+    /**
+     * @brief 计算前缀异或
+     *
+     * 第i位为输入中第0~i位的异或，用于由引号位置得到字符串区间。
+     */
+    inline uint64_t PrefixXor(uint64_t mask)noexcept
+    {
+        mask ^= mask << 1;
+        mask ^= mask << 2;
+        mask ^= mask << 4;
+        mask ^= mask << 8;
+        mask ^= mask << 16;
+        mask ^= mask << 32;
+        return mask;
+    }
+
+    /**
+     * @brief 找出被转义的字符
+     *
+     * 奇数长度的反斜杠序列转义其后的一个字符。以偶数位开始的序列与以奇数位开始的序列分开处理，借助加法进位一次求出
+     * 所有序列的结束位置。
+     */
+    inline uint64_t FindEscaped(uint64_t backslash, uint64_t& prevEscaped)noexcept
+    {
+        static const uint64_t kEvenBits = 0x5555555555555555ull;
+
+        if (backslash == 0)
+        {
+            auto escaped = prevEscaped;
+            prevEscaped = 0;
+            return escaped;
+        }
+
+        backslash &= ~prevEscaped;
+        auto followsEscape = (backslash << 1) | prevEscaped;
+        auto oddSequenceStarts = backslash & ~kEvenBits & ~followsEscape;
+        auto sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+        prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;
+        auto invertMask = sequencesStartingOnEvenBits << 1;
+        return (kEvenBits ^ invertMask) & followsEscape;
+    }
+
+    /**
+     * @brief 由一个块的字符分类产生结构索引
+     * @param masks 字符分类
+     * @param state 扫描状态
+     * @param base 块在输入中的偏移
+     * @param out 输出位置
+     * @return 输出的结束位置
+     *
+     * 被索引的位置包括：字符串外的结构字符、字符串的起始引号、字符串外其他非空白字符序列的首字节。
+     * 第二阶段据此即可定位所有值，并能发现紧跟在值后面的非法字符。
+     */
+    inline uint32_t* IndexBlock(const BlockMasks& masks, IndexState& state, uint32_t base, uint32_t* out)noexcept
+    {
+        auto escaped = FindEscaped(masks.Backslash, state.PrevEscaped);
+        auto quote = masks.Quote & ~escaped;
+
+        // 区间包含起始引号而不包含结束引号
+        auto inString = PrefixXor(quote) ^ state.PrevInString;
+        state.PrevInString = 0 - (inString >> 63);
+
+        auto scalar = ~(masks.Operator | masks.Whitespace | quote | inString);
+        auto scalarStart = scalar & ~((scalar << 1) | state.PrevScalar);
+        state.PrevScalar = scalar >> 63;
+
+        auto structural = (masks.Operator & ~inString) | (quote & inString) | scalarStart;
+        while (structural != 0)
+        {
+            *(out++) = base + CountTrailingZeros(structural);
+            structural &= structural - 1;
+        }
+        return out;
+    }
+
+    inline void ClassifyScalar(const char* p, BlockMasks& masks)noexcept
+    {
+        masks.Backslash = masks.Quote = masks.Whitespace = masks.Operator = 0;
+        for (unsigned i = 0; i < 64; ++i)
+        {
+            auto bit = static_cast<uint64_t>(1) << i;
+            switch (p[i])
+            {
+                case '\\':
+                    masks.Backslash |= bit;
+                    break;
+                case '"':
+                    masks.Quote |= bit;
+                    break;
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    masks.Whitespace |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    masks.Operator |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+#ifdef MOE_JSON_USE_SSE2
+    inline void ClassifySse2(const char* p, BlockMasks& masks)noexcept
+    {
+        const auto backslash = _mm_set1_epi8('\\');
+        const auto quote = _mm_set1_epi8('"');
+        const auto space = _mm_set1_epi8(' ');
+        const auto tab = _mm_set1_epi8('\t');
+        const auto lf = _mm_set1_epi8('\n');
+        const auto cr = _mm_set1_epi8('\r');
+        const auto lower = _mm_set1_epi8(0x20);
+        const auto brace = _mm_set1_epi8('{');
+        const auto closeBrace = _mm_set1_epi8('}');
+        const auto colon = _mm_set1_epi8(':');
+        const auto comma = _mm_set1_epi8(',');
+
+        masks.Backslash = masks.Quote = masks.Whitespace = masks.Operator = 0;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+
+            // '['、']'与'{'、'}'只差0x20这一位
+            auto folded = _mm_or_si128(chunk, lower);
+            auto ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+            auto op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, brace), _mm_cmpeq_epi8(folded, closeBrace)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+
+            auto shift = i * 16;
+            masks.Backslash |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash))) << shift;
+            masks.Quote |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))) << shift;
+            masks.Whitespace |= static_cast<uint64_t>(_mm_movemask_epi8(ws)) << shift;
+            masks.Operator |= static_cast<uint64_t>(_mm_movemask_epi8(op)) << shift;
+        }
+    }
+#endif
+
+#ifdef MOE_JSON_USE_AVX2
+    MOE_JSON_TARGET_AVX2
+    inline void ClassifyAvx2(const char* p, BlockMasks& masks)noexcept
+    {
+        const auto backslash = _mm256_set1_epi8('\\');
+        const auto quote = _mm256_set1_epi8('"');
+        const auto space = _mm256_set1_epi8(' ');
+        const auto tab = _mm256_set1_epi8('\t');
+        const auto lf = _mm256_set1_epi8('\n');
+        const auto cr = _mm256_set1_epi8('\r');
+        const auto lower = _mm256_set1_epi8(0x20);
+        const auto brace = _mm256_set1_epi8('{');
+        const auto closeBrace = _mm256_set1_epi8('}');
+        const auto colon = _mm256_set1_epi8(':');
+        const auto comma = _mm256_set1_epi8(',');
+
+        masks.Backslash = masks.Quote = masks.Whitespace = masks.Operator = 0;
+        for (unsigned i = 0; i < 2; ++i)
+        {
+            auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i * 32));
+
+            auto folded = _mm256_or_si256(chunk, lower);
+            auto ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf), _mm256_cmpeq_epi8(chunk, cr)));
+            auto op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, brace),
+                _mm256_cmpeq_epi8(folded, closeBrace)), _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon),
+                _mm256_cmpeq_epi8(chunk, comma)));
+
+            auto shift = i * 32;
+            masks.Backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(chunk, backslash)))) << shift;
+            masks.Quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(chunk, quote)))) << shift;
+            masks.Whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(ws))) << shift;
+            masks.Operator |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+        }
+    }
+#endif
+
+    /**
+     * @brief 将不足64字节的尾部拷贝到以空白填充的块中
+     */
+    inline const char* PadTail(char (&block)[64], const char* p, size_t size)noexcept
+    {
+        assert(size < 64);
+        ::memset(block, ' ', sizeof(block));
+        ::memcpy(block, p, size);
+        return block;
+    }
+
+    // 每种指令集各有一个驱动循环，使分类函数可以被内联到具有相同目标属性的调用者中
+
+    uint32_t* BuildIndexScalar(const char* data, size_t size, uint32_t* out)noexcept
+    {
+        IndexState state;
+        BlockMasks masks;
+        char block[64];
+
+        size_t i = 0;
+        for (; i + 64 <= size; i += 64)
+        {
+            ClassifyScalar(data + i, masks);
+            out = IndexBlock(masks, state, static_cast<uint32_t>(i), out);
+        }
+        if (i < size)
+        {
+            ClassifyScalar(PadTail(block, data + i, size - i), masks);
+            out = IndexBlock(masks, state, static_cast<uint32_t>(i), out);
+        }
+        return out;
+    }
+
+#ifdef MOE_JSON_USE_SSE2
+    uint32_t* BuildIndexSse2(const char* data, size_t size, uint32_t* out)noexcept
+    {
+        IndexState state;
+        BlockMasks masks;
+        char block[64];
+
+        size_t i = 0;
+        for (; i + 64 <= size; i += 64)
+        {
+            ClassifySse2(data + i, masks);
+            out = IndexBlock(masks, state, static_cast<uint32_t>(i), out);
+        }
+        if (i < size)
+        {
+            ClassifySse2(PadTail(block, data + i, size - i), masks);
+            out = IndexBlock(masks, state, static_cast<uint32_t>(i), out);
+        }
+        return out;
+    }
+#endif
+
+#ifdef MOE_JSON_USE_AVX2
+    MOE_JSON_TARGET_AVX2
+    uint32_t* BuildIndexAvx2(const char* data, size_t size, uint32_t* out)noexcept
+    {
+        IndexState state;
+        BlockMasks masks;
+        char block[64];
+
+        size_t i = 0;
+        for (; i + 64 <= size; i += 64)
+        {
+            ClassifyAvx2(data + i, masks);
+            out = IndexBlock(masks, state, static_cast<uint32_t>(i), out);
+        }
+        if (i < size)
+        {
+            ClassifyAvx2(PadTail(block, data + i, size - i), masks);
+            out = IndexBlock(masks, state, static_cast<uint32_t>(i), out);
+        }
+        return out;
+    }
+
+    bool IsAvx2Supported()noexcept
+    {
+#ifdef _MSC_VER
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        // 需要CPU支持AVX且操作系统保存YMM寄存器
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+            return false;
+        if ((_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif
+
+    /**
+     * @brief 沿结构索引解析JSON
+     *
+     * 每次取出索引中的下一个位置，不再需要跳过空白。标量值解析完成后检查其后紧跟的字符：若既不是空白也不是下一个
+     * 被索引的位置，说明值后面粘连了非法字符，此时将其作为下一个位置交给调用方，以报告与JsonParser相同的错误。
+     */
+    class JsonIndexWalker :
+        public JsonParserBase
+    {
+    public:
+        JsonIndexWalker(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source,
+            ArrayView<uint32_t> index)
+            : JsonParserBase(handler, data, source), m_pIndex(index.GetBuffer()),
+            m_pIndexEnd(index.GetBuffer() + index.GetSize()) {}
+
+    public:
+        void Run()
+        {
+            m_stStringBuffer.clear();
+
+            ParseValue(NextToken());
+
+            auto tail = NextToken();
+            if (tail != m_pEnd)
+                ThrowError(tail, "Bad tailing character {0}", Parser::PrintChar(*tail));
+        }
+
+    private:
+        const char* PeekToken()const noexcept
+        {
+            return m_pIndex < m_pIndexEnd ? m_pBegin + *m_pIndex : m_pEnd;
+        }
+
+        const char* NextToken()noexcept
+        {
+            return m_pIndex < m_pIndexEnd ? m_pBegin + *(m_pIndex++) : m_pEnd;
+        }
+
+        void CheckScalarEnd()noexcept
+        {
+            // 粘连的字符不会是合法的后续位置，调用方取出后必然报错，因此直接用它替换剩余的索引
+            if (m_pCurrent != m_pEnd && !IsWhitespace(*m_pCurrent) && m_pCurrent != PeekToken())
+            {
+                m_uGluedOffset = static_cast<uint32_t>(m_pCurrent - m_pBegin);
+                m_pIndex = &m_uGluedOffset;
+                m_pIndexEnd = &m_uGluedOffset + 1;
+            }
+        }
+
+        void ParseArray()
+        {
+            m_pHandler->OnJsonArrayBegin();
+
+            auto token = NextToken();
+            if (CharAt(token) == ']')
+            {
+                m_pHandler->OnJsonArrayEnd();
+                return;
+            }
+
+            while (true)
+            {
+                ParseValue(token);
+
+                token = NextToken();
+                if (token == m_pEnd)
+                    ThrowError(token, "Unterminated array");
+                else if (*token == ']')
+                {
+                    m_pHandler->OnJsonArrayEnd();
+                    return;
+                }
+                else if (*token != ',')
+                    ThrowError(token, "Expect ',' or ']', but found {0}", Parser::PrintChar(*token));
+
+                token = NextToken();
+            }
+        }
+
+        void ParseObject()
+        {
+            m_pHandler->OnJsonObjectBegin();
+
+            auto token = NextToken();
+            if (CharAt(token) == '}')
+            {
+                m_pHandler->OnJsonObjectEnd();
+                return;
+            }
+
+            while (true)
+            {
+                if (token == m_pEnd)
+                    ThrowError(token, "Unterminated object");
+                else if (*token != '"')
+                    ThrowError(token, "Expect '\"', but found {0}", Parser::PrintChar(*token));
+
+                m_pCurrent = token;
+                m_pHandler->OnJsonObjectKey(ReadString());
+
+                token = NextToken();
+                if (CharAt(token) != ':')
+                    ThrowError(token, "Expect ':', but found {0}", Parser::PrintChar(CharAt(token)));
+
+                ParseValue(NextToken());
+
+                token = NextToken();
+                if (token == m_pEnd)
+                    ThrowError(token, "Unterminated object");
+                else if (*token == '}')
+                {
+                    m_pHandler->OnJsonObjectEnd();
+                    return;
+                }
+                else if (*token != ',')
+                    ThrowError(token, "Expect ',' or '}}', but found {0}", Parser::PrintChar(*token));
+
+                token = NextToken();
+            }
+        }
+
+        void ParseValue(const char* token)
+        {
+            m_pCurrent = token;
+            switch (CharAt(token))
+            {
+                case '{':
+                    ParseObject();
+                    break;
+                case '[':
+                    ParseArray();
+                    break;
+                case '"':
+                    m_pHandler->OnJsonString(ReadString());
+                    break;
+                case 't':
+                    AcceptWord("true", 4);
+                    CheckScalarEnd();
+                    m_pHandler->OnJsonBool(true);
+                    break;
+                case 'f':
+                    AcceptWord("false", 5);
+                    CheckScalarEnd();
+                    m_pHandler->OnJsonBool(false);
+                    break;
+                case 'n':
+                    AcceptWord("null", 4);
+                    CheckScalarEnd();
+                    m_pHandler->OnJsonNull();
+                    break;
+                case '-':
+                case '0':
+                case '1':
+                case '2':
+                case '3':
+                case '4':
+                case '5':
+                case '6':
+                case '7':
+                case '8':
+                case '9':
+                    ParseNumber();
+                    CheckScalarEnd();
+                    break;
+                default:
+                    ThrowError(token, "Unexpected character {0}", Parser::PrintChar(CharAt(token)));
+                    break;
+            }
+        }
+
+    private:
+        const uint32_t* m_pIndex = nullptr;
+        const uint32_t* m_pIndexEnd = nullptr;
+        uint32_t m_uGluedOffset = 0;  // 粘连在标量值后的字符位置
+    };
+}
+
+JsonIndexedParser::InstructionSet JsonIndexedParser::GetBestInstructionSet()noexcept
+{
+#ifdef MOE_JSON_USE_AVX2
+    if (IsAvx2Supported())
+        return InstructionSet::Avx2;
+#endif
+#ifdef MOE_JSON_USE_SSE2
+    return InstructionSet::Sse2;
+#else
+    return InstructionSet::Scalar;
+#endif
+}
+
+JsonIndexedParser::JsonIndexedParser()
+    : m_iInstructionSet(GetBestInstructionSet())
+{
+}
+
+JsonIndexedParser::JsonIndexedParser(InstructionSet instructionSet)
+    : m_iInstructionSet(std::min(instructionSet, GetBestInstructionSet()))
+{
+}
+
+void JsonIndexedParser::Parse(JsonSaxHandler* handler, ArrayView<char> data, const char* source)
+{
+    SaxHandlerAdapter adapter(handler);
+    Parse(&adapter, data, source);
+}
+
+void JsonIndexedParser::Parse(JsonSaxViewHandler* handler, ArrayView<char> data, const char* source)
+{
+    // 索引使用32位偏移
+    if (data.GetSize() > numeric_limits<uint32_t>::max())
+    {
+        m_uIndexCount = 0;
+        JsonParser parser(handler, data, source);
+        parser.Run();
+        return;
+    }
+
+    BuildIndex(data);
+
+    JsonIndexWalker walker(handler, data, source, GetStructuralIndex());
+    walker.Run();
+}
+
+void JsonIndexedParser::Parse(JsonValue& out, ArrayView<char> data, const char* source)
+{
+    SaxHandler handler(out);
+    Parse(&handler, data, source);
+}
+
+void JsonIndexedParser::Parse(JsonDocument& out, ArrayView<char> data, const char* source)
+{
+    JsonDocument::Builder builder(out, data);
+    Parse(&builder, data, source);
+    builder.Finish();
+}
+
+void JsonIndexedParser::BuildIndex(ArrayView<char> data)
+{
+    // 最坏情况下每个字节都被索引
+    if (m_stIndex.size() < data.GetSize())
+        m_stIndex.resize(data.GetSize());
+
+    uint32_t* end = nullptr;
+    switch (m_iInstructionSet)
+    {
+#ifdef MOE_JSON_USE_AVX2
+        case InstructionSet::Avx2:
+            end = BuildIndexAvx2(data.GetBuffer(), data.GetSize(), m_stIndex.data());
+            break;
+#endif
+#ifdef MOE_JSON_USE_SSE2
+        case InstructionSet::Sse2:
+            end = BuildIndexSse2(data.GetBuffer(), data.GetSize(), m_stIndex.data());
+            break;
+#endif
+        default:
+            end = BuildIndexScalar(data.GetBuffer(), data.GetSize(), m_stIndex.data());
+            break;
+    }
+    m_uIndexCount = static_cast<size_t>(end - m_stIndex.data());
+}
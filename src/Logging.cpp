@@ -3,12 +3,16 @@
  * @date 2017/5/29
  */
 #include <Moe.Core/Logging.hpp>
+#include <Moe.Core/Threading.hpp>
 #include <Moe.Core/Exception.hpp>
 #include <Moe.Core/Encoding.hpp>
+#include <Moe.Core/Hasher.hpp>
 
 #include <mutex>
 #include <vector>
 #include <atomic>
+#include <limits>
+#include <condition_variable>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -17,6 +21,7 @@
 #include <Windows.h>
 #else
 #include <unistd.h>
+#include <sys/uio.h>
 #endif
 
 using namespace std;
@@ -45,68 +50,231 @@ namespace
         }
     }
 
-    struct DateTimeLazyCalc
+    /**
+     * @brief 日期时间缓存
+     *
+     * 同一秒内的日志共享相同的日期和时间前缀，每个线程缓存最近一秒的结果。
+     */
+    struct DateTimeCache
     {
-        bool ShortVersion;
-        Time::Timestamp Time;
-        mutable char Buffer[16];
+        uint64_t Second = numeric_limits<uint64_t>::max();
+        char Date[16];
+        char ShortDate[16];
+        char Time[16];  // 不含毫秒
+        size_t DateLength = 0;
+        size_t ShortDateLength = 0;
+        size_t TimeLength = 0;
+
+        void Update(Time::Timestamp ts)noexcept
+        {
+            auto second = ts / 1000;
+            if (second == Second)
+                return;
+
+            auto dt = Time::ToDateTime(ts);
+            DateLength = static_cast<size_t>(snprintf(Date, sizeof(Date), "%04d-%02d-%02d", dt.Year, dt.Month,
+                dt.Day));
+            ShortDateLength = static_cast<size_t>(snprintf(ShortDate, sizeof(ShortDate), "%02d-%02d-%02d",
+                dt.Year % 100, dt.Month, dt.Day));
+            TimeLength = static_cast<size_t>(snprintf(Time, sizeof(Time), "%02d:%02d:%02d", dt.Hour, dt.Minutes,
+                dt.Seconds));
+            Second = second;
+        }
+    };
+
+    DateTimeCache& GetDateTimeCache(Time::Timestamp ts)noexcept
+    {
+#ifndef MOE_EMSCRIPTEN
+        static thread_local DateTimeCache s_stCache;
+#else
+        static DateTimeCache s_stCache;  // NOTE: emscripten 模拟多线程
+#endif
+        s_stCache.Update(ts);
+        return s_stCache;
+    }
+
+    /**
+     * @brief 延迟格式化时的字符串参数
+     *
+     * 与StringToStringFormatter/CStringToStringFormatter一致，不接受格式化参数。
+     */
+    bool DeferredStringToString(string& output, const void* object, const ArrayView<char>& format)
+    {
+        const auto& value = *static_cast<const ArrayView<char>*>(object);
+
+        if (format.GetSize() != 0)
+            return false;
 
-        DateTimeLazyCalc(bool shortVersion, Time::Timestamp time)noexcept
-            : ShortVersion(shortVersion), Time(time) {}
+        output.append(value.GetBuffer(), value.GetSize());
+        return true;
+    }
 
-        const char* ToString()const noexcept
+    struct DeferredArgument
+    {
+        union
         {
-            auto dt = Time::ToDateTime(Time);
-            if (ShortVersion)
-            {
-                snprintf(Buffer, sizeof(Buffer) - 1, "%02d-%02d-%02d", dt.Year % 100, dt.Month, dt.Day);
-                Buffer[sizeof(Buffer) - 1] = '\0';
-            }
-            else
-            {
-                snprintf(Buffer, sizeof(Buffer) - 1, "%04d-%02d-%02d", dt.Year, dt.Month, dt.Day);
-                Buffer[sizeof(Buffer) - 1] = '\0';
-            }
-            return Buffer;
-        }
+            bool Bool;
+            char Char;
+            int8_t Int8;
+            uint8_t UInt8;
+            int16_t Int16;
+            uint16_t UInt16;
+            int32_t Int32;
+            uint32_t UInt32;
+            int64_t Int64;
+            uint64_t UInt64;
+            float Float;
+            double Double;
+            const void* Pointer;
+            std::nullptr_t Null;
+        };
+        ArrayView<char> View;
+        bool IsView = false;
     };
 
-    struct TimeLazyCalc
+    class DeferredArgumentReader
     {
-        Time::Timestamp Time = 0;
-        mutable char Buffer[16];
+    public:
+        DeferredArgumentReader(const char* data, size_t length)noexcept
+            : m_pData(data), m_uLength(length) {}
+
+    public:
+        bool IsEof()const noexcept { return m_uPosition >= m_uLength; }
 
-        TimeLazyCalc(Time::Timestamp time)noexcept
-            : Time(time) {}
+        template <typename T>
+        void Read(T& out)
+        {
+            if (m_uLength - m_uPosition < sizeof(T))
+                MOE_THROW(BadFormatException, "Unexpected end of log arguments");
+            ::memcpy(&out, m_pData + m_uPosition, sizeof(T));
+            m_uPosition += sizeof(T);
+        }
 
-        const char* ToString()const noexcept
+        ArrayView<char> ReadString()
         {
-            auto dt = Time::ToDateTime(Time);
-            snprintf(Buffer, sizeof(Buffer) - 1, "%02d:%02d:%02d.%03d", dt.Hour, dt.Minutes, dt.Seconds,
-                dt.MilliSeconds);
-            Buffer[sizeof(Buffer) - 1] = '\0';
-            return Buffer;
+            uint32_t length = 0;
+            Read(length);
+            if (m_uLength - m_uPosition < static_cast<size_t>(length) + 1)
+                MOE_THROW(BadFormatException, "Unexpected end of log arguments");
+
+            ArrayView<char> ret(m_pData + m_uPosition, length);
+            m_uPosition += length + 1;
+            return ret;
         }
+
+    private:
+        const char* m_pData = nullptr;
+        size_t m_uLength = 0;
+        size_t m_uPosition = 0;
     };
 
-    struct FilenameLazyCalc
+    /**
+     * @brief 解码延迟格式化的参数并格式化
+     * @exception BadFormatException 参数编码损坏或格式化串有误
+     */
+    void FormatDeferredArguments(string& out, const char* format, const char* args, size_t length)
     {
-        const char* Path = nullptr;
+#ifndef MOE_EMSCRIPTEN
+        static thread_local vector<DeferredArgument> s_stArguments;
+        static thread_local vector<const void*> s_stObjects;
+        static thread_local vector<StringUtils::details::ToStringFormatter<char>> s_stFormatters;
+#else
+        static vector<DeferredArgument> s_stArguments;  // NOTE: emscripten 模拟多线程
+        static vector<const void*> s_stObjects;
+        static vector<StringUtils::details::ToStringFormatter<char>> s_stFormatters;
+#endif
+
+        s_stArguments.clear();
+        s_stObjects.clear();
+        s_stFormatters.clear();
+
+#define DECODE_DEFERRED_ARGUMENT(TAG, TYPE) \
+    case details::LogArgumentType::TAG: \
+        reader.Read(arg.TAG); \
+        s_stFormatters.push_back(StringUtils::details::ToStringFormatterSelector<char, TYPE>::AppendToString); \
+        break
 
-        FilenameLazyCalc(const char* path)noexcept
-            : Path(path) {}
+        DeferredArgumentReader reader(args, length);
+        while (!reader.IsEof())
+        {
+            uint8_t tag = 0;
+            reader.Read(tag);
+
+            s_stArguments.emplace_back();
+            auto& arg = s_stArguments.back();
+            switch (static_cast<details::LogArgumentType>(tag))
+            {
+                case details::LogArgumentType::Bool:
+                    reader.Read(arg.UInt8);
+                    arg.Bool = (arg.UInt8 != 0);
+                    s_stFormatters.push_back(
+                        StringUtils::details::ToStringFormatterSelector<char, bool>::AppendToString);
+                    break;
+                DECODE_DEFERRED_ARGUMENT(Char, char);
+                DECODE_DEFERRED_ARGUMENT(Int8, int8_t);
+                DECODE_DEFERRED_ARGUMENT(UInt8, uint8_t);
+                DECODE_DEFERRED_ARGUMENT(Int16, int16_t);
+                DECODE_DEFERRED_ARGUMENT(UInt16, uint16_t);
+                DECODE_DEFERRED_ARGUMENT(Int32, int32_t);
+                DECODE_DEFERRED_ARGUMENT(UInt32, uint32_t);
+                DECODE_DEFERRED_ARGUMENT(Int64, int64_t);
+                DECODE_DEFERRED_ARGUMENT(UInt64, uint64_t);
+                DECODE_DEFERRED_ARGUMENT(Float, float);
+                DECODE_DEFERRED_ARGUMENT(Double, double);
+                case details::LogArgumentType::Enum:
+                    reader.Read(arg.UInt32);
+                    s_stFormatters.push_back(
+                        StringUtils::details::EnumToStringFormatter<char, uint32_t>::AppendToString);
+                    break;
+                case details::LogArgumentType::Pointer:
+                    reader.Read(arg.UInt64);
+                    arg.Pointer = reinterpret_cast<const void*>(static_cast<uintptr_t>(arg.UInt64));
+                    s_stFormatters.push_back(
+                        StringUtils::details::ToStringFormatterSelector<char, const void*>::AppendToString);
+                    break;
+                case details::LogArgumentType::Null:
+                    arg.Null = nullptr;
+                    s_stFormatters.push_back(
+                        StringUtils::details::ToStringFormatterSelector<char, std::nullptr_t>::AppendToString);
+                    break;
+                case details::LogArgumentType::CString:
+                case details::LogArgumentType::String:
+                    arg.View = reader.ReadString();
+                    arg.IsView = true;
+                    s_stFormatters.push_back(DeferredStringToString);
+                    break;
+                case details::LogArgumentType::CharArrayView:
+                    arg.View = reader.ReadString();
+                    arg.IsView = true;
+                    s_stFormatters.push_back(
+                        StringUtils::details::ToStringFormatterSelector<char, ArrayView<char>>::AppendToString);
+                    break;
+                default:
+                    MOE_THROW(BadFormatException, "Unknown log argument type {0}", tag);
+            }
+        }
+
+#undef DECODE_DEFERRED_ARGUMENT
 
-        ArrayView<char> ToString()const noexcept
+        // 参数全部解码后再取地址，避免扩容导致失效
+        for (auto& arg : s_stArguments)
         {
-            return PathUtils::GetFileName(Path);
+            s_stObjects.push_back(arg.IsView ? static_cast<const void*>(&arg.View) :
+                static_cast<const void*>(&arg.Bool));
         }
-    };
+
+        StringUtils::details::FormatArguments(out, ArrayView<char>(format, strlen(format)), s_stObjects.data(),
+            s_stFormatters.data(), s_stObjects.size());
+    }
 }
 
 const char* Logging::kFormatErrorMsg = "(Format message failed while logging message)";
 const size_t Logging::kFormatErrorMsgLength = strlen(kFormatErrorMsg);
 const char* Logging::kAllocErrorMsg = "(Alloc memory failed while logging message)";
 const size_t Logging::kAllocErrorMsgLength = strlen(kAllocErrorMsg);
+const unsigned Logging::kLevelCount;
+const size_t Logging::kDefaultAsyncQueueSize;
+const size_t Logging::kDefaultRateLimitSites;
 
 //////////////////////////////////////////////////////////////////////////////// Context
 
@@ -126,21 +294,396 @@ Logging::FormatterBase::~FormatterBase()
 {
 }
 
+//////////////////////////////////////////////////////////////////////////////// FormatPattern
+
+void Logging::FormatPattern::Compile(const std::string& format)
+{
+    static const unsigned kWidthLimit = 1000000u;
+
+    m_stText.clear();
+    m_stOps.clear();
+
+    char ch = '\0';
+    size_t pos = 0;
+    size_t len = format.length();
+
+    while (true)
+    {
+        // 不断读取并寻找 '{'
+        while (pos < len)
+        {
+            ch = format[pos++];
+
+            if (ch == '}')
+            {
+                // 将连续的 '}}' 转义成 '}'
+                if (pos < len && format[pos] == '}')
+                    ++pos;
+            }
+            else if (ch == '{')
+            {
+                // 将连续的 '{{' 转义成 '{'
+                if (pos < len && format[pos] == '{')
+                    ++pos;
+                else
+                {
+                    --pos;
+                    break;
+                }
+            }
+
+            AppendLiteral(&ch, 1);
+        }
+
+        // 字符串处理完毕
+        if (pos == len)
+            break;
+
+        // 开始解析格式化语法
+        size_t holeStart = pos++;  // 记录当前开始的位置，可以方便做容错
+        size_t variableStart = 0;  // 记录变量名称的起止范围
+        size_t variableEnd = 0;
+        Op op;
+        ArrayView<char> formatDescriptor;
+
+        op.Kind = Field::Literal;
+        op.LeftJustify = false;
+        op.PaddingCharacter = ' ';
+        op.Padding = 0;
+        op.Offset = 0;
+        op.Length = 0;
+
+        while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+            ++pos;
+
+        // 解析Variable部分
+        if (pos == len)
+            goto badFormat;
+
+        ch = format[pos];
+        if (ch == ',' || ch == ':' || ch == '}')
+            goto badFormat;
+
+        variableStart = pos;
+        do
+        {
+            variableEnd = pos;
+            if ((++pos) == len)
+                goto badFormat;
+            ch = format[pos];
+        } while (ch != ',' && ch != ':' && ch != '}');
+
+        // 去掉可选的空白
+        while (variableStart < variableEnd && format[variableEnd] == ' ')
+            --variableEnd;
+
+        // 解析Padding部分
+        if (ch == ',')
+        {
+            ++pos;
+            while (pos < len && format[pos] == ' ')  // 读取可选的空白
+                ++pos;
+
+            if (pos == len)  // 索引越界
+                goto badFormat;
+
+            if ((ch = format[pos]) == '-')  // 是否存在一个减号
+            {
+                op.LeftJustify = true;  // 此时左对齐
+
+                if ((++pos) == len)
+                    goto badFormat;
+
+                ch = format[pos];
+            }
+
+            if (!(ch >= '0' && ch <= '9'))  // 非法字符
+                goto badFormat;
+
+            do
+            {
+                op.Padding = op.Padding * 10 + ch - '0';
+
+                if ((++pos) == len)
+                    goto badFormat;
+
+                ch = format[pos];
+            } while (ch >= '0' && ch <= '9' && op.Padding < kWidthLimit);
+
+            // 扩展语法：如果紧跟一个'['，则读取PaddingCharacter
+            if (ch == '[')
+            {
+                if ((++pos) == len)
+                    goto badFormat;
+
+                op.PaddingCharacter = format[pos];
+
+                if ((++pos) == len)
+                    goto badFormat;
+
+                // 后面必须紧跟一个']'
+                ch = format[pos];
+                if (ch != ']')
+                    goto badFormat;
+
+                if ((++pos) == len)
+                    goto badFormat;
+
+                ch = format[pos];
+            }
+
+            while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+                ++pos;
+        }
+
+        // 读取可选的格式化字段
+        if (ch == ':')
+        {
+            size_t descriptorStart = 0;
+
+            ++pos;
+            while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+                ++pos;
+
+            if (pos == len)
+                goto badFormat;
+
+            descriptorStart = pos;
+            while (pos < len && !(ch == '}' || ch == ' '))
+            {
+                ++pos;
+                ch = format[pos];
+            }
+
+            if (pos == len)
+                goto badFormat;
+
+            if (pos != descriptorStart)
+                formatDescriptor = ArrayView<char>(&format[descriptorStart], pos - descriptorStart);
+
+            while (pos < len && (ch = format[pos]) == ' ')  // 读取可选的空白
+                ++pos;
+        }
+
+        // 此时，format[pos]必然为一个'}'
+        if (ch != '}')
+            goto badFormat;
+        ++pos;
+
+        // 未知的变量或者无效的格式化参数，与VariableFormat一样作为字面量输出
+        op.Kind = GetFieldByName(ArrayView<char>(&format[variableStart], variableEnd - variableStart + 1));
+        if (op.Kind == Field::Literal || !IsFieldFormatValid(op.Kind, formatDescriptor))
+            goto badFormat;
+
+        op.Offset = static_cast<uint32_t>(m_stText.length());
+        op.Length = static_cast<uint32_t>(formatDescriptor.GetSize());
+        m_stText.append(formatDescriptor.GetBuffer(), formatDescriptor.GetSize());
+        m_stOps.push_back(op);
+        continue;
+
+    badFormat:
+        // 错误恢复，直接将从holeStart开始到当前pos位置的所有字符放入结果
+        if (pos < len)
+            ++pos;
+        AppendLiteral(&format[holeStart], pos - holeStart);
+    }
+}
+
+void Logging::FormatPattern::Render(std::string& dest, Level level, const Context& context, const char* msg)const
+{
+    for (const auto& op : m_stOps)
+    {
+        ArrayView<char> text(m_stText.data() + op.Offset, op.Length);
+        if (op.Kind == Field::Literal)
+        {
+            dest.append(text.GetBuffer(), text.GetSize());
+            continue;
+        }
+
+        auto outputPos = dest.length();
+        bool ret = true;
+        switch (op.Kind)
+        {
+            case Field::Date:
+                {
+                    const auto& cache = GetDateTimeCache(context.Time);
+                    dest.append(cache.Date, cache.DateLength);
+                }
+                break;
+            case Field::ShortDate:
+                {
+                    const auto& cache = GetDateTimeCache(context.Time);
+                    dest.append(cache.ShortDate, cache.ShortDateLength);
+                }
+                break;
+            case Field::Time:
+                {
+                    const auto& cache = GetDateTimeCache(context.Time);
+                    auto ms = static_cast<unsigned>(context.Time % 1000);
+                    char buffer[4] = { '.', static_cast<char>('0' + ms / 100), static_cast<char>('0' + ms / 10 % 10),
+                        static_cast<char>('0' + ms % 10) };
+                    dest.append(cache.Time, cache.TimeLength);
+                    dest.append(buffer, sizeof(buffer));
+                }
+                break;
+            case Field::Level:
+                {
+                    auto str = GetLogLevelString(level);
+                    ret = StringUtils::details::ToStringFormatterSelector<char, const char*>::AppendToString(dest, &str,
+                        text);
+                }
+                break;
+            case Field::Thread:
+                ret = StringUtils::details::ToStringFormatterSelector<char, uint64_t>::AppendToString(dest,
+                    &context.ThreadId, text);
+                break;
+            case Field::Path:
+                ret = StringUtils::details::ToStringFormatterSelector<char, const char*>::AppendToString(dest,
+                    &context.File, text);
+                break;
+            case Field::File:
+                if (context.File)
+                {
+                    auto filename = PathUtils::GetFileName(context.File);
+                    dest.append(filename.GetBuffer(), filename.GetSize());
+                }
+                else
+                    dest.append(StringUtils::details::StringConstant<char>::GetNull());
+                break;
+            case Field::Func:
+                ret = StringUtils::details::ToStringFormatterSelector<char, const char*>::AppendToString(dest,
+                    &context.Function, text);
+                break;
+            case Field::Line:
+                ret = StringUtils::details::ToStringFormatterSelector<char, uint32_t>::AppendToString(dest,
+                    &context.Line, text);
+                break;
+            case Field::Msg:
+                ret = StringUtils::details::ToStringFormatterSelector<char, const char*>::AppendToString(dest, &msg,
+                    text);
+                break;
+            default:
+                assert(false);
+                break;
+        }
+
+        // 编译时已经校验过格式化参数
+        MOE_UNUSED(ret);
+        assert(ret);
+
+        auto outputLength = dest.length() - outputPos;
+        if (outputLength < op.Padding)  // 需要进行补齐操作
+        {
+            dest.resize(outputPos + op.Padding);
+
+            size_t paddingPos = 0;
+            if (op.LeftJustify)
+                paddingPos = outputPos + outputLength;
+            else
+            {
+                // 需要对字符串做移动操作
+                ::memmove(&dest[dest.length() - outputLength], dest.data() + outputPos, outputLength);
+                paddingPos = outputPos;
+            }
+
+            ::memset(&dest[paddingPos], op.PaddingCharacter, op.Padding - outputLength);
+        }
+    }
+}
+
+Logging::FormatPattern::Field Logging::FormatPattern::GetFieldByName(const ArrayView<char>& name)noexcept
+{
+    static const pair<const char*, Field> kFields[] = {
+        { "date", Field::Date },
+        { "short_date", Field::ShortDate },
+        { "time", Field::Time },
+        { "level", Field::Level },
+        { "thread", Field::Thread },
+        { "path", Field::Path },
+        { "file", Field::File },
+        { "func", Field::Func },
+        { "line", Field::Line },
+        { "msg", Field::Msg },
+    };
+
+    for (const auto& field : kFields)
+    {
+        if (strlen(field.first) == name.GetSize() && ::memcmp(field.first, name.GetBuffer(), name.GetSize()) == 0)
+            return field.second;
+    }
+    return Field::Literal;
+}
+
+bool Logging::FormatPattern::IsFieldFormatValid(Field field, const ArrayView<char>& format)
+{
+    string tmp;
+    switch (field)
+    {
+        case Field::Date:
+        case Field::ShortDate:
+        case Field::Time:
+        case Field::File:
+            return true;  // 忽略格式化参数
+        case Field::Thread:
+            {
+                uint64_t value = 0;
+                return StringUtils::details::ToStringFormatterSelector<char, uint64_t>::AppendToString(tmp, &value,
+                    format);
+            }
+        case Field::Line:
+            {
+                uint32_t value = 0;
+                return StringUtils::details::ToStringFormatterSelector<char, uint32_t>::AppendToString(tmp, &value,
+                    format);
+            }
+        default:
+            return format.GetSize() == 0;  // 字符串不接受格式化参数
+    }
+}
+
+void Logging::FormatPattern::AppendLiteral(const char* str, size_t length)
+{
+    // 与上一段字面量合并
+    if (m_stOps.empty() || m_stOps.back().Kind != Field::Literal ||
+        m_stOps.back().Offset + m_stOps.back().Length != m_stText.length())
+    {
+        Op op;
+        op.Kind = Field::Literal;
+        op.LeftJustify = false;
+        op.PaddingCharacter = ' ';
+        op.Padding = 0;
+        op.Offset = static_cast<uint32_t>(m_stText.length());
+        op.Length = 0;
+        m_stOps.push_back(op);
+    }
+
+    m_stText.append(str, length);
+    m_stOps.back().Length += static_cast<uint32_t>(length);
+}
+
 //////////////////////////////////////////////////////////////////////////////// PlainFormatter
 
-void Logging::PlainFormatter::Format(std::string& dest, Level level, const Context& context, const char* msg)const
+Logging::PlainFormatter::PlainFormatter()
+{
+    m_stPattern.Compile(m_stFormat);
+}
+
+void Logging::PlainFormatter::SetFormat(const std::string& format)
+{
+    m_stPattern.Compile(format);
+    m_stFormat = format;
+}
+
+void Logging::PlainFormatter::SetFormat(std::string&& format)
 {
-    DateTimeLazyCalc date(false, context.Time);
-    DateTimeLazyCalc shortDate(true, context.Time);
-    TimeLazyCalc time(context.Time);
-    FilenameLazyCalc filename(context.File);
+    m_stPattern.Compile(format);
+    m_stFormat = std::move(format);
+}
 
-    StringUtils::VariableFormat(dest, m_stFormat.c_str(), make_pair("date", reference_wrapper<DateTimeLazyCalc>(date)),
-        make_pair("short_date", reference_wrapper<DateTimeLazyCalc>(shortDate)),
-        make_pair("time", reference_wrapper<TimeLazyCalc>(time)), make_pair("level", GetLogLevelString(level)),
-        make_pair("path", context.File), make_pair("file", reference_wrapper<FilenameLazyCalc>(filename)),
-        make_pair("func", context.Function), make_pair("line", context.Line), make_pair("thread", context.ThreadId),
-        make_pair("msg", msg));
+void Logging::PlainFormatter::Format(std::string& dest, Level level, const Context& context, const char* msg)const
+{
+    dest.clear();
+    m_stPattern.Render(dest, level, context, msg);
 }
 
 std::shared_ptr<Logging::FormatterBase> Logging::PlainFormatter::Clone()const
@@ -152,6 +695,8 @@ std::shared_ptr<Logging::FormatterBase> Logging::PlainFormatter::Clone()const
 
 Logging::AnsiColorFormatter::AnsiColorFormatter()
 {
+    m_stPattern.Compile(m_stFormat);
+
     SetColor(Level::Debug, Colors::Default, Colors::Default);
     SetColor(Level::Trace, Colors::BrightCyan, Colors::Default);
     SetColor(Level::Info, Colors::BrightGreen, Colors::Default);
@@ -160,157 +705,166 @@ Logging::AnsiColorFormatter::AnsiColorFormatter()
     SetColor(Level::Fatal, Colors::BrightWhite, Colors::Red);
 }
 
-void Logging::AnsiColorFormatter::Format(std::string& dest, Level level, const Context& context, const char* msg)const
+void Logging::AnsiColorFormatter::SetFormat(const std::string& format)
+{
+    m_stPattern.Compile(format);
+    m_stFormat = format;
+}
+
+void Logging::AnsiColorFormatter::SetFormat(std::string&& format)
 {
-    DateTimeLazyCalc date(false, context.Time);
-    DateTimeLazyCalc shortDate(true, context.Time);
-    TimeLazyCalc time(context.Time);
-    FilenameLazyCalc filename(context.File);
+    m_stPattern.Compile(format);
+    m_stFormat = std::move(format);
+}
 
-    StringUtils::VariableFormat(dest, m_stFormat.c_str(), make_pair("date", reference_wrapper<DateTimeLazyCalc>(date)),
-        make_pair("short_date", reference_wrapper<DateTimeLazyCalc>(shortDate)),
-        make_pair("time", reference_wrapper<TimeLazyCalc>(time)), make_pair("level", GetLogLevelString(level)),
-        make_pair("path", context.File), make_pair("file", reference_wrapper<FilenameLazyCalc>(filename)),
-        make_pair("func", context.Function), make_pair("line", context.Line), make_pair("thread", context.ThreadId),
-        make_pair("msg", msg));
+void Logging::AnsiColorFormatter::SetColor(Level level, Colors fg, Colors bg)
+{
+    assert(static_cast<unsigned>(level) < CountOf(m_stColors));
+    m_stColors[static_cast<unsigned>(level)] = std::pair<Colors, Colors>(fg, bg);
 
-    // Color it
-    auto pair = GetColor(level);
-    int fg = 0, bg = 0;
-    switch (pair.first)
+    // 预先生成控制序列
+    int fgCode = 0, bgCode = 0;
+    switch (fg)
     {
         case Colors::Black:
-            fg = 30;
+            fgCode = 30;
             break;
         case Colors::Red:
-            fg = 31;
+            fgCode = 31;
             break;
         case Colors::Green:
-            fg = 32;
+            fgCode = 32;
             break;
         case Colors::Yellow:
-            fg = 33;
+            fgCode = 33;
             break;
         case Colors::Blue:
-            fg = 34;
+            fgCode = 34;
             break;
         case Colors::Magenta:
-            fg = 35;
+            fgCode = 35;
             break;
         case Colors::Cyan:
-            fg = 36;
+            fgCode = 36;
             break;
         case Colors::White:
-            fg = 37;
+            fgCode = 37;
             break;
         case Colors::BrightBlack:
-            fg = 90;
+            fgCode = 90;
             break;
         case Colors::BrightRed:
-            fg = 91;
+            fgCode = 91;
             break;
         case Colors::BrightGreen:
-            fg = 92;
+            fgCode = 92;
             break;
         case Colors::BrightYellow:
-            fg = 93;
+            fgCode = 93;
             break;
         case Colors::BrightBlue:
-            fg = 94;
+            fgCode = 94;
             break;
         case Colors::BrightMagenta:
-            fg = 95;
+            fgCode = 95;
             break;
         case Colors::BrightCyan:
-            fg = 96;
+            fgCode = 96;
             break;
         case Colors::BrightWhite:
-            fg = 97;
+            fgCode = 97;
             break;
         default:
             break;
     }
 
-    switch (pair.second)
+    switch (bg)
     {
         case Colors::Black:
-            bg = 40;
+            bgCode = 40;
             break;
         case Colors::Red:
-            bg = 41;
+            bgCode = 41;
             break;
         case Colors::Green:
-            bg = 42;
+            bgCode = 42;
             break;
         case Colors::Yellow:
-            bg = 43;
+            bgCode = 43;
             break;
         case Colors::Blue:
-            bg = 44;
+            bgCode = 44;
             break;
         case Colors::Magenta:
-            bg = 45;
+            bgCode = 45;
             break;
         case Colors::Cyan:
-            bg = 46;
+            bgCode = 46;
             break;
         case Colors::White:
-            bg = 47;
+            bgCode = 47;
             break;
         case Colors::BrightBlack:
-            bg = 100;
+            bgCode = 100;
             break;
         case Colors::BrightRed:
-            bg = 101;
+            bgCode = 101;
             break;
         case Colors::BrightGreen:
-            bg = 102;
+            bgCode = 102;
             break;
         case Colors::BrightYellow:
-            bg = 103;
+            bgCode = 103;
             break;
         case Colors::BrightBlue:
-            bg = 104;
+            bgCode = 104;
             break;
         case Colors::BrightMagenta:
-            bg = 105;
+            bgCode = 105;
             break;
         case Colors::BrightCyan:
-            bg = 106;
+            bgCode = 106;
             break;
         case Colors::BrightWhite:
-            bg = 107;
+            bgCode = 107;
             break;
         default:
             break;
     }
 
-    if (fg != 0 || bg != 0)
+    auto& prefix = m_stColorPrefix[static_cast<unsigned>(level)];
+    prefix.clear();
+    if (fgCode != 0 || bgCode != 0)
     {
-        char indicator[16] = { 0 };
         char buf[16] = { 0 };
 
-        indicator[0] = '\033';
-        indicator[1] = '[';
-
-        if (fg != 0)
+        prefix.append("\033[");
+        if (fgCode != 0)
         {
-            Convert::ToDecimalString(fg, buf);
-            strcat(indicator, buf);
+            Convert::ToDecimalString(fgCode, buf);
+            prefix.append(buf);
         }
-        if (bg != 0)
+        if (bgCode != 0)
         {
-            if (fg != 0)
-                strcat(indicator, ";");
+            if (fgCode != 0)
+                prefix.append(";");
 
-            Convert::ToDecimalString(bg, buf);
-            strcat(indicator, buf);
+            Convert::ToDecimalString(bgCode, buf);
+            prefix.append(buf);
         }
+        prefix.append("m");
+    }
+}
+
+void Logging::AnsiColorFormatter::Format(std::string& dest, Level level, const Context& context, const char* msg)const
+{
+    assert(static_cast<unsigned>(level) < CountOf(m_stColorPrefix));
+    const auto& prefix = m_stColorPrefix[static_cast<unsigned>(level)];
 
-        strcat(indicator, "m");
-        dest.insert(0, indicator);
+    dest.assign(prefix);
+    m_stPattern.Render(dest, level, context, msg);
+    if (!prefix.empty())
         dest.append("\033[m");
-    }
 }
 
 std::shared_ptr<Logging::FormatterBase> Logging::AnsiColorFormatter::Clone()const
@@ -335,37 +889,52 @@ void Logging::SinkBase::Log(Level level, const Context& context, const char* msg
     if (!ShouldLog(level))
         return;
 
+    Write(level, context, msg);
+
+    if (IsAlwaysFlush())
+        Flush();
+}
+
+void Logging::SinkBase::Flush()noexcept
+{
+}
+
+bool Logging::SinkBase::SinkBinary(Level level, const Context& context, const char* format, const char* args,
+    size_t length)noexcept
+{
+    MOE_UNUSED(level);
+    MOE_UNUSED(context);
+    MOE_UNUSED(format);
+    MOE_UNUSED(args);
+    MOE_UNUSED(length);
+    return false;
+}
+
+void Logging::SinkBase::Write(Level level, const Context& context, const char* msg)noexcept
+{
     if (!m_pFormatter)
-        Sink(level, context, msg, msg, strlen(msg));
-    else
     {
+        Sink(level, context, msg, msg, strlen(msg));
+        return;
+    }
+
 #ifndef MOE_EMSCRIPTEN
-        static thread_local string formatted;
+    static thread_local string formatted;
 #else
-        static string formatted;  // NOTE: emscripten 模拟多线程
+    static string formatted;  // NOTE: emscripten 模拟多线程
 #endif
 
-        try
-        {
-            m_pFormatter->Format(formatted, level, context, msg);
-        }
-        catch (...)
-        {
-            Sink(level, context, msg, kFormatErrorMsg, kFormatErrorMsgLength);
-            if (IsAlwaysFlush())
-                Flush();
-            return;
-        }
-
-        Sink(level, context, msg, formatted.c_str(), formatted.length());
+    try
+    {
+        m_pFormatter->Format(formatted, level, context, msg);
+    }
+    catch (...)
+    {
+        Sink(level, context, msg, kFormatErrorMsg, kFormatErrorMsgLength);
+        return;
     }
 
-    if (IsAlwaysFlush())
-        Flush();
-}
-
-void Logging::SinkBase::Flush()noexcept
-{
+    Sink(level, context, msg, formatted.c_str(), formatted.length());
 }
 
 //////////////////////////////////////////////////////////////////////////////// ConsoleSink
@@ -648,33 +1217,281 @@ void Logging::TerminalSink::Flush()noexcept
 #endif
 }
 
-//////////////////////////////////////////////////////////////////////////////// BasicFileSink
+//////////////////////////////////////////////////////////////////////////////// FileWriteBuffer
 
-Logging::BasicFileSink::BasicFileSink(const char* path, bool truncate)
+namespace
 {
-    m_pFile.reset(Pal::OpenFile(path, truncate ? "w" : "a"), FileCloser());
-}
+    /**
+     * @brief 将多段数据写入文件
+     *
+     * POSIX下直接对文件描述符调用writev，一次系统调用写出所有数据，调用前FILE的用户态缓冲区必须为空。
+     */
+    void WriteFileGather(FILE* file, const ArrayView<char>* parts, size_t count)noexcept
+    {
+#ifdef MOE_POSIX
+        static const size_t kMaxParts = 4;
+        assert(count <= kMaxParts);
 
-Logging::BasicFileSink::BasicFileSink(const BasicFileSink& rhs)
-    : SinkBase(rhs), m_pFile(rhs.m_pFile)
-{
-}
+        iovec vec[kMaxParts];
+        size_t left = 0;
+        for (size_t i = 0; i < count && left < kMaxParts; ++i)
+        {
+            if (parts[i].GetSize() == 0)
+                continue;
+            vec[left].iov_base = const_cast<char*>(parts[i].GetBuffer());
+            vec[left].iov_len = parts[i].GetSize();
+            ++left;
+        }
 
-std::shared_ptr<Logging::SinkBase> Logging::BasicFileSink::Clone()const
-{
-    return static_pointer_cast<Logging::SinkBase>(make_shared<Logging::BasicFileSink>(*this));
-}
+        auto fd = ::fileno(file);
+        auto p = vec;
+        while (left > 0)
+        {
+            auto ret = ::writev(fd, p, static_cast<int>(left));
+            if (ret < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;  // 忽略所有错误
+            }
 
-void Logging::BasicFileSink::Sink(Level level, const Context& context, const char* msg, const char* formatted,
-    size_t length)noexcept
-{
-    MOE_UNUSED(level);
-    MOE_UNUSED(context);
-    MOE_UNUSED(msg);
+            // 处理部分写入
+            auto written = static_cast<size_t>(ret);
+            while (left > 0 && written >= p->iov_len)
+            {
+                written -= p->iov_len;
+                ++p;
+                --left;
+            }
+            if (left > 0)
+            {
+                p->iov_base = static_cast<char*>(p->iov_base) + written;
+                p->iov_len -= written;
+            }
+        }
+#else
+        for (size_t i = 0; i < count; ++i)
+            ::fwrite(parts[i].GetBuffer(), sizeof(char), parts[i].GetSize(), file);  // 忽略所有错误
+        ::fflush(file);
+#endif
+    }
 
-    try
+    /**
+     * @brief 后台刷新线程
+     *
+     * 定期检查已注册的缓冲区是否超时，没有注册对象时线程退出。
+     */
+    class BackgroundFlusher
     {
-        unique_lock<mutex> guard(m_stLock);
+    public:
+        using Callback = void(*)(void*, Time::Timestamp);
+
+        static const uint32_t kDefaultTickMs = 100;
+
+        static BackgroundFlusher& GetInstance()
+        {
+            static BackgroundFlusher* s_pInstance = new BackgroundFlusher();  // 不析构，避免与其他静态对象的析构顺序冲突
+            return *s_pInstance;
+        }
+
+    public:
+        void Register(void* object, Callback callback, uint32_t intervalMs)
+        {
+            unique_lock<mutex> lock(m_stLock);
+            m_stEntries.push_back(Entry { object, callback, intervalMs });
+            if (!m_stWorker.joinable())
+            {
+                auto generation = m_uGeneration;
+                m_stWorker = thread([this, generation]() { Run(generation); });
+            }
+            m_stCond.notify_one();
+        }
+
+        void Unregister(void* object)noexcept
+        {
+            thread worker;
+            try
+            {
+                unique_lock<mutex> lock(m_stLock);
+                auto it = std::find_if(m_stEntries.begin(), m_stEntries.end(),
+                    [object](const Entry& e) { return e.Object == object; });
+                if (it == m_stEntries.end())
+                    return;
+                m_stEntries.erase(it);
+
+                if (m_stEntries.empty())
+                {
+                    ++m_uGeneration;  // 通知当前线程退出
+                    worker = std::move(m_stWorker);
+                }
+            }
+            catch (...)
+            {
+                assert(false);
+                return;
+            }
+
+            m_stCond.notify_all();
+            if (worker.joinable())
+                worker.join();
+        }
+
+    private:
+        struct Entry
+        {
+            void* Object;
+            Callback Func;
+            uint32_t IntervalMs;
+        };
+
+        void Run(uint64_t generation)noexcept
+        {
+            try
+            {
+                unique_lock<mutex> lock(m_stLock);
+                while (m_uGeneration == generation)
+                {
+                    // 以最短间隔的一半为周期，保证超时后至多再延迟半个周期写出
+                    uint32_t tick = kDefaultTickMs;
+                    for (auto& e : m_stEntries)
+                        tick = std::min(tick, std::max<uint32_t>(e.IntervalMs / 2, 1));
+                    m_stCond.wait_for(lock, chrono::milliseconds(tick));
+                    if (m_uGeneration != generation)
+                        break;
+
+                    auto now = Time::Now();
+                    for (auto& e : m_stEntries)
+                        e.Func(e.Object, now);
+                }
+            }
+            catch (...)
+            {
+                assert(false);
+            }
+        }
+
+    private:
+        mutex m_stLock;
+        condition_variable m_stCond;
+        vector<Entry> m_stEntries;
+        thread m_stWorker;
+        uint64_t m_uGeneration = 0;
+    };
+
+    const uint32_t BackgroundFlusher::kDefaultTickMs;
+}
+
+void Logging::FileWriteBuffer::Write(FILE* file, const char* data, size_t length, Time::Timestamp now,
+    bool force)noexcept
+{
+    if (!file)
+        return;
+
+    auto expired = m_stPolicy.FlushIntervalMs > 0 && !m_stBuffer.empty() &&
+        now >= m_ullFirstPendingTime + m_stPolicy.FlushIntervalMs;
+    if (!force && !expired && m_stBuffer.size() + length + 1 <= m_stPolicy.FlushBytes)
+    {
+        try
+        {
+            if (m_stBuffer.empty())
+            {
+                m_stBuffer.reserve(m_stPolicy.FlushBytes);
+                m_ullFirstPendingTime = now;
+            }
+            m_stBuffer.append(data, length);
+            m_stBuffer.push_back('\n');
+            return;
+        }
+        catch (...)  // 内存不足时直接写出
+        {
+        }
+    }
+
+    // 缓冲区连同当前日志一次写出
+    const ArrayView<char> parts[] = {
+        ArrayView<char>(m_stBuffer.data(), m_stBuffer.size()),
+        ArrayView<char>(data, length),
+        ArrayView<char>("\n", 1),
+    };
+    WriteFileGather(file, parts, CountOf(parts));
+    m_stBuffer.clear();
+}
+
+void Logging::FileWriteBuffer::Flush(FILE* file)noexcept
+{
+    if (!file || m_stBuffer.empty())
+        return;
+
+    ArrayView<char> part(m_stBuffer.data(), m_stBuffer.size());
+    WriteFileGather(file, &part, 1);
+    m_stBuffer.clear();
+}
+
+void Logging::FileWriteBuffer::FlushIfExpired(FILE* file, Time::Timestamp now)noexcept
+{
+    if (m_stPolicy.FlushIntervalMs > 0 && !m_stBuffer.empty() &&
+        now >= m_ullFirstPendingTime + m_stPolicy.FlushIntervalMs)
+    {
+        Flush(file);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// BasicFileSink
+
+Logging::BasicFileSink::BasicFileSink(const char* path, bool truncate)
+{
+    m_pFile.reset(Pal::OpenFile(path, truncate ? "w" : "a"), FileCloser());
+}
+
+Logging::BasicFileSink::BasicFileSink(const BasicFileSink& rhs)
+    : SinkBase(rhs), m_pFile(rhs.m_pFile)
+{
+    m_stBuffer.SetPolicy(rhs.m_stBuffer.GetPolicy());  // 缓冲中的数据不复制
+    if (m_stBuffer.IsEnabled() && m_stBuffer.GetPolicy().BackgroundFlush && m_stBuffer.GetPolicy().FlushIntervalMs > 0)
+        BackgroundFlusher::GetInstance().Register(this, OnFlushTimer, m_stBuffer.GetPolicy().FlushIntervalMs);
+}
+
+Logging::BasicFileSink::~BasicFileSink()
+{
+    BackgroundFlusher::GetInstance().Unregister(this);
+    m_stBuffer.Flush(m_pFile.get());
+}
+
+void Logging::BasicFileSink::SetBufferPolicy(const BufferPolicy& policy)
+{
+    BackgroundFlusher::GetInstance().Unregister(this);
+
+    m_stBuffer.Flush(m_pFile.get());
+    ::fflush(m_pFile.get());  // 缓冲模式下绕过FILE直接写出，需要先清空FILE的缓冲
+    m_stBuffer.SetPolicy(policy);
+
+    if (m_stBuffer.IsEnabled())
+    {
+        SetAlwaysFlush(false);
+        if (policy.BackgroundFlush && policy.FlushIntervalMs > 0)
+            BackgroundFlusher::GetInstance().Register(this, OnFlushTimer, policy.FlushIntervalMs);
+    }
+}
+
+std::shared_ptr<Logging::SinkBase> Logging::BasicFileSink::Clone()const
+{
+    return static_pointer_cast<Logging::SinkBase>(make_shared<Logging::BasicFileSink>(*this));
+}
+
+void Logging::BasicFileSink::Sink(Level level, const Context& context, const char* msg, const char* formatted,
+    size_t length)noexcept
+{
+    MOE_UNUSED(msg);
+
+    try
+    {
+        unique_lock<mutex> guard(m_stLock);
+        if (m_stBuffer.IsEnabled())
+        {
+            m_stBuffer.Write(m_pFile.get(), formatted, length, context.Time, level == Level::Fatal);
+            return;
+        }
+
         ::fwrite(formatted, sizeof(char), length, m_pFile.get());  // 忽略所有错误
         ::fwrite("\n", sizeof(char), 1, m_pFile.get());
     }
@@ -688,6 +1505,7 @@ void Logging::BasicFileSink::Flush()noexcept
     try
     {
         unique_lock<mutex> guard(m_stLock);
+        m_stBuffer.Flush(m_pFile.get());
         ::fflush(m_pFile.get());
     }
     catch (...)
@@ -695,6 +1513,19 @@ void Logging::BasicFileSink::Flush()noexcept
     }
 }
 
+void Logging::BasicFileSink::OnFlushTimer(void* self, Time::Timestamp now)noexcept
+{
+    auto sink = static_cast<BasicFileSink*>(self);
+    try
+    {
+        unique_lock<mutex> guard(sink->m_stLock);
+        sink->m_stBuffer.FlushIfExpired(sink->m_pFile.get(), now);
+    }
+    catch (...)
+    {
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////// RotatingFileSink
 
 Logging::RotatingFileSink::RotatingFileSink(const char* path, uint64_t size, unsigned count, bool alwaysSinkFirst)
@@ -715,12 +1546,41 @@ Logging::RotatingFileSink::RotatingFileSink(const RotatingFileSink& rhs)
     : SinkBase(rhs), m_pFile(rhs.m_pFile), m_stBaseFilename(rhs.m_stBaseFilename), m_stExtension(rhs.m_stExtension),
     m_uMaxSize(rhs.m_uMaxSize), m_uMaxCount(rhs.m_uMaxCount), m_uCurrentSize(rhs.m_uCurrentSize)
 {
+    m_stBuffer.SetPolicy(rhs.m_stBuffer.GetPolicy());  // 缓冲中的数据不复制
+    if (m_stBuffer.IsEnabled() && m_stBuffer.GetPolicy().BackgroundFlush && m_stBuffer.GetPolicy().FlushIntervalMs > 0)
+        BackgroundFlusher::GetInstance().Register(this, OnFlushTimer, m_stBuffer.GetPolicy().FlushIntervalMs);
+}
+
+Logging::RotatingFileSink::~RotatingFileSink()
+{
+    BackgroundFlusher::GetInstance().Unregister(this);
+    m_stBuffer.Flush(m_pFile.get());
+}
+
+void Logging::RotatingFileSink::SetBufferPolicy(const BufferPolicy& policy)
+{
+    BackgroundFlusher::GetInstance().Unregister(this);
+
+    m_stBuffer.Flush(m_pFile.get());
+    if (m_pFile)
+        ::fflush(m_pFile.get());  // 缓冲模式下绕过FILE直接写出，需要先清空FILE的缓冲
+    m_stBuffer.SetPolicy(policy);
+
+    if (m_stBuffer.IsEnabled())
+    {
+        SetAlwaysFlush(false);
+        if (policy.BackgroundFlush && policy.FlushIntervalMs > 0)
+            BackgroundFlusher::GetInstance().Register(this, OnFlushTimer, policy.FlushIntervalMs);
+    }
 }
 
 std::shared_ptr<Logging::SinkBase> Logging::RotatingFileSink::Clone()const
 {
     // Clone之后需要释放文件所有权，防止无法Rotate
     auto ret = static_pointer_cast<Logging::SinkBase>(make_shared<Logging::RotatingFileSink>(*this));
+
+    unique_lock<mutex> guard(const_cast<mutex&>(m_stLock));  // 后台刷新线程可能正在访问
+    const_cast<FileWriteBuffer&>(m_stBuffer).Flush(m_pFile.get());
     const_cast<SharedFileHandle&>(m_pFile).reset();
     return ret;
 }
@@ -728,8 +1588,6 @@ std::shared_ptr<Logging::SinkBase> Logging::RotatingFileSink::Clone()const
 void Logging::RotatingFileSink::Sink(Level level, const Context& context, const char* msg, const char* formatted,
     size_t length)noexcept
 {
-    MOE_UNUSED(level);
-    MOE_UNUSED(context);
     MOE_UNUSED(msg);
 
     try
@@ -745,12 +1603,23 @@ void Logging::RotatingFileSink::Sink(Level level, const Context& context, const
             }
         }
 
-        ::fwrite(formatted, sizeof(char), length, m_pFile.get());  // 忽略所有错误
-        ::fwrite("\n", sizeof(char), 1, m_pFile.get());
+        if (!m_pFile)
+            return;
+
+        if (m_stBuffer.IsEnabled())
+            m_stBuffer.Write(m_pFile.get(), formatted, length, context.Time, level == Level::Fatal);
+        else
+        {
+            ::fwrite(formatted, sizeof(char), length, m_pFile.get());  // 忽略所有错误
+            ::fwrite("\n", sizeof(char), 1, m_pFile.get());
+        }
 
         m_uCurrentSize += length + 1;
         if (m_uCurrentSize >= m_uMaxSize)
+        {
+            m_stBuffer.Flush(m_pFile.get());
             Rotate();
+        }
     }
     catch (...)
     {
@@ -763,7 +1632,23 @@ void Logging::RotatingFileSink::Flush()noexcept
     {
         unique_lock<mutex> guard(m_stLock);
         if (m_pFile)
+        {
+            m_stBuffer.Flush(m_pFile.get());
             ::fflush(m_pFile.get());
+        }
+    }
+    catch (...)
+    {
+    }
+}
+
+void Logging::RotatingFileSink::OnFlushTimer(void* self, Time::Timestamp now)noexcept
+{
+    auto sink = static_cast<RotatingFileSink*>(self);
+    try
+    {
+        unique_lock<mutex> guard(sink->m_stLock);
+        sink->m_stBuffer.FlushIfExpired(sink->m_pFile.get(), now);
     }
     catch (...)
     {
@@ -823,61 +1708,1282 @@ void Logging::RotatingFileSink::Rotate()
     OpenCurrentFile();
 }
 
-//////////////////////////////////////////////////////////////////////////////// Logging
+//////////////////////////////////////////////////////////////////////////////// BinaryFileSink
 
-Logging& Logging::GetInstance()noexcept
+namespace
 {
-    static Logging s_stLogging;
-    return s_stLogging;
+    const char kBinaryLogMagic[8] = { 'M', 'O', 'E', 'B', 'L', 'O', 'G', 1 };
+
+    enum class BinaryLogEntry : uint8_t
+    {
+        String = 1,  // id: u32, length: u32, data
+        // level: u8, time: u64, thread: u64, line: u32, file: u32, func: u32, format: u32, length: u32, data
+        // format为0时data为文本，否则为编码后的参数
+        Record = 2,
+    };
+
+    template <typename T>
+    void AppendBinary(string& out, const T& value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
 }
 
-void Logging::Commit()
+struct Logging::BinaryFileSink::State
 {
-    // 构造Sinks的拷贝
-    SinkContainerPtr p = make_shared<SinkContainerType>();
-    p->reserve(m_stSinks.size());
+    mutex Lock;
+    UniqueFileHandle File;
+    unordered_map<const void*, uint32_t> Strings;
+    uint32_t NextStringId = 1;  // 0表示空指针
+    string Buffer;
 
-    for (auto& i : m_stSinks)
-        p->emplace_back(i->Clone());
+    uint32_t Intern(const char* str)
+    {
+        if (!str)
+            return 0;
+
+        auto it = Strings.find(str);
+        if (it != Strings.end())
+            return it->second;
+
+        auto id = NextStringId++;
+        auto length = static_cast<uint32_t>(strlen(str));
+        Buffer.push_back(static_cast<char>(BinaryLogEntry::String));
+        AppendBinary(Buffer, id);
+        AppendBinary(Buffer, length);
+        Buffer.append(str, length);
+        Strings.emplace(str, id);
+        return id;
+    }
 
-    // 锁定m_stSinksInUse并赋予新值
+    void Write(Level level, const Context& context, const char* format, const char* data, size_t length)noexcept
     {
-        unique_lock<mutex> lock(m_stLock);
-        m_stSinksInUse = p;
+        try
+        {
+            unique_lock<mutex> guard(Lock);
+            Buffer.clear();
+
+            try
+            {
+                auto file = Intern(context.File);
+                auto func = Intern(context.Function);
+                auto fmt = Intern(format);
+
+                Buffer.push_back(static_cast<char>(BinaryLogEntry::Record));
+                Buffer.push_back(static_cast<char>(level));
+                AppendBinary(Buffer, static_cast<uint64_t>(context.Time));
+                AppendBinary(Buffer, context.ThreadId);
+                AppendBinary(Buffer, context.Line);
+                AppendBinary(Buffer, file);
+                AppendBinary(Buffer, func);
+                AppendBinary(Buffer, fmt);
+                AppendBinary(Buffer, static_cast<uint32_t>(length));
+                Buffer.append(data, length);
+            }
+            catch (...)
+            {
+                // 缓冲区中的字符串定义可能没有写出，全部作废重新定义
+                Strings.clear();
+                return;
+            }
+
+            ::fwrite(Buffer.data(), sizeof(char), Buffer.size(), File.get());  // 忽略所有错误
+        }
+        catch (...)
+        {
+        }
     }
+};
+
+Logging::BinaryFileSink::BinaryFileSink(const char* path, bool truncate)
+    : m_pState(make_shared<State>())
+{
+    m_pState->File.reset(Pal::OpenFile(path, truncate ? "wb" : "ab"));
+
+    ::fseek(m_pState->File.get(), 0, SEEK_END);
+    if (::ftell(m_pState->File.get()) == 0)
+        ::fwrite(kBinaryLogMagic, sizeof(char), sizeof(kBinaryLogMagic), m_pState->File.get());
 }
 
-std::string& Logging::GetFormatStringThreadCache()const noexcept
+Logging::BinaryFileSink::BinaryFileSink(const BinaryFileSink& rhs)
+    : SinkBase(rhs), m_pState(rhs.m_pState)
 {
-#ifndef MOE_EMSCRIPTEN
-    static thread_local string s_stBuffer;
-#else
-    static string s_stBuffer;  // NOTE: emscripten 模拟多线程
-#endif
-    return s_stBuffer;
 }
 
-void Logging::Sink(Level level, const Context& context, const char* msg)const noexcept
+std::shared_ptr<Logging::SinkBase> Logging::BinaryFileSink::Clone()const
+{
+    return static_pointer_cast<Logging::SinkBase>(make_shared<Logging::BinaryFileSink>(*this));
+}
+
+void Logging::BinaryFileSink::Sink(Level level, const Context& context, const char* msg, const char* formatted,
+    size_t length)noexcept
+{
+    MOE_UNUSED(formatted);
+    MOE_UNUSED(length);
+
+    m_pState->Write(level, context, nullptr, msg, strlen(msg));
+}
+
+bool Logging::BinaryFileSink::SinkBinary(Level level, const Context& context, const char* format, const char* args,
+    size_t length)noexcept
 {
-    // 获取指针
-    SinkContainerPtr p;
+    m_pState->Write(level, context, format, args, length);
+    return true;
+}
 
+void Logging::BinaryFileSink::Flush()noexcept
+{
     try
     {
-        unique_lock<mutex> lock(m_stLock);
-        p = m_stSinksInUse;
+        unique_lock<mutex> guard(m_pState->Lock);
+        ::fflush(m_pState->File.get());
     }
     catch (...)
     {
-        // 直接吃掉异常
-        assert(false);
-        return;
     }
+}
 
-    // 分发日志
-    if (p)
+//////////////////////////////////////////////////////////////////////////////// BinaryLogReader
+
+Logging::BinaryLogReader::BinaryLogReader(const char* path)
+{
+    m_pFile.reset(Pal::OpenFile(path, "rb"));
+
+    char magic[sizeof(kBinaryLogMagic)];
+    if (!ReadBytes(magic, sizeof(magic)) || ::memcmp(magic, kBinaryLogMagic, sizeof(magic)) != 0)
+        MOE_THROW(BadFormatException, "Bad binary log header");
+}
+
+bool Logging::BinaryLogReader::Read(Level& level, Context& context, std::string& msg)
+{
+    auto readField = [this](void* buffer, size_t size) {
+        if (!ReadBytes(buffer, size))
+            MOE_THROW(BadFormatException, "Unexpected end of file");
+    };
+
+    while (true)
     {
-        for (auto it = p->begin(); it != p->end(); ++it)
-            (*it)->Log(level, context, msg);
+        uint8_t kind = 0;
+        if (!ReadBytes(&kind, sizeof(kind)))
+            return false;
+
+        if (kind == static_cast<uint8_t>(BinaryLogEntry::String))
+        {
+            uint32_t id = 0, length = 0;
+            readField(&id, sizeof(id));
+            readField(&length, sizeof(length));
+
+            string str;
+            str.resize(length);
+            if (length > 0)
+                readField(&str[0], length);
+            m_stStrings.emplace(id, std::move(str));
+            continue;
+        }
+        else if (kind != static_cast<uint8_t>(BinaryLogEntry::Record))
+            MOE_THROW(BadFormatException, "Unknown entry kind {0}", kind);
+
+        uint8_t lv = 0;
+        uint64_t time = 0, tid = 0;
+        uint32_t line = 0, file = 0, func = 0, format = 0, length = 0;
+        readField(&lv, sizeof(lv));
+        readField(&time, sizeof(time));
+        readField(&tid, sizeof(tid));
+        readField(&line, sizeof(line));
+        readField(&file, sizeof(file));
+        readField(&func, sizeof(func));
+        readField(&format, sizeof(format));
+        readField(&length, sizeof(length));
+        if (lv >= kLevelCount)
+            MOE_THROW(BadFormatException, "Bad log level {0}", lv);
+
+        m_stArguments.resize(length);
+        if (length > 0)
+            readField(&m_stArguments[0], length);
+
+        level = static_cast<Level>(lv);
+        context = Context(time, GetString(file), line, GetString(func), tid);
+        if (format == 0)
+            msg.assign(m_stArguments);
+        else
+            FormatDeferredArguments(msg, GetString(format), m_stArguments.data(), m_stArguments.size());
+        return true;
+    }
+}
+
+size_t Logging::BinaryLogReader::Replay(SinkBase& sink)
+{
+    size_t count = 0;
+    Level level = Level::Debug;
+    Context context;
+    string msg;
+    while (Read(level, context, msg))
+    {
+        sink.Log(level, context, msg.c_str());
+        ++count;
+    }
+    sink.Flush();
+    return count;
+}
+
+bool Logging::BinaryLogReader::ReadBytes(void* buffer, size_t size)
+{
+    auto count = ::fread(buffer, 1, size, m_pFile.get());
+    if (count == size)
+        return true;
+    if (count == 0 && ::feof(m_pFile.get()))
+        return false;
+    MOE_THROW(BadFormatException, "Unexpected end of file");
+}
+
+const char* Logging::BinaryLogReader::GetString(uint32_t id)const
+{
+    if (id == 0)
+        return nullptr;
+
+    auto it = m_stStrings.find(id);
+    if (it == m_stStrings.end())
+        MOE_THROW(BadFormatException, "Undefined string {0}", id);
+    return it->second.c_str();
+}
+
+//////////////////////////////////////////////////////////////////////////////// RingFileSink
+
+namespace
+{
+    const char kRingLogMagic[8] = { 'M', 'O', 'E', 'R', 'I', 'N', 'G', 1 };
+
+    struct RingFileHeader
+    {
+        char Magic[8];
+        uint64_t Capacity;
+        char Padding[48];
+    };
+
+    struct RingRecordHeader
+    {
+        uint64_t Position;  // 记录在环上的绝对位置，用于识别记录边界及新旧
+        uint64_t Time;
+        uint32_t Length;  // 数据长度
+        uint32_t Checksum;  // 对Checksum置0的记录头和数据计算
+        uint8_t Level;
+        uint8_t Padding[7];
+    };
+
+    static_assert(sizeof(RingFileHeader) == 64, "Bad RingFileHeader");
+    static_assert(sizeof(RingRecordHeader) == 32, "Bad RingRecordHeader");
+
+    const size_t kRingAlignment = 8;
+
+    size_t AlignRingSize(size_t size)noexcept
+    {
+        return (size + kRingAlignment - 1) & ~(kRingAlignment - 1);
+    }
+
+    uint32_t ComputeRingChecksum(const RingRecordHeader& header, const char* data)noexcept
+    {
+        auto copy = header;
+        copy.Checksum = 0;
+
+        Hasher::Murmur3<0x52494E47> hasher;
+        hasher.Update(BytesView(reinterpret_cast<const uint8_t*>(&copy), sizeof(copy)));
+        hasher.Update(BytesView(reinterpret_cast<const uint8_t*>(data), header.Length));
+        return static_cast<uint32_t>(hasher.Final());
+    }
+
+    void WriteRing(uint8_t* ring, size_t capacity, uint64_t position, const void* data, size_t length)noexcept
+    {
+        auto offset = static_cast<size_t>(position % capacity);
+        auto first = std::min(length, capacity - offset);
+        ::memcpy(ring + offset, data, first);
+        if (first < length)
+            ::memcpy(ring, static_cast<const uint8_t*>(data) + first, length - first);
+    }
+
+    void ReadRing(const uint8_t* ring, size_t capacity, uint64_t position, void* data, size_t length)noexcept
+    {
+        auto offset = static_cast<size_t>(position % capacity);
+        auto first = std::min(length, capacity - offset);
+        ::memcpy(data, ring + offset, first);
+        if (first < length)
+            ::memcpy(static_cast<uint8_t*>(data) + first, ring, length - first);
+    }
+
+    /**
+     * @brief 扫描环上所有完整的记录
+     * @param ring 环
+     * @param capacity 环大小
+     * @param callback 回调，参数为记录头及数据
+     *
+     * 记录头中的位置与所在偏移一致且校验通过的记录才被视为完整。
+     */
+    template <typename T>
+    void ScanRing(const uint8_t* ring, size_t capacity, string& buffer, T callback)
+    {
+        RingRecordHeader header;
+        for (size_t offset = 0; offset < capacity; offset += kRingAlignment)
+        {
+            ReadRing(ring, capacity, offset, &header, sizeof(header));
+            if (header.Position % capacity != offset || header.Length > capacity - sizeof(header) ||
+                header.Level > static_cast<uint8_t>(Logging::Level::Fatal))
+            {
+                continue;
+            }
+
+            buffer.resize(header.Length);
+            ReadRing(ring, capacity, header.Position + sizeof(header), &buffer[0], header.Length);
+            if (ComputeRingChecksum(header, buffer.data()) != header.Checksum)
+                continue;
+
+            callback(header, buffer);
+        }
+    }
+}
+
+const size_t Logging::RingFileSink::kDefaultCapacity;
+
+struct Logging::RingFileSink::State
+{
+    Pal::MappedFile File;
+    uint8_t* Ring = nullptr;
+    size_t Capacity = 0;
+    atomic<uint64_t> WritePosition { 0 };
+};
+
+Logging::RingFileSink::RingFileSink(const char* path, size_t capacity)
+    : m_pState(make_shared<State>())
+{
+    capacity = AlignRingSize(std::max(capacity, sizeof(RingRecordHeader) * 2));
+
+    m_pState->File = Pal::MappedFile(path, sizeof(RingFileHeader) + capacity);
+    m_pState->Ring = static_cast<uint8_t*>(m_pState->File.GetPointer()) + sizeof(RingFileHeader);
+    m_pState->Capacity = capacity;
+
+    auto header = static_cast<RingFileHeader*>(m_pState->File.GetPointer());
+    if (::memcmp(header->Magic, kRingLogMagic, sizeof(kRingLogMagic)) == 0 && header->Capacity == capacity)
+    {
+        // 接着已有的日志写入
+        string buffer;
+        uint64_t end = 0;
+        ScanRing(m_pState->Ring, capacity, buffer, [&end](const RingRecordHeader& record, const string&) {
+            end = std::max<uint64_t>(end, record.Position + AlignRingSize(sizeof(record) + record.Length));
+        });
+        m_pState->WritePosition.store(end, memory_order_relaxed);
+    }
+    else
+    {
+        ::memset(m_pState->File.GetPointer(), 0, m_pState->File.GetSize());
+        ::memcpy(header->Magic, kRingLogMagic, sizeof(kRingLogMagic));
+        header->Capacity = capacity;
+    }
+
+    SetAlwaysFlush(false);
+}
+
+Logging::RingFileSink::RingFileSink(const RingFileSink& rhs)
+    : SinkBase(rhs), m_pState(rhs.m_pState)
+{
+}
+
+std::shared_ptr<Logging::SinkBase> Logging::RingFileSink::Clone()const
+{
+    return static_pointer_cast<Logging::SinkBase>(make_shared<Logging::RingFileSink>(*this));
+}
+
+void Logging::RingFileSink::Sink(Level level, const Context& context, const char* msg, const char* formatted,
+    size_t length)noexcept
+{
+    MOE_UNUSED(msg);
+
+    auto& state = *m_pState;
+    length = std::min(length, state.Capacity - sizeof(RingRecordHeader));  // 超长的日志截断
+
+    RingRecordHeader header;
+    ::memset(&header, 0, sizeof(header));
+    header.Time = context.Time;
+    header.Length = static_cast<uint32_t>(length);
+    header.Level = static_cast<uint8_t>(level);
+
+    // 占位后各线程独立写入
+    auto size = AlignRingSize(sizeof(header) + length);
+    header.Position = state.WritePosition.fetch_add(size, memory_order_relaxed);
+    header.Checksum = ComputeRingChecksum(header, formatted);
+
+    WriteRing(state.Ring, state.Capacity, header.Position + sizeof(header), formatted, length);
+    WriteRing(state.Ring, state.Capacity, header.Position, &header, sizeof(header));
+}
+
+void Logging::RingFileSink::Flush()noexcept
+{
+    m_pState->File.Sync(false);
+}
+
+//////////////////////////////////////////////////////////////////////////////// RingFileReader
+
+Logging::RingFileReader::RingFileReader(const char* path)
+{
+    Pal::MappedFile file(path, 0, true);
+    if (file.GetSize() <= sizeof(RingFileHeader))
+        MOE_THROW(BadFormatException, "Bad ring log header");
+
+    auto header = static_cast<const RingFileHeader*>(file.GetPointer());
+    auto capacity = file.GetSize() - sizeof(RingFileHeader);
+    if (::memcmp(header->Magic, kRingLogMagic, sizeof(kRingLogMagic)) != 0 || header->Capacity != capacity ||
+        capacity % kRingAlignment != 0)
+    {
+        MOE_THROW(BadFormatException, "Bad ring log header");
+    }
+
+    string buffer;
+    uint64_t end = 0;
+    auto ring = static_cast<const uint8_t*>(file.GetPointer()) + sizeof(RingFileHeader);
+    ScanRing(ring, capacity, buffer, [this, &end](const RingRecordHeader& record, const string& data) {
+        Record r { record.Position, static_cast<Level>(record.Level), record.Time, data };
+        m_stRecords.emplace_back(std::move(r));
+        end = std::max<uint64_t>(end, record.Position + AlignRingSize(sizeof(record) + record.Length));
+    });
+
+    // 丢弃已被覆盖区间中残留的旧记录（例如写入者占位后未写入）
+    auto begin = end > capacity ? end - capacity : 0;
+    m_stRecords.erase(std::remove_if(m_stRecords.begin(), m_stRecords.end(),
+        [begin](const Record& r) { return r.Position < begin; }), m_stRecords.end());
+    std::sort(m_stRecords.begin(), m_stRecords.end(),
+        [](const Record& lhs, const Record& rhs) { return lhs.Position < rhs.Position; });
+}
+
+bool Logging::RingFileReader::Read(Level& level, Time::Timestamp& time, std::string& msg)
+{
+    if (m_uNext >= m_stRecords.size())
+        return false;
+
+    auto& record = m_stRecords[m_uNext++];
+    level = record.RecordLevel;
+    time = record.Time;
+    msg = std::move(record.Message);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////// Module
+
+const uint32_t Logging::LevelFilter::kOverrideBit;
+
+Logging::Module::Module(const char* name, Logging& logging)
+    : m_stLogging(logging), m_stName(name), m_stFilter(0)
+{
+    unique_lock<mutex> guard(logging.m_stModuleLock);
+
+    auto it = logging.m_stModuleFilters.find(m_stName);
+    m_stFilter.Store(it != logging.m_stModuleFilters.end() ? it->second : logging.m_stFilter.Load());
+    logging.m_stModules.push_back(this);
+}
+
+Logging::Module::~Module()
+{
+    unique_lock<mutex> guard(m_stLogging.m_stModuleLock);
+
+    auto it = std::find(m_stLogging.m_stModules.begin(), m_stLogging.m_stModules.end(), this);
+    assert(it != m_stLogging.m_stModules.end());
+    m_stLogging.m_stModules.erase(it);
+}
+
+//////////////////////////////////////////////////////////////////////////////// AsyncState
+
+/**
+ * @brief 异步模式状态
+ *
+ * 基于序号的有界多生产者环形队列，消费者只有后台线程一个。
+ * 每个槽位的Sequence等于pos时可写、等于pos+1时可读，读取完毕后置为pos+容量。
+ */
+struct Logging::AsyncState
+{
+    static const size_t kBatchSize = 256;  // 单批最多分发的日志个数
+    static const unsigned kWaitTimeoutMs = 10;  // 等待超时，用于兜底可能丢失的唤醒
+
+    struct Record
+    {
+        atomic<size_t> Sequence;
+        Level LogLevel = Level::Debug;
+        Context LogContext;
+        const char* Format = nullptr;  // 非空时为延迟格式化，Message存放编码后的参数
+        string Message;  // 槽位复用，容量会被保留
+        bool AllocFailed = false;
+    };
+
+    OverflowPolicy Policy = OverflowPolicy::Block;
+    size_t Mask = 0;
+    unique_ptr<Record[]> Records;
+
+    atomic<size_t> EnqueuePos;  // 下一个写入位置
+    size_t DequeuePos = 0;  // 下一个读取位置，仅后台线程访问
+    atomic<size_t> Processed;  // 已经写出的日志个数
+    atomic<bool> Stopping;
+    atomic<bool> Sleeping;
+    atomic<unsigned> Waiters;  // 正在等待写出的生产者个数
+
+    mutex Lock;
+    condition_variable WakeCond;  // 唤醒后台线程
+    condition_variable DoneCond;  // 通知等待中的生产者
+    thread Worker;
+
+    AsyncState(size_t capacity, OverflowPolicy policy)
+        : Policy(policy), Mask(capacity - 1), Records(new Record[capacity]), EnqueuePos(0), Processed(0),
+        Stopping(false), Sleeping(false), Waiters(0)
+    {
+        assert((capacity & Mask) == 0);
+        for (size_t i = 0; i < capacity; ++i)
+            Records[i].Sequence.store(i, memory_order_relaxed);
+    }
+
+    bool TryPush(Level level, const Context& context, const char* format, const char* data, size_t length,
+        size_t& ticket)noexcept
+    {
+        auto pos = EnqueuePos.load(memory_order_relaxed);
+        Record* record = nullptr;
+        while (true)
+        {
+            record = &Records[pos & Mask];
+            auto seq = record->Sequence.load(memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq - pos);
+            if (diff == 0)
+            {
+                if (EnqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)  // 队列已满
+                return false;
+            else
+                pos = EnqueuePos.load(memory_order_relaxed);
+        }
+
+        record->LogLevel = level;
+        record->LogContext = context;
+        record->Format = format;
+        try
+        {
+            record->Message.assign(data, length);
+            record->AllocFailed = false;
+        }
+        catch (...)
+        {
+            record->Message.clear();
+            record->AllocFailed = true;
+        }
+        record->Sequence.store(pos + 1, memory_order_release);
+
+        ticket = pos + 1;
+        if (Sleeping.load(memory_order_acquire))
+            WakeCond.notify_one();
+        return true;
+    }
+
+    Record* Peek()noexcept
+    {
+        auto& record = Records[DequeuePos & Mask];
+        if (record.Sequence.load(memory_order_acquire) != DequeuePos + 1)
+            return nullptr;
+        return &record;
+    }
+
+    void Pop(Record& record)noexcept
+    {
+        record.Sequence.store(DequeuePos + Mask + 1, memory_order_release);
+        ++DequeuePos;
+    }
+};
+
+const size_t Logging::AsyncState::kBatchSize;
+const unsigned Logging::AsyncState::kWaitTimeoutMs;
+
+//////////////////////////////////////////////////////////////////////////////// RateLimitState
+
+/**
+ * @brief 调用点限流状态
+ *
+ * 调用点存放在定长的开放寻址表中，插入后不再删除。令牌桶以GCRA的形式实现：每个调用点只记录下一条日志的理论到达时间，
+ * 判断和更新只需一次CAS。
+ */
+struct Logging::RateLimitState
+{
+    static const unsigned kMaxProbe = 8;  // 最大探测次数，超出视为表满
+    static const uint64_t kEmptyKey = 0;
+    static const uint64_t kBusyKey = 1;  // 正在写入调用点信息
+
+    struct Site
+    {
+        atomic<uint64_t> Key { kEmptyKey };
+        const char* File = nullptr;
+        uint32_t Line = 0;
+        const char* Function = nullptr;
+        Level SiteLevel = Level::Debug;
+
+        atomic<uint64_t> Tat { 0 };  // 理论到达时间（微秒）
+        atomic<uint64_t> Rejected { 0 };  // 超出限制的总次数，用于采样
+        atomic<uint64_t> Suppressed { 0 };  // 尚未汇总的抑制条数
+        atomic<uint64_t> LastReport { 0 };  // 上次汇总的时间（微秒）
+    };
+
+    RateLimitPolicy Policy;
+    uint64_t EmissionInterval = 0;  // 每个令牌的恢复时间（微秒）
+    uint64_t Tolerance = 0;  // 突发容忍量（微秒）
+    uint64_t ReportInterval = 0;  // 汇总间隔（微秒）
+    size_t Mask = 0;
+    unique_ptr<Site[]> Sites;
+
+    uint64_t Now()const noexcept
+    {
+        if (Policy.Clock)
+            return Policy.Clock();
+        auto clock = Pal::GetMonotonicClock();
+        return clock.first * 1000 + clock.second / 1000;
+    }
+
+    static uint64_t MakeKey(const char* file, uint32_t line)noexcept
+    {
+        // SplitMix64
+        auto x = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(file)) * 0x9E3779B97F4A7C15ull + line;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        x = x ^ (x >> 31);
+        return x <= kBusyKey ? x + 2 : x;
+    }
+
+    RateLimitState(const RateLimitPolicy& policy, size_t capacity)
+        : Policy(policy), Mask(capacity - 1), Sites(new Site[capacity])
+    {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+        EmissionInterval = 1000000u / std::max<uint32_t>(policy.RatePerSecond, 1);
+        Tolerance = EmissionInterval * policy.Burst;
+        ReportInterval = policy.ReportIntervalMs * 1000ull;
+    }
+
+    Site* FindOrInsert(Level level, const Context& context, uint64_t now)noexcept
+    {
+        auto key = MakeKey(context.File, context.Line);
+        for (unsigned i = 0; i < kMaxProbe; ++i)
+        {
+            auto& site = Sites[(key + i) & Mask];
+            auto current = site.Key.load(memory_order_acquire);
+            if (current == kEmptyKey)
+            {
+                if (!site.Key.compare_exchange_strong(current, kBusyKey, memory_order_acq_rel))
+                {
+                    if (current == kBusyKey)
+                        return nullptr;
+                    if (current == key && site.File == context.File && site.Line == context.Line)
+                        return &site;
+                    continue;
+                }
+
+                site.File = context.File;
+                site.Line = context.Line;
+                site.Function = context.Function;
+                site.SiteLevel = level;
+                site.LastReport.store(now, memory_order_relaxed);
+                site.Key.store(key, memory_order_release);
+                return &site;
+            }
+            else if (current == kBusyKey)
+                return nullptr;  // 其他线程正在插入，本次不做限制
+            else if (current == key && site.File == context.File && site.Line == context.Line)
+                return &site;
+        }
+        return nullptr;
+    }
+
+    bool TryAcquire(Site& site, uint64_t now)const noexcept
+    {
+        auto tat = site.Tat.load(memory_order_relaxed);
+        while (true)
+        {
+            auto next = std::max(tat, now) + EmissionInterval;
+            if (next - now > Tolerance)
+                return false;
+            if (site.Tat.compare_exchange_weak(tat, next, memory_order_relaxed))
+                return true;
+        }
+    }
+
+    bool TryBeginReport(Site& site, uint64_t now, bool force, uint64_t& elapsed)const noexcept
+    {
+        if (site.Suppressed.load(memory_order_relaxed) == 0)
+            return false;
+
+        auto last = site.LastReport.load(memory_order_relaxed);
+        do
+        {
+            if (!force && (ReportInterval == 0 || now < last + ReportInterval))
+                return false;
+        } while (!site.LastReport.compare_exchange_weak(last, now, memory_order_relaxed));
+
+        elapsed = now > last ? now - last : 0;
+        return true;
+    }
+};
+
+const unsigned Logging::RateLimitState::kMaxProbe;
+const uint64_t Logging::RateLimitState::kEmptyKey;
+const uint64_t Logging::RateLimitState::kBusyKey;
+
+/**
+ * @brief 一条待输出的抑制汇总
+ */
+struct Logging::SuppressedReport
+{
+    Level SiteLevel;
+    const char* File;
+    uint32_t Line;
+    const char* Function;
+    uint64_t Count;
+    uint64_t ElapsedMs;
+};
+
+//////////////////////////////////////////////////////////////////////////////// Logging
+
+Logging& Logging::GetInstance()noexcept
+{
+    static Logging s_stLogging;
+    return s_stLogging;
+}
+
+Logging::~Logging()
+{
+    assert(m_stModules.empty());  // 模块的生命周期不得超过Logging
+
+    DisableRateLimit();
+    DisableAsync();
+    delete m_pSinksInUse.load(memory_order_relaxed);
+}
+
+void Logging::Commit()
+{
+    // 构造Sinks的拷贝
+    unique_ptr<SinkContainerType> p(new SinkContainerType());
+    p->reserve(m_stSinks.size());
+
+    for (auto& i : m_stSinks)
+        p->emplace_back(i->Clone());
+
+    // 发布新的快照，等待所有读者离开旧快照后回收
+    auto old = m_pSinksInUse.exchange(p.release(), memory_order_seq_cst);
+    if (old)
+    {
+        Threading::Rcu::Synchronize();
+        delete old;
+    }
+}
+
+void Logging::SetMinLevel(Level level)noexcept
+{
+    try
+    {
+        unique_lock<mutex> guard(m_stModuleLock);
+        UpdateLevel(level, GetMaxLevel());
+    }
+    catch (...)
+    {
+        assert(false);
+    }
+}
+
+void Logging::SetMaxLevel(Level level)noexcept
+{
+    try
+    {
+        unique_lock<mutex> guard(m_stModuleLock);
+        UpdateLevel(GetMinLevel(), level);
+    }
+    catch (...)
+    {
+        assert(false);
+    }
+}
+
+void Logging::SetModuleLevel(const char* name, Level min, Level max)
+{
+    auto state = LevelFilter::Make(min, max, true);
+
+    unique_lock<mutex> guard(m_stModuleLock);
+    m_stModuleFilters[name] = state;
+    for (auto module : m_stModules)
+    {
+        if (module->m_stName == name)
+            module->m_stFilter.Store(state);
+    }
+}
+
+void Logging::ResetModuleLevel(const char* name)
+{
+    unique_lock<mutex> guard(m_stModuleLock);
+    m_stModuleFilters.erase(name);
+
+    auto state = m_stFilter.Load();
+    for (auto module : m_stModules)
+    {
+        if (module->m_stName == name)
+            module->m_stFilter.Store(state);
+    }
+}
+
+void Logging::EnableAsync(size_t queueSize, OverflowPolicy policy)
+{
+    DisableAsync();
+
+    size_t capacity = 2;
+    while (capacity < queueSize)
+        capacity <<= 1;
+
+    unique_ptr<AsyncState> state(new AsyncState(capacity, policy));
+    auto p = state.get();
+    state->Worker = thread([this, p]() { AsyncWorker(*p); });
+
+    m_pAsyncState.store(state.release(), memory_order_seq_cst);
+}
+
+void Logging::DisableAsync()noexcept
+{
+    auto state = m_pAsyncState.exchange(nullptr, memory_order_seq_cst);
+    if (!state)
+        return;
+
+    // 等待仍持有异步状态的生产者离开，此时后台线程仍在消费，阻塞中的生产者可以继续
+    while (m_uAsyncUsers.load(memory_order_seq_cst) != 0)
+        this_thread::yield();
+
+    state->Stopping.store(true, memory_order_release);
+    state->WakeCond.notify_one();
+    state->Worker.join();
+    delete state;
+}
+
+void Logging::Flush()noexcept
+{
+    ReportSuppressed(true);
+
+    if (m_pAsyncState.load(memory_order_relaxed))
+    {
+        m_uAsyncUsers.fetch_add(1, memory_order_seq_cst);
+        auto state = m_pAsyncState.load(memory_order_seq_cst);
+        if (state)
+            AsyncWait(*state, state->EnqueuePos.load(memory_order_relaxed));
+        m_uAsyncUsers.fetch_sub(1, memory_order_release);
+    }
+
+    Threading::Rcu::ReadGuard guard;
+    auto p = GetSinksInUse();
+    if (p)
+    {
+        for (auto it = p->begin(); it != p->end(); ++it)
+            (*it)->Flush();
+    }
+}
+
+void Logging::EnableRateLimit(const RateLimitPolicy& policy, size_t sites)
+{
+    DisableRateLimit();
+
+    size_t capacity = 2;
+    while (capacity < sites)
+        capacity <<= 1;
+
+    m_pRateLimitState.store(new RateLimitState(policy, capacity), memory_order_seq_cst);
+
+    if (policy.ReportIntervalMs > 0)
+        BackgroundFlusher::GetInstance().Register(this, OnRateLimitTimer, policy.ReportIntervalMs);
+}
+
+void Logging::DisableRateLimit()noexcept
+{
+    auto state = m_pRateLimitState.exchange(nullptr, memory_order_seq_cst);
+    if (!state)
+        return;
+
+    BackgroundFlusher::GetInstance().Unregister(this);
+    Threading::Rcu::Synchronize();
+
+    // 输出剩余的汇总
+    auto now = state->Now();
+    for (size_t i = 0; i <= state->Mask; ++i)
+    {
+        auto& site = state->Sites[i];
+        uint64_t elapsed = 0;
+        if (site.Key.load(memory_order_acquire) > RateLimitState::kBusyKey &&
+            state->TryBeginReport(site, now, true, elapsed))
+        {
+            SuppressedReport report { site.SiteLevel, site.File, site.Line, site.Function,
+                site.Suppressed.exchange(0, memory_order_relaxed), elapsed / 1000 };
+            SinkSuppressedReport(report);
+        }
+    }
+    delete state;
+}
+
+uint64_t Logging::GetDroppedCount()const noexcept
+{
+    uint64_t ret = 0;
+    for (unsigned i = 0; i < kLevelCount; ++i)
+        ret += m_stDroppedCount[i].load(memory_order_relaxed);
+    return ret;
+}
+
+void Logging::ResetDroppedCount()noexcept
+{
+    for (unsigned i = 0; i < kLevelCount; ++i)
+        m_stDroppedCount[i].store(0, memory_order_relaxed);
+}
+
+std::string& Logging::GetFormatStringThreadCache()const noexcept
+{
+#ifndef MOE_EMSCRIPTEN
+    static thread_local string s_stBuffer;
+#else
+    static string s_stBuffer;  // NOTE: emscripten 模拟多线程
+#endif
+    return s_stBuffer;
+}
+
+void Logging::OnRateLimitTimer(void* self, Time::Timestamp now)noexcept
+{
+    MOE_UNUSED(now);
+    static_cast<Logging*>(self)->ReportSuppressed(false);
+}
+
+bool Logging::RateLimitAdmit(Level level, const Context& context)const noexcept
+{
+    SuppressedReport report;
+    {
+        Threading::Rcu::ReadGuard guard;
+        auto state = m_pRateLimitState.load(memory_order_acquire);
+        if (!state)
+            return true;
+
+        auto now = state->Now();
+        auto site = state->FindOrInsert(level, context, now);
+        if (!site || state->TryAcquire(*site, now))
+            return true;
+
+        // 超出限制后采样放行
+        auto rejected = site->Rejected.fetch_add(1, memory_order_relaxed) + 1;
+        if (state->Policy.SampleEvery > 0 && rejected % state->Policy.SampleEvery == 0)
+            return true;
+
+        m_ullSuppressedCount.fetch_add(1, memory_order_relaxed);
+        site->Suppressed.fetch_add(1, memory_order_relaxed);
+
+        // 到达汇总间隔时由当前线程输出汇总
+        uint64_t elapsed = 0;
+        if (!state->TryBeginReport(*site, now, false, elapsed))
+            return false;
+
+        report.SiteLevel = site->SiteLevel;
+        report.File = site->File;
+        report.Line = site->Line;
+        report.Function = site->Function;
+        report.Count = site->Suppressed.exchange(0, memory_order_relaxed);
+        report.ElapsedMs = elapsed / 1000;
+    }
+
+    SinkSuppressedReport(report);
+    return false;
+}
+
+void Logging::ReportSuppressed(bool force)const noexcept
+{
+    if (!m_pRateLimitState.load(memory_order_relaxed))
+        return;
+
+    vector<SuppressedReport> reports;
+    try
+    {
+        Threading::Rcu::ReadGuard guard;
+        auto state = m_pRateLimitState.load(memory_order_acquire);
+        if (!state)
+            return;
+
+        auto now = state->Now();
+        for (size_t i = 0; i <= state->Mask; ++i)
+        {
+            auto& site = state->Sites[i];
+            uint64_t elapsed = 0;
+            if (site.Key.load(memory_order_acquire) > RateLimitState::kBusyKey &&
+                state->TryBeginReport(site, now, force, elapsed))
+            {
+                reports.push_back(SuppressedReport { site.SiteLevel, site.File, site.Line, site.Function,
+                    site.Suppressed.exchange(0, memory_order_relaxed), elapsed / 1000 });
+            }
+        }
+    }
+    catch (...)
+    {
+        assert(false);
+    }
+
+    // 离开读端临界区后再输出，避免阻塞Commit
+    for (const auto& report : reports)
+        SinkSuppressedReport(report);
+}
+
+void Logging::SinkSuppressedReport(const SuppressedReport& report)const noexcept
+{
+    if (report.Count == 0)
+        return;
+
+    Context context(Time::Now(), report.File, report.Line, report.Function, Context::GetThreadIdCached());
+    std::string& formatted = GetFormatStringThreadCache();
+    formatted.clear();
+
+    try
+    {
+        StringUtils::Format(formatted, "(Suppressed {0} message(s) from this call site in the last {1} ms)",
+            report.Count, report.ElapsedMs);
+        Sink(report.SiteLevel, context, formatted.c_str());
+    }
+    catch (...)
+    {
+        Sink(Level::Fatal, context, kAllocErrorMsg);
+    }
+}
+
+const Logging::SinkContainerType* Logging::GetSinksInUse()const noexcept
+{
+    return m_pSinksInUse.load(memory_order_acquire);
+}
+
+void Logging::Sink(Level level, const Context& context, const char* msg)const noexcept
+{
+    // 异步模式下交给后台线程
+    if (m_pAsyncState.load(memory_order_relaxed))
+    {
+        m_uAsyncUsers.fetch_add(1, memory_order_seq_cst);
+        auto state = m_pAsyncState.load(memory_order_seq_cst);
+        if (state)
+            AsyncSink(*state, level, context, nullptr, msg, strlen(msg));
+        m_uAsyncUsers.fetch_sub(1, memory_order_release);
+        if (state)
+            return;
+    }
+
+    // 获取快照，读端无锁
+    Threading::Rcu::ReadGuard guard;
+    auto p = GetSinksInUse();
+
+    // 分发日志
+    if (p)
+    {
+        for (auto it = p->begin(); it != p->end(); ++it)
+            (*it)->Log(level, context, msg);
+    }
+}
+
+void Logging::DeferredSink(Level level, const Context& context, const char* format, const char* args,
+    size_t length)const noexcept
+{
+    // 异步模式下交给后台线程
+    if (m_pAsyncState.load(memory_order_relaxed))
+    {
+        m_uAsyncUsers.fetch_add(1, memory_order_seq_cst);
+        auto state = m_pAsyncState.load(memory_order_seq_cst);
+        if (state)
+            AsyncSink(*state, level, context, format, args, length);
+        m_uAsyncUsers.fetch_sub(1, memory_order_release);
+        if (state)
+            return;
+    }
+
+    Threading::Rcu::ReadGuard guard;
+    auto p = GetSinksInUse();
+    if (p)
+        DispatchDeferred(*p, level, context, format, args, length, true);
+}
+
+void Logging::DispatchDeferred(const SinkContainerType& sinks, Level level, const Context& context,
+    const char* format, const char* args, size_t length, bool flush)const noexcept
+{
+#ifndef MOE_EMSCRIPTEN
+    static thread_local string s_stFormatted;
+#else
+    static string s_stFormatted;  // NOTE: emscripten 模拟多线程
+#endif
+
+    const char* msg = nullptr;  // 首个需要文本的Sink出现时才格式化，且只格式化一次
+    for (auto it = sinks.begin(); it != sinks.end(); ++it)
+    {
+        auto& sink = **it;
+        if (!sink.ShouldLog(level))
+            continue;
+
+        if (!sink.SinkBinary(level, context, format, args, length))
+        {
+            if (!msg)
+            {
+                try
+                {
+                    FormatDeferredArguments(s_stFormatted, format, args, length);
+                    msg = s_stFormatted.c_str();
+                }
+                catch (const std::bad_alloc&)
+                {
+                    msg = kAllocErrorMsg;
+                }
+                catch (...)
+                {
+                    msg = kFormatErrorMsg;
+                }
+            }
+            sink.Write(level, context, msg);
+        }
+
+        if (flush && sink.IsAlwaysFlush())
+            sink.Flush();
+    }
+}
+
+void Logging::AsyncSink(AsyncState& state, Level level, const Context& context, const char* format,
+    const char* data, size_t length)const noexcept
+{
+    size_t ticket = 0;
+    while (!state.TryPush(level, context, format, data, length, ticket))
+    {
+        auto drop = level != Level::Fatal && (state.Policy == OverflowPolicy::Drop ||
+            (state.Policy == OverflowPolicy::DropLowLevel && level < Level::Warn));
+        if (drop)
+        {
+            m_stDroppedCount[static_cast<unsigned>(level)].fetch_add(1, memory_order_relaxed);
+            return;
+        }
+
+        // 等待后台线程腾出空位
+        AsyncWait(state, state.Processed.load(memory_order_relaxed) + 1);
+    }
+
+    // Fatal日志需要保证落地
+    if (level == Level::Fatal)
+    {
+        AsyncWait(state, ticket);
+
+        Threading::Rcu::ReadGuard guard;
+        auto p = GetSinksInUse();
+        if (p)
+        {
+            for (auto it = p->begin(); it != p->end(); ++it)
+                (*it)->Flush();
+        }
+    }
+}
+
+void Logging::AsyncWait(AsyncState& state, size_t ticket)const noexcept
+{
+    if (state.Processed.load(memory_order_acquire) >= ticket)
+        return;
+
+    try
+    {
+        unique_lock<mutex> lock(state.Lock);
+        ++state.Waiters;
+        while (state.Processed.load(memory_order_acquire) < ticket)
+        {
+            state.WakeCond.notify_one();
+            state.DoneCond.wait_for(lock, chrono::milliseconds(AsyncState::kWaitTimeoutMs));
+        }
+        --state.Waiters;
+    }
+    catch (...)
+    {
+        assert(false);
+    }
+}
+
+void Logging::UpdateLevel(Level min, Level max)noexcept
+{
+    auto state = LevelFilter::Make(min, max);
+    m_stFilter.Store(state);
+
+    // 同步到跟随全局级别的模块
+    for (auto module : m_stModules)
+    {
+        if ((module->m_stFilter.Load() & LevelFilter::kOverrideBit) == 0)
+            module->m_stFilter.Store(state);
+    }
+}
+
+void Logging::AsyncWorker(AsyncState& state)noexcept
+{
+    while (true)
+    {
+        // 批量分发，每批只刷新一次
+        size_t count = 0;
+        {
+            Threading::Rcu::ReadGuard guard;
+            auto p = GetSinksInUse();
+            while (count < AsyncState::kBatchSize)
+            {
+                auto record = state.Peek();
+                if (!record)
+                    break;
+
+                if (p && record->Format && !record->AllocFailed)
+                {
+                    DispatchDeferred(*p, record->LogLevel, record->LogContext, record->Format,
+                        record->Message.data(), record->Message.size(), false);
+                }
+                else if (p)
+                {
+                    auto msg = record->AllocFailed ? kAllocErrorMsg : record->Message.c_str();
+                    for (auto it = p->begin(); it != p->end(); ++it)
+                    {
+                        if ((*it)->ShouldLog(record->LogLevel))
+                            (*it)->Write(record->LogLevel, record->LogContext, msg);
+                    }
+                }
+
+                state.Pop(*record);
+                ++count;
+            }
+
+            if (count > 0 && p)
+            {
+                for (auto it = p->begin(); it != p->end(); ++it)
+                {
+                    if ((*it)->IsAlwaysFlush())
+                        (*it)->Flush();
+                }
+            }
+        }
+
+        if (count > 0)
+        {
+            state.Processed.store(state.DequeuePos, memory_order_release);
+            if (state.Waiters.load(memory_order_acquire) > 0)
+            {
+                try
+                {
+                    unique_lock<mutex> lock(state.Lock);
+                    state.DoneCond.notify_all();
+                }
+                catch (...)
+                {
+                    assert(false);
+                }
+            }
+            continue;
+        }
+
+        // 生产者已全部离开，队列排空后退出
+        if (state.Stopping.load(memory_order_acquire))
+            break;
+
+        // 队列为空，休眠等待
+        try
+        {
+            unique_lock<mutex> lock(state.Lock);
+            state.Sleeping.store(true, memory_order_seq_cst);
+            if (!state.Peek() && !state.Stopping.load(memory_order_acquire))
+                state.WakeCond.wait_for(lock, chrono::milliseconds(AsyncState::kWaitTimeoutMs));
+            state.Sleeping.store(false, memory_order_relaxed);
+        }
+        catch (...)
+        {
+            assert(false);
+        }
     }
 }
@@ -4,6 +4,11 @@
  * @date 2018/8/2
  */
 #include <Moe.Core/ObjectPool.hpp>
+#include <Moe.Core/Pal.hpp>
+
+#include <new>
+#include <cstring>
+#include <algorithm>
 
 using namespace std;
 using namespace moe;
@@ -56,30 +61,216 @@ void ObjectPool::Node::Detach(Node* parent)noexcept
 
 #endif
 
-//////////////////////////////////////////////////////////////////////////////// ObjectPool
+//////////////////////////////////////////////////////////////////////////////// Statistics
+
+void ObjectPool::Statistics::Merge(const Statistics& rhs)
+{
+    AllocatedSize += rhs.AllocatedSize;
+    FreeSize += rhs.FreeSize;
+
+    for (const auto& stat : rhs.Buckets)
+    {
+        auto it = lower_bound(Buckets.begin(), Buckets.end(), stat.NodeSize,
+            [](const BucketStatistics& lhs, size_t nodeSize) { return lhs.NodeSize < nodeSize; });
+        if (it == Buckets.end() || it->NodeSize != stat.NodeSize)
+        {
+            Buckets.insert(it, stat);
+            continue;
+        }
+
+        it->AllocatedCount += stat.AllocatedCount;
+        it->AllocatedSize += stat.AllocatedSize;
+        it->FreeCount += stat.FreeCount;
+        it->PeakUsedCount += stat.PeakUsedCount;
+        it->AllocCalls += stat.AllocCalls;
+        it->FreeCalls += stat.FreeCalls;
+        it->FreeListHits += stat.FreeListHits;
+        it->FreshAllocs += stat.FreshAllocs;
+        it->SystemAllocCalls += stat.SystemAllocCalls;
+        it->RequestedBytes += stat.RequestedBytes;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// Slab
+
+struct ObjectPool::Slab
+{
+    Bucket* Parent = nullptr;  // 所属的Bucket
+    Slab* Prev = nullptr;  // 所在链表中的上一个Slab
+    Slab* Next = nullptr;  // 所在链表中的下一个Slab
+    void* FreeList = nullptr;  // 空闲节点，链表指针保存在节点的数据区中
+    uint32_t Capacity = 0;  // 节点个数
+    uint32_t Carved = 0;  // 已经切分出去的节点个数，之后的节点从未被使用过
+    uint32_t UsedCount = 0;  // 使用中的节点个数
+
+    static Slab* FromPointer(void* p)noexcept;
+
+    uint8_t* GetData()noexcept;
+    void Link(Slab*& list)noexcept;
+    void Unlink(Slab*& list)noexcept;
+};
 
 namespace
 {
-    size_t SizeToIndex(size_t size)noexcept
+    // 头部占用一个缓存行，保证节点16字节对齐
+    const size_t kSlabHeaderSize = 64;
+    static_assert(sizeof(void*) > 4 || ObjectPool::kSlabSize == 64 * 1024, "Bad slab size");
+
+    /**
+     * @brief Slab页表
+     *
+     * 记录每个按kSlabSize对齐的地址区间是否属于Slab，使得任意由对象池分配的指针都能区分出是否位于Slab中。
+     * 采用两级基数树，叶子为位图，按需分配且不再释放。
+     * 根节点同样在首次注册Slab时才分配，未使用Slab模式时查询只需判断一次空指针。
+     */
+    class SlabPageMap
     {
-        if (size <= ObjectPool::kSmallSizeThreshold)
-            return (size + (ObjectPool::kSmallSizeBlockSize - 1)) / ObjectPool::kSmallSizeBlockSize;
-        else if (size <= ObjectPool::kLargeSizeThreshold)
+        static const unsigned kPageShift = 16;  // log2(kSlabSize)
+        static const unsigned kPageBits = (sizeof(void*) == 8 ? 48 : 32) - kPageShift;
+        static const unsigned kLeafBits = kPageBits / 2;
+        static const unsigned kRootBits = kPageBits - kLeafBits;
+        static const size_t kLeafWords = (static_cast<size_t>(1) << kLeafBits) / 32;
+
+        static_assert((1u << kPageShift) == ObjectPool::kSlabSize, "Page size mismatched");
+
+        using Leaf = atomic<uint32_t>;
+        using Root = atomic<Leaf*>;
+        static const size_t kRootSlots = static_cast<size_t>(1) << kRootBits;
+
+    public:
+        bool Contains(const void* p)const noexcept
+        {
+            auto page = reinterpret_cast<uintptr_t>(p) >> kPageShift;
+            auto root = m_pRoot.load(memory_order_acquire);
+            if (!root || (page >> kPageBits))
+                return false;
+
+            auto leaf = root[page >> kLeafBits].load(memory_order_acquire);
+            if (!leaf)
+                return false;
+
+            auto index = page & ((static_cast<uintptr_t>(1) << kLeafBits) - 1);
+            return ((leaf[index / 32].load(memory_order_relaxed) >> (index % 32)) & 1u) != 0;
+        }
+
+        bool Register(const void* p)noexcept
         {
-            size -= ObjectPool::kSmallSizeThreshold;
-            return (size + (ObjectPool::kLargeSizeBlockSize - 1)) / ObjectPool::kLargeSizeBlockSize +
-                ObjectPool::kSmallSizeBlocks;
+            auto page = reinterpret_cast<uintptr_t>(p) >> kPageShift;
+            if (page >> kPageBits)
+                return false;
+
+            auto root = m_pRoot.load(memory_order_acquire);
+            if (!root)
+            {
+                auto newRoot = static_cast<Root*>(::calloc(kRootSlots, sizeof(Root)));
+                if (!newRoot)
+                    return false;
+                if (m_pRoot.compare_exchange_strong(root, newRoot, memory_order_acq_rel, memory_order_acquire))
+                    root = newRoot;
+                else
+                    ::free(newRoot);
+            }
+
+            auto& slot = root[page >> kLeafBits];
+            auto leaf = slot.load(memory_order_acquire);
+            if (!leaf)
+            {
+                auto newLeaf = static_cast<Leaf*>(::calloc(kLeafWords, sizeof(Leaf)));
+                if (!newLeaf)
+                    return false;
+                if (slot.compare_exchange_strong(leaf, newLeaf, memory_order_acq_rel, memory_order_acquire))
+                    leaf = newLeaf;
+                else
+                    ::free(newLeaf);
+            }
+
+            auto index = page & ((static_cast<uintptr_t>(1) << kLeafBits) - 1);
+            leaf[index / 32].fetch_or(1u << (index % 32), memory_order_release);
+            return true;
+        }
+
+        void Unregister(const void* p)noexcept
+        {
+            auto page = reinterpret_cast<uintptr_t>(p) >> kPageShift;
+            assert((page >> kPageBits) == 0);
+
+            auto root = m_pRoot.load(memory_order_acquire);
+            assert(root);
+
+            auto leaf = root[page >> kLeafBits].load(memory_order_acquire);
+            assert(leaf);
+
+            auto index = page & ((static_cast<uintptr_t>(1) << kLeafBits) - 1);
+            leaf[index / 32].fetch_and(~(1u << (index % 32)), memory_order_release);
         }
-        assert(false);
-        return 0;
+
+    private:
+        atomic<Root*> m_pRoot { nullptr };
+    };
+
+    SlabPageMap& GetSlabPageMap()noexcept
+    {
+        static SlabPageMap s_stPageMap;  // 静态存储，零初始化
+        return s_stPageMap;
+    }
+}
+
+ObjectPool::Slab* ObjectPool::Slab::FromPointer(void* p)noexcept
+{
+    if (!GetSlabPageMap().Contains(p))
+        return nullptr;
+    return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(kSlabSize - 1));
+}
+
+uint8_t* ObjectPool::Slab::GetData()noexcept
+{
+    return reinterpret_cast<uint8_t*>(this) + kSlabHeaderSize;
+}
+
+void ObjectPool::Slab::Link(Slab*& list)noexcept
+{
+    assert(!Prev && !Next);
+    Next = list;
+    if (list)
+        list->Prev = this;
+    list = this;
+}
+
+void ObjectPool::Slab::Unlink(Slab*& list)noexcept
+{
+    if (Prev)
+        Prev->Next = Next;
+    else
+    {
+        assert(list == this);
+        list = Next;
     }
+    if (Next)
+        Next->Prev = Prev;
+    Prev = Next = nullptr;
 }
 
+//////////////////////////////////////////////////////////////////////////////// ObjectPool
+
+const unsigned ObjectPool::kSmallSizeThreshold;
+const unsigned ObjectPool::kSmallSizeBlockSize;
+const unsigned ObjectPool::kSmallSizeBlocks;
+const unsigned ObjectPool::kLargeSizeThreshold;
+const unsigned ObjectPool::kLargeSizeBlockSize;
+const unsigned ObjectPool::kLargeSizeBlocks;
+const unsigned ObjectPool::kTotalBlocks;
+const unsigned ObjectPool::kSlabSize;
+const unsigned ObjectPool::kSlabMaxNodeSize;
+
 ObjectPool* ObjectPool::GetPoolFromPointer(void* p)noexcept
 {
     if (!p)
         return nullptr;
 
+    auto slab = Slab::FromPointer(p);
+    if (slab)
+        return slab->Parent->Pool;
+
     Node* n = reinterpret_cast<Node*>(static_cast<uint8_t*>(p) - offsetof(Node, Data));
     assert(n->Header.Status == NodeStatus::Used);
     assert(n->Header.Parent);
@@ -91,15 +282,74 @@ void ObjectPool::Free(void* p)noexcept
     if (!p)
         return;
 
+    auto slab = Slab::FromPointer(p);
+    if (slab)
+    {
+        slab->Parent->Pool->InternalFree(p, slab);
+        return;
+    }
+
     Node* n = reinterpret_cast<Node*>(static_cast<uint8_t*>(p) - offsetof(Node, Data));
     assert(n->Header.Status == NodeStatus::Used);
     assert(n->Header.Parent);
 
-    n->Header.Parent->Pool->InternalFree(n);
+    n->Header.Parent->Pool->InternalFree(p, nullptr);
+}
+
+void ObjectPool::FreeBatch(void* const* p, size_t count)noexcept
+{
+    auto getParent = [](void* ptr, Slab* slab)noexcept -> Bucket* {
+        if (slab)
+            return slab->Parent;
+
+        Node* n = reinterpret_cast<Node*>(static_cast<uint8_t*>(ptr) - offsetof(Node, Data));
+        assert(n->Header.Status == NodeStatus::Used);
+        assert(n->Header.Parent);
+        return n->Header.Parent;
+    };
+
+    size_t i = 0;
+    while (i < count)
+    {
+        if (!p[i])
+        {
+            ++i;
+            continue;
+        }
+
+        // 找出属于同一个Bucket（或同一个Slab）的一段
+        auto slab = Slab::FromPointer(p[i]);
+        auto bucket = getParent(p[i], slab);
+        auto j = i + 1;
+        for (; j < count && p[j]; ++j)
+        {
+            auto nextSlab = Slab::FromPointer(p[j]);
+            if (nextSlab != slab || getParent(p[j], nextSlab) != bucket)
+                break;
+        }
+
+        bucket->Pool->InternalFreeBatch(p + i, j - i, slab);
+        i = j;
+    }
 }
 
-ObjectPool::ObjectPool()
+size_t ObjectPool::GetCapacityFromPointer(void* p)noexcept
 {
+    assert(p);
+
+    auto slab = Slab::FromPointer(p);
+    if (slab)
+        return slab->Parent->NodeSize;
+
+    Node* n = reinterpret_cast<Node*>(static_cast<uint8_t*>(p) - offsetof(Node, Data));
+    auto nodeSize = n->Header.Parent->NodeSize;
+    return nodeSize == 0 ? n->Header.Size : nodeSize;
+}
+
+ObjectPool::ObjectPool(bool slabMode)
+    : m_bSlabMode(slabMode), m_stOwnerThread(thread::id()), m_pRemoteFreeList(nullptr)
+{
+    m_stBuckets[0].Pool = this;
     m_stBuckets[0].NodeSize = 0;
     for (unsigned i = 1; i <= kSmallSizeBlocks; ++i)
     {
@@ -115,6 +365,7 @@ ObjectPool::ObjectPool()
 
 ObjectPool::~ObjectPool()
 {
+    DrainRemoteFree();  // 回收其他线程释放的节点
     CollectGarbage();  // 收集所有节点
 
     // 检查内存泄漏
@@ -134,6 +385,12 @@ ObjectPool::~ObjectPool()
             }
             leak = true;
         }
+        if (bucket.PartialSlabs || bucket.FullSlabs)
+        {
+            if (m_pLeakReporter)
+                ReportSlabLeaks(bucket);
+            leak = true;
+        }
 #else
         if (bucket.AllocatedCount)
         {
@@ -151,7 +408,7 @@ size_t ObjectPool::GetAllocatedSize()const noexcept
 {
     size_t ret = 0;
     for (unsigned i = 0; i < CountOf(m_stBuckets); ++i)
-        ret += m_stBuckets[i].AllocatedCount * m_stBuckets[i].NodeSize;
+        ret += m_stBuckets[i].GetAllocatedSize();
     return ret;
 }
 
@@ -163,6 +420,49 @@ size_t ObjectPool::GetFreeSize()const noexcept
     return ret;
 }
 
+ObjectPool::Statistics ObjectPool::GetStatistics()const
+{
+    Statistics ret;
+    for (unsigned i = 0; i < CountOf(m_stBuckets); ++i)
+    {
+        auto& bucket = m_stBuckets[i];
+        ret.AllocatedSize += bucket.GetAllocatedSize();
+        ret.FreeSize += bucket.FreeCount * bucket.NodeSize;
+        if (bucket.AllocCalls == 0 && bucket.AllocatedCount == 0)
+            continue;
+
+        BucketStatistics stat;
+        stat.NodeSize = bucket.NodeSize;
+        stat.AllocatedCount = bucket.AllocatedCount;
+        stat.AllocatedSize = bucket.GetAllocatedSize();
+        stat.FreeCount = bucket.FreeCount;
+        stat.PeakUsedCount = bucket.PeakUsedCount;
+        stat.AllocCalls = bucket.AllocCalls;
+        stat.FreeCalls = bucket.FreeCalls;
+        stat.FreeListHits = bucket.FreeListHits;
+        stat.FreshAllocs = bucket.FreshAllocs;
+        stat.SystemAllocCalls = bucket.SystemAllocCalls;
+        stat.RequestedBytes = bucket.RequestedBytes;
+        ret.Buckets.push_back(stat);
+    }
+    return ret;
+}
+
+void ObjectPool::ResetStatistics()noexcept
+{
+    for (unsigned i = 0; i < CountOf(m_stBuckets); ++i)
+    {
+        auto& bucket = m_stBuckets[i];
+        bucket.PeakUsedCount = bucket.AllocatedCount - bucket.FreeCount;
+        bucket.AllocCalls = 0;
+        bucket.FreeCalls = 0;
+        bucket.FreeListHits = 0;
+        bucket.FreshAllocs = 0;
+        bucket.SystemAllocCalls = 0;
+        bucket.RequestedBytes = 0;
+    }
+}
+
 size_t ObjectPool::CollectGarbage(unsigned factor, size_t maxFree)noexcept
 {
     factor = max<unsigned>(factor, 1);
@@ -179,10 +479,9 @@ size_t ObjectPool::CollectGarbage(unsigned factor, size_t maxFree)noexcept
         }
 
         size_t collects = bucket.FreeCount / factor;
-        for (unsigned j = 0; j < collects; ++j)
+        while (collects > 0 && bucket.FreeList.Header.Next)
         {
             auto obj = bucket.FreeList.Header.Next;
-            assert(obj);
 #ifndef NDEBUG
             obj->Detach();
 #else
@@ -190,33 +489,44 @@ size_t ObjectPool::CollectGarbage(unsigned factor, size_t maxFree)noexcept
 #endif
             ::free(obj);
 
+            --collects;
             --bucket.FreeCount;
             --bucket.AllocatedCount;
             ret += bucket.NodeSize;
             if (maxFree && ret >= maxFree)
                 return ret;
         }
+
+        // 剩余的空闲节点位于Slab中
+        if (collects > 0 && bucket.PartialSlabs)
+        {
+            ret += CollectSlabs(bucket, collects, maxFree ? maxFree - ret : 0);
+            if (maxFree && ret >= maxFree)
+                return ret;
+        }
     }
 
     return ret;
 }
 
 #ifndef NDEBUG
-void* ObjectPool::InternalAlloc(size_t sz, const AllocContext& context)
+void* ObjectPool::InternalAlloc(size_t sizeClass, size_t sz, const AllocContext& context)
 #else
-void* ObjectPool::InternalAlloc(size_t sz)
+void* ObjectPool::InternalAlloc(size_t sizeClass, size_t sz)
 #endif
 {
     Node* ret = nullptr;
 
+    assert(sizeClass == GetSizeClass(sz));
     sz = max<size_t>(sz, 1);
-    if (sz > kLargeSizeThreshold)  // 直接从系统分配，并挂在大小为0的节点上
+    if (sizeClass == 0)  // 直接从系统分配，并挂在大小为0的节点上
     {
         ret = reinterpret_cast<Node*>(::malloc(offsetof(Node, Data) + sz));
         if (!ret)
             throw bad_alloc();
         ret->Header.Status = NodeStatus::Used;
         ret->Header.Parent = &m_stBuckets[0];
+        ret->Header.Size = sz;
 #ifndef NDEBUG
         ret->Header.Context = context;
         ret->Attach(&m_stBuckets->UseList);
@@ -224,13 +534,16 @@ void* ObjectPool::InternalAlloc(size_t sz)
         ret->Header.Next = nullptr;
 #endif
         ++m_stBuckets[0].AllocatedCount;
+        m_stBuckets[0].LargeSize += sz;
+        ++m_stBuckets[0].FreshAllocs;
+        ++m_stBuckets[0].SystemAllocCalls;
+        m_stBuckets[0].OnAlloc(sz);
         return static_cast<void*>(ret->Data);
     }
 
     // 获取对应的Bucket
-    auto index = SizeToIndex(sz);
-    assert(m_stBuckets[index].NodeSize >= sz);
-    Bucket& bucket = m_stBuckets[index];
+    assert(sizeClass < kTotalBlocks && m_stBuckets[sizeClass].NodeSize >= sz);
+    Bucket& bucket = m_stBuckets[sizeClass];
     if (bucket.FreeList.Header.Next)  // 如果有空闲节点，就分配
     {
         assert(bucket.FreeCount > 0);
@@ -241,15 +554,33 @@ void* ObjectPool::InternalAlloc(size_t sz)
         ret->Detach(&bucket.FreeList);
 #endif
         --bucket.FreeCount;
+        ++bucket.FreeListHits;
     }
     else
     {
+        if (m_bSlabMode && bucket.NodeSize <= kSlabMaxNodeSize)  // 从Slab中切分
+        {
+            auto slab = bucket.PartialSlabs;
+            if (!slab && (slab = NewSlab(bucket)) != nullptr)
+                ++bucket.SystemAllocCalls;
+
+            if (slab)
+            {
+                auto p = SlabAlloc(bucket, slab);
+                bucket.OnAlloc(sz);
+                return p;
+            }
+        }
+
         ret = reinterpret_cast<Node*>(::malloc(offsetof(Node, Data) + bucket.NodeSize));
         if (!ret)
             throw bad_alloc();
         ret->Header.Parent = &bucket;
         ++bucket.AllocatedCount;
+        ++bucket.FreshAllocs;
+        ++bucket.SystemAllocCalls;
     }
+    bucket.OnAlloc(sz);
 
     assert(ret);
     ret->Header.Status = NodeStatus::Used;
@@ -262,6 +593,115 @@ void* ObjectPool::InternalAlloc(size_t sz)
     return static_cast<void*>(ret->Data);
 }
 
+#ifndef NDEBUG
+void ObjectPool::InternalAllocBatch(size_t sizeClass, size_t sz, void** out, size_t count,
+    const AllocContext& context)
+#else
+void ObjectPool::InternalAllocBatch(size_t sizeClass, size_t sz, void** out, size_t count)
+#endif
+{
+    assert(sizeClass == GetSizeClass(sz));
+
+    size_t n = 0;
+    if (sizeClass == 0)  // 超大对象没有空闲节点可用，逐个分配
+    {
+        try
+        {
+            for (; n < count; ++n)
+#ifndef NDEBUG
+                out[n] = InternalAlloc(sizeClass, sz, context);
+#else
+                out[n] = InternalAlloc(sizeClass, sz);
+#endif
+        }
+        catch (...)
+        {
+            FreeBatch(out, n);
+            throw;
+        }
+        return;
+    }
+
+    sz = max<size_t>(sz, 1);
+    assert(sizeClass < kTotalBlocks && m_stBuckets[sizeClass].NodeSize >= sz);
+    Bucket& bucket = m_stBuckets[sizeClass];
+
+    // 从FreeList上整段取出空闲节点
+#ifndef NDEBUG
+    while (n < count && bucket.FreeList.Header.Next)
+    {
+        auto node = bucket.FreeList.Header.Next;
+        node->Detach();
+        node->Header.Status = NodeStatus::Used;
+        node->Header.Context = context;
+        node->Attach(&bucket.UseList);
+        out[n++] = static_cast<void*>(node->Data);
+    }
+#else
+    auto node = bucket.FreeList.Header.Next;
+    while (n < count && node)
+    {
+        auto next = node->Header.Next;
+        node->Header.Status = NodeStatus::Used;
+        node->Header.Next = nullptr;
+        out[n++] = static_cast<void*>(node->Data);
+        node = next;
+    }
+    bucket.FreeList.Header.Next = node;
+#endif
+    assert(bucket.FreeCount >= n);
+    bucket.FreeCount -= n;
+    bucket.FreeListHits += n;
+    bucket.OnAlloc(sz, n);
+
+    try
+    {
+        if (m_bSlabMode && bucket.NodeSize <= kSlabMaxNodeSize)  // 从Slab中切分
+        {
+            while (n < count)
+            {
+                auto slab = bucket.PartialSlabs;
+                if (!slab)
+                {
+                    slab = NewSlab(bucket);
+                    if (!slab)
+                        break;
+                    ++bucket.SystemAllocCalls;
+                }
+
+                auto got = SlabAllocBatch(bucket, slab, out + n, count - n);
+                bucket.OnAlloc(sz, got);
+                n += got;
+            }
+        }
+
+        while (n < count)
+        {
+            auto ret = reinterpret_cast<Node*>(::malloc(offsetof(Node, Data) + bucket.NodeSize));
+            if (!ret)
+                throw bad_alloc();
+            ret->Header.Status = NodeStatus::Used;
+            ret->Header.Parent = &bucket;
+#ifndef NDEBUG
+            ret->Header.Context = context;
+            ret->Attach(&bucket.UseList);
+#else
+            ret->Header.Next = nullptr;
+#endif
+            ++bucket.AllocatedCount;
+            ++bucket.FreshAllocs;
+            ++bucket.SystemAllocCalls;
+            bucket.OnAlloc(sz);
+            out[n++] = static_cast<void*>(ret->Data);
+        }
+    }
+    catch (...)
+    {
+        FreeBatch(out, n);
+        throw;
+    }
+}
+
 #ifndef NDEBUG
 void* ObjectPool::InternalRealloc(void* p, size_t sz, const AllocContext& context)
 #else
@@ -270,25 +710,45 @@ void* ObjectPool::InternalRealloc(void* p, size_t sz)
 {
     if (!p)  // 当传入的p为nullptr时，Realloc的行为和Alloc一致
 #ifndef NDEBUG
-        return InternalAlloc(sz, context);
+        return InternalAlloc(GetSizeClass(sz), sz, context);
 #else
-        return InternalAlloc(sz);
+        return InternalAlloc(GetSizeClass(sz), sz);
 #endif
 
-    Node* n = reinterpret_cast<Node*>(static_cast<uint8_t*>(p) - offsetof(Node, Data));
-    assert(n->Header.Parent->Pool == this);
+    auto slab = Slab::FromPointer(p);
+    Node* n = slab ? nullptr : reinterpret_cast<Node*>(static_cast<uint8_t*>(p) - offsetof(Node, Data));
+    auto parent = slab ? slab->Parent : n->Header.Parent;
+    assert(parent->Pool == this);
     if (sz == 0)  // 当大小为0，其行为和Free一致
     {
-        InternalFree(n);
+        InternalFree(p, slab);
         return nullptr;
     }
 
-    auto nodeSize = n->Header.Parent->NodeSize;
+    auto nodeSize = parent->NodeSize;
     if (nodeSize == 0)  // 超大对象，调用系统的realloc
     {
+        assert(n);
+#ifndef NDEBUG
+        auto prev = n->Header.Prev;
+        n->Detach();  // realloc可能移动节点，需要先从UseList脱离
+#endif
+        auto oldSize = n->Header.Size;
         auto ret = static_cast<Node*>(::realloc(n, offsetof(Node, Data) + sz));
         if (!ret)
+        {
+#ifndef NDEBUG
+            n->Attach(prev);
+#endif
             throw bad_alloc();
+        }
+        ret->Header.Size = sz;
+        parent->LargeSize -= oldSize;
+        parent->LargeSize += sz;
+#ifndef NDEBUG
+        ret->Header.Context = context;
+        ret->Attach(prev);
+#endif
         return static_cast<void*>(ret->Data);
     }
     if (nodeSize >= sz)  // 如果本身分配的内存就足够使用，则直接返回
@@ -296,20 +756,55 @@ void* ObjectPool::InternalRealloc(void* p, size_t sz)
 
     // 这里，只能新分配一块内存（当bad_alloc发生时，不影响已分配的内存）
 #ifndef NDEBUG
-    auto* np = InternalAlloc(sz, context);
+    auto* np = InternalAlloc(GetSizeClass(sz), sz, context);
 #else
-    auto* np = InternalAlloc(sz);
+    auto* np = InternalAlloc(GetSizeClass(sz), sz);
 #endif
     memcpy(np, p, nodeSize);
 
     // 内存拷贝完毕，释放老内存，返回新内存
-    InternalFree(n);
+    InternalFree(p, slab);
     return np;
 }
 
-void ObjectPool::InternalFree(Node* p)noexcept
+void ObjectPool::InternalFree(void* p, Slab* slab)noexcept
 {
     assert(p);
+
+    // 作为线程缓存时，其他线程的释放操作需要交还给所属线程处理
+    if (m_bThreadCache && m_stOwnerThread.load(memory_order_relaxed) != this_thread::get_id())
+    {
+        RemoteFree(p);
+        return;
+    }
+
+    LocalFree(p, slab);
+}
+
+void ObjectPool::InternalFreeBatch(void* const* p, size_t count, Slab* slab)noexcept
+{
+    assert(p && count > 0);
+
+    if (m_bThreadCache && m_stOwnerThread.load(memory_order_relaxed) != this_thread::get_id())
+    {
+        RemoteFreeBatch(p, count);
+        return;
+    }
+
+    LocalFreeBatch(p, count, slab);
+}
+
+void ObjectPool::LocalFree(void* ptr, Slab* slab)noexcept
+{
+    assert(ptr);
+
+    if (slab)
+    {
+        SlabFree(slab, ptr);
+        return;
+    }
+
+    Node* p = reinterpret_cast<Node*>(static_cast<uint8_t*>(ptr) - offsetof(Node, Data));
     assert(p->Header.Parent->Pool == this);
 
     p->Header.Status = NodeStatus::Free;
@@ -318,8 +813,10 @@ void ObjectPool::InternalFree(Node* p)noexcept
 #endif
 
     Bucket& bucket = *p->Header.Parent;
+    ++bucket.FreeCalls;
     if (bucket.NodeSize == 0)  // 超大对象，直接释放
     {
+        bucket.LargeSize -= p->Header.Size;
         ::free(p);
         --bucket.AllocatedCount;
         return;
@@ -329,3 +826,521 @@ void ObjectPool::InternalFree(Node* p)noexcept
     p->Attach(&bucket.FreeList);
     ++bucket.FreeCount;
 }
+
+void ObjectPool::LocalFreeBatch(void* const* p, size_t count, Slab* slab)noexcept
+{
+    assert(p && count > 0);
+
+    if (slab)
+    {
+        SlabFreeBatch(slab, p, count);
+        return;
+    }
+
+    Bucket& bucket = *reinterpret_cast<Node*>(static_cast<uint8_t*>(p[0]) - offsetof(Node, Data))->Header.Parent;
+    assert(bucket.Pool == this);
+    if (bucket.NodeSize == 0)  // 超大对象，逐个释放
+    {
+        for (size_t i = 0; i < count; ++i)
+            LocalFree(p[i], nullptr);
+        return;
+    }
+
+    // 串成链表后整段挂到FreeList上
+#ifndef NDEBUG
+    for (size_t i = 0; i < count; ++i)
+    {
+        Node* n = reinterpret_cast<Node*>(static_cast<uint8_t*>(p[i]) - offsetof(Node, Data));
+        assert(n->Header.Parent == &bucket);
+        n->Header.Status = NodeStatus::Free;
+        n->Detach();
+        n->Attach(&bucket.FreeList);
+    }
+#else
+    auto head = bucket.FreeList.Header.Next;
+    auto i = count;
+    while (i-- > 0)
+    {
+        Node* n = reinterpret_cast<Node*>(static_cast<uint8_t*>(p[i]) - offsetof(Node, Data));
+        assert(n->Header.Parent == &bucket);
+        n->Header.Status = NodeStatus::Free;
+        n->Header.Next = head;
+        head = n;
+    }
+    bucket.FreeList.Header.Next = head;
+#endif
+    bucket.FreeCount += count;
+    bucket.FreeCalls += count;
+}
+
+void ObjectPool::RemoteFree(void* p)noexcept
+{
+    assert(p);
+
+    // 节点头部由所属线程维护（调试版本下还处在UseList中），这里借用已释放对象的数据区存放链表指针
+    auto next = static_cast<void**>(p);
+    auto head = m_pRemoteFreeList.load(memory_order_relaxed);
+    do
+    {
+        *next = head;
+    } while (!m_pRemoteFreeList.compare_exchange_weak(head, p, memory_order_release, memory_order_relaxed));
+}
+
+void ObjectPool::RemoteFreeBatch(void* const* p, size_t count)noexcept
+{
+    assert(p && count > 0);
+
+    // 先在数据区中串成链表，再一次性压入远程释放队列
+    for (size_t i = 0; i + 1 < count; ++i)
+        *static_cast<void**>(p[i]) = p[i + 1];
+
+    auto tail = static_cast<void**>(p[count - 1]);
+    auto head = m_pRemoteFreeList.load(memory_order_relaxed);
+    do
+    {
+        *tail = head;
+    } while (!m_pRemoteFreeList.compare_exchange_weak(head, p[0], memory_order_release, memory_order_relaxed));
+}
+
+void ObjectPool::DrainRemoteFree()noexcept
+{
+    if (!m_pRemoteFreeList.load(memory_order_relaxed))
+        return;
+
+    auto p = m_pRemoteFreeList.exchange(nullptr, memory_order_acquire);
+    while (p)
+    {
+        auto next = *static_cast<void**>(p);
+        LocalFree(p, Slab::FromPointer(p));
+        p = next;
+    }
+}
+
+ObjectPool::Slab* ObjectPool::NewSlab(Bucket& bucket)
+{
+    assert(bucket.NodeSize > 0 && bucket.NodeSize <= kSlabMaxNodeSize);
+
+    auto mem = Pal::AllocAlignedPages(kSlabSize);
+    if (!mem)
+        throw bad_alloc();
+    if (!GetSlabPageMap().Register(mem))  // 无法登记的地址退化为普通节点
+    {
+        Pal::FreeAlignedPages(mem, kSlabSize);
+        return nullptr;
+    }
+
+    auto slab = new(mem) Slab();
+    slab->Parent = &bucket;
+    slab->Capacity = static_cast<uint32_t>((kSlabSize - kSlabHeaderSize) / bucket.NodeSize);
+    slab->Link(bucket.PartialSlabs);
+
+    bucket.AllocatedCount += slab->Capacity;
+    bucket.FreeCount += slab->Capacity;
+    return slab;
+}
+
+void ObjectPool::DeleteSlab(Slab* slab)noexcept
+{
+    assert(slab->UsedCount == 0);
+
+    auto& bucket = *slab->Parent;
+    slab->Unlink(bucket.PartialSlabs);
+
+    assert(bucket.AllocatedCount >= slab->Capacity && bucket.FreeCount >= slab->Capacity);
+    bucket.AllocatedCount -= slab->Capacity;
+    bucket.FreeCount -= slab->Capacity;
+
+    GetSlabPageMap().Unregister(slab);
+    slab->~Slab();
+    Pal::FreeAlignedPages(slab, kSlabSize);
+}
+
+void* ObjectPool::SlabAlloc(Bucket& bucket, Slab* slab)noexcept
+{
+    assert(slab->Parent == &bucket);
+    assert(slab->UsedCount < slab->Capacity);
+
+    void* ret = nullptr;
+    if (slab->FreeList)
+    {
+        ret = slab->FreeList;
+        slab->FreeList = *static_cast<void**>(ret);
+        ++bucket.FreeListHits;
+    }
+    else
+    {
+        // 从未使用过的节点，视为新分配
+        assert(slab->Carved < slab->Capacity);
+        ret = slab->GetData() + slab->Carved * bucket.NodeSize;
+        ++slab->Carved;
+        ++bucket.FreshAllocs;
+    }
+
+    --bucket.FreeCount;
+    if (++slab->UsedCount == slab->Capacity)  // 分配满的Slab移出PartialSlabs
+    {
+        slab->Unlink(bucket.PartialSlabs);
+        slab->Link(bucket.FullSlabs);
+    }
+    return ret;
+}
+
+size_t ObjectPool::SlabAllocBatch(Bucket& bucket, Slab* slab, void** out, size_t count)noexcept
+{
+    assert(slab->Parent == &bucket);
+    assert(slab->UsedCount < slab->Capacity);
+
+    auto n = min<size_t>(count, slab->Capacity - slab->UsedCount);
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (slab->FreeList)
+        {
+            out[i] = slab->FreeList;
+            slab->FreeList = *static_cast<void**>(out[i]);
+            ++hits;
+        }
+        else
+        {
+            assert(slab->Carved < slab->Capacity);
+            out[i] = slab->GetData() + slab->Carved * bucket.NodeSize;
+            ++slab->Carved;
+        }
+    }
+    bucket.FreeListHits += hits;
+    bucket.FreshAllocs += n - hits;
+
+    bucket.FreeCount -= n;
+    slab->UsedCount += static_cast<uint32_t>(n);
+    if (slab->UsedCount == slab->Capacity)
+    {
+        slab->Unlink(bucket.PartialSlabs);
+        slab->Link(bucket.FullSlabs);
+    }
+    return n;
+}
+
+void ObjectPool::SlabFree(Slab* slab, void* p)noexcept
+{
+    auto& bucket = *slab->Parent;
+    assert(bucket.Pool == this);
+    assert(slab->UsedCount > 0);
+
+    *static_cast<void**>(p) = slab->FreeList;
+    slab->FreeList = p;
+
+    ++bucket.FreeCount;
+    ++bucket.FreeCalls;
+    if (slab->UsedCount-- == slab->Capacity)
+    {
+        slab->Unlink(bucket.FullSlabs);
+        slab->Link(bucket.PartialSlabs);
+    }
+}
+
+void ObjectPool::SlabFreeBatch(Slab* slab, void* const* p, size_t count)noexcept
+{
+    auto& bucket = *slab->Parent;
+    assert(bucket.Pool == this);
+    assert(slab->UsedCount >= count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        assert(Slab::FromPointer(p[i]) == slab);
+        *static_cast<void**>(p[i]) = (i + 1 < count) ? p[i + 1] : slab->FreeList;
+    }
+    slab->FreeList = p[0];
+
+    bucket.FreeCount += count;
+    bucket.FreeCalls += count;
+    auto full = (slab->UsedCount == slab->Capacity);
+    slab->UsedCount -= static_cast<uint32_t>(count);
+    if (full)
+    {
+        slab->Unlink(bucket.FullSlabs);
+        slab->Link(bucket.PartialSlabs);
+    }
+}
+
+size_t ObjectPool::CollectSlabs(Bucket& bucket, size_t maxNodes, size_t maxFree)noexcept
+{
+    size_t ret = 0;
+    size_t nodes = 0;
+    auto slab = bucket.PartialSlabs;
+    while (slab && nodes < maxNodes)
+    {
+        auto next = slab->Next;
+        if (slab->UsedCount == 0)
+        {
+            nodes += slab->Capacity;
+            ret += slab->Capacity * bucket.NodeSize;
+            DeleteSlab(slab);
+            if (maxFree && ret >= maxFree)
+                break;
+        }
+        slab = next;
+    }
+    return ret;
+}
+
+#ifndef NDEBUG
+void ObjectPool::ReportSlabLeaks(Bucket& bucket)noexcept
+{
+    assert(m_pLeakReporter);
+
+    Slab* lists[] = { bucket.PartialSlabs, bucket.FullSlabs };
+    for (auto slab : lists)
+    {
+        for (; slab; slab = slab->Next)
+        {
+            // 标记空闲节点，剩下的即为泄漏的节点
+            vector<bool> freeMarks(slab->Carved, false);
+            for (auto p = slab->FreeList; p; p = *static_cast<void**>(p))
+                freeMarks[(static_cast<uint8_t*>(p) - slab->GetData()) / bucket.NodeSize] = true;
+
+            for (uint32_t i = 0; i < slab->Carved; ++i)
+            {
+                if (!freeMarks[i])
+                    m_pLeakReporter(slab->GetData() + i * bucket.NodeSize, bucket.NodeSize, AllocContext());
+            }
+        }
+    }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////// ConcurrentObjectPool
+
+namespace moe
+{
+    namespace details
+    {
+        struct ConcurrentObjectPoolState
+        {
+            const uint64_t Id;
+            const bool SlabMode;
+            mutable mutex Lock;
+            vector<unique_ptr<ObjectPool>> Caches;  // 所有的线程缓存
+            vector<ObjectPool*> AbandonedCaches;  // 所属线程已退出的缓存
+            ObjectPool::MemLeakReportCallback LeakReporter;
+
+            ConcurrentObjectPoolState(uint64_t id, bool slabMode)
+                : Id(id), SlabMode(slabMode) {}
+
+            ~ConcurrentObjectPoolState()
+            {
+                // 此时已经没有线程持有缓存，回收所有的远程释放节点后再逐个析构
+                for (auto& cache : Caches)
+                    cache->DrainRemoteFree();
+            }
+
+            ObjectPool* Acquire()
+            {
+                unique_lock<mutex> lock(Lock);
+
+                ObjectPool* ret = nullptr;
+                if (!AbandonedCaches.empty())
+                {
+                    ret = AbandonedCaches.back();
+                    AbandonedCaches.pop_back();
+                }
+                else
+                {
+                    unique_ptr<ObjectPool> cache(new ObjectPool(SlabMode));
+                    cache->m_bThreadCache = true;
+                    cache->SetLeakReporter(LeakReporter);
+                    Caches.emplace_back(std::move(cache));
+                    ret = Caches.back().get();
+                }
+
+                ret->m_stOwnerThread.store(this_thread::get_id(), memory_order_relaxed);
+                return ret;
+            }
+
+            void Abandon(ObjectPool* cache)noexcept
+            {
+                assert(cache->m_stOwnerThread.load(memory_order_relaxed) == this_thread::get_id());
+
+                unique_lock<mutex> lock(Lock);
+                cache->m_stOwnerThread.store(thread::id(), memory_order_relaxed);
+                try
+                {
+                    AbandonedCaches.push_back(cache);
+                }
+                catch (...)
+                {
+                    // 无法被接管的缓存将会一直保留到对象池析构
+                    assert(false);
+                }
+            }
+        };
+    }
+}
+
+namespace
+{
+    struct ThreadCacheSlot
+    {
+        uint64_t PoolId = 0;
+        weak_ptr<details::ConcurrentObjectPoolState> State;
+        ObjectPool* Cache = nullptr;
+    };
+
+    /**
+     * @brief 线程缓存登记表
+     *
+     * 记录当前线程在各个ConcurrentObjectPool中使用的缓存，线程退出时将缓存交还给对象池。
+     */
+    class ThreadCacheRegistry :
+        public NonCopyable
+    {
+    public:
+        ~ThreadCacheRegistry()
+        {
+            for (auto& slot : m_stSlots)
+            {
+                auto state = slot.State.lock();
+                if (state)
+                    state->Abandon(slot.Cache);
+            }
+        }
+
+    public:
+        ObjectPool* Find(uint64_t id)const noexcept
+        {
+            for (auto& slot : m_stSlots)
+            {
+                if (slot.PoolId == id)
+                    return slot.Cache;
+            }
+            return nullptr;
+        }
+
+        void Add(const shared_ptr<details::ConcurrentObjectPoolState>& state, ObjectPool* cache)
+        {
+            // 顺便清理已经析构的对象池
+            m_stSlots.erase(remove_if(m_stSlots.begin(), m_stSlots.end(), [](const ThreadCacheSlot& slot) {
+                return slot.State.expired();
+            }), m_stSlots.end());
+
+            ThreadCacheSlot slot;
+            slot.PoolId = state->Id;
+            slot.State = state;
+            slot.Cache = cache;
+            m_stSlots.emplace_back(std::move(slot));
+        }
+
+    private:
+        vector<ThreadCacheSlot> m_stSlots;
+    };
+
+    ThreadCacheRegistry& GetThreadCacheRegistry()noexcept
+    {
+#ifndef MOE_EMSCRIPTEN
+        static thread_local ThreadCacheRegistry s_stRegistry;
+#else
+        static ThreadCacheRegistry s_stRegistry;  // NOTE: emscripten 模拟多线程
+#endif
+        return s_stRegistry;
+    }
+
+    uint64_t AllocConcurrentObjectPoolId()noexcept
+    {
+        static atomic<uint64_t> s_ullNextId(1);
+        return s_ullNextId.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+ConcurrentObjectPool::ConcurrentObjectPool(bool slabMode)
+    : m_pState(make_shared<details::ConcurrentObjectPoolState>(AllocConcurrentObjectPoolId(), slabMode))
+{
+}
+
+ConcurrentObjectPool::~ConcurrentObjectPool()
+{
+}
+
+size_t ConcurrentObjectPool::GetThreadCacheCount()const noexcept
+{
+    unique_lock<mutex> lock(m_pState->Lock);
+    return m_pState->Caches.size();
+}
+
+ObjectPool::Statistics ConcurrentObjectPool::GetStatistics()const
+{
+    ObjectPool::Statistics ret;
+
+    unique_lock<mutex> lock(m_pState->Lock);
+    for (auto& cache : m_pState->Caches)
+        ret.Merge(cache->GetStatistics());
+    return ret;
+}
+
+void ConcurrentObjectPool::SetLeakReporter(const MemLeakReportCallback& cb)
+{
+    unique_lock<mutex> lock(m_pState->Lock);
+    m_pState->LeakReporter = cb;
+    for (auto& cache : m_pState->Caches)
+        cache->SetLeakReporter(cb);
+}
+
+size_t ConcurrentObjectPool::CollectGarbage(unsigned factor, size_t maxFree)
+{
+    return GetThreadCache()->CollectGarbage(factor, maxFree);
+}
+
+#ifndef NDEBUG
+std::unique_ptr<void, ConcurrentObjectPool::Deleter<void>>& ConcurrentObjectPool::Realloc(
+    std::unique_ptr<void, Deleter<void>>& p, size_t sz, const AllocContext& context)
+#else
+std::unique_ptr<void, ConcurrentObjectPool::Deleter<void>>& ConcurrentObjectPool::Realloc(
+    std::unique_ptr<void, Deleter<void>>& p, size_t sz)
+#endif
+{
+    auto cache = GetThreadCache();
+    if (!p || ObjectPool::GetPoolFromPointer(p.get()) == cache)
+#ifndef NDEBUG
+        return cache->Realloc(p, sz, context);
+#else
+        return cache->Realloc(p, sz);
+#endif
+
+    if (sz == 0)
+    {
+        p.reset();
+        return p;
+    }
+
+    // 由其他线程分配的对象，只能在当前线程重新分配后拷贝
+    auto oldSize = ObjectPool::GetCapacityFromPointer(p.get());
+
+#ifndef NDEBUG
+    auto np = cache->Alloc(sz, context);
+#else
+    auto np = cache->Alloc(sz);
+#endif
+    ::memcpy(np.get(), p.get(), min(oldSize, sz));
+    p = std::move(np);
+    return p;
+}
+
+ObjectPool* ConcurrentObjectPool::GetThreadCache()
+{
+    auto& registry = GetThreadCacheRegistry();
+    auto cache = registry.Find(m_pState->Id);
+    if (!cache)
+    {
+        cache = m_pState->Acquire();
+        try
+        {
+            registry.Add(m_pState, cache);
+        }
+        catch (...)
+        {
+            m_pState->Abandon(cache);
+            throw;
+        }
+    }
+
+    cache->DrainRemoteFree();
+    return cache;
+}
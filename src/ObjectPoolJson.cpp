@@ -0,0 +1,40 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <Moe.Core/ObjectPoolJson.hpp>
+
+using namespace std;
+using namespace moe;
+
+JsonValue& moe::ToJson(JsonValue& out, const ObjectPool::Statistics& stat)
+{
+    JsonValue::ArrayType buckets;
+    buckets.reserve(stat.Buckets.size());
+    for (const auto& bucket : stat.Buckets)
+    {
+        buckets.emplace_back(JsonValue::MakeObject({
+            { "nodeSize", static_cast<double>(bucket.NodeSize) },
+            { "allocated", static_cast<double>(bucket.AllocatedCount) },
+            { "allocatedSize", static_cast<double>(bucket.AllocatedSize) },
+            { "free", static_cast<double>(bucket.FreeCount) },
+            { "used", static_cast<double>(bucket.AllocatedCount - bucket.FreeCount) },
+            { "peakUsed", static_cast<double>(bucket.PeakUsedCount) },
+            { "allocCalls", static_cast<double>(bucket.AllocCalls) },
+            { "freeCalls", static_cast<double>(bucket.FreeCalls) },
+            { "freeListHits", static_cast<double>(bucket.FreeListHits) },
+            { "freshAllocs", static_cast<double>(bucket.FreshAllocs) },
+            { "systemAllocCalls", static_cast<double>(bucket.SystemAllocCalls) },
+            { "requestedBytes", static_cast<double>(bucket.RequestedBytes) },
+            { "wastedBytes", static_cast<double>(bucket.GetWastedBytes()) },
+        }));
+    }
+
+    out = JsonValue::MakeObject({
+        { "allocatedSize", static_cast<double>(stat.AllocatedSize) },
+        { "freeSize", static_cast<double>(stat.FreeSize) },
+        { "usedSize", static_cast<double>(stat.AllocatedSize - stat.FreeSize) },
+        { "buckets", std::move(buckets) },
+    });
+    return out;
+}
@@ -11,6 +11,7 @@
 #include <cmath>
 #include <chrono>
 #include <thread>
+#include <vector>
 #include <algorithm>
 
 #if defined(MOE_WINDOWS)
@@ -36,6 +37,7 @@
 #include <sys/stat.h>
 #if defined(MOE_LINUX)
 #include <sys/syscall.h>
+#include <sys/sendfile.h>
 #elif defined(MOE_FREEBSD)
 #include <sys/thr.h>
 #elif defined(MOE_EMSCRIPTEN)
@@ -493,6 +495,268 @@ void SharedMemory::Free()noexcept
     m_bAutoFree = false;
 }
 
+MappedFile::MappedFile()noexcept
+{
+}
+
+MappedFile::MappedFile(const char* path, size_t sz, bool readOnly)
+    : m_bReadOnly(readOnly)
+{
+    assert(!(readOnly && sz != 0));
+
+#ifdef MOE_WINDOWS
+    wstring wpath;
+    Encoding::Convert<Encoding::Utf8, Encoding::Utf16, char, wchar_t>(wpath, ArrayView<char>(path, strlen(path)),
+        Encoding::DefaultUnicodeFallbackHandler);
+
+    m_hFile = ::CreateFileW(wpath.c_str(), readOnly ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE),
+        FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, sz == 0 ? OPEN_EXISTING : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (m_hFile == INVALID_HANDLE_VALUE)
+    {
+        m_hFile = nullptr;
+        auto err = GetLastError();
+        MOE_THROW(ApiException, "Open file \"{0}\" failed, err={1}", path, err);
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(m_hFile, &size))
+    {
+        auto err = GetLastError();
+        Close();
+        MOE_THROW(ApiException, "Get size of file \"{0}\" failed, err={1}", path, err);
+    }
+    if (sz == 0)
+        sz = static_cast<size_t>(size.QuadPart);
+    if (sz == 0)
+    {
+        Close();
+        MOE_THROW(BadArgumentException, "Cannot map empty file \"{0}\"", path);
+    }
+
+    m_hMapping = ::CreateFileMappingW(m_hFile, nullptr, readOnly ? PAGE_READONLY : PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<uint64_t>(sz) >> 32), static_cast<DWORD>(sz & 0xFFFFFFFFu), nullptr);
+    if (!m_hMapping)
+    {
+        auto err = GetLastError();
+        Close();
+        MOE_THROW(ApiException, "Create mapping of file \"{0}\" failed, err={1}", path, err);
+    }
+
+    m_pData = ::MapViewOfFile(m_hMapping, readOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS, 0, 0, sz);
+    if (!m_pData)
+    {
+        auto err = GetLastError();
+        Close();
+        MOE_THROW(ApiException, "Map file \"{0}\" failed, err={1}", path, err);
+    }
+#else
+    m_iFd = ::open(path, readOnly ? O_RDONLY : (sz == 0 ? O_RDWR : (O_RDWR | O_CREAT)), S_IRUSR | S_IWUSR | S_IRGRP);
+    if (m_iFd == -1)
+    {
+        auto err = errno;
+        MOE_THROW(ApiException, "Open file \"{0}\" failed, err={1}", path, err);
+    }
+
+    struct stat st;
+    if (::fstat(m_iFd, &st) == -1)
+    {
+        auto err = errno;
+        Close();
+        MOE_THROW(ApiException, "Get size of file \"{0}\" failed, err={1}", path, err);
+    }
+    if (sz == 0)
+        sz = static_cast<size_t>(st.st_size);
+    else if (static_cast<uint64_t>(st.st_size) != sz && ::ftruncate(m_iFd, static_cast<off_t>(sz)) == -1)
+    {
+        auto err = errno;
+        Close();
+        MOE_THROW(ApiException, "Resize file \"{0}\" failed, err={1}", path, err);
+    }
+    if (sz == 0)
+    {
+        Close();
+        MOE_THROW(BadArgumentException, "Cannot map empty file \"{0}\"", path);
+    }
+
+    auto p = ::mmap(0, sz, readOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, m_iFd, 0);
+    if (p == MAP_FAILED)
+    {
+        auto err = errno;
+        Close();
+        MOE_THROW(ApiException, "Map file \"{0}\" failed, err={1}", path, err);
+    }
+    m_pData = p;
+#endif
+
+    m_uSize = sz;
+}
+
+MappedFile::MappedFile(MappedFile&& org)noexcept
+    : m_uSize(org.m_uSize), m_pData(org.m_pData), m_bReadOnly(org.m_bReadOnly)
+{
+#ifdef MOE_WINDOWS
+    m_hFile = org.m_hFile;
+    m_hMapping = org.m_hMapping;
+    org.m_hFile = nullptr;
+    org.m_hMapping = nullptr;
+#else
+    m_iFd = org.m_iFd;
+    org.m_iFd = -1;
+#endif
+
+    org.m_uSize = 0;
+    org.m_pData = nullptr;
+    org.m_bReadOnly = false;
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs)noexcept
+{
+    Close();
+
+#ifdef MOE_WINDOWS
+    m_hFile = rhs.m_hFile;
+    m_hMapping = rhs.m_hMapping;
+    rhs.m_hFile = nullptr;
+    rhs.m_hMapping = nullptr;
+#else
+    m_iFd = rhs.m_iFd;
+    rhs.m_iFd = -1;
+#endif
+
+    m_uSize = rhs.m_uSize;
+    rhs.m_uSize = 0u;
+
+    m_pData = rhs.m_pData;
+    rhs.m_pData = nullptr;
+
+    m_bReadOnly = rhs.m_bReadOnly;
+    rhs.m_bReadOnly = false;
+
+    return *this;
+}
+
+void MappedFile::Sync(bool wait)noexcept
+{
+    if (!m_pData || m_bReadOnly)
+        return;
+
+#ifdef MOE_WINDOWS
+    ::FlushViewOfFile(m_pData, 0);
+    if (wait)
+        ::FlushFileBuffers(m_hFile);
+#else
+    ::msync(m_pData, m_uSize, wait ? MS_SYNC : MS_ASYNC);
+#endif
+}
+
+void MappedFile::Close()noexcept
+{
+#ifdef MOE_WINDOWS
+    if (m_pData)
+    {
+        ::UnmapViewOfFile(m_pData);
+        m_pData = nullptr;
+    }
+    if (m_hMapping)
+    {
+        ::CloseHandle(m_hMapping);
+        m_hMapping = nullptr;
+    }
+    if (m_hFile)
+    {
+        ::CloseHandle(m_hFile);
+        m_hFile = nullptr;
+    }
+#else
+    if (m_pData)
+    {
+        ::munmap(m_pData, m_uSize);
+        m_pData = nullptr;
+    }
+    if (m_iFd != -1)
+    {
+        ::close(m_iFd);
+        m_iFd = -1;
+    }
+#endif
+
+    m_uSize = 0;
+    m_bReadOnly = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void* Pal::AllocAlignedPages(size_t sz)noexcept
+{
+    assert(sz >= 64 * 1024 && (sz & (sz - 1)) == 0);
+    const auto mask = static_cast<uintptr_t>(sz - 1);
+
+#if defined(MOE_WINDOWS)
+    // Windows的分配粒度为64K，通常可以直接满足对齐要求
+    auto p = ::VirtualAlloc(nullptr, sz, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!p)
+        return nullptr;
+    if ((reinterpret_cast<uintptr_t>(p) & mask) == 0)
+        return p;
+    ::VirtualFree(p, 0, MEM_RELEASE);
+
+    // 保留两倍的地址空间来找到对齐的位置，释放后再在该位置分配，由于可能和其他线程竞争，需要重试
+    for (int i = 0; i < 8; ++i)
+    {
+        auto reserved = ::VirtualAlloc(nullptr, sz * 2, MEM_RESERVE, PAGE_NOACCESS);
+        if (!reserved)
+            return nullptr;
+        auto aligned = (reinterpret_cast<uintptr_t>(reserved) + mask) & ~mask;
+        ::VirtualFree(reserved, 0, MEM_RELEASE);
+
+        p = ::VirtualAlloc(reinterpret_cast<void*>(aligned), sz, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (p)
+            return p;
+    }
+    return nullptr;
+#elif defined(MOE_EMSCRIPTEN)
+    void* p = nullptr;
+    if (::posix_memalign(&p, sz, sz) != 0)
+        return nullptr;
+    return p;
+#else
+    // 映射两倍的大小，然后裁掉首尾不对齐的部分
+    auto p = ::mmap(nullptr, sz * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+
+    auto begin = reinterpret_cast<uintptr_t>(p);
+    auto aligned = (begin + mask) & ~mask;
+    if (aligned > begin)
+        ::munmap(p, aligned - begin);
+    if (begin + sz * 2 > aligned + sz)
+        ::munmap(reinterpret_cast<void*>(aligned + sz), begin + sz * 2 - (aligned + sz));
+    return reinterpret_cast<void*>(aligned);
+#endif
+}
+
+void Pal::FreeAlignedPages(void* p, size_t sz)noexcept
+{
+    if (!p)
+        return;
+
+#if defined(MOE_WINDOWS)
+    MOE_UNUSED(sz);
+    ::VirtualFree(p, 0, MEM_RELEASE);
+#elif defined(MOE_EMSCRIPTEN)
+    MOE_UNUSED(sz);
+    ::free(p);
+#else
+    ::munmap(p, sz);
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void Pal::Pause()noexcept
@@ -753,3 +1017,207 @@ uint64_t Pal::GetFileSize(const char* path)
     return static_cast<uint64_t>(st.st_size);
 #endif
 }
+
+void Pal::SeekFile(FILE* f, int64_t offset, int whence)
+{
+    if (f == nullptr)
+        MOE_THROW(BadArgumentException, "Must specific file");
+
+#if defined(MOE_WINDOWS)
+    if (::_fseeki64(f, offset, whence) != 0)
+        MOE_THROW(ApiException, "_fseeki64 failed, errno={0}", errno);
+#elif defined(MOE_APPLE)
+    if (::fseeko(f, static_cast<off_t>(offset), whence) != 0)
+        MOE_THROW(ApiException, "fseeko failed, errno={0}", errno);
+#else
+    if (::fseeko64(f, static_cast<off64_t>(offset), whence) != 0)
+        MOE_THROW(ApiException, "fseeko64 failed, errno={0}", errno);
+#endif
+}
+
+uint64_t Pal::TellFile(FILE* f)
+{
+    if (f == nullptr)
+        MOE_THROW(BadArgumentException, "Must specific file");
+
+#if defined(MOE_WINDOWS)
+    auto ret = ::_ftelli64(f);
+    if (ret < 0)
+        MOE_THROW(ApiException, "_ftelli64 failed, errno={0}", errno);
+#elif defined(MOE_APPLE)
+    auto ret = ::ftello(f);
+    if (ret < 0)
+        MOE_THROW(ApiException, "ftello failed, errno={0}", errno);
+#else
+    auto ret = ::ftello64(f);
+    if (ret < 0)
+        MOE_THROW(ApiException, "ftello64 failed, errno={0}", errno);
+#endif
+    return static_cast<uint64_t>(ret);
+}
+
+size_t Pal::ReadFileAt(FILE* f, uint64_t offset, void* buffer, size_t size)
+{
+    if (f == nullptr)
+        MOE_THROW(BadArgumentException, "Must specific file");
+
+    auto p = static_cast<uint8_t*>(buffer);
+    size_t total = 0;
+#if defined(MOE_WINDOWS)
+    auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(::_fileno(f)));
+    while (total < size)
+    {
+        auto position = offset + total;
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFull);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+        DWORD count = 0;
+        auto request = static_cast<DWORD>(std::min<size_t>(size - total, 0x40000000u));
+        if (!::ReadFile(handle, p + total, request, &count, &overlapped))
+        {
+            auto err = ::GetLastError();
+            if (err == ERROR_HANDLE_EOF)
+                break;
+            MOE_THROW(ApiException, "ReadFile failed, err={0}", err);
+        }
+        if (count == 0)
+            break;
+        total += count;
+    }
+#else
+    auto fd = fileno(f);
+    while (total < size)
+    {
+        auto ret = ::pread(fd, p + total, size - total, static_cast<off_t>(offset + total));
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            MOE_THROW(ApiException, "pread failed, errno={0}", errno);
+        }
+        if (ret == 0)
+            break;
+        total += static_cast<size_t>(ret);
+    }
+#endif
+    return total;
+}
+
+void Pal::WriteFileAt(FILE* f, uint64_t offset, const void* buffer, size_t size)
+{
+    if (f == nullptr)
+        MOE_THROW(BadArgumentException, "Must specific file");
+
+    auto p = static_cast<const uint8_t*>(buffer);
+    size_t total = 0;
+#if defined(MOE_WINDOWS)
+    auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(::_fileno(f)));
+    while (total < size)
+    {
+        auto position = offset + total;
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFull);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+        DWORD count = 0;
+        auto request = static_cast<DWORD>(std::min<size_t>(size - total, 0x40000000u));
+        if (!::WriteFile(handle, p + total, request, &count, &overlapped))
+        {
+            auto err = ::GetLastError();
+            MOE_THROW(ApiException, "WriteFile failed, err={0}", err);
+        }
+        total += count;
+    }
+#else
+    auto fd = fileno(f);
+    while (total < size)
+    {
+        auto ret = ::pwrite(fd, p + total, size - total, static_cast<off_t>(offset + total));
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            MOE_THROW(ApiException, "pwrite failed, errno={0}", errno);
+        }
+        total += static_cast<size_t>(ret);
+    }
+#endif
+}
+
+size_t Pal::CopyFileData(FILE* dest, uint64_t destOffset, FILE* src, uint64_t srcOffset, size_t count)
+{
+    if (dest == nullptr || src == nullptr)
+        MOE_THROW(BadArgumentException, "Must specific file");
+
+    size_t total = 0;
+#if defined(MOE_LINUX)
+    auto in = fileno(src);
+    auto out = fileno(dest);
+
+#ifdef SYS_copy_file_range
+    // copy_file_range: 同一文件系统内可由内核直接复制（甚至reflink）
+    while (total < count)
+    {
+        auto inOffset = static_cast<loff_t>(srcOffset + total);
+        auto outOffset = static_cast<loff_t>(destOffset + total);
+        auto request = std::min<size_t>(count - total, 0x40000000u);
+        auto ret = ::syscall(SYS_copy_file_range, in, &inOffset, out, &outOffset, request, 0u);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (total == 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EBADF ||
+                errno == EOPNOTSUPP))
+                break;
+            MOE_THROW(ApiException, "copy_file_range failed, errno={0}", errno);
+        }
+        if (ret == 0)
+            return total;
+        total += static_cast<size_t>(ret);
+    }
+    if (total > 0)
+        return total;
+#endif
+
+    // sendfile: 写入目标文件描述符的当前位置
+    if (::lseek(out, static_cast<off_t>(destOffset), SEEK_SET) != static_cast<off_t>(-1))
+    {
+        while (total < count)
+        {
+            auto inOffset = static_cast<off_t>(srcOffset + total);
+            auto request = std::min<size_t>(count - total, 0x40000000u);
+            auto ret = ::sendfile(out, in, &inOffset, request);
+            if (ret < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (total == 0 && (errno == ENOSYS || errno == EINVAL))
+                    break;
+                MOE_THROW(ApiException, "sendfile failed, errno={0}", errno);
+            }
+            if (ret == 0)
+                return total;
+            total += static_cast<size_t>(ret);
+        }
+        if (total > 0)
+            return total;
+    }
+#endif
+
+    // 通用实现
+    vector<uint8_t> buffer(std::min<size_t>(count, 256 * 1024));
+    while (total < count)
+    {
+        auto request = std::min(count - total, buffer.size());
+        auto ret = ReadFileAt(src, srcOffset + total, buffer.data(), request);
+        if (ret > 0)
+            WriteFileAt(dest, destOffset + total, buffer.data(), ret);
+        total += ret;
+        if (ret < request)
+            break;
+    }
+    return total;
+}
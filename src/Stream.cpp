@@ -3,16 +3,145 @@
  * @date 2017/7/14
  */
 #include <Moe.Core/Stream.hpp>
+#include <Moe.Core/Pal.hpp>
+
+#ifndef MOE_WINDOWS
+#include <sys/uio.h>
+#endif
 
 using namespace std;
 using namespace moe;
 
+namespace
+{
+    static const size_t kCopyBufferSize = 64 * 1024;
+
+    vector<uint8_t>& GetCopyBuffer()
+    {
+#ifndef MOE_EMSCRIPTEN
+        static thread_local vector<uint8_t> s_stBuffer;
+#else
+        static vector<uint8_t> s_stBuffer;  // NOTE: emscripten 模拟多线程
+#endif
+        if (s_stBuffer.empty())
+            s_stBuffer.resize(kCopyBufferSize);
+        return s_stBuffer;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////// Stream
 
 Stream::~Stream()
 {
 }
 
+BytesView Stream::GetReadWindow()
+{
+    return BytesView();
+}
+
+void Stream::AdvanceRead(size_t count)
+{
+    MOE_UNUSED(count);
+    assert(count == 0);
+}
+
+MutableBytesView Stream::GetWriteWindow()
+{
+    return MutableBytesView();
+}
+
+void Stream::AdvanceWrite(size_t count)
+{
+    MOE_UNUSED(count);
+    assert(count == 0);
+}
+
+size_t Stream::ReadV(ArrayView<MutableBytesView> buffers)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+    {
+        auto& buffer = buffers[i];
+        auto count = Read(buffer, buffer.GetSize());
+        total += count;
+        if (count < buffer.GetSize())
+            break;
+    }
+    return total;
+}
+
+void Stream::WriteV(ArrayView<BytesView> buffers)
+{
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+        Write(buffers[i], buffers[i].GetSize());
+}
+
+FILE* Stream::GetFileHandle()const noexcept
+{
+    return nullptr;
+}
+
+size_t Stream::CopyTo(Stream* other, size_t count)
+{
+    assert(other);
+
+    // 文件到文件，交由内核复制
+    auto src = GetFileHandle();
+    auto dest = other->GetFileHandle();
+    if (src && dest && src != dest && IsReadable() && other->IsWriteable())
+    {
+        auto srcPosition = GetPosition();
+        auto destPosition = other->GetPosition();
+        other->Flush();
+        if (IsWriteable())
+            Flush();
+
+        auto total = Pal::CopyFileData(dest, destPosition, src, srcPosition, count);
+
+        // 同步FILE的位置并丢弃其缓冲区
+        Seek(static_cast<int64_t>(srcPosition + total), StreamSeekOrigin::Begin);
+        other->Seek(static_cast<int64_t>(destPosition + total), StreamSeekOrigin::Begin);
+        return total;
+    }
+
+    size_t total = 0;
+    while (total < count)
+    {
+        // 源流提供读取窗口时直接写出窗口
+        auto window = GetReadWindow();
+        if (!window.IsEmpty())
+        {
+            auto readCount = std::min(count - total, window.GetSize());
+            other->Write(window, readCount);
+            AdvanceRead(readCount);
+            total += readCount;
+            continue;
+        }
+
+        // 目标流提供写入窗口时直接读入窗口
+        size_t readCount = 0;
+        auto target = other->GetWriteWindow();
+        if (!target.IsEmpty())
+        {
+            readCount = Read(target, std::min(count - total, target.GetSize()));
+            other->AdvanceWrite(readCount);
+        }
+        else
+        {
+            auto& buffer = GetCopyBuffer();
+            readCount = Read(MutableBytesView(buffer.data(), buffer.size()), std::min(count - total, buffer.size()));
+            if (readCount > 0)
+                other->Write(BytesView(buffer.data(), readCount), readCount);
+        }
+
+        if (readCount == 0)
+            break;
+        total += readCount;
+    }
+    return total;
+}
+
 //////////////////////////////////////////////////////////////////////////////// BytesViewStream
 
 BytesViewStream::BytesViewStream(BytesView view)
@@ -104,7 +233,7 @@ size_t BytesViewStream::Seek(int64_t offset, StreamSeekOrigin origin)
                 if (positive >= m_stView.GetSize())
                     m_uPosition = 0;
                 else
-                    m_uPosition -= positive;
+                    m_uPosition = m_stView.GetSize() - positive;
             }
             break;
     }
@@ -141,6 +270,71 @@ void BytesViewStream::Write(BytesView view, size_t count)
     m_uPosition += count;
 }
 
+size_t BytesViewStream::ReadV(ArrayView<MutableBytesView> buffers)
+{
+    assert(m_stView.GetSize() >= m_uPosition);
+
+    size_t total = 0;
+    for (size_t i = 0; i < buffers.GetSize() && m_uPosition < m_stView.GetSize(); ++i)
+    {
+        auto buffer = buffers[i];
+        auto count = std::min(buffer.GetSize(), m_stView.GetSize() - m_uPosition);
+        if (count > 0)
+            ::memcpy(buffer.GetBuffer(), m_stView.GetBuffer() + m_uPosition, count);
+        m_uPosition += count;
+        total += count;
+    }
+    return total;
+}
+
+void BytesViewStream::WriteV(ArrayView<BytesView> buffers)
+{
+    if (!m_stMutableView)
+        MOE_THROW(OperationNotSupportException, "BytesView is not mutable");
+
+    // 先检查总长度，保证要么全部写入要么不写入
+    size_t total = 0;
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+        total += buffers[i].GetSize();
+    if (m_uPosition + total > m_stMutableView->GetSize())
+        MOE_THROW(OutOfRangeException, "Write out of range");
+
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+    {
+        auto count = buffers[i].GetSize();
+        if (count > 0)
+            ::memcpy(m_stMutableView->GetBuffer() + m_uPosition, buffers[i].GetBuffer(), count);
+        m_uPosition += count;
+    }
+}
+
+BytesView BytesViewStream::GetReadWindow()
+{
+    assert(m_stView.GetSize() >= m_uPosition);
+    return BytesView(m_stView.GetBuffer() + m_uPosition, m_stView.GetSize() - m_uPosition);
+}
+
+void BytesViewStream::AdvanceRead(size_t count)
+{
+    assert(m_uPosition + count <= m_stView.GetSize());
+    m_uPosition += count;
+}
+
+MutableBytesView BytesViewStream::GetWriteWindow()
+{
+    if (!m_stMutableView)
+        return MutableBytesView();
+
+    assert(m_stMutableView->GetSize() >= m_uPosition);
+    return MutableBytesView(m_stMutableView->GetBuffer() + m_uPosition, m_stMutableView->GetSize() - m_uPosition);
+}
+
+void BytesViewStream::AdvanceWrite(size_t count)
+{
+    assert(m_stMutableView && m_uPosition + count <= m_stMutableView->GetSize());
+    m_uPosition += count;
+}
+
 //////////////////////////////////////////////////////////////////////////////// BytesVectorStream
 
 BytesVectorStream::BytesVectorStream(std::vector<uint8_t>& vec)
@@ -227,7 +421,7 @@ size_t BytesVectorStream::Seek(int64_t offset, StreamSeekOrigin origin)
                 if (positive >= m_stVec.size())
                     m_uPosition = 0;
                 else
-                    m_uPosition -= positive;
+                    m_uPosition = m_stVec.size() - positive;
             }
             break;
     }
@@ -258,3 +452,555 @@ void BytesVectorStream::Write(BytesView view, size_t count)
     ::memcpy(m_stVec.data() + m_uPosition, view.GetBuffer(), count);
     m_uPosition += count;
 }
+
+size_t BytesVectorStream::ReadV(ArrayView<MutableBytesView> buffers)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < buffers.GetSize() && m_uPosition < m_stVec.size(); ++i)
+    {
+        auto buffer = buffers[i];
+        auto count = std::min(buffer.GetSize(), m_stVec.size() - m_uPosition);
+        if (count > 0)
+            ::memcpy(buffer.GetBuffer(), m_stVec.data() + m_uPosition, count);
+        m_uPosition += count;
+        total += count;
+    }
+    return total;
+}
+
+void BytesVectorStream::WriteV(ArrayView<BytesView> buffers)
+{
+    // 一次性扩容
+    size_t total = 0;
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+        total += buffers[i].GetSize();
+    if (m_uPosition + total > m_stVec.size())
+        m_stVec.resize(m_uPosition + total);
+
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+    {
+        auto count = buffers[i].GetSize();
+        if (count > 0)
+            ::memcpy(m_stVec.data() + m_uPosition, buffers[i].GetBuffer(), count);
+        m_uPosition += count;
+    }
+}
+
+BytesView BytesVectorStream::GetReadWindow()
+{
+    if (m_uPosition >= m_stVec.size())
+        return BytesView();
+    return BytesView(m_stVec.data() + m_uPosition, m_stVec.size() - m_uPosition);
+}
+
+void BytesVectorStream::AdvanceRead(size_t count)
+{
+    assert(m_uPosition + count <= m_stVec.size());
+    m_uPosition += count;
+}
+
+//////////////////////////////////////////////////////////////////////////////// FileStream
+
+FileStream::FileStream(const char* path, const char* mode)
+    : m_pFile(Pal::OpenFile(path, mode))
+{
+    m_bReadable = (strchr(mode, 'r') != nullptr || strchr(mode, '+') != nullptr);
+    m_bWriteable = (strchr(mode, 'w') != nullptr || strchr(mode, 'a') != nullptr || strchr(mode, '+') != nullptr);
+}
+
+FileStream::~FileStream()
+{
+    ::fclose(m_pFile);
+}
+
+bool FileStream::IsReadable()const noexcept
+{
+    return m_bReadable;
+}
+
+bool FileStream::IsWriteable()const noexcept
+{
+    return m_bWriteable;
+}
+
+bool FileStream::IsSeekable()const noexcept
+{
+    return true;
+}
+
+size_t FileStream::GetLength()const
+{
+    return static_cast<size_t>(Pal::GetFileSize(m_pFile));
+}
+
+size_t FileStream::GetPosition()const
+{
+    return static_cast<size_t>(Pal::TellFile(m_pFile));
+}
+
+void FileStream::Flush()
+{
+    if (::fflush(m_pFile) != 0)
+        MOE_THROW(ApiException, "fflush failed, errno={0}", errno);
+}
+
+int FileStream::ReadByte()
+{
+    if (!m_bReadable)
+        MOE_THROW(OperationNotSupportException, "File is not readable");
+
+    auto ret = ::fgetc(m_pFile);
+    return ret == EOF ? -1 : ret;
+}
+
+size_t FileStream::Read(MutableBytesView out, size_t count)
+{
+    assert(out.GetSize() >= count);
+    if (!m_bReadable)
+        MOE_THROW(OperationNotSupportException, "File is not readable");
+
+    count = std::min(count, out.GetSize());
+    return ::fread(out.GetBuffer(), 1, count, m_pFile);
+}
+
+size_t FileStream::Seek(int64_t offset, StreamSeekOrigin origin)
+{
+    int whence = SEEK_SET;
+    switch (origin)
+    {
+        case StreamSeekOrigin::Begin:
+            whence = SEEK_SET;
+            break;
+        case StreamSeekOrigin::Current:
+            whence = SEEK_CUR;
+            break;
+        case StreamSeekOrigin::End:
+            whence = SEEK_END;
+            break;
+    }
+
+    Pal::SeekFile(m_pFile, offset, whence);
+    return GetPosition();
+}
+
+void FileStream::SetLength(size_t length)
+{
+    MOE_UNUSED(length);
+    MOE_THROW(OperationNotSupportException, "FileStream cannot reset size");
+}
+
+void FileStream::WriteByte(uint8_t b)
+{
+    if (!m_bWriteable)
+        MOE_THROW(OperationNotSupportException, "File is not writeable");
+    if (::fputc(b, m_pFile) == EOF)
+        MOE_THROW(ApiException, "fputc failed, errno={0}", errno);
+}
+
+void FileStream::Write(BytesView view, size_t count)
+{
+    assert(view.GetSize() >= count);
+    if (!m_bWriteable)
+        MOE_THROW(OperationNotSupportException, "File is not writeable");
+
+    count = std::min(count, view.GetSize());
+    if (::fwrite(view.GetBuffer(), 1, count, m_pFile) != count)
+        MOE_THROW(ApiException, "fwrite failed, errno={0}", errno);
+}
+
+void FileStream::WriteV(ArrayView<BytesView> buffers)
+{
+    if (!m_bWriteable)
+        MOE_THROW(OperationNotSupportException, "File is not writeable");
+
+    size_t total = 0;
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+        total += buffers[i].GetSize();
+
+#ifndef MOE_WINDOWS
+    // 数据量较大时绕过FILE的缓冲区，直接使用writev一次性写入
+    if (total >= BUFSIZ)
+    {
+        Flush();
+
+        auto fd = fileno(m_pFile);
+        size_t index = 0;
+        size_t offset = 0;  // 当前段中已写入的部分
+        while (index < buffers.GetSize())
+        {
+            static const size_t kMaxVectors = 64;
+
+            struct iovec vectors[kMaxVectors];
+            size_t count = 0;
+            for (size_t i = index; i < buffers.GetSize() && count < kMaxVectors; ++i)
+            {
+                auto skip = (i == index ? offset : 0);
+                vectors[count].iov_base = const_cast<uint8_t*>(buffers[i].GetBuffer()) + skip;
+                vectors[count].iov_len = buffers[i].GetSize() - skip;
+                ++count;
+            }
+
+            auto ret = ::writev(fd, vectors, static_cast<int>(count));
+            if (ret < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                MOE_THROW(ApiException, "writev failed, errno={0}", errno);
+            }
+
+            // 推进到下一个未写完的段
+            auto written = static_cast<size_t>(ret);
+            while (index < buffers.GetSize() && written >= buffers[index].GetSize() - offset)
+            {
+                written -= buffers[index].GetSize() - offset;
+                offset = 0;
+                ++index;
+            }
+            offset += written;
+        }
+
+        // 令FILE重新与文件描述符的位置同步
+        if (::fseek(m_pFile, 0, SEEK_CUR) != 0)
+            MOE_THROW(ApiException, "fseek failed, errno={0}", errno);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+    {
+        auto count = buffers[i].GetSize();
+        if (count > 0 && ::fwrite(buffers[i].GetBuffer(), 1, count, m_pFile) != count)
+            MOE_THROW(ApiException, "fwrite failed, errno={0}", errno);
+    }
+}
+
+FILE* FileStream::GetFileHandle()const noexcept
+{
+    return m_pFile;
+}
+
+size_t FileStream::ReadAt(uint64_t offset, MutableBytesView out, size_t count)
+{
+    assert(out.GetSize() >= count);
+    if (!m_bReadable)
+        MOE_THROW(OperationNotSupportException, "File is not readable");
+
+    if (m_bWriteable)
+        Flush();
+    return Pal::ReadFileAt(m_pFile, offset, out.GetBuffer(), std::min(count, out.GetSize()));
+}
+
+void FileStream::WriteAt(uint64_t offset, BytesView view, size_t count)
+{
+    assert(view.GetSize() >= count);
+    if (!m_bWriteable)
+        MOE_THROW(OperationNotSupportException, "File is not writeable");
+
+    Flush();
+    Pal::WriteFileAt(m_pFile, offset, view.GetBuffer(), std::min(count, view.GetSize()));
+}
+
+//////////////////////////////////////////////////////////////////////////////// MmapStream
+
+namespace
+{
+    Pal::MappedFile MapFileReadOnly(const char* path)
+    {
+        // 空文件无法映射
+        if (Pal::GetFileSize(path) == 0)
+            return Pal::MappedFile();
+        return Pal::MappedFile(path, 0, true);
+    }
+}
+
+MmapStream::MmapStream(const char* path)
+    : m_stFile(MapFileReadOnly(path)),
+    m_stView(static_cast<const uint8_t*>(m_stFile.GetPointer()), m_stFile.GetSize()),
+    m_stStream(m_stView)
+{
+}
+
+bool MmapStream::IsReadable()const noexcept
+{
+    return true;
+}
+
+bool MmapStream::IsWriteable()const noexcept
+{
+    return false;
+}
+
+bool MmapStream::IsSeekable()const noexcept
+{
+    return true;
+}
+
+size_t MmapStream::GetLength()const
+{
+    return m_stView.GetSize();
+}
+
+size_t MmapStream::GetPosition()const
+{
+    return m_stStream.GetPosition();
+}
+
+void MmapStream::Flush()
+{
+}
+
+int MmapStream::ReadByte()
+{
+    return m_stStream.ReadByte();
+}
+
+size_t MmapStream::Read(MutableBytesView out, size_t count)
+{
+    return m_stStream.Read(out, count);
+}
+
+size_t MmapStream::Seek(int64_t offset, StreamSeekOrigin origin)
+{
+    return m_stStream.Seek(offset, origin);
+}
+
+void MmapStream::SetLength(size_t length)
+{
+    MOE_UNUSED(length);
+    MOE_THROW(OperationNotSupportException, "MmapStream is read-only");
+}
+
+void MmapStream::WriteByte(uint8_t b)
+{
+    MOE_UNUSED(b);
+    MOE_THROW(OperationNotSupportException, "MmapStream is read-only");
+}
+
+void MmapStream::Write(BytesView view, size_t count)
+{
+    MOE_UNUSED(view);
+    MOE_UNUSED(count);
+    MOE_THROW(OperationNotSupportException, "MmapStream is read-only");
+}
+
+BytesView MmapStream::GetReadWindow()
+{
+    return m_stStream.GetReadWindow();
+}
+
+void MmapStream::AdvanceRead(size_t count)
+{
+    m_stStream.AdvanceRead(count);
+}
+
+//////////////////////////////////////////////////////////////////////////////// BufferedStream
+
+const size_t BufferedStream::kDefaultBufferSize;
+
+BufferedStream::BufferedStream(Stream* stream, size_t bufferSize)
+    : m_pStream(stream), m_stBuffer(std::max<size_t>(bufferSize, 16))
+{
+    assert(stream);
+}
+
+BufferedStream::~BufferedStream()
+{
+    try
+    {
+        FlushWriteBuffer();
+    }
+    catch (...)
+    {
+    }
+}
+
+bool BufferedStream::IsReadable()const noexcept
+{
+    return m_pStream->IsReadable();
+}
+
+bool BufferedStream::IsWriteable()const noexcept
+{
+    return m_pStream->IsWriteable();
+}
+
+bool BufferedStream::IsSeekable()const noexcept
+{
+    return m_pStream->IsSeekable();
+}
+
+size_t BufferedStream::GetLength()const
+{
+    auto length = m_pStream->GetLength();
+    if (m_uWriteEnd > 0)
+        length = std::max(length, m_pStream->GetPosition() + m_uWriteEnd);
+    return length;
+}
+
+size_t BufferedStream::GetPosition()const
+{
+    return m_pStream->GetPosition() + m_uWriteEnd - (m_uReadEnd - m_uReadPosition);
+}
+
+void BufferedStream::Flush()
+{
+    FlushWriteBuffer();
+    m_pStream->Flush();
+}
+
+size_t BufferedStream::Read(MutableBytesView out, size_t count)
+{
+    assert(out.GetSize() >= count);
+    count = std::min(count, out.GetSize());
+
+    // 先消耗缓冲区中的数据
+    size_t total = std::min(count, m_uReadEnd - m_uReadPosition);
+    ::memcpy(out.GetBuffer(), m_stBuffer.data() + m_uReadPosition, total);
+    m_uReadPosition += total;
+
+    while (total < count)
+    {
+        // 大块读取直接访问底层流
+        if (count - total >= m_stBuffer.size())
+        {
+            FlushWriteBuffer();
+            auto ret = m_pStream->Read(MutableBytesView(out.GetBuffer() + total, count - total), count - total);
+            total += ret;
+            break;
+        }
+
+        FillReadBuffer();
+        if (m_uReadEnd == 0)
+            break;
+
+        auto ret = std::min(count - total, m_uReadEnd - m_uReadPosition);
+        ::memcpy(out.GetBuffer() + total, m_stBuffer.data() + m_uReadPosition, ret);
+        m_uReadPosition += ret;
+        total += ret;
+    }
+    return total;
+}
+
+size_t BufferedStream::Seek(int64_t offset, StreamSeekOrigin origin)
+{
+    FlushWriteBuffer();
+
+    // 底层流的位置领先于逻辑位置
+    if (origin == StreamSeekOrigin::Current)
+        offset -= static_cast<int64_t>(m_uReadEnd - m_uReadPosition);
+    m_uReadPosition = m_uReadEnd = 0;
+    return m_pStream->Seek(offset, origin);
+}
+
+void BufferedStream::SetLength(size_t length)
+{
+    FlushWriteBuffer();
+    DiscardReadBuffer();
+    m_pStream->SetLength(length);
+}
+
+void BufferedStream::Write(BytesView view, size_t count)
+{
+    assert(view.GetSize() >= count);
+    count = std::min(count, view.GetSize());
+
+    if (m_uReadEnd != 0)
+        DiscardReadBuffer();
+
+    if (m_uWriteEnd + count <= m_stBuffer.size())
+    {
+        ::memcpy(m_stBuffer.data() + m_uWriteEnd, view.GetBuffer(), count);
+        m_uWriteEnd += count;
+        return;
+    }
+
+    // 放不下时先写出缓冲区，大块数据直接写入底层流
+    FlushWriteBuffer();
+    if (count >= m_stBuffer.size())
+        m_pStream->Write(view, count);
+    else
+    {
+        ::memcpy(m_stBuffer.data(), view.GetBuffer(), count);
+        m_uWriteEnd = count;
+    }
+}
+
+void BufferedStream::WriteV(ArrayView<BytesView> buffers)
+{
+    if (m_uReadEnd != 0)
+        DiscardReadBuffer();
+
+    size_t total = 0;
+    for (size_t i = 0; i < buffers.GetSize(); ++i)
+        total += buffers[i].GetSize();
+
+    // 能放入缓冲区时合并写入，否则整体交给底层流
+    if (m_uWriteEnd + total <= m_stBuffer.size())
+    {
+        for (size_t i = 0; i < buffers.GetSize(); ++i)
+        {
+            auto count = buffers[i].GetSize();
+            if (count > 0)
+                ::memcpy(m_stBuffer.data() + m_uWriteEnd, buffers[i].GetBuffer(), count);
+            m_uWriteEnd += count;
+        }
+        return;
+    }
+
+    FlushWriteBuffer();
+    m_pStream->WriteV(buffers);
+}
+
+int BufferedStream::ReadByteSlow()
+{
+    FillReadBuffer();
+    if (m_uReadPosition < m_uReadEnd)
+        return m_stBuffer[m_uReadPosition++];
+    return -1;
+}
+
+void BufferedStream::WriteByteSlow(uint8_t b)
+{
+    PrepareWrite();
+    m_stBuffer[m_uWriteEnd++] = b;
+}
+
+void BufferedStream::FillReadBuffer()
+{
+    assert(m_uReadPosition == m_uReadEnd);
+
+    FlushWriteBuffer();
+    m_uReadPosition = 0;
+    m_uReadEnd = m_pStream->Read(MutableBytesView(m_stBuffer.data(), m_stBuffer.size()), m_stBuffer.size());
+}
+
+void BufferedStream::DiscardReadBuffer()
+{
+    // 退回预读但尚未消耗的数据
+    auto unread = m_uReadEnd - m_uReadPosition;
+    if (unread > 0)
+    {
+        if (!m_pStream->IsSeekable())
+            MOE_THROW(OperationNotSupportException, "Underlying stream is not seekable");
+        m_pStream->Seek(-static_cast<int64_t>(unread), StreamSeekOrigin::Current);
+    }
+    m_uReadPosition = m_uReadEnd = 0;
+}
+
+void BufferedStream::FlushWriteBuffer()
+{
+    if (m_uWriteEnd == 0)
+        return;
+
+    auto count = m_uWriteEnd;
+    m_uWriteEnd = 0;
+    m_pStream->Write(BytesView(m_stBuffer.data(), count), count);
+}
+
+void BufferedStream::PrepareWrite()
+{
+    if (m_uReadEnd != 0)
+        DiscardReadBuffer();
+    if (m_uWriteEnd == m_stBuffer.size())
+        FlushWriteBuffer();
+}
@@ -53,3 +53,129 @@ void Event::Reset()
     unique_lock<mutex> lockGuard(m_stLock);
     m_bEventSet = false;
 }
+
+//////////////////////////////////////////////////////////////////////////////// Rcu
+
+namespace
+{
+    struct RcuSlot
+    {
+        atomic<uint64_t> Epoch;  // 进入临界区时的纪元，0表示不在临界区
+        atomic<bool> InUse;
+        unsigned Depth = 0;  // 嵌套深度，仅所属线程访问
+        RcuSlot* Next = nullptr;
+
+        RcuSlot()noexcept
+            : Epoch(0), InUse(true) {}
+    };
+
+    /**
+     * @brief 线程槽位注册表
+     *
+     * 槽位只增不减，线程退出后槽位被标记为空闲，供后续线程复用。
+     */
+    class RcuRegistry
+    {
+    public:
+        RcuRegistry()noexcept
+            : m_pHead(nullptr), m_ullEpoch(1) {}
+
+    public:
+        RcuSlot* GetHead()const noexcept { return m_pHead.load(memory_order_acquire); }
+
+        uint64_t GetEpoch()const noexcept { return m_ullEpoch.load(memory_order_acquire); }
+        uint64_t AdvanceEpoch()noexcept { return m_ullEpoch.fetch_add(1, memory_order_seq_cst) + 1; }
+
+        RcuSlot* AcquireSlot()
+        {
+            for (auto p = GetHead(); p; p = p->Next)
+            {
+                auto inUse = false;
+                if (!p->InUse.load(memory_order_relaxed) &&
+                    p->InUse.compare_exchange_strong(inUse, true, memory_order_acquire, memory_order_relaxed))
+                    return p;
+            }
+
+            auto slot = new RcuSlot();
+            auto head = m_pHead.load(memory_order_relaxed);
+            do
+            {
+                slot->Next = head;
+            } while (!m_pHead.compare_exchange_weak(head, slot, memory_order_release, memory_order_relaxed));
+            return slot;
+        }
+
+    private:
+        atomic<RcuSlot*> m_pHead;
+        atomic<uint64_t> m_ullEpoch;
+    };
+
+    RcuRegistry& GetRcuRegistry()noexcept
+    {
+        static RcuRegistry s_stRegistry;
+        return s_stRegistry;
+    }
+
+    struct RcuSlotHolder
+    {
+        RcuSlot* Slot;
+
+        RcuSlotHolder()
+            : Slot(GetRcuRegistry().AcquireSlot()) {}
+
+        ~RcuSlotHolder()
+        {
+            assert(Slot->Depth == 0);
+            Slot->InUse.store(false, memory_order_release);
+        }
+    };
+
+    RcuSlot& GetRcuSlot()
+    {
+#ifndef MOE_EMSCRIPTEN
+        static thread_local RcuSlotHolder s_stHolder;
+#else
+        static RcuSlotHolder s_stHolder;  // NOTE: emscripten 模拟多线程
+#endif
+        return *s_stHolder.Slot;
+    }
+}
+
+void Rcu::ReadLock()noexcept
+{
+    auto& slot = GetRcuSlot();
+    if (slot.Depth++ == 0)
+    {
+        slot.Epoch.store(GetRcuRegistry().GetEpoch(), memory_order_seq_cst);
+
+        // 槽位的写入必须先于临界区内对受保护指针的读取对Synchronize可见（StoreLoad屏障）
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+void Rcu::ReadUnlock()noexcept
+{
+    auto& slot = GetRcuSlot();
+    assert(slot.Depth > 0);
+    if (--slot.Depth == 0)
+        slot.Epoch.store(0, memory_order_release);
+}
+
+void Rcu::Synchronize()noexcept
+{
+    auto& registry = GetRcuRegistry();
+    auto epoch = registry.AdvanceEpoch();
+
+    // 等待在推进纪元之前进入临界区的读者
+    for (auto p = registry.GetHead(); p; p = p->Next)
+    {
+        Sleeper sleeper;
+        while (true)
+        {
+            auto e = p->Epoch.load(memory_order_seq_cst);
+            if (e == 0 || e >= epoch)
+                break;
+            sleeper.Wait();
+        }
+    }
+}
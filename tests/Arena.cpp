@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+#include <Moe.Core/Arena.hpp>
+
+using namespace std;
+using namespace moe;
+
+namespace
+{
+    struct Counter
+    {
+        int& Count;
+
+        Counter(int& count)
+            : Count(count) { ++Count; }
+        ~Counter() { --Count; }
+    };
+}
+
+TEST(Arena, Alloc)
+{
+    Arena arena(256);
+    EXPECT_EQ(0u, arena.GetUsedSize());
+
+    auto p1 = arena.Alloc(10);
+    auto p2 = arena.Alloc(10);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p1) % Arena::kDefaultAlignment);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p2) % Arena::kDefaultAlignment);
+    EXPECT_LE(static_cast<uint8_t*>(p1) + 10, p2);
+
+    auto p3 = arena.Alloc(1, 1);
+    auto p4 = arena.Alloc(1, 1);
+    EXPECT_EQ(static_cast<uint8_t*>(p3) + 1, p4);
+
+    auto p5 = arena.Alloc(8, 64);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p5) % 64);
+
+    // 超过块大小的分配
+    auto p6 = arena.Alloc(1000, 128);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p6) % 128);
+    memset(p6, 0, 1000);
+
+    // 仅最近一次分配可以回收
+    auto used = arena.GetUsedSize();
+    arena.Free(p5, 8);
+    EXPECT_EQ(used, arena.GetUsedSize());
+    auto p7 = arena.Alloc(16, 1);
+    arena.Free(p7, 16);
+    EXPECT_EQ(used, arena.GetUsedSize());
+}
+
+TEST(Arena, Checkpoint)
+{
+    int count = 0;
+    Arena arena(128);
+
+    arena.New<Counter>(count);
+    auto cp1 = arena.GetCheckpoint();
+    auto used1 = arena.GetUsedSize();
+    {
+        Arena::Scope scope(arena);
+        for (int i = 0; i < 100; ++i)
+            arena.New<Counter>(count);
+        EXPECT_EQ(101, count);
+
+        auto cp2 = arena.GetCheckpoint();
+        arena.New<Counter>(count);
+        arena.Alloc(4096);
+        arena.Rewind(cp2);
+        EXPECT_EQ(101, count);
+    }
+    EXPECT_EQ(1, count);
+    EXPECT_EQ(used1, arena.GetUsedSize());
+
+    // 回滚后复用已经申请的块
+    auto capacity = arena.GetCapacity();
+    for (int i = 0; i < 100; ++i)
+        arena.New<Counter>(count);
+    EXPECT_EQ(capacity, arena.GetCapacity());
+
+    arena.Rewind(cp1);
+    EXPECT_EQ(1, count);
+
+    arena.Reset();
+    EXPECT_EQ(0, count);
+    EXPECT_EQ(0u, arena.GetUsedSize());
+    EXPECT_EQ(capacity, arena.GetCapacity());
+
+    arena.Alloc(1);
+    EXPECT_LT(0u, arena.Shrink());
+    EXPECT_GT(capacity, arena.GetCapacity());
+
+    arena.New<Counter>(count);
+    EXPECT_EQ(1, count);
+}
+
+TEST(Arena, Allocator)
+{
+    Arena arena;
+    {
+        using Vec = vector<int, ArenaAllocator<int>>;
+        using Map = map<int, Vec, less<int>, ArenaAllocator<pair<const int, Vec>>>;
+
+        ArenaAllocator<pair<const int, Vec>> allocator(arena);
+        Map m(less<int>(), allocator);
+        for (int i = 0; i < 100; ++i)
+        {
+            auto it = m.emplace(i, Vec(ArenaAllocator<int>(arena))).first;
+            for (int j = 0; j < i; ++j)
+                it->second.push_back(j);
+        }
+        EXPECT_EQ(100u, m.size());
+        EXPECT_EQ(99u, m.at(99).size());
+        EXPECT_EQ(98, m.at(99)[98]);
+    }
+    EXPECT_LT(0u, arena.GetUsedSize());
+
+    arena.Reset();
+    EXPECT_EQ(0u, arena.GetUsedSize());
+}
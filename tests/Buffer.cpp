@@ -4,6 +4,9 @@
  */
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <vector>
+
 #include <Moe.Core/Buffer.hpp>
 
 using namespace std;
@@ -136,3 +139,165 @@ TEST(Buffer, ShiftLeft)
     for (size_t i = 0; i < 4; ++i)
         EXPECT_EQ(i + 4, test3[i]);
 }
+
+TEST(Buffer, SameSizeCopy)
+{
+    Buffer<4> a;
+    for (uint8_t i = 0; i < 100; ++i)
+        a.Append(&i, 1);
+
+    Buffer<4> b = a;
+    Buffer<4> c;
+    c = a;
+    a[0] = 0xFF;
+    EXPECT_EQ(100u, b.GetSize());
+    EXPECT_EQ(100u, c.GetSize());
+    EXPECT_EQ(0, b[0]);
+    EXPECT_EQ(0, c[0]);
+    EXPECT_NE(a.GetBuffer(), b.GetBuffer());
+
+    auto p = b.GetBuffer();
+    Buffer<4> d = std::move(b);
+    EXPECT_EQ(p, d.GetBuffer());
+    EXPECT_EQ(0u, b.GetSize());
+    c = std::move(d);
+    EXPECT_EQ(p, c.GetBuffer());
+    EXPECT_EQ(99, c[99]);
+}
+
+TEST(Buffer, ReserveAndShrink)
+{
+    Buffer<16> buffer;
+
+    // 追加时按2的幂次增长
+    size_t reallocations = 0;
+    auto last = buffer.GetBuffer();
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        buffer.Append(&i, sizeof(i));
+        if (buffer.GetBuffer() != last)
+        {
+            last = buffer.GetBuffer();
+            ++reallocations;
+        }
+    }
+    EXPECT_EQ(40000u, buffer.GetSize());
+    EXPECT_EQ(65536u, buffer.GetCapacity());
+    EXPECT_LE(reallocations, 13u);
+
+    // 精确预留
+    buffer.Reserve(100000);
+    EXPECT_EQ(100000u, buffer.GetCapacity());
+    buffer.Reserve(10);
+    EXPECT_EQ(100000u, buffer.GetCapacity());
+
+    buffer.ShrinkToFit();
+    EXPECT_EQ(40000u, buffer.GetCapacity());
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        uint32_t v;
+        ::memcpy(&v, buffer.GetBuffer() + i * sizeof(uint32_t), sizeof(v));
+        ASSERT_EQ(i, v);
+    }
+
+    // 回到原地空间
+    buffer.Resize(10);
+    buffer.ShrinkToFit();
+    EXPECT_EQ(16u, buffer.GetCapacity());
+    EXPECT_EQ(10u, buffer.GetSize());
+    uint32_t v;
+    ::memcpy(&v, buffer.GetBuffer() + 4, sizeof(v));
+    EXPECT_EQ(1u, v);
+
+    Buffer<16> empty;
+    empty.Reserve(8);
+    EXPECT_EQ(16u, empty.GetCapacity());
+    empty.Reserve(17);
+    EXPECT_EQ(17u, empty.GetCapacity());
+    empty.ShrinkToFit();
+    EXPECT_EQ(16u, empty.GetCapacity());
+}
+
+TEST(Buffer, Pool)
+{
+    ObjectPool pool;
+    {
+        Buffer<8> buffer(&pool);
+        EXPECT_EQ(&pool, buffer.GetPool());
+
+        buffer.Append(BytesView(reinterpret_cast<const uint8_t*>("0123456789"), 10));
+        EXPECT_EQ(&pool, ObjectPool::GetPoolFromPointer(buffer.GetBuffer()));
+        EXPECT_LT(0u, pool.GetUsedSize());
+
+        // 拷贝继承对象池
+        Buffer<8> copy = buffer;
+        EXPECT_EQ(&pool, copy.GetPool());
+        EXPECT_EQ(&pool, ObjectPool::GetPoolFromPointer(copy.GetBuffer()));
+
+        // 切换到malloc后的重新分配
+        buffer.SetPool(nullptr);
+        buffer.Reserve(1000);
+        EXPECT_EQ(0, ::memcmp(buffer.GetBuffer(), "0123456789", 10));
+        Buffer<8> moved = std::move(copy);
+        moved.ShrinkToFit();
+        EXPECT_EQ(10u, moved.GetCapacity());
+        EXPECT_EQ(0, ::memcmp(moved.GetBuffer(), "0123456789", 10));
+    }
+    EXPECT_EQ(0u, pool.GetUsedSize());
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Buffer, DISABLED_Benchmark)
+{
+    static const size_t kMessages = 200000;
+
+    // 模拟小消息的拼装：若干个长度不一的字段
+    vector<size_t> fields;
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        fields.push_back(1 + (seed >> 16) % 24);
+    }
+    uint8_t payload[32] = {};
+
+    size_t total = 0;
+    auto bench = [&](const char* name, const std::function<size_t()>& build) {
+        auto start = chrono::steady_clock::now();
+        size_t sum = 0;
+        for (size_t i = 0; i < kMessages; ++i)
+            sum += build();
+        auto elapsed = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+        if (total == 0)
+            total = sum;
+        EXPECT_EQ(total, sum);
+        printf("[ BENCH    ] %-32s: %.1f ns/message\n", name, elapsed.count() * 1e9 / kMessages);
+    };
+
+    bench("std::vector<uint8_t>", [&]() {
+        vector<uint8_t> msg;
+        for (auto sz : fields)
+            msg.insert(msg.end(), payload, payload + sz);
+        return msg.size();
+    });
+    bench("Buffer<128>", [&]() {
+        Buffer<128> msg;
+        for (auto sz : fields)
+            msg.Append(payload, sz);
+        return msg.GetSize();
+    });
+    bench("Buffer<32>", [&]() {
+        Buffer<32> msg;
+        for (auto sz : fields)
+            msg.Append(payload, sz);
+        return msg.GetSize();
+    });
+
+    ObjectPool pool;
+    bench("Buffer<32>(ObjectPool)", [&]() {
+        Buffer<32> msg(&pool);
+        for (auto sz : fields)
+            msg.Append(payload, sz);
+        return msg.GetSize();
+    });
+}
@@ -0,0 +1,240 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <gtest/gtest.h>
+
+#include <Moe.Core/Mdr.hpp>
+#include <Moe.Core/Http.hpp>
+#include <Moe.Core/ChainBuffer.hpp>
+
+using namespace std;
+using namespace moe;
+
+namespace
+{
+    string ToString(const ChainBuffer& buffer)
+    {
+        string ret(buffer.GetSize(), '\0');
+        EXPECT_EQ(buffer.GetSize(), buffer.CopyTo(MutableBytesView(reinterpret_cast<uint8_t*>(&ret[0]), ret.size())));
+        return ret;
+    }
+
+    BytesView ToView(const char* str)
+    {
+        return BytesView(reinterpret_cast<const uint8_t*>(str), strlen(str));
+    }
+}
+
+TEST(ChainBuffer, AppendAndConsume)
+{
+    ObjectPool pool;
+    {
+        ChainBuffer buffer(pool, 16);
+        EXPECT_TRUE(buffer.IsEmpty());
+
+        string expected;
+        for (int i = 0; i < 20; ++i)
+        {
+            auto s = "line" + to_string(i) + ";";
+            buffer.Append(ToView(s.c_str()));
+            expected += s;
+        }
+        EXPECT_EQ(expected.size(), buffer.GetSize());
+        EXPECT_EQ((expected.size() + 15) / 16, buffer.GetSegmentCount());
+        EXPECT_EQ(expected, ToString(buffer));
+
+        // 偏移拷贝
+        char part[10];
+        EXPECT_EQ(10u, buffer.CopyTo(MutableBytesView(reinterpret_cast<uint8_t*>(part), 10), 14));
+        EXPECT_EQ(expected.substr(14, 10), string(part, 10));
+
+        EXPECT_EQ(20u, buffer.Consume(20));
+        expected.erase(0, 20);
+        EXPECT_EQ(expected, ToString(buffer));
+        EXPECT_EQ(expected.size(), buffer.Consume(1000));
+        EXPECT_TRUE(buffer.IsEmpty());
+        EXPECT_EQ(0u, buffer.GetSegmentCount());
+
+        // 直接写入末尾
+        auto window = buffer.PrepareAppend();
+        EXPECT_EQ(16u, window.GetSize());
+        memcpy(window.GetBuffer(), "abc", 3);
+        buffer.CommitAppend(3);
+        window = buffer.PrepareAppend();
+        EXPECT_EQ(13u, window.GetSize());
+        window[0] = 'd';
+        buffer.CommitAppend(1);
+        EXPECT_EQ("abcd", ToString(buffer));
+        EXPECT_EQ(1u, buffer.GetSegmentCount());
+
+        // 移动
+        ChainBuffer moved(std::move(buffer));
+        EXPECT_TRUE(buffer.IsEmpty());
+        EXPECT_EQ("abcd", ToString(moved));
+        buffer = std::move(moved);
+        EXPECT_EQ("abcd", ToString(buffer));
+    }
+    EXPECT_EQ(0u, pool.GetUsedSize());
+}
+
+TEST(ChainBuffer, Prepend)
+{
+    ObjectPool pool;
+    {
+        ChainBuffer buffer(pool, 8);
+        buffer.Append(ToView("body"));
+        buffer.Prepend(ToView("header:"));
+        EXPECT_EQ("header:body", ToString(buffer));
+        buffer.Prepend(ToView("0"));
+        buffer.Prepend(ToView("1"));
+        EXPECT_EQ("10header:body", ToString(buffer));
+        EXPECT_EQ(3u, buffer.GetSegmentCount());
+
+        buffer.Prepend(ToView("a very long prefix "));
+        EXPECT_EQ("a very long prefix 10header:body", ToString(buffer));
+
+        ChainBuffer empty(pool, 8);
+        empty.Prepend(ToView("xyz"));
+        EXPECT_EQ("xyz", ToString(empty));
+        empty.Append(ToView("123456"));
+        EXPECT_EQ("xyz123456", ToString(empty));
+    }
+    EXPECT_EQ(0u, pool.GetUsedSize());
+}
+
+TEST(ChainBuffer, SplitAndGather)
+{
+    ObjectPool pool;
+    {
+        ChainBuffer buffer(pool, 10);
+        buffer.Append(ToView("0123456789abcdefghijABCDEFGHIJ"));
+        EXPECT_EQ(3u, buffer.GetSegmentCount());
+
+        // 在块中间拆分，边界块被共享
+        auto front = buffer.Split(15);
+        EXPECT_EQ("0123456789abcde", ToString(front));
+        EXPECT_EQ("fghijABCDEFGHIJ", ToString(buffer));
+        EXPECT_EQ(front.GetSegment(1).GetBuffer() + 5, buffer.GetSegment(0).GetBuffer());
+
+        // 共享的块不会被写入
+        front.Append(ToView("!"));
+        buffer.Prepend(ToView("?"));
+        EXPECT_EQ("0123456789abcde!", ToString(front));
+        EXPECT_EQ("?fghijABCDEFGHIJ", ToString(buffer));
+
+        // 拼接回去
+        front.Append(std::move(buffer));
+        EXPECT_TRUE(buffer.IsEmpty());
+        EXPECT_EQ("0123456789abcde!?fghijABCDEFGHIJ", ToString(front));
+
+        BytesView views[8];
+        auto count = front.Gather(MutableArrayView<BytesView>(views, 8));
+        EXPECT_EQ(front.GetSegmentCount(), count);
+        string joined;
+        for (size_t i = 0; i < count; ++i)
+            joined.append(reinterpret_cast<const char*>(views[i].GetBuffer()), views[i].GetSize());
+        EXPECT_EQ(ToString(front), joined);
+
+        count = front.Gather(MutableArrayView<BytesView>(views, 2), 12);
+        EXPECT_EQ(2u, count);
+        EXPECT_EQ(3u, views[0].GetSize());
+        EXPECT_EQ('c', views[0][0]);
+
+        vector<uint8_t> out;
+        BytesVectorStream stream(out);
+        count = front.Gather(MutableArrayView<BytesView>(views, 8));
+        stream.WriteV(ArrayView<BytesView>(views, count));
+        EXPECT_EQ(joined, string(out.begin(), out.end()));
+
+        auto all = front.Split(1000);
+        EXPECT_TRUE(front.IsEmpty());
+        EXPECT_EQ(joined, ToString(all));
+    }
+    EXPECT_EQ(0u, pool.GetUsedSize());
+}
+
+TEST(ChainBuffer, Stream)
+{
+    ObjectPool pool;
+    {
+        ChainBuffer buffer(pool, 64);
+        ChainBufferStream stream(buffer);
+
+        BinaryWriter<> writer(&stream);
+        for (uint32_t i = 0; i < 100; ++i)
+            writer.WriteUInt32LE(i * 7);
+        stream.WriteByte(0xAB);
+        EXPECT_EQ(401u, buffer.GetSize());
+
+        BinaryReader<> reader(&stream);
+        for (uint32_t i = 0; i < 100; ++i)
+            ASSERT_EQ(i * 7, reader.ReadUInt32LE());
+        EXPECT_EQ(0xAB, stream.ReadByte());
+        EXPECT_EQ(-1, stream.ReadByte());
+        EXPECT_EQ(401u, stream.GetPosition());
+        EXPECT_EQ(401u, stream.GetLength());
+        EXPECT_THROW(stream.Seek(0, StreamSeekOrigin::Begin), OperationNotSupportException);
+
+        // Mdr经由分段缓冲区读写
+        vector<string> values;
+        for (int i = 0; i < 100; ++i)
+            values.push_back(string(static_cast<size_t>(i), 'x'));
+        Mdr::Writer mdrWriter(&stream);
+        mdrWriter.Write(values, 0);
+        EXPECT_GT(buffer.GetSegmentCount(), 1u);
+
+        vector<string> out;
+        Mdr::Reader mdrReader(&stream);
+        mdrReader.Read(out, 0);
+        EXPECT_EQ(values, out);
+        EXPECT_TRUE(buffer.IsEmpty());
+    }
+    EXPECT_EQ(0u, pool.GetUsedSize());
+}
+
+TEST(ChainBuffer, Protocol)
+{
+    ObjectPool pool;
+    {
+        ChainBuffer buffer(pool, 7);
+        buffer.Append(ToView("POST /index HTTP/1.1\r\nHost: example.com\r\nContent-Length: 11\r\n\r\nhello world"));
+
+        string body;
+        HttpProtocol http(HttpProtocol::ProtocolType::Request);
+        http.SetBodyDataCallback([&](BytesView data) {
+            body.append(reinterpret_cast<const char*>(data.GetBuffer()), data.GetSize());
+        });
+        EXPECT_TRUE(http.Parse(buffer));
+        EXPECT_EQ(HttpMethods::Post, http.GetMethod());
+        EXPECT_EQ("/index", http.GetUrl());
+        EXPECT_EQ("hello world", body);
+        EXPECT_TRUE(buffer.IsEmpty());
+
+        // 未完成的请求
+        HttpProtocol partial(HttpProtocol::ProtocolType::Request);
+        buffer.Clear();
+        buffer.Append(ToView("GET / HTTP/1.1\r\nHost: a"));
+        EXPECT_FALSE(partial.Parse(buffer));
+        EXPECT_TRUE(buffer.IsEmpty());
+        buffer.Append(ToView("\r\n\r\n"));
+        EXPECT_TRUE(partial.Parse(buffer));
+
+        // WebSocket：未掩码的文本帧
+        string payload;
+        size_t messages = 0;
+        WebSocketProtocol ws;
+        ws.SetDataCallback([&](BytesView data) {
+            payload.append(reinterpret_cast<const char*>(data.GetBuffer()), data.GetSize());
+        });
+        ws.SetMessageCompleteCallback([&]() { ++messages; });
+
+        const uint8_t frame[] = { 0x81, 0x0B, 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd' };
+        buffer.Append(BytesView(frame, sizeof(frame)));
+        ws.Parse(buffer);
+        EXPECT_TRUE(buffer.IsEmpty());
+        EXPECT_EQ("hello world", payload);
+        EXPECT_EQ(1u, messages);
+    }
+    EXPECT_EQ(0u, pool.GetUsedSize());
+}
@@ -0,0 +1,299 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+
+#include <Moe.Core/Mdr.hpp>
+#include <Moe.Core/Compression.hpp>
+
+using namespace std;
+using namespace moe;
+using namespace Compression;
+
+namespace
+{
+    vector<uint8_t> MakeText(size_t size)
+    {
+        static const char* kWords[] = {
+            "moe", "core", "stream", "logging", "compression", "buffer", "block", "the", "of", "and", " ", "\n",
+        };
+
+        mt19937 rand(42);
+        vector<uint8_t> ret;
+        while (ret.size() < size)
+        {
+            auto word = kWords[rand() % (sizeof(kWords) / sizeof(kWords[0]))];
+            ret.insert(ret.end(), word, word + strlen(word));
+        }
+        ret.resize(size);
+        return ret;
+    }
+
+    vector<uint8_t> MakeRandom(size_t size)
+    {
+        mt19937 rand(7);
+        vector<uint8_t> ret(size);
+        for (auto& b : ret)
+            b = static_cast<uint8_t>(rand());
+        return ret;
+    }
+
+    void CheckRoundTrip(const vector<uint8_t>& input)
+    {
+        vector<uint8_t> compressed;
+        Lz4::Compress(compressed, BytesView(input.data(), input.size()));
+        EXPECT_LE(compressed.size(), Lz4::GetMaxCompressedSize(input.size()));
+
+        vector<uint8_t> output(input.size());
+        EXPECT_EQ(input.size(), Lz4::Decompress(BytesView(compressed.data(), compressed.size()),
+            MutableBytesView(output.data(), output.size())));
+        EXPECT_EQ(input, output);
+
+        vector<uint8_t> output2 { 'x' };
+        Lz4::Decompress(output2, BytesView(compressed.data(), compressed.size()));
+        ASSERT_EQ(input.size() + 1, output2.size());
+        EXPECT_TRUE(equal(input.begin(), input.end(), output2.begin() + 1));
+    }
+}
+
+TEST(Compression, Lz4)
+{
+    // 边界大小
+    for (size_t size : { 0, 1, 4, 12, 13, 14, 16, 100, 65535, 65536, 200000 })
+    {
+        CheckRoundTrip(MakeText(size));
+        CheckRoundTrip(MakeRandom(size));
+        CheckRoundTrip(vector<uint8_t>(size, 'a'));
+    }
+
+    // 长重复在远距离处出现
+    auto text = MakeText(100000);
+    auto random = MakeRandom(100000);
+    vector<uint8_t> mixed;
+    mixed.insert(mixed.end(), random.begin(), random.end());
+    mixed.insert(mixed.end(), text.begin(), text.end());
+    mixed.insert(mixed.end(), random.begin(), random.begin() + 1000);
+    CheckRoundTrip(mixed);
+
+    // 压缩效果
+    vector<uint8_t> compressed;
+    Lz4::Compress(compressed, BytesView(text.data(), text.size()));
+    EXPECT_LT(compressed.size(), text.size() / 2);
+
+    // 输出缓冲区不足
+    uint8_t small[8];
+    EXPECT_THROW(Lz4::Compress(BytesView(text.data(), text.size()), MutableBytesView(small, sizeof(small))),
+        OutOfRangeException);
+    EXPECT_THROW(Lz4::Decompress(BytesView(compressed.data(), compressed.size()), MutableBytesView(small,
+        sizeof(small))), OutOfRangeException);
+}
+
+TEST(Compression, Lz4BlockFormat)
+{
+    // 手工构造的标准LZ4块："abc" + 匹配(偏移3，长度9) + "xyzxy"
+    const uint8_t block[] = { 0x35, 'a', 'b', 'c', 0x03, 0x00, 0x50, 'x', 'y', 'z', 'x', 'y' };
+    uint8_t out[64] = {};
+    auto size = Lz4::Decompress(BytesView(block, sizeof(block)), MutableBytesView(out, sizeof(out)));
+    EXPECT_EQ("abcabcabcabcxyzxy", string(reinterpret_cast<const char*>(out), size));
+
+    // 空输入被编码为单个token
+    vector<uint8_t> empty;
+    Lz4::Compress(empty, BytesView());
+    ASSERT_EQ(1u, empty.size());
+    EXPECT_EQ(0, empty[0]);
+
+    // 损坏的数据
+    const uint8_t badOffset[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    EXPECT_THROW(Lz4::Decompress(BytesView(badOffset, sizeof(badOffset)), MutableBytesView(out, sizeof(out))),
+        BadFormatException);
+    const uint8_t truncated[] = { 0xF0, 0xFF };
+    EXPECT_THROW(Lz4::Decompress(BytesView(truncated, sizeof(truncated)), MutableBytesView(out, sizeof(out))),
+        BadFormatException);
+    EXPECT_THROW(Lz4::Decompress(BytesView(), MutableBytesView(out, sizeof(out))), BadFormatException);
+
+    vector<uint8_t> vec;
+    EXPECT_THROW(Lz4::Decompress(vec, BytesView(badOffset, sizeof(badOffset))), BadFormatException);
+    EXPECT_TRUE(vec.empty());
+
+    // 随机破坏压缩数据不应越界
+    auto text = MakeText(10000);
+    vector<uint8_t> compressed;
+    Lz4::Compress(compressed, BytesView(text.data(), text.size()));
+    mt19937 rand(1);
+    vector<uint8_t> output(text.size());
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto corrupted = compressed;
+        corrupted[rand() % corrupted.size()] ^= static_cast<uint8_t>(1 + rand() % 255);
+        try
+        {
+            Lz4::Decompress(BytesView(corrupted.data(), corrupted.size()), MutableBytesView(output.data(),
+                output.size()));
+        }
+        catch (const BadFormatException&)
+        {
+        }
+        catch (const OutOfRangeException&)
+        {
+        }
+    }
+}
+
+TEST(Compression, Lz4Stream)
+{
+    auto text = MakeText(300000);
+    auto random = MakeRandom(100000);
+
+    vector<uint8_t> data;
+    {
+        BytesVectorStream inner(data);
+        Lz4CompressStream stream(&inner, 64 * 1024);
+        stream.Write(BytesView(text.data(), text.size()), text.size());
+        for (size_t i = 0; i < 1000; ++i)
+            stream.WriteByte(static_cast<uint8_t>(i));
+        stream.Write(BytesView(random.data(), random.size()), random.size());
+        EXPECT_EQ(text.size() + 1000 + random.size(), stream.GetPosition());
+    }
+    EXPECT_LT(data.size(), text.size());
+
+    {
+        BytesViewStream inner(BytesView(data.data(), data.size()));
+        Lz4DecompressStream stream(&inner);
+
+        vector<uint8_t> out(text.size());
+        EXPECT_EQ(text.size(), stream.Read(MutableBytesView(out.data(), out.size()), out.size()));
+        EXPECT_EQ(text, out);
+        for (size_t i = 0; i < 1000; ++i)
+            ASSERT_EQ(static_cast<uint8_t>(i), stream.ReadByte());
+
+        out.resize(random.size() + 10);
+        EXPECT_EQ(random.size(), stream.Read(MutableBytesView(out.data(), out.size()), out.size()));
+        out.resize(random.size());
+        EXPECT_EQ(random, out);
+        EXPECT_EQ(-1, stream.ReadByte());
+        EXPECT_EQ(text.size() + 1000 + random.size(), stream.GetPosition());
+        EXPECT_EQ(inner.GetLength(), inner.GetPosition());
+    }
+
+    // 空流
+    data.clear();
+    {
+        BytesVectorStream inner(data);
+        Lz4CompressStream stream(&inner);
+        stream.Finish();
+        EXPECT_THROW(stream.WriteByte(0), InvalidCallException);
+    }
+    {
+        BytesViewStream inner(BytesView(data.data(), data.size()));
+        Lz4DecompressStream stream(&inner);
+        EXPECT_EQ(-1, stream.ReadByte());
+    }
+
+    // 截断与错误的头
+    data.resize(data.size() - 1);
+    {
+        BytesViewStream inner(BytesView(data.data(), data.size()));
+        Lz4DecompressStream stream(&inner);
+        EXPECT_THROW(stream.ReadByte(), BadFormatException);
+    }
+    {
+        BytesViewStream inner(BytesView(text.data(), text.size()));
+        EXPECT_THROW(Lz4DecompressStream stream(&inner), BadFormatException);
+    }
+
+    // 长度为0的块只能作为结束标记出现
+    {
+        static const uint8_t kEmptyStored[] = { 'M', 'L', 'Z', '4', 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00 };
+        BytesViewStream inner(BytesView(kEmptyStored, sizeof(kEmptyStored)));
+        Lz4DecompressStream stream(&inner);
+        EXPECT_THROW(stream.ReadByte(), BadFormatException);
+    }
+    {
+        static const uint8_t kEmptyCompressed[] = { 'M', 'L', 'Z', '4', 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00 };
+        BytesViewStream inner(BytesView(kEmptyCompressed, sizeof(kEmptyCompressed)));
+        Lz4DecompressStream stream(&inner);
+        uint8_t buf[4];
+        EXPECT_THROW(stream.Read(MutableBytesView(buf, sizeof(buf)), sizeof(buf)), BadFormatException);
+    }
+
+    // Mdr经由压缩流读写
+    vector<uint64_t> values;
+    for (uint64_t i = 0; i < 50000; ++i)
+        values.push_back(i * 3);
+    data.clear();
+    {
+        BytesVectorStream inner(data);
+        Lz4CompressStream stream(&inner);
+        Mdr::Writer writer(&stream);
+        writer.Write(values, 0);
+        writer.Write(string("tail"), 1);
+    }
+    {
+        BytesViewStream inner(BytesView(data.data(), data.size()));
+        Lz4DecompressStream stream(&inner);
+        Mdr::Reader reader(&stream);
+        vector<uint64_t> out;
+        string tail;
+        reader.Read(out, 0);
+        reader.Read(tail, 1);
+        EXPECT_EQ(values, out);
+        EXPECT_EQ("tail", tail);
+    }
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Compression, DISABLED_Lz4Benchmark)
+{
+    static const char* kFiles[] = {
+        "UnicodeNormalizeData.cpp", "DtoaPrecomputedShortestSingle.cpp", "UrlTestData.cpp",
+    };
+
+    string dir(__FILE__);
+    dir = dir.substr(0, dir.find_last_of("/\\") + 1) + "Data/";
+
+    for (auto name : kFiles)
+    {
+        string input;
+        try
+        {
+            ReadWholeFile(input, (dir + name).c_str());
+        }
+        catch (const IOException&)
+        {
+            printf("[ BENCH    ] %s: not found, skipped\n", name);
+            continue;
+        }
+
+        BytesView view(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+        vector<uint8_t> compressed;
+        vector<uint8_t> output(input.size());
+
+        const int kRounds = 10;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < kRounds; ++i)
+        {
+            compressed.clear();
+            Lz4::Compress(compressed, view);
+        }
+        auto compressTime = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < kRounds; ++i)
+        {
+            Lz4::Decompress(BytesView(compressed.data(), compressed.size()), MutableBytesView(output.data(),
+                output.size()));
+        }
+        auto decompressTime = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+        EXPECT_TRUE(equal(output.begin(), output.end(), view.GetBuffer()));
+
+        auto mb = input.size() * kRounds / 1048576.0;
+        printf("[ BENCH    ] %-36s: ratio %.3f, compress %.1f MB/s, decompress %.1f MB/s\n", name,
+            static_cast<double>(compressed.size()) / input.size(), mb / compressTime.count(),
+            mb / decompressTime.count());
+    }
+}
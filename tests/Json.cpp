@@ -5,6 +5,8 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <chrono>
+#include <random>
 
 #include <Moe.Core/Json.hpp>
 #include <Moe.Core/Parser.hpp>
@@ -72,3 +74,896 @@ TEST(Json, Parse5)
     EXPECT_THROW(Json5::Parse("\"\\uqqqq\""), LexicalException);
     EXPECT_THROW(Json5::Parse("\"\\u00A\""), LexicalException);
 }
+
+TEST(Json, Parse)
+{
+    // 标量
+    EXPECT_EQ(Json::Parse("123"), 123.);
+    EXPECT_EQ(Json::Parse(" -0.5e1 "), -5.);
+    EXPECT_EQ(Json::Parse("\"asd\""), "asd");
+    EXPECT_EQ(Json::Parse("true"), true);
+    EXPECT_EQ(Json::Parse("false"), false);
+    EXPECT_EQ(Json::Parse("null"), nullptr);
+    EXPECT_EQ(Json::Parse("12345678901234567890").Get<double>(), 12345678901234567890.);
+    EXPECT_EQ(Json::Parse("123.456e-7").Get<double>(), 123.456e-7);
+    EXPECT_TRUE(std::signbit(Json::Parse("-0").Get<double>()));
+
+    // 不接受Json5扩展
+    EXPECT_THROW(Json::Parse("{\"id\":0,}"), LexicalException);
+    EXPECT_THROW(Json::Parse("[0,]"), LexicalException);
+    EXPECT_THROW(Json::Parse("[1]/**/"), LexicalException);
+    EXPECT_THROW(Json::Parse("{key: 1}"), LexicalException);
+    EXPECT_THROW(Json::Parse("'a'"), LexicalException);
+    EXPECT_THROW(Json::Parse("NaN"), LexicalException);
+    EXPECT_THROW(Json::Parse("-Infinity"), LexicalException);
+    EXPECT_THROW(Json::Parse("0x42"), LexicalException);
+    EXPECT_THROW(Json::Parse("+1"), LexicalException);
+    EXPECT_THROW(Json::Parse(".2"), LexicalException);
+    EXPECT_THROW(Json::Parse("1."), LexicalException);
+    EXPECT_THROW(Json::Parse("01"), LexicalException);
+    EXPECT_THROW(Json::Parse("0E+"), LexicalException);
+    EXPECT_THROW(Json::Parse("\"\t\""), LexicalException);
+    EXPECT_THROW(Json::Parse("\"a\\\nb\""), LexicalException);
+
+    // 未闭合标记
+    EXPECT_THROW(Json::Parse(""), LexicalException);
+    EXPECT_THROW(Json::Parse("{{}"), LexicalException);
+    EXPECT_THROW(Json::Parse("[[]"), LexicalException);
+    EXPECT_THROW(Json::Parse("[[]]]"), LexicalException);
+    EXPECT_THROW(Json::Parse("{\"\":"), LexicalException);
+    EXPECT_THROW(Json::Parse("{\"a\":1"), LexicalException);
+    EXPECT_THROW(Json::Parse("{}}"), LexicalException);
+    EXPECT_THROW(Json::Parse("tru"), LexicalException);
+    EXPECT_THROW(Json::Parse("\"abcdefghijklmnopqrstuvwxyz"), LexicalException);
+
+    // 数组与字典
+    EXPECT_TRUE(Json::Parse("[[],[[]]]").Is<JsonValue::ArrayType>());
+    EXPECT_TRUE(Json::Parse("{\"\":0}").Is<JsonValue::ObjectType>());
+    EXPECT_THROW(Json::Parse("[,1]"), LexicalException);
+    EXPECT_THROW(Json::Parse("[1 2]"), LexicalException);
+    EXPECT_THROW(Json::Parse("{\"a\" 1}"), LexicalException);
+    EXPECT_THROW(Json::Parse("{1:1}"), LexicalException);
+    EXPECT_THROW(Json::Parse("{\"a\":\"b\",\"a\":\"b\"}"), ObjectExistsException);
+
+    // 字符串
+    EXPECT_EQ(Json::Parse("\"\\\"\\\\\\/\\b\\f\\n\\r\\t\""), "\"\\/\b\f\n\r\t");
+    EXPECT_EQ(Json::Parse("\"\\u0041\\u00e9\\u4E2D\""), "A\xC3\xA9\xE4\xB8\xAD");
+    EXPECT_EQ(Json::Parse("\"\\uD83D\\uDE00\""), "\xF0\x9F\x98\x80");
+    EXPECT_EQ(Json::Parse("\"\xE4\xB8\xAD\x7F\"").Get<string>().size(), 4u);
+    EXPECT_THROW(Json::Parse("\"\\uD83D\""), LexicalException);
+    EXPECT_THROW(Json::Parse("\"\\uD83D\\u0041\""), LexicalException);
+    EXPECT_THROW(Json::Parse("\"\\uDE00\""), LexicalException);
+    EXPECT_THROW(Json::Parse("\"\\uqqqq\""), LexicalException);
+    EXPECT_THROW(Json::Parse("\"\\u00A\""), LexicalException);
+    EXPECT_THROW(Json::Parse("\"\\"), LexicalException);
+    EXPECT_THROW(Json::Parse("\"\\x\""), LexicalException);
+
+    // 跨越16字节边界的长字符串及空白
+    string longString(100, 'x');
+    longString[40] = '\x01';
+    EXPECT_THROW(Json::Parse("\"" + longString + "\""), LexicalException);
+    longString[40] = 'y';
+    EXPECT_EQ(Json::Parse(string(37, ' ') + "\"" + longString + "\"" + string(21, '\n')), longString);
+
+    // 出错位置与Json5一致
+    const char* kBad = "{\n  \"a\": [1,\r\n   2,,\n]}";
+    for (int which = 0; which < 2; ++which)
+    {
+        try
+        {
+            if (which == 0)
+                Json5::Parse(kBad, "test.json");
+            else
+                Json::Parse(kBad, "test.json");
+            FAIL();
+        }
+        catch (const LexicalException& ex)
+        {
+            EXPECT_NE(string::npos, string(ex.GetDescription()).find("test.json:19:3:6:"));
+            EXPECT_EQ(19u, ex.GetInfo<size_t>("Position"));
+            EXPECT_EQ(3u, ex.GetInfo<uint32_t>("Line"));
+            EXPECT_EQ(6u, ex.GetInfo<uint32_t>("Column"));
+        }
+    }
+
+    // 与Json5结果一致
+    const char* kDocuments[] = {
+        "{\"a\": [1, 2.5, -3e2, true, false, null], \"b\": {\"c\": \"\\u00e9\\n\"}, \"d\": []}",
+        "[{\"x\": 0.1}, {\"y\": 1E400}, {\"z\": 123456789012345678}]",
+        " \"\\/path\\/to\" ",
+    };
+    for (auto doc : kDocuments)
+        EXPECT_EQ(Json5::Parse(doc), Json::Parse(doc));
+}
+
+namespace
+{
+    template <typename TParse>
+    string ParseResult(TParse parse)
+    {
+        try
+        {
+            return Json::Stringify(parse());
+        }
+        catch (const LexicalException& ex)
+        {
+            return "LexicalException at " + to_string(ex.GetInfo<size_t>("Position"));
+        }
+        catch (const ObjectExistsException&)
+        {
+            return "ObjectExistsException";
+        }
+    }
+
+    template <typename TParse>
+    string ParseError(TParse parse)
+    {
+        try
+        {
+            parse();
+        }
+        catch (const LexicalException& ex)
+        {
+            return ex.GetDescription() + " at " + to_string(ex.GetInfo<size_t>("Position"));
+        }
+        return "no error";
+    }
+
+    void GenerateString(mt19937& rand, string& out)
+    {
+        out.push_back('"');
+        auto length = rand() % 100;
+        for (size_t i = 0; i < length; ++i)
+        {
+            switch (rand() % 10)
+            {
+                case 0:
+                    out.append(rand() % 2 == 0 ? "\\\\" : "\\\\\\\\");
+                    break;
+                case 1:
+                    out.append("\\\"");
+                    break;
+                case 2:
+                    out.append("\\u00e9");
+                    break;
+                case 3:
+                    out.append("\\n");
+                    break;
+                case 4:
+                    out.push_back("{}[]:, "[rand() % 7]);
+                    break;
+                default:
+                    out.push_back(static_cast<char>('a' + rand() % 26));
+                    break;
+            }
+        }
+        out.push_back('"');
+    }
+
+    void GenerateWhitespace(mt19937& rand, string& out)
+    {
+        if (rand() % 3 == 0)
+            out.append(rand() % 70, " \t\r\n"[rand() % 4]);
+    }
+
+    void GenerateValue(mt19937& rand, string& out, int depth)
+    {
+        GenerateWhitespace(rand, out);
+        switch (rand() % (depth > 3 ? 4 : 6))
+        {
+            case 0:
+                out.append(rand() % 3 == 0 ? "true" : (rand() % 2 == 0 ? "false" : "null"));
+                break;
+            case 1:
+                out.append(to_string(static_cast<int>(rand() % 2000000) - 1000000));
+                if (rand() % 2 == 0)
+                    out.append(".25e-3");
+                break;
+            case 2:
+            case 3:
+                GenerateString(rand, out);
+                break;
+            case 4:
+                out.push_back('[');
+                for (auto i = rand() % 6; i > 0; --i)
+                {
+                    GenerateValue(rand, out, depth + 1);
+                    if (i > 1)
+                        out.push_back(',');
+                }
+                GenerateWhitespace(rand, out);
+                out.push_back(']');
+                break;
+            default:
+                out.push_back('{');
+                for (auto i = rand() % 6; i > 0; --i)
+                {
+                    GenerateWhitespace(rand, out);
+                    out.append("\"k" + to_string(i) + "\"");
+                    GenerateWhitespace(rand, out);
+                    out.push_back(':');
+                    GenerateValue(rand, out, depth + 1);
+                    if (i > 1)
+                        out.push_back(',');
+                }
+                GenerateWhitespace(rand, out);
+                out.push_back('}');
+                break;
+        }
+        GenerateWhitespace(rand, out);
+    }
+}
+
+TEST(Json, ParseIndexed)
+{
+    using InstructionSet = JsonIndexedParser::InstructionSet;
+
+    // 结构索引
+    JsonIndexedParser scalar(InstructionSet::Scalar);
+    EXPECT_EQ(InstructionSet::Scalar, scalar.GetInstructionSet());
+    scalar.Parse(R"({"a\"b": [1, -2.5e3,true], "c":null})");
+    const uint32_t kExpected[] = { 0, 1, 7, 9, 10, 11, 13, 19, 20, 24, 25, 27, 30, 31, 35 };
+    auto index = scalar.GetStructuralIndex();
+    EXPECT_EQ(vector<uint32_t>(kExpected, kExpected + sizeof(kExpected) / sizeof(kExpected[0])),
+        vector<uint32_t>(index.GetBuffer(), index.GetBuffer() + index.GetSize()));
+
+    // 与Json、Json5的结果一致
+    const char* kCases[] = {
+        "123", "\"asd\"", "{\"id\":0,}", "[0,]", "[\"a/*b*/c/*d//e\"]", "{\"a\":\"b\"}/**/", "{{}", "[[]", "[[]]]",
+        "{\"\":", "{}}", "/*", "NaN", "-Infinity", "0x42", "0E+", ".2e-3", "123.456e-7", "0E0", "0e+1", "1eE2",
+        "[[],[[]]]", "[,1]", "[\"\": 1]", "[1,0A10A,1\n", "{\"\":0}", "{key: 'value'}", "{\"a\":\"b\",\"a\":\"b\"}",
+        "{:\"b\"}", "{1:1}", "\"\\\"\\\\/\\b\\f\\n\\r\\t\"", "\"\x7F\"", "\"\\u0000\"", "\"\\", "\"a\010a\"",
+        "\"\\uqqqq\"", "\"\\u00A\"", "", "   ", "tru", "truex", "nul", "-", "-a", "1.", "01", "1 2", "[1 2]",
+        "{\"a\" 1}", "{\"a\":1", "\"\\uD83D\\uDE00\"", "\"\\uD83D\"", "[1]x", "\"a\"b", "\"\\\\\"", "\"\\\\\\\"\"",
+        " {\"a\": [1, 2.5, -3e2, true, false, null], \"b\": {\"c\": \"\\u00e9\\n\"}, \"d\": []} ",
+    };
+    for (auto isa : { InstructionSet::Scalar, InstructionSet::Sse2, InstructionSet::Avx2 })
+    {
+        JsonIndexedParser parser(isa);
+        for (auto input : kCases)
+        {
+            auto expected = ParseResult([&]() { return Json::Parse(input); });
+            EXPECT_EQ(expected, ParseResult([&]() { return parser.Parse(input); })) << input;
+
+            // Json5能接受的严格JSON，结果相同（Json5不合并代理对）
+            auto json5 = ParseResult([&]() { return Json5::Parse(input); });
+            if (expected.find("Exception") == string::npos && json5.find("Exception") == string::npos &&
+                strstr(input, "\\uD8") == nullptr)
+            {
+                EXPECT_EQ(json5, expected) << input;
+            }
+        }
+    }
+
+    // 随机文档及其变异，覆盖跨越64字节块边界的转义与字符串
+    mt19937 rand(1234);
+    JsonIndexedParser parsers[] = {
+        JsonIndexedParser(InstructionSet::Scalar), JsonIndexedParser(InstructionSet::Sse2), JsonIndexedParser(),
+    };
+    for (int i = 0; i < 300; ++i)
+    {
+        string doc;
+        GenerateValue(rand, doc, 0);
+        for (int j = 0; j < 10; ++j)
+        {
+            string input = doc;
+            if (j > 0 && !input.empty())
+            {
+                const char kMutations[] = "\"\\{}[]:, a0-\n\x01";
+                input[rand() % input.size()] = kMutations[rand() % (sizeof(kMutations) - 1)];
+                if (j % 3 == 0)
+                    input.resize(rand() % input.size());
+            }
+
+            auto expected = ParseResult([&]() { return Json::Parse(input); });
+            if (j == 0)
+            {
+                ASSERT_EQ(string::npos, expected.find("Exception")) << input;
+            }
+            for (auto& parser : parsers)
+                ASSERT_EQ(expected, ParseResult([&]() { return parser.Parse(input); })) << input;
+        }
+    }
+}
+
+TEST(Json, ParseIndexedError)
+{
+    using InstructionSet = JsonIndexedParser::InstructionSet;
+
+    // 值后面粘连非法字符时，与Json报告相同的错误
+    const char* kCases[] = {
+        "123abc", "nullx", "truex", "falsey", "true x", "\"s\"x", "[1]x", "-1.5e3z", "[1x]", "[null,nullx]",
+        "{\"a\":truex}", "{\"a\":0b,\"c\":1}",
+    };
+    for (auto isa : { InstructionSet::Scalar, InstructionSet::Sse2, InstructionSet::Avx2 })
+    {
+        JsonIndexedParser parser(isa);
+        for (auto input : kCases)
+        {
+            auto expected = ParseError([&]() { return Json::Parse(input); });
+            EXPECT_NE("no error", expected) << input;
+            EXPECT_EQ(expected, ParseError([&]() { return parser.Parse(input); })) << input;
+        }
+    }
+    auto message = ParseError([]() { return JsonIndexedParser().Parse("123abc"); });
+    EXPECT_NE(string::npos, message.find("Bad tailing character 'a' at 3")) << message;
+}
+
+namespace
+{
+    class CountingHandler :
+        public JsonSaxHandler
+    {
+    public:
+        size_t Count = 0;
+
+    protected:
+        void OnJsonNull()override { ++Count; }
+        void OnJsonBool(JsonValue::BoolType)override { ++Count; }
+        void OnJsonNumber(JsonValue::NumberType)override { ++Count; }
+        void OnJsonString(const JsonValue::StringType&)override { ++Count; }
+        void OnJsonArrayBegin()override { ++Count; }
+        void OnJsonArrayEnd()override { ++Count; }
+        void OnJsonObjectBegin()override { ++Count; }
+        void OnJsonObjectKey(const std::string&)override { ++Count; }
+        void OnJsonObjectEnd()override { ++Count; }
+    };
+
+    class CountingViewHandler :
+        public JsonSaxViewHandler
+    {
+    public:
+        size_t Count = 0;
+
+    protected:
+        void OnJsonNull()override { ++Count; }
+        void OnJsonBool(JsonValue::BoolType)override { ++Count; }
+        void OnJsonNumber(JsonValue::NumberType)override { ++Count; }
+        void OnJsonString(ArrayView<char>)override { ++Count; }
+        void OnJsonArrayBegin()override { ++Count; }
+        void OnJsonArrayEnd()override { ++Count; }
+        void OnJsonObjectBegin()override { ++Count; }
+        void OnJsonObjectKey(ArrayView<char>)override { ++Count; }
+        void OnJsonObjectEnd()override { ++Count; }
+    };
+
+    class RecordingViewHandler :
+        public JsonSaxViewHandler
+    {
+    public:
+        RecordingViewHandler(const char* input)
+            : m_pBegin(input), m_pEnd(input + strlen(input)) {}
+
+    public:
+        vector<string> Events;
+        size_t Borrowed = 0;  // 直接指向输入数据的字符串个数
+
+    protected:
+        void OnJsonNull()override { Events.push_back("null"); }
+        void OnJsonBool(JsonValue::BoolType val)override { Events.push_back(val ? "true" : "false"); }
+        void OnJsonNumber(JsonValue::NumberType val)override { Events.push_back(to_string(val)); }
+        void OnJsonString(ArrayView<char> val)override { Record("s:", val); }
+        void OnJsonArrayBegin()override { Events.push_back("["); }
+        void OnJsonArrayEnd()override { Events.push_back("]"); }
+        void OnJsonObjectBegin()override { Events.push_back("{"); }
+        void OnJsonObjectKey(ArrayView<char> key)override { Record("k:", key); }
+        void OnJsonObjectEnd()override { Events.push_back("}"); }
+
+    private:
+        void Record(const char* prefix, ArrayView<char> val)
+        {
+            if (m_pBegin <= val.GetBuffer() && val.GetBuffer() + val.GetSize() <= m_pEnd)
+                ++Borrowed;
+            Events.push_back(prefix + string(val.GetBuffer(), val.GetSize()));
+        }
+
+    private:
+        const char* m_pBegin;
+        const char* m_pEnd;
+    };
+}
+
+TEST(Json, ParseView)
+{
+    const char* kInput = R"({"name": "plain", "escaped\n": "a\"b\u00e9", "list": ["x", "", 1, true, null]})";
+    const vector<string> kExpected = {
+        "{", "k:name", "s:plain", "k:escaped\n", "s:a\"b\xC3\xA9", "k:list", "[", "s:x", "s:", to_string(1.),
+        "true", "null", "]", "}",
+    };
+
+    JsonIndexedParser indexed;
+    for (int which = 0; which < 3; ++which)
+    {
+        RecordingViewHandler handler(kInput);
+        switch (which)
+        {
+            case 0:
+                Json5::Parse(&handler, kInput);
+                break;
+            case 1:
+                Json::Parse(&handler, kInput);
+                break;
+            default:
+                indexed.Parse(&handler, kInput);
+                break;
+        }
+        EXPECT_EQ(kExpected, handler.Events);
+
+        // 只有含转义的字符串需要解码，Json5总是解码
+        EXPECT_EQ(which == 0 ? 0u : 5u, handler.Borrowed);
+    }
+
+    // 含转义的字符串在缓冲区中解码，不影响其后的字符串
+    RecordingViewHandler handler("[\"\\t\", \"abc\", \"\\u0041\"]");
+    Json::Parse(&handler, "[\"\\t\", \"abc\", \"\\u0041\"]");
+    EXPECT_EQ(vector<string>({ "[", "s:\t", "s:abc", "s:A", "]" }), handler.Events);
+}
+
+namespace
+{
+    class NumberHandler :
+        public JsonSaxHandler
+    {
+    public:
+        vector<JsonValue::NumberType> Numbers;
+        vector<JsonValue::IntegerType> Integers;
+
+    protected:
+        void OnJsonNull()override {}
+        void OnJsonBool(JsonValue::BoolType)override {}
+        void OnJsonNumber(JsonValue::NumberType val)override { Numbers.push_back(val); }
+        void OnJsonInteger(JsonValue::IntegerType val)override { Integers.push_back(val); }
+        void OnJsonString(const JsonValue::StringType&)override {}
+        void OnJsonArrayBegin()override {}
+        void OnJsonArrayEnd()override {}
+        void OnJsonObjectBegin()override {}
+        void OnJsonObjectKey(const std::string&)override {}
+        void OnJsonObjectEnd()override {}
+    };
+
+    uint64_t ToBits(double d)
+    {
+        uint64_t ret;
+        memcpy(&ret, &d, sizeof(d));
+        return ret;
+    }
+
+    // 各解析器得到的double应与Convert::ParseDouble逐位相同，整数则应为其舍入后的值
+    void CheckDouble(const string& text)
+    {
+        size_t processed = 0;
+        auto expected = Convert::ParseDouble(text.c_str(), text.length(), processed);
+        ASSERT_EQ(text.length(), processed) << text;
+
+        JsonIndexedParser indexed;
+        JsonValue values[3] = { Json5::Parse(text), Json::Parse(text), indexed.Parse(text) };
+        for (const auto& value : values)
+            ASSERT_EQ(ToBits(expected), ToBits(value.Get<JsonValue::NumberType>())) << text;
+    }
+
+    void CheckInteger(const string& text, JsonValue::IntegerType expected)
+    {
+        JsonIndexedParser indexed;
+        JsonValue values[3] = { Json5::Parse(text), Json::Parse(text), indexed.Parse(text) };
+        for (const auto& value : values)
+        {
+            ASSERT_TRUE(value.IsInteger()) << text;
+            EXPECT_EQ(expected, value.GetInteger()) << text;
+            EXPECT_EQ(text, Json::Stringify(value));
+        }
+    }
+}
+
+TEST(Json, ParseNumber)
+{
+    // 64位整数不经过double
+    CheckInteger("0", 0);
+    CheckInteger("-1", -1);
+    CheckInteger("9007199254740993", 9007199254740993ll);
+    CheckInteger("-9007199254740993", -9007199254740993ll);
+    CheckInteger("9223372036854775807", numeric_limits<int64_t>::max());
+    CheckInteger("-9223372036854775808", numeric_limits<int64_t>::min());
+    CheckInteger("1234567890123456789", 1234567890123456789ll);
+
+    // 超出范围、带有小数或指数的数字为double
+    const char* kDoubles[] = {
+        "-0", "1.0", "1e2", "1E+2", "100e-2", "9223372036854775808", "-9223372036854775809",
+        "18446744073709551616", "123456789012345678901234567890", "0.1", "0.30000000000000004",
+        "3.141592653589793238462643383279", "1.7976931348623157e308", "1.7976931348623159e308", "4.9e-324",
+        "2.4e-324", "2.5e-324", "2.2250738585072011e-308", "2.2250738585072014e-308", "9007199254740993.0",
+        "0.000000000000000000000000000000000000000000001", "1e400", "-1e400", "1e-400", "0e1000000",
+        "1e1000000", "123e-1000000", "0.000001e6", "1.00000000000000000000000000000000000000000001",
+        "9007199254740993.00000000000000000000001", "9007199254740995e-16", "7.2057594037927933e16",
+    };
+    for (auto text : kDoubles)
+    {
+        CheckDouble(text);
+        EXPECT_FALSE(Json::Parse(text).IsInteger()) << text;
+    }
+    CheckDouble(string(400, '9'));
+    CheckDouble("1" + string(308, '0'));
+    CheckDouble("0." + string(330, '0') + "1");
+    CheckDouble("1." + string(30, '0') + "1e-300");
+    EXPECT_TRUE(signbit(Json::Parse("-0").Get<JsonValue::NumberType>()));
+    EXPECT_TRUE(signbit(Json5::Parse("-0").Get<JsonValue::NumberType>()));
+
+    // 随机的浮点数与数字串
+    mt19937_64 rand(7);
+    char buffer[64];
+    for (int i = 0; i < 20000; ++i)
+    {
+        double d;
+        do
+        {
+            auto bits = rand();
+            memcpy(&d, &bits, sizeof(d));
+        } while (!isfinite(d));
+        snprintf(buffer, sizeof(buffer), "%.17g", d);
+        CheckDouble(buffer);
+        snprintf(buffer, sizeof(buffer), "%.*e", static_cast<int>(rand() % 20), d);
+        CheckDouble(buffer);
+
+        string digits = to_string(rand() % 1000000) + "." + to_string(rand());
+        digits += "e" + to_string(static_cast<int>(rand() % 700) - 350);
+        CheckDouble(digits);
+    }
+
+    // Json5的扩展写法
+    EXPECT_EQ(-16, Json5::Parse("-0x10").GetInteger());
+    EXPECT_EQ(255, Json5::Parse("0XFF").GetInteger());
+    EXPECT_EQ(5, Json5::Parse("+5").GetInteger());
+    EXPECT_FALSE(Json5::Parse("5.").IsInteger());
+    EXPECT_EQ(0.5, Json5::Parse(".5").Get<JsonValue::NumberType>());
+    EXPECT_THROW(Json5::Parse("0x"), LexicalException);
+
+    // SAX事件：未覆盖OnJsonInteger的句柄通过OnJsonNumber收到整数
+    NumberHandler handler;
+    Json::Parse(&handler, "[1, -2, 3.5, 9007199254740993, 1e3]");
+    EXPECT_EQ((vector<JsonValue::IntegerType> { 1, -2, 9007199254740993ll }), handler.Integers);
+    EXPECT_EQ((vector<JsonValue::NumberType> { 3.5, 1000 }), handler.Numbers);
+
+    CountingHandler counting;
+    Json5::Parse(&counting, "[1, 2.5, 0x10]");
+    EXPECT_EQ(5u, counting.Count);
+
+    // JsonValue
+    JsonValue value(static_cast<JsonValue::IntegerType>(9007199254740993ll));
+    EXPECT_TRUE(value.IsInteger());
+    EXPECT_EQ(JsonValue(static_cast<JsonValue::IntegerType>(9007199254740993ll)), value);
+    EXPECT_NE(JsonValue(static_cast<JsonValue::IntegerType>(9007199254740992ll)), value);
+    EXPECT_EQ(JsonValue(9007199254740992.), value);  // 一方不是整数时按double比较
+    EXPECT_TRUE(JsonValue(1).IsInteger());
+    EXPECT_FALSE(JsonValue(1.).IsInteger());
+    EXPECT_THROW(JsonValue(1.).GetInteger(), InvalidCallException);
+    EXPECT_THROW(JsonValue("1").GetInteger(), InvalidCallException);
+    value.Get<JsonValue::NumberType>() = 0.5;
+    EXPECT_FALSE(value.IsInteger());
+    EXPECT_EQ("0.5", Json::Stringify(value));
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Json, DISABLED_Benchmark)
+{
+    // 生成一个带缩进的文档
+    mt19937 rand(42);
+    JsonValue root = JsonValue::ArrayType();
+    for (int i = 0; i < 20000; ++i)
+    {
+        JsonValue item = JsonValue::ObjectType();
+        item.Append("id", JsonValue(static_cast<double>(i)));
+        item.Append("name", JsonValue("item name with some text " + to_string(rand())));
+        item.Append("price", JsonValue(static_cast<double>(rand() % 100000) / 100.));
+        item.Append("enabled", JsonValue(i % 2 == 0));
+        item.Append("tags", JsonValue { "alpha", "beta", "gamma" });
+        root.Append(std::move(item));
+    }
+
+    string texts[2];
+    root.Stringify(texts[0]);
+    root.StringifyInline(texts[1]);
+    const char* kNames[] = { "indented", "compact" };
+
+    const int kRounds = 5;
+    JsonIndexedParser indexed;
+    for (int t = 0; t < 2; ++t)
+    {
+        const string& text = texts[t];
+        EXPECT_EQ(root, Json::Parse(text));
+        EXPECT_EQ(root, indexed.Parse(text));
+
+        double speed[5] = {};
+        size_t events[5] = {};
+        for (int which = 0; which < 5; ++which)
+        {
+            CountingHandler handler;
+            CountingViewHandler viewHandler;
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < kRounds; ++i)
+            {
+                switch (which)
+                {
+                    case 0:
+                        Json5::Parse(&handler, text);
+                        break;
+                    case 1:
+                        Json::Parse(&handler, text);
+                        break;
+                    case 2:
+                        indexed.Parse(&handler, text);
+                        break;
+                    case 3:
+                        Json::Parse(&viewHandler, text);
+                        break;
+                    default:
+                        indexed.Parse(&viewHandler, text);
+                        break;
+                }
+            }
+            auto seconds = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+            speed[which] = text.size() * kRounds / 1048576.0 / seconds.count();
+            events[which] = handler.Count + viewHandler.Count;
+        }
+        for (int which = 1; which < 5; ++which)
+            EXPECT_EQ(events[0], events[which]);
+
+        printf("[ BENCH    ] %.1f MB %s document, SAX: Json5 %.1f MB/s, Json %.1f MB/s, JsonIndexedParser "
+            "%.1f MB/s\n", text.size() / 1048576.0, kNames[t], speed[0], speed[1], speed[2]);
+        printf("[ BENCH    ] %.1f MB %s document, SAX view: Json %.1f MB/s, JsonIndexedParser %.1f MB/s\n",
+            text.size() / 1048576.0, kNames[t], speed[3], speed[4]);
+    }
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Json, DISABLED_NumberBenchmark)
+{
+    // 生成以数字为主的文档：整数ID、两位小数的价格和任意的浮点数
+    mt19937_64 rand(42);
+    string text = "[";
+    char buffer[64];
+    for (int i = 0; i < 100000; ++i)
+    {
+        snprintf(buffer, sizeof(buffer), "%lld,%lld.%02d,%.17g,", static_cast<long long>(rand() >> 2),
+            static_cast<long long>(rand() % 100000), static_cast<int>(rand() % 100),
+            static_cast<double>(rand() % 1000000) / 7.);
+        text.append(buffer);
+    }
+    text.back() = ']';
+
+    const int kRounds = 5;
+    JsonIndexedParser indexed;
+    double speed[3] = {};
+    for (int which = 0; which < 3; ++which)
+    {
+        CountingHandler handler;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < kRounds; ++i)
+        {
+            switch (which)
+            {
+                case 0:
+                    Json5::Parse(&handler, text);
+                    break;
+                case 1:
+                    Json::Parse(&handler, text);
+                    break;
+                default:
+                    indexed.Parse(&handler, text);
+                    break;
+            }
+        }
+        auto seconds = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+        speed[which] = text.size() * kRounds / 1048576.0 / seconds.count();
+        EXPECT_EQ((300000u + 2u) * kRounds, handler.Count);
+    }
+
+    printf("[ BENCH    ] %.1f MB number document, SAX: Json5 %.1f MB/s, Json %.1f MB/s, JsonIndexedParser %.1f MB/s\n",
+        text.size() / 1048576.0, speed[0], speed[1], speed[2]);
+}
+
+TEST(Json, Document)
+{
+    string text = R"({"name":"moe","description":"a string longer than the inline capacity",)"
+        R"("escaped":"line one\nline two, long enough to be copied","short\"key":"xA",)"
+        R"("a very long key that is not inlined":[1,-2,3.5,true,false,null,[],{}],)"
+        R"("nested":{"list":[{"id":1},{"id":2},{"id":3}],"empty":""},"big":9007199254740993})";
+    auto inInput = [&](ArrayView<char> view) {
+        return view.GetBuffer() >= text.data() && view.GetBuffer() < text.data() + text.size();
+    };
+    auto toString = [](ArrayView<char> view) {
+        return string(view.GetBuffer(), view.GetSize());
+    };
+
+    JsonDocument doc;
+    EXPECT_TRUE(doc.IsEmpty());
+    EXPECT_TRUE(doc.GetRoot().IsNull());
+
+    Json::Parse(doc, ToArrayView<char>(text));
+    auto root = doc.GetRoot();
+    EXPECT_EQ(JsonValueTypes::Object, root.GetType());
+    EXPECT_EQ(7u, root.GetElementCount());
+    EXPECT_EQ(Json::Parse(text), root.ToJsonValue());
+
+    // 短字符串内联，没有转义的长字符串和键指向输入，含转义的长字符串被拷贝
+    EXPECT_EQ("moe", toString(root.GetElementByKey("name").GetString()));
+    EXPECT_FALSE(inInput(root.GetElementByKey("name").GetString()));
+    auto description = root.GetElementByKey("description").GetString();
+    EXPECT_EQ("a string longer than the inline capacity", toString(description));
+    EXPECT_TRUE(inInput(description));
+    auto escaped = root.GetElementByKey(string("escaped")).GetString();
+    EXPECT_EQ("line one\nline two, long enough to be copied", toString(escaped));
+    EXPECT_FALSE(inInput(escaped));
+    EXPECT_EQ("xA", toString(root.GetElementByKey("short\"key").GetString()));
+    EXPECT_EQ("", toString(root.GetElementByKey("nested").GetElementByKey("empty").GetString()));
+    EXPECT_EQ(9007199254740993ll, root.GetElementByKey("big").GetInteger());
+
+    vector<string> keys;
+    for (auto it = root.begin(); it != root.end(); ++it)
+    {
+        keys.push_back(toString(it.GetKey()));
+        if (it.GetKey().GetSize() > JsonDocument::kMaxInlineStringSize)
+        {
+            EXPECT_TRUE(inInput(it.GetKey()));
+        }
+    }
+    vector<string> expectedKeys = { "name", "description", "escaped", "short\"key",
+        "a very long key that is not inlined", "nested", "big" };
+    EXPECT_EQ(expectedKeys, keys);
+
+    // 数组
+    auto array = root.GetElementByKey("a very long key that is not inlined");
+    ASSERT_EQ(8u, array.GetElementCount());
+    EXPECT_TRUE(array.GetElementByIndex(0).IsInteger());
+    EXPECT_EQ(-2, array.GetElementByIndex(1).GetInteger());
+    EXPECT_EQ(-2., array.GetElementByIndex(1).GetNumber());
+    EXPECT_FALSE(array.GetElementByIndex(2).IsInteger());
+    EXPECT_EQ(3.5, array.GetElementByIndex(2).GetNumber());
+    EXPECT_THROW(array.GetElementByIndex(2).GetInteger(), InvalidCallException);
+    EXPECT_TRUE(array.GetElementByIndex(3).GetBool());
+    EXPECT_FALSE(array.GetElementByIndex(4).GetBool());
+    EXPECT_TRUE(array.GetElementByIndex(5).IsNull());
+    EXPECT_EQ(0u, array.GetElementByIndex(6).GetElementCount());
+    EXPECT_TRUE(array.GetElementByIndex(6).begin() == array.GetElementByIndex(6).end());
+    EXPECT_EQ(JsonValueTypes::Object, array.GetElementByIndex(7).GetType());
+    EXPECT_THROW(array.GetElementByIndex(8), OutOfRangeException);
+
+    size_t count = 0;
+    for (auto element : array)
+    {
+        EXPECT_EQ(array.GetElementByIndex(count).GetType(), element.GetType());
+        ++count;
+    }
+    EXPECT_EQ(8u, count);
+
+    int64_t sum = 0;
+    for (auto item : root.GetElementByKey("nested").GetElementByKey("list"))
+        sum += item.GetElementByKey("id").GetInteger();
+    EXPECT_EQ(6, sum);
+
+    // 错误的访问
+    EXPECT_TRUE(root.HasElement("nested"));
+    EXPECT_FALSE(root.HasElement("list"));
+    EXPECT_THROW(root.GetElementByKey("list"), ObjectNotFoundException);
+    EXPECT_THROW(root.GetElementByIndex(0), InvalidCallException);
+    EXPECT_THROW(root.GetBool(), InvalidCallException);
+    EXPECT_THROW(root.GetString(), InvalidCallException);
+    EXPECT_THROW(array.HasElement("a"), InvalidCallException);
+    EXPECT_THROW(array.GetElementByIndex(0).begin(), InvalidCallException);
+    EXPECT_THROW(array.GetElementByIndex(0).GetElementCount(), InvalidCallException);
+
+    // 移动后游标仍然有效
+    JsonDocument moved(std::move(doc));
+    EXPECT_EQ("moe", toString(root.GetElementByKey("name").GetString()));
+    EXPECT_EQ(root.ToJsonValue(), moved.GetRoot().ToJsonValue());
+
+    // 解析失败时文档被清空
+    EXPECT_THROW(Json::Parse(moved, ToArrayView<char>("[1,2,{\"a\":")), LexicalException);
+    EXPECT_TRUE(moved.IsEmpty());
+    EXPECT_TRUE(moved.GetRoot().IsNull());
+
+    // 根为标量，重复的键
+    Json::Parse(moved, ToArrayView<char>("42"));
+    EXPECT_EQ(1u, moved.GetNodeCount());
+    EXPECT_EQ(42, moved.GetRoot().GetInteger());
+    Json::Parse(moved, ToArrayView<char>("{\"a\":1,\"a\":2}"));
+    EXPECT_EQ(2u, moved.GetRoot().GetElementCount());
+    EXPECT_EQ(1, moved.GetRoot().GetElementByKey("a").GetInteger());
+    EXPECT_THROW(moved.GetRoot().ToJsonValue(), ObjectExistsException);
+
+    // 三种解析器产生相同的文档
+    const char* kTexts[] = {
+        "[]",
+        "{}",
+        "\"a string with \\u4e2d\\u6587 and \\t escapes\"",
+        "[[[[1]],[2,[3,{\"k\":[4]}]]],{\"x\":{\"y\":{\"z\":null}}}]",
+        "{\"numbers\":[0,-0,1e10,-1.5e-300,123456789012345678901234567890],\"strings\":[\"\",\"\\\\\",\"\\/\"]}",
+    };
+    JsonIndexedParser indexed;
+    for (auto str : kTexts)
+    {
+        auto expected = Json::Parse(str);
+        Json::Parse(moved, ToArrayView<char>(str));
+        EXPECT_EQ(expected, moved.GetRoot().ToJsonValue()) << str;
+        Json5::Parse(moved, ToArrayView<char>(str));
+        EXPECT_EQ(expected, moved.GetRoot().ToJsonValue()) << str;
+        indexed.Parse(moved, ToArrayView<char>(str));
+        EXPECT_EQ(expected, moved.GetRoot().ToJsonValue()) << str;
+    }
+
+    // JSON5
+    const char* json5 = "// config\n"
+        "{unquotedKeyOfSomeLength: 'single quoted string value', hex: 0x10, list: [.5, +1,],}";
+    Json5::Parse(moved, ToArrayView<char>(json5));
+    EXPECT_EQ(Json5::Parse(json5), moved.GetRoot().ToJsonValue());
+    EXPECT_EQ(16, moved.GetRoot().GetElementByKey("hex").GetInteger());
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Json, DISABLED_DocumentBenchmark)
+{
+    mt19937 rand(42);
+    JsonValue root = JsonValue::ArrayType();
+    for (int i = 0; i < 50000; ++i)
+    {
+        JsonValue item = JsonValue::ObjectType();
+        item.Append("id", JsonValue(static_cast<JsonValue::IntegerType>(i)));
+        item.Append("name", JsonValue("item name with some text " + to_string(rand())));
+        item.Append("price", JsonValue(static_cast<double>(rand() % 100000) / 100.));
+        item.Append("enabled", JsonValue(i % 2 == 0));
+        item.Append("tags", JsonValue { "alpha", "beta", "gamma" });
+        root.Append(std::move(item));
+    }
+
+    string text;
+    root.StringifyInline(text);
+
+    JsonDocument doc;
+    JsonIndexedParser indexed;
+    indexed.Parse(doc, ToArrayView<char>(text));
+    EXPECT_EQ(root, doc.GetRoot().ToJsonValue());
+
+    // 解析并析构，之后遍历所有的价格
+    const int kRounds = 5;
+    double speed[3] = {};
+    double sums[3] = {};
+    for (int which = 0; which < 3; ++which)
+    {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < kRounds; ++i)
+        {
+            double sum = 0;
+            switch (which)
+            {
+                case 0:
+                    {
+                        JsonValue value;
+                        indexed.Parse(value, text);
+                        for (size_t j = 0; j < value.GetElementCount(); ++j)
+                            sum += value.GetElementByIndex(j).GetElementByKey("price").Get<JsonValue::NumberType>();
+                    }
+                    break;
+                case 1:
+                    {
+                        JsonDocument fresh;
+                        indexed.Parse(fresh, ToArrayView<char>(text));
+                        for (auto item : fresh.GetRoot())
+                            sum += item.GetElementByKey("price").GetNumber();
+                    }
+                    break;
+                default:
+                    indexed.Parse(doc, ToArrayView<char>(text));
+                    for (auto item : doc.GetRoot())
+                        sum += item.GetElementByKey("price").GetNumber();
+                    break;
+            }
+            sums[which] = sum;
+        }
+        auto seconds = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+        speed[which] = text.size() * kRounds / 1048576.0 / seconds.count();
+    }
+    EXPECT_EQ(sums[0], sums[1]);
+    EXPECT_EQ(sums[0], sums[2]);
+
+    printf("[ BENCH    ] %.1f MB document, parse + walk + destroy: JsonValue %.1f MB/s, JsonDocument %.1f MB/s, "
+        "reused JsonDocument %.1f MB/s\n", text.size() / 1048576.0, speed[0], speed[1], speed[2]);
+    printf("[ BENCH    ] JsonDocument uses %zu nodes\n", doc.GetNodeCount());
+}
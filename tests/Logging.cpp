@@ -0,0 +1,913 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <gtest/gtest.h>
+
+#include <Moe.Core/Pal.hpp>
+#include <Moe.Core/PathUtils.hpp>
+#include <Moe.Core/Logging.hpp>
+
+using namespace std;
+using namespace moe;
+
+namespace
+{
+    struct CollectedLogs
+    {
+        mutex Lock;
+        vector<string> Messages;
+        size_t FlushCount = 0;
+    };
+
+    class CollectSink :
+        public Logging::SinkBase
+    {
+    public:
+        CollectSink(shared_ptr<CollectedLogs> logs)
+            : m_pLogs(logs) {}
+
+    public:
+        shared_ptr<SinkBase> Clone()const override
+        {
+            return make_shared<CollectSink>(*this);
+        }
+
+    protected:
+        void Sink(Logging::Level level, const Logging::Context& context, const char* msg, const char* formatted,
+            size_t length)noexcept override
+        {
+            MOE_UNUSED(level);
+            MOE_UNUSED(context);
+            MOE_UNUSED(msg);
+
+            lock_guard<mutex> guard(m_pLogs->Lock);
+            m_pLogs->Messages.emplace_back(formatted, length);
+        }
+
+        void Flush()noexcept override
+        {
+            lock_guard<mutex> guard(m_pLogs->Lock);
+            ++m_pLogs->FlushCount;
+        }
+
+    private:
+        shared_ptr<CollectedLogs> m_pLogs;
+    };
+
+    enum class TestColor
+    {
+        Red = 3,
+    };
+
+    struct TestCustom
+    {
+        string ToString()const { return "custom"; }
+    };
+
+    void LogAllTypes(Logging& logging)
+    {
+        static const char kArray[] = "array";
+        const char* nullString = nullptr;
+        int value = 0;
+
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0} {0:no|yes} {1} {2} {3} {4}", true, 'c',
+            static_cast<int8_t>(-8), static_cast<uint16_t>(16), -32);
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0} {1:X} {2} {3:F2}", numeric_limits<int64_t>::min(),
+            numeric_limits<uint64_t>::max(), 1.5f, 3.14159);
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0}|{1}|{2}|{3}|{4}|{5,8}", "literal", kArray,
+            nullString, string("std::string"), ArrayView<char>("view", 4), "pad");
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0} {1} {2}", TestColor::Red, nullptr,
+            static_cast<const void*>(&value));
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0}", TestCustom());
+        logging.Log(Logging::Level::Info, Logging::Context(), "no arguments");
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0:bad}", "literal");
+    }
+
+    atomic<uint64_t> s_ullFakeClock { 0 };
+
+    uint64_t FakeClock()
+    {
+        return s_ullFakeClock.load(memory_order_relaxed);
+    }
+}
+
+TEST(Logging, Async)
+{
+    static const int kThreads = 4;
+    static const int kCount = 1000;
+
+    auto logs = make_shared<CollectedLogs>();
+    Logging logging;
+    logging.SetMinLevel(Logging::Level::Debug);
+    logging.AppendSink(make_shared<CollectSink>(logs));
+    logging.Commit();
+    logging.EnableAsync(16);
+    EXPECT_TRUE(logging.IsAsync());
+
+    vector<thread> threads;
+    for (int i = 0; i < kThreads; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < kCount; ++j)
+                logging.Log(Logging::Level::Info, Logging::Context(), "{0}:{1}", i, j);
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    logging.Flush();
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        EXPECT_EQ(static_cast<size_t>(kThreads * kCount), logs->Messages.size());
+        EXPECT_GT(static_cast<size_t>(kThreads * kCount), logs->FlushCount);  // 按批刷新
+    }
+    EXPECT_EQ(0u, logging.GetDroppedCount());
+
+    // Fatal日志返回时已经落地
+    logging.Log(Logging::Level::Fatal, Logging::Context(), "fatal");
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        EXPECT_EQ("fatal", logs->Messages.back());
+    }
+
+    logging.DisableAsync();
+    EXPECT_FALSE(logging.IsAsync());
+}
+
+TEST(Logging, AsyncDrop)
+{
+    auto logs = make_shared<CollectedLogs>();
+    Logging logging;
+    logging.SetMinLevel(Logging::Level::Debug);
+    logging.AppendSink(make_shared<CollectSink>(logs));
+    logging.Commit();
+    logging.EnableAsync(2, Logging::OverflowPolicy::DropLowLevel);
+
+    // 阻塞后台线程，使队列保持满
+    unique_lock<mutex> block(logs->Lock);
+    for (int i = 0; i < 100; ++i)
+        logging.Log(Logging::Level::Debug, Logging::Context(), "debug");
+    EXPECT_LE(100u - 3u, logging.GetDroppedCount(Logging::Level::Debug));
+    EXPECT_EQ(logging.GetDroppedCount(), logging.GetDroppedCount(Logging::Level::Debug));
+    block.unlock();
+
+    logging.Log(Logging::Level::Error, Logging::Context(), "error");
+    logging.DisableAsync();
+    EXPECT_EQ("error", logs->Messages.back());
+    EXPECT_EQ(100u, logs->Messages.size() - 1 + logging.GetDroppedCount());
+
+    logging.ResetDroppedCount();
+    EXPECT_EQ(0u, logging.GetDroppedCount());
+}
+
+TEST(Logging, DeferredFormat)
+{
+    auto expected = make_shared<CollectedLogs>();
+    {
+        Logging logging;
+        logging.SetMinLevel(Logging::Level::Debug);
+        logging.AppendSink(make_shared<CollectSink>(expected));
+        logging.Commit();
+        LogAllTypes(logging);
+    }
+    ASSERT_EQ(7u, expected->Messages.size());
+
+    // 同步模式
+    auto logs = make_shared<CollectedLogs>();
+    {
+        Logging logging;
+        logging.SetMinLevel(Logging::Level::Debug);
+        logging.AppendSink(make_shared<CollectSink>(logs));
+        logging.Commit();
+        logging.SetDeferredFormat(true);
+        EXPECT_TRUE(logging.IsDeferredFormat());
+        LogAllTypes(logging);
+    }
+    EXPECT_EQ(expected->Messages, logs->Messages);
+
+    // 异步模式
+    logs = make_shared<CollectedLogs>();
+    {
+        Logging logging;
+        logging.SetMinLevel(Logging::Level::Debug);
+        logging.AppendSink(make_shared<CollectSink>(logs));
+        logging.Commit();
+        logging.SetDeferredFormat(true);
+        logging.EnableAsync(4);
+        LogAllTypes(logging);
+        logging.Flush();
+    }
+    EXPECT_EQ(expected->Messages, logs->Messages);
+}
+
+TEST(Logging, BinaryFileSink)
+{
+    static const char* kPath = "MoeCoreTest_Logging.bin";
+
+    auto expected = make_shared<CollectedLogs>();
+    {
+        Logging logging;
+        logging.SetMinLevel(Logging::Level::Debug);
+        logging.AppendSink(make_shared<CollectSink>(expected));
+        logging.Commit();
+        LogAllTypes(logging);
+    }
+
+    {
+        Logging logging;
+        logging.SetMinLevel(Logging::Level::Debug);
+        logging.AppendSink(make_shared<Logging::BinaryFileSink>(kPath, true));
+        logging.Commit();
+        logging.SetDeferredFormat(true);
+        logging.EnableAsync();
+        LogAllTypes(logging);
+        logging.Log(Logging::Level::Error, Logging::Context(__FILE__, 42, "Func"), "{0}", 123);
+    }
+
+    {
+        Logging::BinaryLogReader reader(kPath);
+        Logging::Level level = Logging::Level::Debug;
+        Logging::Context context;
+        string msg;
+
+        for (size_t i = 0; i < expected->Messages.size(); ++i)
+        {
+            ASSERT_TRUE(reader.Read(level, context, msg));
+            EXPECT_EQ(Logging::Level::Info, level);
+            EXPECT_EQ(expected->Messages[i], msg);
+        }
+
+        ASSERT_TRUE(reader.Read(level, context, msg));
+        EXPECT_EQ(Logging::Level::Error, level);
+        EXPECT_EQ("123", msg);
+        EXPECT_STREQ(__FILE__, context.File);
+        EXPECT_STREQ("Func", context.Function);
+        EXPECT_EQ(42u, context.Line);
+        EXPECT_EQ(Logging::Context::GetThreadIdCached(), context.ThreadId);
+        EXPECT_FALSE(reader.Read(level, context, msg));
+    }
+
+    {
+        auto logs = make_shared<CollectedLogs>();
+        CollectSink sink(logs);
+        Logging::BinaryLogReader reader(kPath);
+        EXPECT_EQ(expected->Messages.size() + 1, reader.Replay(sink));
+        EXPECT_EQ("123", logs->Messages.back());
+    }
+
+    Pal::RemoveFile(kPath);
+}
+
+TEST(Logging, RingFileSink)
+{
+    static const char* kPath = "MoeCoreTest_Logging.ring";
+    if (Pal::IsFileExists(kPath))
+        Pal::RemoveFile(kPath);
+
+    auto readAll = [](vector<string>& out) {
+        Logging::RingFileReader reader(kPath);
+        Logging::Level level = Logging::Level::Debug;
+        Time::Timestamp time = 0;
+        string msg;
+
+        out.clear();
+        while (reader.Read(level, time, msg))
+            out.push_back(msg);
+    };
+
+    vector<string> messages;
+    {
+        Logging logging;
+        logging.AppendSink(make_shared<Logging::RingFileSink>(kPath, 4096));
+        logging.Commit();
+        for (int i = 0; i < 10; ++i)
+            logging.Log(Logging::Level::Info, Logging::Context(), "message {0}", i);
+    }
+    readAll(messages);
+    ASSERT_EQ(10u, messages.size());
+    EXPECT_EQ("message 0", messages[0]);
+    EXPECT_EQ("message 9", messages[9]);
+
+    // 重新打开后接着写入，写满后覆盖最旧的日志
+    {
+        Logging logging;
+        logging.AppendSink(make_shared<Logging::RingFileSink>(kPath, 4096));
+        logging.Commit();
+        for (int i = 10; i < 1000; ++i)
+            logging.Log(Logging::Level::Info, Logging::Context(), "message {0}", i);
+
+        string large(10000, 'x');
+        logging.Log(Logging::Level::Error, Logging::Context(), "{0}", large);  // 超长截断
+        logging.Log(Logging::Level::Error, Logging::Context(), "last");
+    }
+    readAll(messages);
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_EQ("last", messages[0]);
+
+    {
+        Logging logging;
+        logging.AppendSink(make_shared<Logging::RingFileSink>(kPath, 4096));
+        logging.Commit();
+        for (int i = 0; i < 1000; ++i)
+            logging.Log(Logging::Level::Info, Logging::Context(), "message {0}", i);
+    }
+    readAll(messages);
+    ASSERT_LT(50u, messages.size());
+    ASSERT_GT(1000u, messages.size());
+    for (size_t i = 0; i < messages.size(); ++i)
+        EXPECT_EQ(StringUtils::Format("message {0}", 1000 - messages.size() + i), messages[i]);
+
+    // 损坏的记录被丢弃
+    {
+        UniqueFileHandle file(Pal::OpenFile(kPath, "r+b"));
+        ::fseek(file.get(), 2048, SEEK_SET);
+        char buffer[16];
+        ASSERT_EQ(sizeof(buffer), ::fread(buffer, 1, sizeof(buffer), file.get()));
+        for (auto& c : buffer)
+            c = static_cast<char>(~c);
+        ::fseek(file.get(), 2048, SEEK_SET);
+        ::fwrite(buffer, 1, sizeof(buffer), file.get());
+    }
+    vector<string> corrupted;
+    readAll(corrupted);
+    EXPECT_GT(messages.size(), corrupted.size());
+    EXPECT_LE(messages.size() - 2, corrupted.size());
+    EXPECT_EQ(messages.back(), corrupted.back());
+
+    // 多线程写入（不发生覆盖）
+    {
+        static const int kThreads = 4;
+        static const int kCount = 2000;
+
+        Logging logging;
+        logging.AppendSink(make_shared<Logging::RingFileSink>(kPath, 1024 * 1024));
+        logging.Commit();
+
+        vector<thread> threads;
+        for (int t = 0; t < kThreads; ++t)
+        {
+            threads.emplace_back([&logging, t]() {
+                for (int i = 0; i < kCount; ++i)
+                    logging.Log(Logging::Level::Info, Logging::Context(), "{0} {1}", t, i);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+    }
+    readAll(messages);
+    EXPECT_EQ(8000u, messages.size());
+    int last[4] = { -1, -1, -1, -1 };
+    for (const auto& msg : messages)
+    {
+        auto space = msg.find(' ');
+        ASSERT_NE(string::npos, space);
+        size_t processed = 0;
+        auto t = Convert::ParseInt(msg.c_str(), space, processed);
+        auto i = Convert::ParseInt(msg.c_str() + space + 1, msg.length() - space - 1, processed);
+        ASSERT_TRUE(t >= 0 && t < 4);
+        EXPECT_LT(last[t], i);
+        last[t] = static_cast<int>(i);
+    }
+    for (auto i : last)
+        EXPECT_EQ(1999, i);
+
+    Pal::RemoveFile(kPath);
+}
+
+TEST(Logging, Module)
+{
+    auto logs = make_shared<CollectedLogs>();
+    Logging logging;
+    logging.SetMinLevel(Logging::Level::Info);
+    logging.AppendSink(make_shared<CollectSink>(logs));
+    logging.Commit();
+
+    Logging::Module net("net", logging);
+    Logging::Module db("db", logging);
+    EXPECT_STREQ("net", net.GetName());
+    EXPECT_FALSE(net.IsLevelOverrided());
+    EXPECT_EQ(Logging::Level::Info, net.GetMinLevel());
+    EXPECT_FALSE(net.ShouldLog(Logging::Level::Debug));
+    EXPECT_TRUE(net.ShouldLog(Logging::Level::Info));
+
+    // 单独打开某一模块的Debug日志
+    logging.SetModuleLevel("net", Logging::Level::Debug);
+    EXPECT_TRUE(net.IsLevelOverrided());
+    EXPECT_TRUE(net.ShouldLog(Logging::Level::Debug));
+    EXPECT_FALSE(db.ShouldLog(Logging::Level::Debug));
+    EXPECT_FALSE(logging.ShouldLog(Logging::Level::Debug));
+
+    MOE_MODULE_LOG_DEBUG(net, "net {0}", 1);
+    MOE_MODULE_LOG_DEBUG(db, "db {0}", 1);
+    MOE_MODULE_LOG_INFO(db, "db {0}", 2);
+    ASSERT_EQ(2u, logs->Messages.size());
+    EXPECT_EQ("net 1", logs->Messages[0]);
+    EXPECT_EQ("db 2", logs->Messages[1]);
+
+    // 全局级别变更只影响跟随全局的模块
+    logging.SetMinLevel(Logging::Level::Error);
+    EXPECT_FALSE(db.ShouldLog(Logging::Level::Warn));
+    EXPECT_TRUE(db.ShouldLog(Logging::Level::Error));
+    EXPECT_TRUE(net.ShouldLog(Logging::Level::Debug));
+    logging.SetMaxLevel(Logging::Level::Error);
+    EXPECT_FALSE(logging.ShouldLog(Logging::Level::Fatal));
+    EXPECT_FALSE(db.ShouldLog(Logging::Level::Fatal));
+    EXPECT_TRUE(net.ShouldLog(Logging::Level::Fatal));
+
+    // 之后创建的同名模块同样生效
+    {
+        Logging::Module net2("net", logging);
+        EXPECT_TRUE(net2.ShouldLog(Logging::Level::Debug));
+    }
+
+    logging.ResetModuleLevel("net");
+    EXPECT_FALSE(net.IsLevelOverrided());
+    EXPECT_EQ(Logging::Level::Error, net.GetMinLevel());
+    EXPECT_EQ(Logging::Level::Error, net.GetMaxLevel());
+    EXPECT_FALSE(net.ShouldLog(Logging::Level::Debug));
+}
+
+TEST(Logging, RateLimit)
+{
+    auto logs = make_shared<CollectedLogs>();
+    Logging logging;
+    logging.SetMinLevel(Logging::Level::Debug);
+    logging.AppendSink(make_shared<CollectSink>(logs));
+    logging.Commit();
+
+    // 使用手动推进的时钟，避免结果依赖真实时间
+    s_ullFakeClock.store(1000000, memory_order_relaxed);
+
+    // 突发10条，每秒恢复1条，之后每25条采样1条，不做定时汇总
+    Logging::RateLimitPolicy policy(10, 1, 25, 0);
+    policy.Clock = FakeClock;
+    logging.EnableRateLimit(policy);
+    EXPECT_TRUE(logging.IsRateLimited());
+
+    static const char* kFile = "RateLimit.cpp";
+    for (int i = 0; i < 110; ++i)
+        logging.Log(Logging::Level::Error, Logging::Context(0, kFile, 1, "func", 0), "site1 {0}", i);
+    for (int i = 0; i < 5; ++i)
+        logging.Log(Logging::Level::Error, Logging::Context(0, kFile, 2, "func", 0), "site2 {0}", i);
+    logging.Log(Logging::Level::Fatal, Logging::Context(0, kFile, 1, "func", 0), "fatal");
+    logging.Log(Logging::Level::Error, Logging::Context(), "no file");
+
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        ASSERT_EQ(10u + 4u + 5u + 2u, logs->Messages.size());
+        EXPECT_EQ("site1 9", logs->Messages[9]);
+        EXPECT_EQ("site1 34", logs->Messages[10]);  // 第25条超限的日志
+        EXPECT_EQ("site1 109", logs->Messages[13]);
+        EXPECT_EQ("site2 0", logs->Messages[14]);
+        EXPECT_EQ("fatal", logs->Messages[19]);
+        logs->Messages.clear();
+    }
+    EXPECT_EQ(96u, logging.GetSuppressedCount());
+
+    // 1秒后恢复一个令牌
+    s_ullFakeClock.fetch_add(1000000, memory_order_relaxed);
+    logging.Log(Logging::Level::Error, Logging::Context(0, kFile, 1, "func", 0), "site1 refill");
+    logging.Log(Logging::Level::Error, Logging::Context(0, kFile, 1, "func", 0), "site1 suppressed");
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        ASSERT_EQ(1u, logs->Messages.size());
+        EXPECT_EQ("site1 refill", logs->Messages[0]);
+        logs->Messages.clear();
+    }
+    EXPECT_EQ(97u, logging.GetSuppressedCount());
+
+    // Flush时输出汇总
+    logging.Flush();
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        ASSERT_EQ(1u, logs->Messages.size());
+        EXPECT_EQ("(Suppressed 97 message(s) from this call site in the last 1000 ms)", logs->Messages[0]);
+        logs->Messages.clear();
+    }
+    logging.Flush();
+    EXPECT_TRUE(logs->Messages.empty());
+
+    // 定时汇总：时钟未推进时不会输出
+    policy = Logging::RateLimitPolicy(1, 1, 0, 20);
+    policy.Clock = FakeClock;
+    logging.EnableRateLimit(policy);
+    logging.ResetSuppressedCount();
+    for (int i = 0; i < 10; ++i)
+        logging.Log(Logging::Level::Warn, Logging::Context(0, kFile, 3, "func", 0), "site3 {0}", i);
+    EXPECT_EQ(9u, logging.GetSuppressedCount());
+    s_ullFakeClock.fetch_add(19000, memory_order_relaxed);
+    logging.Log(Logging::Level::Warn, Logging::Context(0, kFile, 3, "func", 0), "site3");
+    EXPECT_EQ(10u, logging.GetSuppressedCount());
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        ASSERT_EQ(1u, logs->Messages.size());
+        EXPECT_EQ("site3 0", logs->Messages[0]);
+        logs->Messages.clear();
+    }
+
+    // 到达汇总间隔后由后台线程输出
+    s_ullFakeClock.fetch_add(1000, memory_order_relaxed);
+    for (int i = 0; i < 1000; ++i)
+    {
+        {
+            lock_guard<mutex> guard(logs->Lock);
+            if (!logs->Messages.empty())
+                break;
+        }
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        ASSERT_EQ(1u, logs->Messages.size());
+        EXPECT_EQ("(Suppressed 10 message(s) from this call site in the last 20 ms)", logs->Messages[0]);
+        logs->Messages.clear();
+    }
+
+    // 关闭时输出剩余的汇总
+    s_ullFakeClock.fetch_add(5000, memory_order_relaxed);
+    logging.Log(Logging::Level::Warn, Logging::Context(0, kFile, 3, "func", 0), "site3");
+    logging.DisableRateLimit();
+    EXPECT_FALSE(logging.IsRateLimited());
+    {
+        lock_guard<mutex> guard(logs->Lock);
+        ASSERT_EQ(1u, logs->Messages.size());
+        EXPECT_EQ("(Suppressed 1 message(s) from this call site in the last 5 ms)", logs->Messages[0]);
+    }
+}
+
+TEST(Logging, CommitWhileLogging)
+{
+    auto logs = make_shared<CollectedLogs>();
+    Logging logging;
+    logging.SetMinLevel(Logging::Level::Debug);
+    logging.AppendSink(make_shared<CollectSink>(logs));
+    logging.Commit();
+
+    atomic<bool> stop(false);
+    thread writer([&]() {
+        while (!stop.load())
+            logging.Log(Logging::Level::Info, Logging::Context(), "msg");
+    });
+
+    // 旧的快照必须在读者离开后才被回收
+    for (int i = 0; i < 100; ++i)
+    {
+        logging.Commit();
+        this_thread::yield();
+    }
+    stop.store(true);
+    writer.join();
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Logging, DISABLED_ContentionBenchmark)
+{
+    static const int kCount = 100000;
+
+    // 落地对象过滤掉所有日志，只测量分发路径的开销
+    auto logs = make_shared<CollectedLogs>();
+    auto sink = make_shared<CollectSink>(logs);
+    sink->SetMinLevel(Logging::Level::Fatal);
+
+    Logging logging;
+    logging.SetMinLevel(Logging::Level::Debug);
+    logging.AppendSink(sink);
+    logging.Commit();
+
+    auto maxThreads = max(1u, thread::hardware_concurrency());
+    for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+    {
+        auto start = chrono::steady_clock::now();
+
+        vector<thread> threads;
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&]() {
+                for (int j = 0; j < kCount; ++j)
+                    logging.Log(Logging::Level::Info, Logging::Context(), "{0}", j);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        auto elapsed = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+        printf("[ BENCH    ] %2u thread(s): %.2f M msgs/s\n", threadCount,
+            threadCount * kCount / elapsed.count() / 1e6);
+    }
+
+    lock_guard<mutex> guard(logs->Lock);
+    EXPECT_TRUE(logs->Messages.empty());
+}
+
+namespace
+{
+    string ReadAllText(const char* path)
+    {
+        string ret;
+        UniqueFileHandle file(Pal::OpenFile(path, "rb"));
+        char buffer[4096];
+        size_t count = 0;
+        while ((count = ::fread(buffer, 1, sizeof(buffer), file.get())) > 0)
+            ret.append(buffer, count);
+        return ret;
+    }
+}
+
+TEST(Logging, BufferedFileSink)
+{
+    static const char* kPath = "MoeCoreTest_Buffered.log";
+
+    auto sink = make_shared<Logging::BasicFileSink>(kPath, true);
+    sink->SetBufferPolicy(Logging::BufferPolicy(64));
+    EXPECT_FALSE(sink->IsAlwaysFlush());
+    EXPECT_EQ(64u, sink->GetBufferPolicy().FlushBytes);
+
+    {
+        Logging logging;
+        logging.SetMinLevel(Logging::Level::Debug);
+        logging.AppendSink(sink);
+        logging.Commit();
+
+        // 超过缓冲区大小时写出
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0}", string(20, 'a'));
+        EXPECT_EQ(0u, Pal::GetFileSize(kPath));
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0}", string(20, 'b'));
+        logging.Log(Logging::Level::Info, Logging::Context(), "{0}", string(40, 'c'));
+        EXPECT_EQ(83u, Pal::GetFileSize(kPath));
+
+        // Fatal日志立即写出
+        logging.Log(Logging::Level::Fatal, Logging::Context(), "d");
+        EXPECT_EQ(85u, Pal::GetFileSize(kPath));
+
+        logging.Log(Logging::Level::Info, Logging::Context(), "e");
+        logging.Flush();
+        EXPECT_EQ(87u, Pal::GetFileSize(kPath));
+    }
+    EXPECT_EQ(string(20, 'a') + "\n" + string(20, 'b') + "\n" + string(40, 'c') + "\nd\ne\n", ReadAllText(kPath));
+
+    // 后台线程写出超时的缓冲
+    sink = make_shared<Logging::BasicFileSink>(kPath, true);
+    sink->SetBufferPolicy(Logging::BufferPolicy(4096, 10, true));
+    {
+        Logging logging;
+        logging.SetMinLevel(Logging::Level::Debug);
+        logging.AppendSink(sink);
+        logging.Commit();
+
+        logging.Log(Logging::Level::Info, Logging::Context(), "timed");
+        for (int i = 0; i < 200 && Pal::GetFileSize(kPath) == 0; ++i)
+            this_thread::sleep_for(chrono::milliseconds(10));
+        EXPECT_EQ(6u, Pal::GetFileSize(kPath));
+    }
+
+    sink.reset();
+    Pal::RemoveFile(kPath);
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Logging, DISABLED_FileSinkBenchmark)
+{
+    static const int kCount = 50000;
+    static const char* kPath = "MoeCoreTest_Bench.log";
+    static const char* kRotatingPaths[] = {
+        "MoeCoreTest_Bench.log", "MoeCoreTest_Bench.1.log", "MoeCoreTest_Bench.2.log",
+    };
+
+    struct Policy
+    {
+        const char* Name;
+        bool AlwaysFlush;
+        Logging::BufferPolicy Buffer;
+    };
+    const Policy policies[] = {
+        { "always flush", true, Logging::BufferPolicy() },
+        { "never flush", false, Logging::BufferPolicy() },
+        { "buffer 64K", false, Logging::BufferPolicy(64 * 1024) },
+        { "buffer 64K/10ms+bg", false, Logging::BufferPolicy(64 * 1024, 10, true) },
+    };
+
+    for (int rotating = 0; rotating < 2; ++rotating)
+    {
+        for (const auto& policy : policies)
+        {
+            for (auto path : kRotatingPaths)
+            {
+                if (Pal::IsFileExists(path))
+                    Pal::RemoveFile(path);
+            }
+
+            {
+                Logging logging;
+                logging.SetMinLevel(Logging::Level::Debug);
+
+                shared_ptr<Logging::SinkBase> sink;
+                if (rotating)
+                {
+                    // 约每1.5万条日志滚动一次
+                    auto p = make_shared<Logging::RotatingFileSink>(kPath, 1024 * 1024, 2);
+                    p->SetBufferPolicy(policy.Buffer);
+                    sink = p;
+                }
+                else
+                {
+                    auto p = make_shared<Logging::BasicFileSink>(kPath, true);
+                    p->SetBufferPolicy(policy.Buffer);
+                    sink = p;
+                }
+                sink->SetAlwaysFlush(policy.AlwaysFlush);
+                logging.AppendSink(sink);
+                logging.Commit();
+
+                auto start = chrono::steady_clock::now();
+                for (int i = 0; i < kCount; ++i)
+                {
+                    logging.Log(Logging::Level::Info, Logging::Context(),
+                        "benchmark message {0} with some payload to make it realistic", i);
+                }
+                logging.Flush();
+
+                auto elapsed = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+                printf("[ BENCH    ] %-8s %-20s: %.2f K msgs/s\n", rotating ? "rotating" : "basic", policy.Name,
+                    kCount / elapsed.count() / 1e3);
+            }
+
+            if (!rotating)
+            {
+                auto text = ReadAllText(kPath);
+                EXPECT_EQ(kCount, count(text.begin(), text.end(), '\n'));
+            }
+        }
+    }
+
+    for (auto path : kRotatingPaths)
+    {
+        if (Pal::IsFileExists(path))
+            Pal::RemoveFile(path);
+    }
+}
+
+namespace
+{
+    struct LegacyDateLazyCalc
+    {
+        bool ShortVersion;
+        Time::Timestamp Time;
+        mutable char Buffer[16];
+
+        LegacyDateLazyCalc(bool shortVersion, Time::Timestamp time)noexcept
+            : ShortVersion(shortVersion), Time(time) {}
+
+        const char* ToString()const noexcept
+        {
+            auto dt = Time::ToDateTime(Time);
+            if (ShortVersion)
+                snprintf(Buffer, sizeof(Buffer), "%02d-%02d-%02d", dt.Year % 100, dt.Month, dt.Day);
+            else
+                snprintf(Buffer, sizeof(Buffer), "%04d-%02d-%02d", dt.Year, dt.Month, dt.Day);
+            return Buffer;
+        }
+    };
+
+    struct LegacyTimeLazyCalc
+    {
+        Time::Timestamp Time;
+        mutable char Buffer[16];
+
+        LegacyTimeLazyCalc(Time::Timestamp time)noexcept
+            : Time(time) {}
+
+        const char* ToString()const noexcept
+        {
+            auto dt = Time::ToDateTime(Time);
+            snprintf(Buffer, sizeof(Buffer), "%02d:%02d:%02d.%03d", dt.Hour, dt.Minutes, dt.Seconds, dt.MilliSeconds);
+            return Buffer;
+        }
+    };
+
+    struct LegacyFilenameLazyCalc
+    {
+        const char* Path;
+
+        LegacyFilenameLazyCalc(const char* path)noexcept
+            : Path(path) {}
+
+        ArrayView<char> ToString()const noexcept
+        {
+            return PathUtils::GetFileName(Path);
+        }
+    };
+
+    /**
+     * @brief 预编译之前的格式化实现，作为对照
+     */
+    void LegacyFormat(string& dest, const string& format, Logging::Level level, const Logging::Context& context,
+        const char* msg)
+    {
+        LegacyDateLazyCalc date(false, context.Time);
+        LegacyDateLazyCalc shortDate(true, context.Time);
+        LegacyTimeLazyCalc time(context.Time);
+        LegacyFilenameLazyCalc filename(context.File);
+        static const char* kLevels[] = { "DEBUG", "TRACE", "INFO", "WARN", "ERROR", "FATAL" };
+
+        dest.clear();
+        StringUtils::VariableFormat(dest, format.c_str(),
+            make_pair("date", reference_wrapper<LegacyDateLazyCalc>(date)),
+            make_pair("short_date", reference_wrapper<LegacyDateLazyCalc>(shortDate)),
+            make_pair("time", reference_wrapper<LegacyTimeLazyCalc>(time)),
+            make_pair("level", kLevels[static_cast<unsigned>(level)]), make_pair("path", context.File),
+            make_pair("file", reference_wrapper<LegacyFilenameLazyCalc>(filename)),
+            make_pair("func", context.Function), make_pair("line", context.Line), make_pair("thread", context.ThreadId),
+            make_pair("msg", msg));
+    }
+}
+
+TEST(Logging, FormatPattern)
+{
+    static const char* kFormats[] = {
+        "[{short_date} {time}][{level,-5}][0x{thread:H}][{file}:{line},{func}] {msg}",
+        "{date} {time} {path}",
+        "{{escaped}} {{{msg}}} }} {",
+        "{level,8[*]}|{level,-8[.]}|{line,6:x}|{thread,-20}",
+        "{ msg }{ line , 4 }{line:X8}",
+        "{unknown} {msg:Q} {line:Z} {msg,} {msg,-} {msg,3[x} {line",
+        "{}{,}{:}{msg",
+        "",
+        "plain text only",
+    };
+
+    Logging::PlainFormatter plain;
+    Logging::AnsiColorFormatter color;
+    Logging::FormatterBase& plainBase = plain;
+    Logging::FormatterBase& colorBase = color;
+    color.SetColor(Logging::Level::Info, Logging::AnsiColorFormatter::Colors::Default,
+        Logging::AnsiColorFormatter::Colors::Default);
+
+    Logging::Context contexts[] = {
+        Logging::Context(1476086400123ll, "/path/to/Source.cpp", 123, "Function", 0x1234),
+        Logging::Context(1476086400999ll, "Source.cpp", 0, "", 0),
+        Logging::Context(Time::Now(), "C:\\path\\to\\Source.cpp", 4294967295u, "func", 0xFFFFFFFFFFFFFFFFull),
+    };
+
+    string expected, actual;
+    for (auto format : kFormats)
+    {
+        plain.SetFormat(format);
+        color.SetFormat(format);
+
+        for (const auto& context : contexts)
+        {
+            LegacyFormat(expected, format, Logging::Level::Info, context, "message");
+
+            plainBase.Format(actual, Logging::Level::Info, context, "message");
+            EXPECT_EQ(expected, actual) << "format: " << format;
+
+            colorBase.Format(actual, Logging::Level::Info, context, "message");
+            EXPECT_EQ(expected, actual) << "format: " << format;
+
+            LegacyFormat(expected, format, Logging::Level::Error, context, "message");
+            colorBase.Format(actual, Logging::Level::Error, context, "message");
+            EXPECT_EQ("\033[91m" + expected + "\033[m", actual) << "format: " << format;
+        }
+    }
+
+    // 跨越秒边界时日期缓存需要更新
+    plain.SetFormat("{date} {time}");
+    for (auto time : { 1476086399999ll, 1476086400000ll, 1476172799999ll, 1476172800000ll })
+    {
+        Logging::Context context(time, "Source.cpp", 1, "func", 1);
+        LegacyFormat(expected, "{date} {time}", Logging::Level::Info, context, "");
+        plainBase.Format(actual, Logging::Level::Info, context, "");
+        EXPECT_EQ(expected, actual);
+    }
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Logging, DISABLED_FormatterBenchmark)
+{
+    static const int kCount = 200000;
+
+    Logging::PlainFormatter plain;
+    Logging::FormatterBase& base = plain;
+    Logging::Context context(__FILE__, __LINE__, __FUNCTION__);
+    string dest;
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < kCount; ++i)
+    {
+        LegacyFormat(dest, plain.GetFormat(), Logging::Level::Info, context, "benchmark message");
+        context.Time += (i & 1);
+    }
+    auto legacy = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < kCount; ++i)
+    {
+        base.Format(dest, Logging::Level::Info, context, "benchmark message");
+        context.Time += (i & 1);
+    }
+    auto compiled = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start).count();
+
+    printf("[ BENCH    ] legacy  : %.2f M msgs/s\n", kCount / legacy / 1000000.0);
+    printf("[ BENCH    ] compiled: %.2f M msgs/s\n", kCount / compiled / 1000000.0);
+}
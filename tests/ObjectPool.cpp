@@ -0,0 +1,391 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <gtest/gtest.h>
+
+#include <Moe.Core/ObjectPool.hpp>
+#include <Moe.Core/ObjectPoolJson.hpp>
+
+using namespace std;
+using namespace moe;
+
+TEST(ObjectPool, AllocAndFree)
+{
+    ObjectPool pool;
+
+    auto p1 = pool.Alloc(16);
+    auto p2 = pool.Alloc(ObjectPool::kLargeSizeThreshold + 1);
+    EXPECT_EQ(&pool, ObjectPool::GetPoolFromPointer(p1.get()));
+    EXPECT_EQ(&pool, ObjectPool::GetPoolFromPointer(p2.get()));
+    EXPECT_EQ(ObjectPool::kSmallSizeBlockSize + ObjectPool::kLargeSizeThreshold + 1, pool.GetUsedSize());
+
+    auto raw = p1.get();
+    p1.reset();
+    EXPECT_EQ(ObjectPool::kSmallSizeBlockSize, pool.GetFreeSize());
+
+    auto p3 = pool.Alloc(ObjectPool::kSmallSizeBlockSize);
+    EXPECT_EQ(raw, p3.get());
+
+    memset(p2.get(), 0xCC, ObjectPool::kLargeSizeThreshold + 1);
+    pool.Realloc(p2, ObjectPool::kLargeSizeThreshold * 2);
+    EXPECT_EQ(0xCC, static_cast<uint8_t*>(p2.get())[ObjectPool::kLargeSizeThreshold]);
+}
+
+TEST(ObjectPool, ConcurrentCrossThreadFree)
+{
+    static const size_t kCount = 1000;
+
+    ConcurrentObjectPool pool;
+    vector<unique_ptr<void, ObjectPool::Deleter<void>>> objects;
+
+    // 在工作线程上分配，主线程上释放
+    thread worker([&]() {
+        for (size_t i = 0; i < kCount; ++i)
+            objects.emplace_back(pool.Alloc(i % 512 + 1));
+    });
+    worker.join();
+
+    auto cache = ObjectPool::GetPoolFromPointer(objects.front().get());
+    ASSERT_NE(nullptr, cache);
+    EXPECT_EQ(1u, pool.GetThreadCacheCount());
+    EXPECT_LT(0u, cache->GetUsedSize());
+
+    for (auto& p : objects)
+        ObjectPool::Free(p.release());
+    objects.clear();
+
+    // 工作线程已退出，新线程接管其缓存并回收远程释放的节点
+    thread adopter([&]() {
+        auto p = pool.Alloc(32);
+        EXPECT_EQ(cache, ObjectPool::GetPoolFromPointer(p.get()));
+        EXPECT_EQ(32u, cache->GetUsedSize());
+    });
+    adopter.join();
+    EXPECT_EQ(1u, pool.GetThreadCacheCount());
+
+    // 同一时刻存活的线程使用不同的缓存
+    auto p = pool.Alloc(32);
+    thread([&]() {
+        auto q = pool.Alloc(32);
+        EXPECT_NE(ObjectPool::GetPoolFromPointer(p.get()), ObjectPool::GetPoolFromPointer(q.get()));
+    }).join();
+    EXPECT_EQ(2u, pool.GetThreadCacheCount());
+}
+
+TEST(ObjectPool, ConcurrentStress)
+{
+    static const size_t kThreads = 4;
+    static const size_t kRounds = 10000;
+
+    ConcurrentObjectPool pool;
+    mutex lock;
+    vector<unique_ptr<void, ObjectPool::Deleter<void>>> shared;
+
+    vector<thread> threads;
+    for (size_t i = 0; i < kThreads; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            for (size_t j = 0; j < kRounds; ++j)
+            {
+                auto p = pool.Alloc((i * kRounds + j) % 1024 + 1);
+                memset(p.get(), static_cast<int>(i), 1);
+
+                unique_lock<mutex> guard(lock);
+                shared.emplace_back(std::move(p));
+                if (shared.size() > 64)
+                    shared.erase(shared.begin(), shared.begin() + 32);  // 释放其他线程分配的对象
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    auto large = pool.Alloc(ObjectPool::kLargeSizeThreshold + 1);
+    thread([&]() {
+        memset(large.get(), 0x5A, ObjectPool::kLargeSizeThreshold + 1);
+        pool.Realloc(large, ObjectPool::kLargeSizeThreshold * 2);
+        EXPECT_EQ(0x5A, static_cast<uint8_t*>(large.get())[ObjectPool::kLargeSizeThreshold]);
+    }).join();
+
+    shared.clear();
+    large.reset();
+}
+
+TEST(ObjectPool, Slab)
+{
+    static const size_t kCount = 10000;
+
+    ObjectPool pool(true);
+    EXPECT_TRUE(pool.IsSlabMode());
+
+    vector<unique_ptr<void, ObjectPool::Deleter<void>>> objects;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        objects.emplace_back(pool.Alloc(32));
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(objects.back().get()) % 16);
+        EXPECT_EQ(&pool, ObjectPool::GetPoolFromPointer(objects.back().get()));
+    }
+    EXPECT_EQ(kCount * 32, pool.GetUsedSize());
+
+    // 同一个Slab中的节点是连续的
+    EXPECT_EQ(static_cast<uint8_t*>(objects[0].get()) + 32, objects[1].get());
+
+    // 超过kSlabMaxNodeSize的对象仍然使用独立的节点
+    auto large = pool.Alloc(ObjectPool::kSlabMaxNodeSize + 1);
+    EXPECT_EQ(&pool, ObjectPool::GetPoolFromPointer(large.get()));
+    large.reset();
+
+    // Realloc
+    memset(objects[0].get(), 0xAB, 32);
+    pool.Realloc(objects[0], 100);
+    EXPECT_EQ(0xAB, static_cast<uint8_t*>(objects[0].get())[31]);
+    pool.Realloc(objects[0], 32);
+
+    // 全部释放后，空闲的Slab可以归还给系统
+    objects.clear();
+    EXPECT_EQ(0u, pool.GetUsedSize());
+    EXPECT_LE(kCount * 32, pool.GetFreeSize());
+    EXPECT_LE(kCount * 32, pool.CollectGarbage());
+    EXPECT_EQ(0u, pool.GetAllocatedSize());
+
+    // 部分释放时，仍有使用中节点的Slab会被保留
+    for (size_t i = 0; i < kCount; ++i)
+        objects.emplace_back(pool.Alloc(64));
+    for (size_t i = 0; i < kCount; i += 2)
+        objects[i].reset();
+    pool.CollectGarbage();
+    EXPECT_EQ(kCount / 2 * 64, pool.GetUsedSize());
+    objects.clear();
+}
+
+TEST(ObjectPool, ConcurrentSlab)
+{
+    ConcurrentObjectPool pool(true);
+    vector<unique_ptr<void, ObjectPool::Deleter<void>>> objects;
+    auto local = pool.Alloc(16);
+
+    thread([&]() {
+        for (size_t i = 0; i < 1000; ++i)
+            objects.emplace_back(pool.Alloc(i % 256 + 1));
+    }).join();
+
+    auto cache = ObjectPool::GetPoolFromPointer(objects.front().get());
+    EXPECT_TRUE(cache->IsSlabMode());
+
+    EXPECT_NE(cache, ObjectPool::GetPoolFromPointer(local.get()));
+
+    memset(objects.front().get(), 0x11, 1);
+    pool.Realloc(objects.front(), 1024);
+    EXPECT_EQ(ObjectPool::GetPoolFromPointer(local.get()), ObjectPool::GetPoolFromPointer(objects.front().get()));
+    EXPECT_EQ(0x11, *static_cast<uint8_t*>(objects.front().get()));
+    objects.clear();
+}
+
+TEST(ObjectPool, Statistics)
+{
+    ObjectPool pool;
+
+    auto p1 = pool.Alloc(10);
+    auto p2 = pool.Alloc(20);
+    p1.reset();
+    auto p3 = pool.Alloc(30);
+    auto p4 = pool.Alloc(ObjectPool::kLargeSizeThreshold + 1);
+
+    auto stat = pool.GetStatistics();
+    ASSERT_EQ(2u, stat.Buckets.size());
+    EXPECT_EQ(pool.GetAllocatedSize(), stat.AllocatedSize);
+    EXPECT_EQ(pool.GetFreeSize(), stat.FreeSize);
+
+    auto& large = stat.Buckets[0];
+    EXPECT_EQ(0u, large.NodeSize);
+    EXPECT_EQ(ObjectPool::kLargeSizeThreshold + 1, large.AllocatedSize);
+    EXPECT_EQ(1u, large.AllocCalls);
+    EXPECT_EQ(1u, large.FreshAllocs);
+    EXPECT_EQ(1u, large.SystemAllocCalls);
+
+    auto& small = stat.Buckets[1];
+    EXPECT_EQ(32u, small.NodeSize);
+    EXPECT_EQ(2u, small.AllocatedCount);
+    EXPECT_EQ(0u, small.FreeCount);
+    EXPECT_EQ(2u, small.PeakUsedCount);
+    EXPECT_EQ(3u, small.AllocCalls);
+    EXPECT_EQ(1u, small.FreeCalls);
+    EXPECT_EQ(64u, small.AllocatedSize);
+    EXPECT_EQ(1u, small.FreeListHits);
+    EXPECT_EQ(2u, small.FreshAllocs);
+    EXPECT_EQ(2u, small.SystemAllocCalls);
+    EXPECT_EQ(ObjectPool::kLargeSizeThreshold + 1 + 64, stat.AllocatedSize);
+    EXPECT_EQ(60u, small.RequestedBytes);
+    EXPECT_EQ(36u, small.GetWastedBytes());
+
+    JsonValue json;
+    ToJson(json, stat);
+    EXPECT_EQ(2u, json.GetElementByKey("buckets").GetElementCount());
+    auto& smallJson = json.GetElementByKey("buckets").GetElementByIndex(1);
+    EXPECT_EQ(36., smallJson.GetElementByKey("wastedBytes").Get<JsonValue::NumberType>());
+    EXPECT_EQ(2., smallJson.GetElementByKey("freshAllocs").Get<JsonValue::NumberType>());
+
+    // 超大对象按实际大小计入，重新分配和释放后同步更新
+    pool.Realloc(p4, ObjectPool::kLargeSizeThreshold + 100);
+    EXPECT_EQ(ObjectPool::kLargeSizeThreshold + 100 + 64, pool.GetAllocatedSize());
+    p4.reset();
+    EXPECT_EQ(64u, pool.GetAllocatedSize());
+
+    // 超大对象都已释放，清空计数后不再出现在快照中
+    pool.ResetStatistics();
+    stat = pool.GetStatistics();
+    ASSERT_EQ(1u, stat.Buckets.size());
+    EXPECT_EQ(0u, stat.Buckets[0].AllocCalls);
+    EXPECT_EQ(2u, stat.Buckets[0].PeakUsedCount);
+
+    // Slab模式
+    ObjectPool slabPool(true);
+    auto s1 = slabPool.Alloc(32);
+    auto s2 = slabPool.Alloc(32);
+    stat = slabPool.GetStatistics();
+    ASSERT_EQ(1u, stat.Buckets.size());
+    EXPECT_EQ(1u, stat.Buckets[0].SystemAllocCalls);
+    EXPECT_EQ(0u, stat.Buckets[0].FreeListHits);
+    EXPECT_EQ(2u, stat.Buckets[0].FreshAllocs);
+    EXPECT_EQ(2u, stat.Buckets[0].PeakUsedCount);
+
+    // 只有复用释放过的节点才计为命中
+    s1.reset();
+    s1 = slabPool.Alloc(32);
+    void* batch[3] = {};
+    s2.reset();
+    slabPool.AllocBatch(32, batch, 3);
+    stat = slabPool.GetStatistics();
+    EXPECT_EQ(2u, stat.Buckets[0].FreeListHits);
+    EXPECT_EQ(4u, stat.Buckets[0].FreshAllocs);
+    EXPECT_EQ(stat.Buckets[0].AllocCalls, stat.Buckets[0].FreeListHits + stat.Buckets[0].FreshAllocs);
+    ObjectPool::FreeBatch(batch, 3);
+}
+
+TEST(ObjectPool, ConcurrentStatistics)
+{
+    ConcurrentObjectPool pool;
+    auto p1 = pool.Alloc(16);
+    auto p2 = pool.Alloc(ObjectPool::kLargeSizeThreshold + 1);
+
+    thread worker([&]() {
+        auto p3 = pool.Alloc(16);
+        auto p4 = pool.Alloc(100);
+        p4.reset();
+    });
+    worker.join();
+
+    auto stat = pool.GetStatistics();
+    EXPECT_EQ(2u, pool.GetThreadCacheCount());
+    ASSERT_EQ(3u, stat.Buckets.size());
+    EXPECT_EQ(0u, stat.Buckets[0].NodeSize);
+    EXPECT_EQ(ObjectPool::kLargeSizeThreshold + 1, stat.Buckets[0].AllocatedSize);
+    EXPECT_EQ(ObjectPool::GetSizeClass(16), ObjectPool::GetSizeClass(stat.Buckets[1].NodeSize));
+    EXPECT_EQ(2u, stat.Buckets[1].AllocCalls);
+    EXPECT_EQ(1u, stat.Buckets[1].FreeCalls);
+    EXPECT_EQ(2u, stat.Buckets[1].PeakUsedCount);
+    EXPECT_EQ(1u, stat.Buckets[2].AllocCalls);
+    EXPECT_EQ(1u, stat.Buckets[2].FreeCount);
+    EXPECT_EQ(ObjectPool::kLargeSizeThreshold + 1 + stat.Buckets[1].NodeSize * 2 + stat.Buckets[2].NodeSize,
+        stat.AllocatedSize);
+}
+
+namespace
+{
+    struct PooledMessage :
+        public RefBase<PooledMessage, ObjectPool::Deleter<PooledMessage>>
+    {
+        static int Alive;
+
+        int Value = 0;
+
+        explicit PooledMessage(int value)
+            : Value(value) { ++Alive; }
+        ~PooledMessage() { --Alive; }
+    };
+
+    int PooledMessage::Alive = 0;
+}
+
+TEST(ObjectPool, TypedPool)
+{
+    ObjectPool pool;
+    TypedPool<PooledMessage> typed(pool);
+    EXPECT_EQ(ObjectPool::GetSizeClass(sizeof(PooledMessage)), TypedPool<PooledMessage>::kSizeClass);
+
+    {
+        auto p1 = typed.Alloc(1);
+        EXPECT_EQ(1, p1->Value);
+        EXPECT_EQ(&pool, ObjectPool::GetPoolFromPointer(p1.get()));
+
+        auto r1 = typed.AllocRef(2);
+        auto r2 = r1;
+        EXPECT_EQ(2, r2->Value);
+        EXPECT_EQ(2, PooledMessage::Alive);
+    }
+    EXPECT_EQ(0, PooledMessage::Alive);
+    EXPECT_EQ(0u, pool.GetUsedSize());
+}
+
+TEST(ObjectPool, Batch)
+{
+    for (auto slabMode : { false, true })
+    {
+        ObjectPool pool(slabMode);
+        TypedPool<PooledMessage> typed(pool);
+
+        vector<UniquePooledObject<PooledMessage>> objects;
+        typed.AllocBatch(objects, 100, 7);
+        ASSERT_EQ(100u, objects.size());
+        EXPECT_EQ(100, PooledMessage::Alive);
+        EXPECT_EQ(7, objects.back()->Value);
+
+        TypedPool<PooledMessage>::FreeBatch(objects);
+        EXPECT_TRUE(objects.empty());
+        EXPECT_EQ(0, PooledMessage::Alive);
+        EXPECT_EQ(0u, pool.GetUsedSize());
+
+        // 空闲节点被整段复用
+        auto allocated = pool.GetAllocatedSize();
+        typed.AllocBatch(objects, 100, 8);
+        EXPECT_EQ(allocated, pool.GetAllocatedSize());
+        EXPECT_EQ(100, PooledMessage::Alive);
+        objects.clear();
+
+        // 混合大小及超大对象
+        void* ptrs[4] = {};
+        pool.AllocBatch(ObjectPool::kLargeSizeThreshold + 1, ptrs, 2);
+        pool.AllocBatch(16, ptrs + 2, 2);
+        EXPECT_NE(nullptr, ptrs[3]);
+        ObjectPool::FreeBatch(ptrs, 4);
+        EXPECT_EQ(0u, pool.GetUsedSize());
+
+        auto stat = pool.GetStatistics();
+        EXPECT_EQ(stat.Buckets[0].AllocCalls, stat.Buckets[0].FreeCalls);
+    }
+}
+
+TEST(ObjectPool, ConcurrentBatchRemoteFree)
+{
+    ConcurrentObjectPool pool;
+    void* ptrs[64] = {};
+
+    thread worker([&]() {
+        pool.AllocBatch(48, ptrs, 64);
+    });
+    worker.join();
+
+    auto cache = ObjectPool::GetPoolFromPointer(ptrs[0]);
+    EXPECT_EQ(64 * 64u, cache->GetUsedSize());
+    ObjectPool::FreeBatch(ptrs, 64);
+
+    // 新线程接管缓存后回收远程释放的节点
+    thread adopter([&]() {
+        pool.AllocBatch(48, ptrs, 1);
+        EXPECT_EQ(cache, ObjectPool::GetPoolFromPointer(ptrs[0]));
+        EXPECT_EQ(64u, cache->GetUsedSize());
+        ObjectPool::Free(ptrs[0]);
+    });
+    adopter.join();
+}
@@ -0,0 +1,537 @@
+/**
+ * @file
+ * @date 2026/10/16
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <Moe.Core/Json.hpp>
+#include <Moe.Core/Mdr.hpp>
+#include <Moe.Core/Stream.hpp>
+
+using namespace std;
+using namespace moe;
+
+TEST(Stream, BinaryReaderWriter)
+{
+    vector<uint8_t> data;
+    BytesVectorStream stream(data);
+    BinaryWriter<> writer(&stream);
+    writer.WriteUInt8(0xAB);
+    writer.WriteUInt16LE(0x1234);
+    writer.WriteUInt32LE(0x12345678u);
+    writer.WriteUInt64LE(0x123456789ABCDEF0ull);
+    writer.WriteUInt16BE(0x1234);
+    writer.WriteUInt32BE(0x12345678u);
+    writer.WriteUInt64BE(0x123456789ABCDEF0ull);
+    writer.WriteInt32LE(-2);
+    writer.WriteInt32BE(-3);
+    writer.WriteInt64BE(-4);
+    ASSERT_EQ(1u + 2 + 4 + 8 + 2 + 4 + 8 + 4 + 4 + 8, data.size());
+    EXPECT_EQ(0x34, data[1]);
+    EXPECT_EQ(0x12, data[2]);
+    EXPECT_EQ(0x12, data[15]);
+    EXPECT_EQ(0x34, data[16]);
+
+    // 窗口路径
+    BytesViewStream view(BytesView(data.data(), data.size()));
+    BinaryReader<> reader(&view);
+    EXPECT_EQ(0xAB, reader.ReadUInt8());
+    EXPECT_EQ(0x1234, reader.ReadUInt16LE());
+    EXPECT_EQ(0x12345678u, reader.ReadUInt32LE());
+    EXPECT_EQ(0x123456789ABCDEF0ull, reader.ReadUInt64LE());
+    EXPECT_EQ(0x1234, reader.ReadUInt16BE());
+    EXPECT_EQ(0x12345678u, reader.ReadUInt32BE());
+    EXPECT_EQ(0x123456789ABCDEF0ull, reader.ReadUInt64BE());
+    EXPECT_EQ(-2, reader.ReadInt32LE());
+    EXPECT_EQ(-3, reader.ReadInt32BE());
+    EXPECT_EQ(-4, reader.ReadInt64BE());
+    EXPECT_THROW(reader.ReadUInt16LE(), OutOfRangeException);
+
+    // 跨越缓冲区边界
+    BytesViewStream inner(BytesView(data.data(), data.size()));
+    BufferedStream buffered(&inner, 16);
+    BinaryReader<> reader2(&buffered);
+    EXPECT_EQ(0xAB, reader2.ReadUInt8());
+    EXPECT_EQ(0x1234, reader2.ReadUInt16LE());
+    EXPECT_EQ(0x12345678u, reader2.ReadUInt32LE());
+    EXPECT_EQ(0x123456789ABCDEF0ull, reader2.ReadUInt64LE());
+    EXPECT_EQ(0x1234, reader2.ReadUInt16BE());
+    EXPECT_EQ(0x12345678u, reader2.ReadUInt32BE());
+    EXPECT_EQ(0x123456789ABCDEF0ull, reader2.ReadUInt64BE());
+    EXPECT_EQ(-2, reader2.ReadInt32LE());
+    EXPECT_EQ(-3, reader2.ReadInt32BE());
+    EXPECT_EQ(-4, reader2.ReadInt64BE());
+    EXPECT_THROW(reader2.ReadUInt8(), OutOfRangeException);
+}
+
+TEST(Stream, BufferedStream)
+{
+    vector<uint8_t> data;
+    BytesVectorStream inner(data);
+
+    {
+        BufferedStream stream(&inner, 16);
+        for (int i = 0; i < 100; ++i)
+            stream.WriteByte(static_cast<uint8_t>(i));
+        EXPECT_EQ(100u, stream.GetPosition());
+        EXPECT_EQ(100u, stream.GetLength());
+
+        uint8_t block[40];
+        for (size_t i = 0; i < sizeof(block); ++i)
+            block[i] = static_cast<uint8_t>(100 + i);
+        stream.Write(BytesView(block, 5), 5);
+        stream.Write(BytesView(block + 5, 35), 35);
+        EXPECT_EQ(140u, stream.GetPosition());
+    }
+    ASSERT_EQ(140u, data.size());
+    for (size_t i = 0; i < data.size(); ++i)
+        EXPECT_EQ(static_cast<uint8_t>(i), data[i]);
+
+    inner.Seek(0, StreamSeekOrigin::Begin);
+    BufferedStream stream(&inner, 16);
+    EXPECT_EQ(0, stream.ReadByte());
+    EXPECT_EQ(1, stream.ReadByte());
+    EXPECT_EQ(2u, stream.GetPosition());
+
+    uint8_t out[64];
+    EXPECT_EQ(3u, stream.Read(MutableBytesView(out, 3), 3));
+    EXPECT_EQ(2, out[0]);
+    EXPECT_EQ(40u, stream.Read(MutableBytesView(out, 40), 40));
+    EXPECT_EQ(5, out[0]);
+    EXPECT_EQ(44, out[39]);
+    EXPECT_EQ(45u, stream.GetPosition());
+
+    // 读写交替
+    EXPECT_EQ(45, stream.ReadByte());
+    stream.WriteByte(0xFF);
+    EXPECT_EQ(47u, stream.GetPosition());
+    EXPECT_EQ(47, stream.ReadByte());
+    EXPECT_EQ(0xFF, data[46]);
+
+    // Seek
+    EXPECT_EQ(10u, stream.Seek(-38, StreamSeekOrigin::Current));
+    EXPECT_EQ(10, stream.ReadByte());
+    EXPECT_EQ(138u, stream.Seek(-2, StreamSeekOrigin::End));
+    EXPECT_EQ(138, stream.ReadByte());
+    EXPECT_EQ(139, stream.ReadByte());
+    EXPECT_EQ(-1, stream.ReadByte());
+
+    // 追加
+    stream.WriteByte(0xEE);
+    EXPECT_EQ(141u, stream.GetLength());
+    stream.Flush();
+    ASSERT_EQ(141u, data.size());
+    EXPECT_EQ(0xEE, data[140]);
+}
+
+TEST(Stream, FileStream)
+{
+    static const char* kPath = "MoeCoreTest_Stream.bin";
+
+    {
+        FileStream file(kPath, "wb");
+        BufferedStream stream(&file, 64);
+        BinaryWriter<> writer(&stream);
+        for (uint32_t i = 0; i < 1000; ++i)
+            writer.WriteUInt32BE(i);
+    }
+
+    {
+        FileStream file(kPath, "rb");
+        EXPECT_EQ(4000u, file.GetLength());
+
+        BufferedStream stream(&file, 64);
+        BinaryReader<> reader(&stream);
+        for (uint32_t i = 0; i < 1000; ++i)
+            ASSERT_EQ(i, reader.ReadUInt32BE());
+        EXPECT_EQ(-1, stream.ReadByte());
+
+        // 写入被缓冲，在写出时才会失败
+        stream.WriteByte(0);
+        EXPECT_THROW(stream.Flush(), OperationNotSupportException);
+    }
+
+    ::remove(kPath);
+}
+
+TEST(Stream, FileStreamPositional)
+{
+    static const char* kPath = "MoeCoreTest_StreamAt.bin";
+
+    {
+        FileStream file(kPath, "w+b");
+        file.Write(BytesView(reinterpret_cast<const uint8_t*>("0123456789"), 10), 10);
+        EXPECT_EQ(10u, file.GetPosition());
+
+        file.WriteAt(2, BytesView(reinterpret_cast<const uint8_t*>("ab"), 2), 2);
+        EXPECT_EQ(10u, file.GetPosition());
+
+        uint8_t buffer[16];
+        EXPECT_EQ(4u, file.ReadAt(0, MutableBytesView(buffer, 4), 4));
+        EXPECT_EQ(0, memcmp(buffer, "01ab", 4));
+        EXPECT_EQ(2u, file.ReadAt(8, MutableBytesView(buffer, 16), 16));
+        EXPECT_EQ(0, memcmp(buffer, "89", 2));
+        EXPECT_EQ(0u, file.ReadAt(100, MutableBytesView(buffer, 16), 16));
+        EXPECT_EQ(10u, file.GetPosition());
+    }
+
+    {
+        FileStream file(kPath, "rb");
+        EXPECT_THROW(file.WriteAt(0, BytesView(reinterpret_cast<const uint8_t*>("x"), 1), 1),
+            OperationNotSupportException);
+
+        // 多线程并发读取
+        vector<thread> threads;
+        atomic<int> errors(0);
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([&, i]() {
+                for (int j = 0; j < 1000; ++j)
+                {
+                    uint8_t b = 0;
+                    auto offset = static_cast<uint64_t>((i + j) % 10);
+                    if (file.ReadAt(offset, MutableBytesView(&b, 1), 1) != 1 || b != "01ab456789"[offset])
+                        ++errors;
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        EXPECT_EQ(0, errors.load());
+    }
+
+    // 超过2GB的偏移（稀疏文件）
+    if (sizeof(size_t) >= 8)
+    {
+        static const uint64_t kFar = 5ull * 1024 * 1024 * 1024;
+
+        FileStream file(kPath, "w+b");
+        EXPECT_EQ(kFar, file.Seek(static_cast<int64_t>(kFar), StreamSeekOrigin::Begin));
+        file.WriteByte('x');
+        EXPECT_EQ(kFar + 1, file.GetPosition());
+        file.Flush();
+        EXPECT_EQ(kFar + 1, file.GetLength());
+        EXPECT_EQ(kFar, file.Seek(-1, StreamSeekOrigin::End));
+        EXPECT_EQ('x', file.ReadByte());
+    }
+
+    ::remove(kPath);
+}
+
+TEST(Stream, MmapStream)
+{
+    static const char* kPath = "MoeCoreTest_Mmap.bin";
+
+    {
+        FileStream file(kPath, "wb");
+    }
+    {
+        MmapStream stream(kPath);
+        EXPECT_EQ(0u, stream.GetLength());
+        EXPECT_EQ(0u, stream.GetView().GetSize());
+        EXPECT_EQ(-1, stream.ReadByte());
+    }
+
+    // Json5直接解析映射区
+    {
+        FileStream file(kPath, "wb");
+        const char* json = "{ a: [1, 2, 3], b: 'text', }";
+        file.Write(BytesView(reinterpret_cast<const uint8_t*>(json), strlen(json)), strlen(json));
+    }
+    {
+        MmapStream stream(kPath);
+        auto view = stream.GetView();
+        JsonValue value;
+        Json5::Parse(value, ArrayView<char>(reinterpret_cast<const char*>(view.GetBuffer()), view.GetSize()),
+            kPath);
+        ASSERT_TRUE(value.Is<JsonValue::ObjectType>());
+        EXPECT_EQ(value.GetElementByKey("b"), "text");
+        EXPECT_EQ(3u, value.GetElementByKey("a").GetElementCount());
+        EXPECT_THROW(stream.WriteByte(0), OperationNotSupportException);
+    }
+
+    // Mdr::Reader直接读取映射区
+    vector<uint64_t> values;
+    for (uint64_t i = 0; i < 10000; ++i)
+        values.push_back(i * i * i);
+    {
+        vector<uint8_t> data;
+        BytesVectorStream stream(data);
+        Mdr::Writer writer(&stream);
+        writer.Write(values, 0);
+
+        FileStream file(kPath, "wb");
+        file.Write(BytesView(data.data(), data.size()), data.size());
+    }
+    {
+        MmapStream stream(kPath);
+        EXPECT_EQ(Pal::GetFileSize(kPath), stream.GetLength());
+
+        vector<uint64_t> out;
+        Mdr::Reader reader(&stream);
+        reader.Read(out, 0);
+        EXPECT_EQ(values, out);
+        EXPECT_EQ(stream.GetLength(), stream.GetPosition());
+
+        EXPECT_EQ(1u, stream.Seek(1, StreamSeekOrigin::Begin));
+        EXPECT_EQ(stream.GetView()[1], stream.ReadByte());
+    }
+
+    ::remove(kPath);
+}
+
+TEST(Stream, CopyTo)
+{
+    static const char* kSrcPath = "MoeCoreTest_CopySrc.bin";
+    static const char* kDestPath = "MoeCoreTest_CopyDest.bin";
+
+    vector<uint8_t> data(300 * 1024);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i * 7);
+
+    // 内存到内存
+    {
+        vector<uint8_t> out;
+        BytesViewStream src(BytesView(data.data(), data.size()));
+        BytesVectorStream dest(out);
+        EXPECT_EQ(10u, src.Seek(10, StreamSeekOrigin::Begin));
+        EXPECT_EQ(100u, src.CopyTo(&dest, 100));
+        EXPECT_EQ(data.size() - 110, src.CopyTo(&dest));
+        ASSERT_EQ(data.size() - 10, out.size());
+        EXPECT_TRUE(equal(out.begin(), out.end(), data.begin() + 10));
+    }
+
+    // 内存到文件
+    {
+        BytesViewStream src(BytesView(data.data(), data.size()));
+        FileStream dest(kSrcPath, "wb");
+        EXPECT_EQ(data.size(), src.CopyTo(&dest));
+        EXPECT_EQ(data.size(), dest.GetPosition());
+    }
+
+    // 文件到文件
+    {
+        FileStream src(kSrcPath, "rb");
+        FileStream dest(kDestPath, "wb");
+        EXPECT_EQ('\0', static_cast<char>(src.ReadByte()));
+        dest.WriteByte(0xAA);
+        EXPECT_EQ(1000u, src.CopyTo(&dest, 1000));
+        EXPECT_EQ(1001u, src.GetPosition());
+        EXPECT_EQ(1001u, dest.GetPosition());
+        EXPECT_EQ(data.size() - 1001, src.CopyTo(&dest));
+        EXPECT_EQ(-1, src.ReadByte());
+        dest.WriteByte(0xBB);
+    }
+    {
+        MmapStream stream(kDestPath);
+        auto view = stream.GetView();
+        ASSERT_EQ(data.size() + 1, view.GetSize());
+        EXPECT_EQ(0xAA, view[0]);
+        EXPECT_TRUE(equal(data.begin() + 1, data.end(), view.GetBuffer() + 1));
+        EXPECT_EQ(0xBB, view[data.size()]);
+    }
+
+    // 文件到内存，经由缓冲流
+    {
+        vector<uint8_t> out;
+        FileStream file(kSrcPath, "rb");
+        BufferedStream src(&file);
+        BytesVectorStream dest(out);
+        EXPECT_EQ(data.size(), src.CopyTo(&dest));
+        EXPECT_EQ(data, out);
+    }
+
+    ::remove(kSrcPath);
+    ::remove(kDestPath);
+}
+
+TEST(Stream, ScatterGather)
+{
+    static const char* kPath = "MoeCoreTest_StreamV.bin";
+
+    const char* header = "HEAD";
+    vector<uint8_t> payload(20000);
+    for (size_t i = 0; i < payload.size(); ++i)
+        payload[i] = static_cast<uint8_t>(i * 13);
+    const char* trailer = "TAIL";
+
+    BytesView parts[] = {
+        BytesView(reinterpret_cast<const uint8_t*>(header), 4),
+        BytesView(),
+        BytesView(payload.data(), payload.size()),
+        BytesView(reinterpret_cast<const uint8_t*>(trailer), 4),
+    };
+    ArrayView<BytesView> input(parts, 4);
+
+    vector<uint8_t> expected;
+    expected.insert(expected.end(), header, header + 4);
+    expected.insert(expected.end(), payload.begin(), payload.end());
+    expected.insert(expected.end(), trailer, trailer + 4);
+
+    // 内存流
+    vector<uint8_t> data;
+    {
+        BytesVectorStream stream(data);
+        stream.WriteByte(0);
+        stream.WriteV(input);
+        EXPECT_EQ(expected.size() + 1, stream.GetPosition());
+    }
+    EXPECT_TRUE(equal(expected.begin(), expected.end(), data.begin() + 1));
+
+    {
+        uint8_t small[16];
+        BytesViewStream stream(MutableBytesView(small, sizeof(small)));
+        EXPECT_THROW(stream.WriteV(input), OutOfRangeException);
+        EXPECT_EQ(0u, stream.GetPosition());
+    }
+
+    {
+        BytesViewStream stream(BytesView(data.data(), data.size()));
+        uint8_t a[3], b[10];
+        vector<uint8_t> c(data.size());
+        MutableBytesView buffers[] = {
+            MutableBytesView(a, sizeof(a)), MutableBytesView(b, sizeof(b)), MutableBytesView(c.data(), c.size()),
+        };
+        EXPECT_EQ(data.size(), stream.ReadV(ArrayView<MutableBytesView>(buffers, 3)));
+        EXPECT_EQ(0, a[0]);
+        EXPECT_EQ(0, memcmp(a + 1, "HE", 2));
+        EXPECT_EQ(0, memcmp(b, "AD", 2));
+        EXPECT_EQ(data.size(), stream.GetPosition());
+    }
+
+    // 文件流（大块走writev，小块走FILE缓冲区）
+    {
+        FileStream file(kPath, "wb");
+        file.WriteByte(0);
+        file.WriteV(input);
+        file.WriteV(ArrayView<BytesView>(parts, 2));
+        EXPECT_EQ(expected.size() + 5, file.GetPosition());
+    }
+    {
+        MmapStream stream(kPath);
+        auto view = stream.GetView();
+        ASSERT_EQ(expected.size() + 5, view.GetSize());
+        EXPECT_TRUE(equal(expected.begin(), expected.end(), view.GetBuffer() + 1));
+        EXPECT_EQ(0, memcmp(view.GetBuffer() + expected.size() + 1, "HEAD", 4));
+    }
+
+    // 缓冲流
+    {
+        FileStream file(kPath, "wb");
+        BufferedStream stream(&file, 64);
+        stream.WriteV(ArrayView<BytesView>(parts, 2));
+        stream.WriteV(input);
+        stream.WriteByte(1);
+        EXPECT_EQ(expected.size() + 5, stream.GetPosition());
+    }
+    {
+        FileStream file(kPath, "rb");
+        vector<uint8_t> out(expected.size() + 8);
+        EXPECT_EQ(expected.size() + 5, file.Read(MutableBytesView(out.data(), out.size()), out.size()));
+        EXPECT_EQ(0, memcmp(out.data(), "HEAD", 4));
+        EXPECT_TRUE(equal(expected.begin(), expected.end(), out.begin() + 4));
+        EXPECT_EQ(1, out[expected.size() + 4]);
+    }
+
+    ::remove(kPath);
+}
+
+// 基准测试，默认不运行，使用--gtest_also_run_disabled_tests执行
+TEST(Stream, DISABLED_Benchmark)
+{
+    static const char* kPath = "MoeCoreTest_StreamBench.bin";
+    static const size_t kCount = 1000000;
+
+    vector<uint8_t> data;
+    {
+        BytesVectorStream stream(data);
+        BinaryWriter<> writer(&stream);
+        for (size_t i = 0; i < kCount; ++i)
+            writer.WriteUInt32LE(static_cast<uint32_t>(i * 2654435761u));
+    }
+    {
+        FILE* fp = ::fopen(kPath, "wb");
+        ASSERT_NE(nullptr, fp);
+        ::fwrite(data.data(), 1, data.size(), fp);
+        ::fclose(fp);
+    }
+
+    auto bench = [](const char* name, Stream* stream) {
+        auto start = chrono::steady_clock::now();
+        BinaryReader<> reader(stream);
+        uint32_t sum = 0;
+        for (size_t i = 0; i < kCount; ++i)
+            sum += reader.ReadUInt32LE();
+        auto elapsed = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+        printf("[ BENCH    ] BinaryReader %-24s: %.2f M ints/s (%08X)\n", name, kCount / elapsed.count() / 1e6, sum);
+    };
+
+    {
+        BytesViewStream stream(BytesView(data.data(), data.size()));
+        bench("BytesViewStream", &stream);
+    }
+    {
+        FileStream stream(kPath);
+        bench("FileStream", &stream);
+    }
+    {
+        FileStream file(kPath);
+        BufferedStream stream(&file, 64 * 1024);
+        bench("BufferedStream(File)", &stream);
+    }
+    {
+        MmapStream stream(kPath);
+        bench("MmapStream", &stream);
+    }
+
+    // Mdr变长整数
+    vector<uint64_t> values(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+        values[i] = i * i;
+    vector<uint8_t> mdr;
+    {
+        BytesVectorStream stream(mdr);
+        Mdr::Writer writer(&stream);
+        writer.Write(values, 0);
+    }
+    {
+        FILE* fp = ::fopen(kPath, "wb");
+        ASSERT_NE(nullptr, fp);
+        ::fwrite(mdr.data(), 1, mdr.size(), fp);
+        ::fclose(fp);
+    }
+
+    auto benchMdr = [&](const char* name, Stream* stream) {
+        auto start = chrono::steady_clock::now();
+        vector<uint64_t> out;
+        Mdr::Reader reader(stream);
+        reader.Read(out, 0);
+        auto elapsed = chrono::duration_cast<chrono::duration<double>>(chrono::steady_clock::now() - start);
+        EXPECT_EQ(values, out);
+        printf("[ BENCH    ] Mdr %-33s: %.2f M varints/s\n", name, kCount / elapsed.count() / 1e6);
+    };
+
+    {
+        BytesViewStream stream(BytesView(mdr.data(), mdr.size()));
+        benchMdr("BytesViewStream", &stream);
+    }
+    {
+        FileStream stream(kPath);
+        benchMdr("FileStream", &stream);
+    }
+    {
+        FileStream file(kPath);
+        BufferedStream stream(&file, 64 * 1024);
+        benchMdr("BufferedStream(File)", &stream);
+    }
+    {
+        MmapStream stream(kPath);
+        benchMdr("MmapStream", &stream);
+    }
+
+    ::remove(kPath);
+}